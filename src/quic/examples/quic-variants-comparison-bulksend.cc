@@ -144,12 +144,14 @@ int main (int argc, char *argv[])
   bool flow_monitor = false;
   bool pcap = false;
   std::string queue_disc_type = "ns3::PfifoFastQueueDisc";
+  bool pacing = false;
 
   // LogComponentEnable ("Config", LOG_LEVEL_ALL);
   CommandLine cmd;
   cmd.AddValue ("transport_prot", "Transport protocol to use: TcpNewReno, "
                 "TcpHybla, TcpHighSpeed, TcpHtcp, TcpVegas, TcpScalable, TcpVeno, "
-                "TcpBic, TcpYeah, TcpIllinois, TcpWestwood, TcpWestwoodPlus, TcpLedbat ", transport_prot);
+                "TcpBic, TcpYeah, TcpIllinois, TcpWestwood, TcpWestwoodPlus, TcpLedbat, "
+                "QuicCongestionControl, QuicBbr, QuicCubic ", transport_prot);
   cmd.AddValue ("error_p", "Packet error rate", error_p);
   cmd.AddValue ("bandwidth", "Bottleneck bandwidth", bandwidth);
   cmd.AddValue ("delay", "Bottleneck delay", delay);
@@ -165,9 +167,12 @@ int main (int argc, char *argv[])
   cmd.AddValue ("flow_monitor", "Enable flow monitor", flow_monitor);
   cmd.AddValue ("pcap_tracing", "Enable or disable PCAP tracing", pcap);
   cmd.AddValue ("queue_disc_type", "Queue disc type for gateway (e.g. ns3::CoDelQueueDisc)", queue_disc_type);
+  cmd.AddValue ("pacing", "Enable pacing of QUIC data packets", pacing);
   cmd.Parse (argc, argv);
 
   transport_prot = std::string ("ns3::") + transport_prot;
+  // BBR is rate-based and relies on the socket pacing its packets
+  pacing |= transport_prot.compare ("ns3::QuicBbr") == 0;
 
   SeedManager::SetSeed (1);
   SeedManager::SetRun (run);
@@ -193,6 +198,7 @@ int main (int argc, char *argv[])
   Config::SetDefault ("ns3::QuicSocketBase::SocketSndBufSize", UintegerValue (1 << 21));
   Config::SetDefault ("ns3::QuicStreamBase::StreamSndBufSize", UintegerValue (1 << 21));
   Config::SetDefault ("ns3::QuicStreamBase::StreamRcvBufSize", UintegerValue (1 << 21));
+  Config::SetDefault ("ns3::QuicSocketBase::EnablePacing", BooleanValue (pacing));
  
   // Select congestion control variant
   if (transport_prot.compare ("ns3::TcpWestwoodPlus") == 0)
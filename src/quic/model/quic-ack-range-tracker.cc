@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Alvise De Biasio <alvise.debiasio@gmail.com>
+ *          Federico Chiariotti <chiariotti.federico@gmail.com>
+ *          Michele Polese <michele.polese@gmail.com>
+ *          Davide Marcato <davidemarcato@outlook.com>
+ *          
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <algorithm>
+#include <iterator>
+#include "quic-ack-range-tracker.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicAckRangeTracker");
+
+QuicAckRangeTracker::QuicAckRangeTracker ()
+  : m_ranges ()
+{
+}
+
+bool
+QuicAckRangeTracker::Add (uint64_t packetNumber)
+{
+  NS_LOG_FUNCTION (this << packetNumber);
+
+  // first range that starts after the packet number
+  RangeMap::iterator next = m_ranges.upper_bound (packetNumber);
+  RangeMap::iterator prev = m_ranges.end ();
+  if (next != m_ranges.begin ())
+    {
+      prev = std::prev (next);
+      if (prev->second >= packetNumber)
+        {
+          NS_LOG_LOGIC ("Duplicate packet " << packetNumber);
+          return false;
+        }
+    }
+
+  bool extendsPrev = (prev != m_ranges.end () && prev->second + 1 == packetNumber);
+  bool extendsNext = (next != m_ranges.end () && next->first == packetNumber + 1);
+
+  if (extendsPrev && extendsNext)
+    {
+      prev->second = next->second;
+      m_ranges.erase (next);
+    }
+  else if (extendsPrev)
+    {
+      prev->second = packetNumber;
+    }
+  else if (extendsNext)
+    {
+      uint64_t last = next->second;
+      m_ranges.erase (next);
+      m_ranges.insert (std::make_pair (packetNumber, last));
+    }
+  else
+    {
+      m_ranges.insert (next, std::make_pair (packetNumber, packetNumber));
+    }
+  return true;
+}
+
+bool
+QuicAckRangeTracker::Contains (uint64_t packetNumber) const
+{
+  RangeMap::const_iterator next = m_ranges.upper_bound (packetNumber);
+  if (next == m_ranges.begin ())
+    {
+      return false;
+    }
+  return std::prev (next)->second >= packetNumber;
+}
+
+bool
+QuicAckRangeTracker::IsEmpty () const
+{
+  return m_ranges.empty ();
+}
+
+uint64_t
+QuicAckRangeTracker::GetLargest () const
+{
+  NS_ABORT_MSG_IF (m_ranges.empty (), "No packet numbers tracked");
+  return m_ranges.rbegin ()->second;
+}
+
+uint64_t
+QuicAckRangeTracker::GetSmallestMissingAbove (uint64_t packetNumber) const
+{
+  uint64_t first = packetNumber + 1;
+  RangeMap::const_iterator next = m_ranges.upper_bound (first);
+  if (next != m_ranges.begin () && std::prev (next)->second >= first)
+    {
+      // ranges are not adjacent, the one after the range holding first is missing
+      return std::prev (next)->second + 1;
+    }
+  return first;
+}
+
+uint32_t
+QuicAckRangeTracker::GetNumRanges () const
+{
+  return m_ranges.size ();
+}
+
+void
+QuicAckRangeTracker::DiscardBelow (uint64_t packetNumber)
+{
+  NS_LOG_FUNCTION (this << packetNumber);
+
+  while (m_ranges.size () > 1 && m_ranges.begin ()->second < packetNumber)
+    {
+      NS_LOG_LOGIC ("Discard range [" << m_ranges.begin ()->first << ", "
+                                      << m_ranges.begin ()->second << "]");
+      m_ranges.erase (m_ranges.begin ());
+    }
+}
+
+void
+QuicAckRangeTracker::DiscardOldest (uint32_t maxRanges)
+{
+  NS_LOG_FUNCTION (this << maxRanges);
+
+  while (m_ranges.size () > std::max (maxRanges, (uint32_t) 1))
+    {
+      NS_LOG_LOGIC ("Discard range [" << m_ranges.begin ()->first << ", "
+                                      << m_ranges.begin ()->second << "]");
+      m_ranges.erase (m_ranges.begin ());
+    }
+}
+
+void
+QuicAckRangeTracker::BuildAckBlocks (uint32_t maxGaps, QuicAckRanges &ackRanges) const
+{
+  NS_LOG_FUNCTION (this << maxGaps);
+
+  ackRanges.Clear ();
+  RangeMap::const_reverse_iterator curr = m_ranges.rbegin ();
+  if (curr == m_ranges.rend ())
+    {
+      return;
+    }
+  RangeMap::const_reverse_iterator next = std::next (curr);
+  for (; next != m_ranges.rend () && ackRanges.GetCount () < maxGaps; ++curr, ++next)
+    {
+      ackRanges.Add (curr->first - 1, next->second);
+    }
+}
+
+void
+QuicAckRangeTracker::Clear ()
+{
+  m_ranges.clear ();
+}
+
+void
+QuicAckRangeTracker::Print (std::ostream &os) const
+{
+  for (RangeMap::const_reverse_iterator it = m_ranges.rbegin ();
+       it != m_ranges.rend (); ++it)
+    {
+      os << "[" << it->first << ", " << it->second << "]";
+    }
+}
+
+} // namespace ns3
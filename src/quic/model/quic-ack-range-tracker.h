@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Alvise De Biasio <alvise.debiasio@gmail.com>
+ *          Federico Chiariotti <chiariotti.federico@gmail.com>
+ *          Michele Polese <michele.polese@gmail.com>
+ *          Davide Marcato <davidemarcato@outlook.com>
+ *          
+ */
+
+#ifndef QUICACKRANGETRACKER_H
+#define QUICACKRANGETRACKER_H
+
+#include <map>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include "quic-ack-ranges.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ *
+ * \brief Set of received packet numbers, stored as coalesced ranges
+ *
+ * Each range [first, last] holds consecutive packet numbers received
+ * from the peer. Adjacent ranges are merged on insertion, so the memory
+ * footprint and the cost of building an ACK frame depend on the number
+ * of holes in the packet number space rather than on the number of
+ * received packets. Insertions take O(log R), with R the number of ranges.
+ */
+class QuicAckRangeTracker
+{
+public:
+  QuicAckRangeTracker ();
+
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param packetNumber the packet number
+   * \return false if the packet number was already recorded
+   */
+  bool Add (uint64_t packetNumber);
+
+  /**
+   * \brief Check whether a packet number has been recorded
+   *
+   * \param packetNumber the packet number
+   * \return true if the packet number belongs to a tracked range
+   */
+  bool Contains (uint64_t packetNumber) const;
+
+  /**
+   * \brief Check whether there is anything to acknowledge
+   *
+   * \return true if no packet numbers are tracked
+   */
+  bool IsEmpty () const;
+
+  /**
+   * \brief Get the largest packet number received
+   *
+   * \return the largest tracked packet number
+   */
+  uint64_t GetLargest () const;
+
+  /**
+   * \brief Get the first packet number not received after a given one
+   *
+   * \param packetNumber the packet number to start from
+   * \return the smallest packet number larger than packetNumber that is not
+   *         tracked, i.e., GetLargest () + 1 if there are no holes above it
+   */
+  uint64_t GetSmallestMissingAbove (uint64_t packetNumber) const;
+
+  /**
+   * \brief Get the number of disjoint ranges
+   *
+   * \return the number of tracked ranges
+   */
+  uint32_t GetNumRanges () const;
+
+  /**
+   * \brief Forget the ranges that lie entirely below a packet number
+   *
+   * Used once the peer has acknowledged an ACK frame covering those
+   * ranges. The range holding the largest packet number is always kept.
+   *
+   * \param packetNumber the lowest packet number that must still be reported
+   */
+  void DiscardBelow (uint64_t packetNumber);
+
+  /**
+   * \brief Forget the lowest ranges beyond a maximum number of ranges
+   *
+   * Bounds the memory of a receiver whose ACK frames are never
+   * acknowledged, and thus never pruned with DiscardBelow.
+   *
+   * \param maxRanges the maximum number of ranges to keep, at least one
+   */
+  void DiscardOldest (uint32_t maxRanges);
+
+  /**
+   * \brief Fill the gaps and additional ACK blocks of an ACK frame
+   *
+   * Ranges are visited from the highest to the lowest. For every hole,
+   * the gap holds the highest missing packet number and the block holds
+   * the highest packet number of the range below it, as expected by
+   * QuicSubheader::CreateAck.
+   *
+   * \param maxGaps the maximum number of gaps to report
+   * \param ackRanges the pairs of gaps and ACK blocks, cleared first
+   */
+  void BuildAckBlocks (uint32_t maxGaps, QuicAckRanges &ackRanges) const;
+
+  /**
+   * \brief Remove all the tracked ranges
+   */
+  void Clear ();
+
+  /**
+   * \brief Print the tracked ranges
+   * \param os ostream
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  typedef std::map<uint64_t, uint64_t> RangeMap;  //!< first packet number -> last packet number
+
+  RangeMap m_ranges;  //!< Disjoint, non-adjacent ranges of received packet numbers
+};
+
+} // namespace ns3
+
+#endif /* QUICACKRANGETRACKER_H */
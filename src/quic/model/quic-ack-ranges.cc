@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Alvise De Biasio <alvise.debiasio@gmail.com>
+ *          Federico Chiariotti <chiariotti.federico@gmail.com>
+ *          Michele Polese <michele.polese@gmail.com>
+ *          Davide Marcato <davidemarcato@outlook.com>
+ *          
+ */
+
+#include "ns3/assert.h"
+#include "quic-ack-ranges.h"
+
+namespace ns3 {
+
+const uint32_t QuicAckRanges::kInlineRanges;
+
+QuicAckRanges::QuicAckRanges ()
+  : m_count (0)
+{
+}
+
+void
+QuicAckRanges::Clear ()
+{
+  m_overflow.clear ();
+  m_count = 0;
+}
+
+void
+QuicAckRanges::Add (uint64_t gap, uint64_t block)
+{
+  if (m_count < kInlineRanges)
+    {
+      m_inline[m_count].m_gap = gap;
+      m_inline[m_count].m_block = block;
+    }
+  else
+    {
+      Range range;
+      range.m_gap = gap;
+      range.m_block = block;
+      m_overflow.push_back (range);
+    }
+  ++m_count;
+}
+
+uint32_t
+QuicAckRanges::GetCount () const
+{
+  return m_count;
+}
+
+uint64_t
+QuicAckRanges::GetGap (uint32_t index) const
+{
+  NS_ASSERT (index < m_count);
+  return index < kInlineRanges ? m_inline[index].m_gap : m_overflow[index - kInlineRanges].m_gap;
+}
+
+uint64_t
+QuicAckRanges::GetBlock (uint32_t index) const
+{
+  NS_ASSERT (index < m_count);
+  return index < kInlineRanges ? m_inline[index].m_block : m_overflow[index - kInlineRanges].m_block;
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Alvise De Biasio <alvise.debiasio@gmail.com>
+ *          Federico Chiariotti <chiariotti.federico@gmail.com>
+ *          Michele Polese <michele.polese@gmail.com>
+ *          Davide Marcato <davidemarcato@outlook.com>
+ *          
+ */
+
+#ifndef QUICACKRANGES_H
+#define QUICACKRANGES_H
+
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ *
+ * \brief Gaps and additional ACK blocks of an ACK frame
+ *
+ * The pairs are stored inline up to kInlineRanges, which covers the ACKs
+ * sent on most paths, and only the pairs beyond that go to the heap. ACK
+ * frames are therefore built, copied, parsed and processed without any
+ * allocation in the common case.
+ *
+ * Pair i holds the gap and the additional ACK block that follows it, as
+ * expected by QuicSubheader::CreateAck.
+ */
+class QuicAckRanges
+{
+public:
+  static const uint32_t kInlineRanges = 4;  //!< Number of pairs stored without allocation
+
+  QuicAckRanges ();
+
+  /**
+   * \brief Remove all the pairs
+   */
+  void Clear ();
+
+  /**
+   * \brief Append a pair
+   *
+   * \param gap the gap
+   * \param block the additional ACK block below the gap
+   */
+  void Add (uint64_t gap, uint64_t block);
+
+  /**
+   * \brief Get the number of pairs, i.e., the ACK block count
+   *
+   * \return the number of pairs
+   */
+  uint32_t GetCount () const;
+
+  /**
+   * \brief Get a gap
+   *
+   * \param index the index of the pair
+   * \return the gap
+   */
+  uint64_t GetGap (uint32_t index) const;
+
+  /**
+   * \brief Get an additional ACK block
+   *
+   * \param index the index of the pair
+   * \return the additional ACK block
+   */
+  uint64_t GetBlock (uint32_t index) const;
+
+private:
+  /**
+   * \brief A gap and the additional ACK block that follows it
+   */
+  struct Range
+  {
+    uint64_t m_gap;    //!< Gap
+    uint64_t m_block;  //!< Additional ACK block
+  };
+
+  Range m_inline[kInlineRanges];  //!< The first pairs
+  std::vector<Range> m_overflow;  //!< The pairs beyond kInlineRanges
+  uint32_t m_count;               //!< Number of pairs
+};
+
+} // namespace ns3
+
+#endif /* QUICACKRANGES_H */
@@ -0,0 +1,570 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "quic-bbr.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicBbr");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicBbr);
+
+const char* const
+QuicBbr::BbrModeName[QuicBbr::BBR_PROBE_RTT + 1] =
+{
+  "BBR_STARTUP", "BBR_DRAIN", "BBR_PROBE_BW", "BBR_PROBE_RTT"
+};
+
+/**
+ * Pacing gains of the phases of the probe-bandwidth cycle: probe for more
+ * bandwidth, drain the queue that probing may have created, then cruise
+ */
+static const double kPacingGainCycle[] = { 5.0 / 4, 3.0 / 4, 1, 1, 1, 1, 1, 1 };
+static const uint32_t kGainCycleLength = sizeof (kPacingGainCycle) / sizeof (double);
+
+/**
+ * Pacing and cwnd gain in startup: the smallest gain that doubles the
+ * delivery rate each round (2/ln(2))
+ */
+static const double kHighGain = 2.885;
+
+TypeId
+QuicBbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicBbr")
+    .SetParent<QuicCongestionOps> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicBbr> ()
+    .AddAttribute ("BandwidthWindowLength", "Length of the max bandwidth filter, in rounds",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&QuicBbr::m_bandwidthWindowLength),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MinRttWindowLength", "Length of the min RTT filter",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&QuicBbr::m_minRttWindowLength),
+                   MakeTimeChecker ())
+    .AddAttribute ("ProbeRttDuration", "Minimum time spent in probe-RTT",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&QuicBbr::m_probeRttDuration),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinCwndSegments", "Minimum congestion window, in segments",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&QuicBbr::m_minCwndSegments),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+QuicBbr::QuicBbr (void)
+  : QuicCongestionOps (),
+    m_highGain (kHighGain),
+    m_bandwidthWindowLength (10),
+    m_minRttWindowLength (Seconds (10)),
+    m_probeRttDuration (MilliSeconds (200)),
+    m_minCwndSegments (4),
+    m_mode (BBR_STARTUP),
+    m_pacingGain (m_highGain),
+    m_cWndGain (m_highGain),
+    m_cycleIndex (0),
+    m_cycleStamp (Seconds (0)),
+    m_filledPipe (false),
+    m_fullBandwidth (0),
+    m_fullBandwidthCount (0),
+    m_roundCount (0),
+    m_nextRoundDelivered (0),
+    m_roundStart (false),
+    m_minRtt (Time::Max ()),
+    m_minRttStamp (Seconds (0)),
+    m_probeRttDoneStamp (Seconds (0)),
+    m_probeRttRoundDone (false),
+    m_priorCwnd (0),
+    m_packetConservation (false),
+    m_inRecovery (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      m_maxBandwidth[i].m_rate = DataRate (0);
+      m_maxBandwidth[i].m_round = 0;
+    }
+}
+
+QuicBbr::QuicBbr (const QuicBbr& sock)
+  : QuicCongestionOps (sock),
+    m_highGain (sock.m_highGain),
+    m_bandwidthWindowLength (sock.m_bandwidthWindowLength),
+    m_minRttWindowLength (sock.m_minRttWindowLength),
+    m_probeRttDuration (sock.m_probeRttDuration),
+    m_minCwndSegments (sock.m_minCwndSegments),
+    m_mode (sock.m_mode),
+    m_pacingGain (sock.m_pacingGain),
+    m_cWndGain (sock.m_cWndGain),
+    m_cycleIndex (sock.m_cycleIndex),
+    m_cycleStamp (sock.m_cycleStamp),
+    m_filledPipe (sock.m_filledPipe),
+    m_fullBandwidth (sock.m_fullBandwidth),
+    m_fullBandwidthCount (sock.m_fullBandwidthCount),
+    m_roundCount (sock.m_roundCount),
+    m_nextRoundDelivered (sock.m_nextRoundDelivered),
+    m_roundStart (sock.m_roundStart),
+    m_minRtt (sock.m_minRtt),
+    m_minRttStamp (sock.m_minRttStamp),
+    m_probeRttDoneStamp (sock.m_probeRttDoneStamp),
+    m_probeRttRoundDone (sock.m_probeRttRoundDone),
+    m_priorCwnd (sock.m_priorCwnd),
+    m_packetConservation (sock.m_packetConservation),
+    m_inRecovery (sock.m_inRecovery)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      m_maxBandwidth[i] = sock.m_maxBandwidth[i];
+    }
+}
+
+QuicBbr::~QuicBbr (void)
+{
+}
+
+std::string
+QuicBbr::GetName () const
+{
+  return "QuicBbr";
+}
+
+Ptr<TcpCongestionOps>
+QuicBbr::Fork ()
+{
+  return CopyObject<QuicBbr> (this);
+}
+
+bool
+QuicBbr::HasPacingRate () const
+{
+  return true;
+}
+
+QuicBbr::BbrMode_t
+QuicBbr::GetMode () const
+{
+  return m_mode;
+}
+
+DataRate
+QuicBbr::GetMaxBandwidth () const
+{
+  return m_maxBandwidth[0].m_rate;
+}
+
+Time
+QuicBbr::GetMinRtt () const
+{
+  return m_minRtt;
+}
+
+void
+QuicBbr::OnPacketSent (QuicSocketState &tcb,
+                       SequenceNumber64 packetNumber, bool isAckOnly)
+{
+  NS_LOG_FUNCTION (this << packetNumber << isAckOnly);
+  QuicCongestionOps::OnPacketSent (tcb, packetNumber, isAckOnly);
+
+  if (m_minRtt == Time::Max ())
+    {
+      // No estimate yet: pace the initial window at the startup gain
+      SetPacingRate (tcb);
+    }
+}
+
+void
+QuicBbr::OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack,
+                        QuicSocketTxItemSpan newAcks,
+                        const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  QuicCongestionOps::OnAckReceived (tcb, ack, newAcks, rs);
+
+  uint32_t priorInFlight = tcb.m_bytesInFlight.Get () + rs.m_ackedBytes;
+
+  m_roundStart = false;
+  if (rs.m_delivered > 0 && rs.m_priorDelivered >= m_nextRoundDelivered)
+    {
+      // The ACK delivered a packet sent after the start of the round
+      m_nextRoundDelivered = rs.m_totalDelivered;
+      m_roundCount++;
+      m_roundStart = true;
+      m_packetConservation = false;
+    }
+  // Application limited samples only tell that the bandwidth is at least that high
+  if (rs.IsValid () && (!rs.m_isAppLimited || rs.m_deliveryRate >= GetMaxBandwidth ()))
+    {
+      UpdateMaxBandwidth (rs.m_deliveryRate);
+    }
+
+  // newAcks are ordered from the highest packet number to the smallest
+  QuicSocketTxItem* lastAcked = newAcks.front ();
+  if (m_inRecovery && lastAcked->m_packetNumber > tcb.m_endOfRecovery)
+    {
+      NS_LOG_INFO ("Exit recovery, restore cwnd " << m_priorCwnd);
+      m_inRecovery = false;
+      m_packetConservation = false;
+      tcb.m_cWnd = std::max (tcb.m_cWnd.Get (), m_priorCwnd);
+    }
+
+  CheckCyclePhase (tcb, priorInFlight);
+  CheckFullPipe ();
+  CheckDrain (tcb);
+  UpdateMinRtt (tcb, Now () - lastAcked->m_lastSent);
+  CheckProbeRtt (tcb, rs);
+
+  SetPacingRate (tcb);
+  SetCwnd (tcb, rs);
+}
+
+void
+QuicBbr::OnPacketsLost (QuicSocketState &tcb,
+                        QuicSocketTxItemSpan lostPackets,
+                        const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto largestLostPacket = lostPackets.back ();
+  if (!InRecovery (tcb, largestLostPacket->m_packetNumber))
+    {
+      // BBR does not back off on loss, but conserves packets for one round
+      NS_LOG_INFO ("Enter recovery, packet conservation");
+      tcb.m_endOfRecovery = tcb.m_highTxPacketNumber;
+      if (!m_inRecovery)
+        {
+          m_priorCwnd = tcb.m_cWnd;
+        }
+      m_inRecovery = true;
+      m_packetConservation = true;
+      m_nextRoundDelivered = rs.m_totalDelivered;
+      tcb.m_cWnd = std::max (tcb.m_bytesInFlight.Get (),
+                              m_minCwndSegments * tcb.m_segmentSize);
+    }
+
+  // the window before the congestion is restored at the end of the recovery
+  if (InPersistentCongestion (tcb, lostPackets))
+    {
+      OnPersistentCongestion (tcb);
+    }
+}
+
+void
+QuicBbr::OnPacketAckedCC (QuicSocketState &tcb,
+                          QuicSocketTxItem & ackedPacket)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QuicBbr::UpdateMaxBandwidth (DataRate sample)
+{
+  NS_LOG_FUNCTION (this << sample);
+
+  // Windowed max filter with three samples (Kathleen Nichols' algorithm)
+  BandwidthSample val;
+  val.m_rate = sample;
+  val.m_round = m_roundCount;
+  uint64_t window = m_bandwidthWindowLength;
+
+  if (sample >= m_maxBandwidth[0].m_rate
+      || val.m_round - m_maxBandwidth[2].m_round > window)
+    {
+      m_maxBandwidth[0] = m_maxBandwidth[1] = m_maxBandwidth[2] = val;
+      return;
+    }
+  if (sample >= m_maxBandwidth[1].m_rate)
+    {
+      m_maxBandwidth[1] = m_maxBandwidth[2] = val;
+    }
+  else if (sample >= m_maxBandwidth[2].m_rate)
+    {
+      m_maxBandwidth[2] = val;
+    }
+
+  uint64_t dt = val.m_round - m_maxBandwidth[0].m_round;
+  if (dt > window)
+    {
+      // The best sample expired: promote the second and third best
+      m_maxBandwidth[0] = m_maxBandwidth[1];
+      m_maxBandwidth[1] = m_maxBandwidth[2];
+      m_maxBandwidth[2] = val;
+      if (val.m_round - m_maxBandwidth[0].m_round > window)
+        {
+          m_maxBandwidth[0] = m_maxBandwidth[1];
+          m_maxBandwidth[1] = m_maxBandwidth[2];
+        }
+    }
+  else if (m_maxBandwidth[1].m_round == m_maxBandwidth[0].m_round
+           && dt > window / 4)
+    {
+      // A quarter of the window passed without a second best sample
+      m_maxBandwidth[1] = m_maxBandwidth[2] = val;
+    }
+  else if (m_maxBandwidth[2].m_round == m_maxBandwidth[1].m_round
+           && dt > window / 2)
+    {
+      // Half of the window passed without a third best sample
+      m_maxBandwidth[2] = val;
+    }
+}
+
+void
+QuicBbr::UpdateMinRtt (QuicSocketState &tcb, Time rtt)
+{
+  NS_LOG_FUNCTION (this << rtt);
+
+  bool expired = Now () > m_minRttStamp + m_minRttWindowLength;
+  if (rtt.IsStrictlyPositive () && (rtt <= m_minRtt || expired))
+    {
+      m_minRtt = rtt;
+      m_minRttStamp = Now ();
+    }
+
+  if (expired && m_mode != BBR_PROBE_RTT && m_minRtt != Time::Max ())
+    {
+      NS_LOG_INFO ("Min RTT expired, enter " << BbrModeName[BBR_PROBE_RTT]);
+      m_mode = BBR_PROBE_RTT;
+      m_pacingGain = 1;
+      m_cWndGain = 1;
+      m_priorCwnd = m_inRecovery ? std::max (m_priorCwnd, tcb.m_cWnd.Get ()) : tcb.m_cWnd.Get ();
+      m_probeRttDoneStamp = Seconds (0);
+    }
+}
+
+void
+QuicBbr::CheckCyclePhase (QuicSocketState &tcb, uint32_t priorInFlight)
+{
+  NS_LOG_FUNCTION (this << priorInFlight);
+
+  if (m_mode != BBR_PROBE_BW)
+    {
+      return;
+    }
+
+  bool isFullLength = (Now () - m_cycleStamp) > m_minRtt;
+  bool advance = isFullLength;
+  if (m_pacingGain > 1)
+    {
+      // Keep probing until the extra data is actually in flight
+      advance = isFullLength && (m_inRecovery
+                                 || priorInFlight >= GetInflight (tcb, m_pacingGain));
+    }
+  else if (m_pacingGain < 1)
+    {
+      // Stop draining as soon as the queue is gone
+      advance = isFullLength || priorInFlight <= GetInflight (tcb, 1);
+    }
+
+  if (advance)
+    {
+      m_cycleIndex = (m_cycleIndex + 1) % kGainCycleLength;
+      m_cycleStamp = Now ();
+      m_pacingGain = kPacingGainCycle[m_cycleIndex];
+      NS_LOG_LOGIC ("Gain cycle phase " << m_cycleIndex << " pacing gain " << m_pacingGain);
+    }
+}
+
+void
+QuicBbr::CheckFullPipe ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_filledPipe || !m_roundStart)
+    {
+      return;
+    }
+
+  DataRate maxBandwidth = GetMaxBandwidth ();
+  if (maxBandwidth.GetBitRate () >= m_fullBandwidth.GetBitRate () * 5 / 4)
+    {
+      m_fullBandwidth = maxBandwidth;
+      m_fullBandwidthCount = 0;
+      return;
+    }
+  m_fullBandwidthCount++;
+  if (m_fullBandwidthCount >= 3)
+    {
+      NS_LOG_INFO ("Bandwidth stopped growing at " << m_fullBandwidth << ", pipe filled");
+      m_filledPipe = true;
+    }
+}
+
+void
+QuicBbr::CheckDrain (QuicSocketState &tcb)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_mode == BBR_STARTUP && m_filledPipe)
+    {
+      NS_LOG_INFO ("Enter " << BbrModeName[BBR_DRAIN]);
+      m_mode = BBR_DRAIN;
+      m_pacingGain = 1 / m_highGain;
+      m_cWndGain = m_highGain;
+    }
+  if (m_mode == BBR_DRAIN && tcb.m_bytesInFlight.Get () <= GetInflight (tcb, 1))
+    {
+      EnterProbeBw ();
+    }
+}
+
+void
+QuicBbr::CheckProbeRtt (QuicSocketState &tcb, const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_mode != BBR_PROBE_RTT)
+    {
+      return;
+    }
+
+  if (m_probeRttDoneStamp.IsZero ()
+      && tcb.m_bytesInFlight.Get () <= m_minCwndSegments * tcb.m_segmentSize)
+    {
+      m_probeRttDoneStamp = Now () + m_probeRttDuration;
+      m_probeRttRoundDone = false;
+      m_nextRoundDelivered = rs.m_totalDelivered;
+    }
+  else if (!m_probeRttDoneStamp.IsZero ())
+    {
+      if (m_roundStart)
+        {
+          m_probeRttRoundDone = true;
+        }
+      if (m_probeRttRoundDone && Now () > m_probeRttDoneStamp)
+        {
+          m_minRttStamp = Now ();
+          tcb.m_cWnd = std::max (tcb.m_cWnd.Get (), m_priorCwnd);
+          if (m_filledPipe)
+            {
+              EnterProbeBw ();
+            }
+          else
+            {
+              EnterStartup ();
+            }
+        }
+    }
+}
+
+void
+QuicBbr::EnterStartup ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("Enter " << BbrModeName[BBR_STARTUP]);
+  m_mode = BBR_STARTUP;
+  m_pacingGain = m_highGain;
+  m_cWndGain = m_highGain;
+}
+
+void
+QuicBbr::EnterProbeBw ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("Enter " << BbrModeName[BBR_PROBE_BW]);
+  m_mode = BBR_PROBE_BW;
+  m_cWndGain = 2;
+  // Start at a random phase, but never in the draining one
+  m_cycleIndex = m_uv->GetInteger (0, kGainCycleLength - 2);
+  if (m_cycleIndex >= 1)
+    {
+      m_cycleIndex++;
+    }
+  m_cycleStamp = Now ();
+  m_pacingGain = kPacingGainCycle[m_cycleIndex];
+}
+
+uint32_t
+QuicBbr::GetInflight (const QuicSocketState &tcb, double gain) const
+{
+  if (m_minRtt == Time::Max ())
+    {
+      return tcb.m_initialCWnd;
+    }
+  double bdp = GetMaxBandwidth ().GetBitRate () * m_minRtt.GetSeconds () / 8;
+  // Allow some extra room for delayed and stretched ACKs
+  return static_cast<uint32_t> (gain * bdp) + 3 * tcb.m_segmentSize;
+}
+
+void
+QuicBbr::SetPacingRate (QuicSocketState &tcb)
+{
+  NS_LOG_FUNCTION (this);
+
+  DataRate rate;
+  if (GetMaxBandwidth ().GetBitRate () == 0)
+    {
+      Time rtt = tcb.m_smoothedRtt.IsZero () ? tcb.m_kDefaultInitialRtt : tcb.m_smoothedRtt;
+      rate = DataRate (m_highGain * tcb.m_cWnd.Get () * 8 / rtt.GetSeconds ());
+    }
+  else
+    {
+      rate = DataRate (m_pacingGain * GetMaxBandwidth ().GetBitRate ());
+    }
+  if (tcb.m_maxPacingRate.GetBitRate () > 0 && tcb.m_maxPacingRate < rate)
+    {
+      rate = tcb.m_maxPacingRate;
+    }
+  // Do not slow down in startup until the pipe is filled
+  if (m_filledPipe || rate > tcb.m_currentPacingRate)
+    {
+      tcb.m_currentPacingRate = rate;
+    }
+}
+
+void
+QuicBbr::SetCwnd (QuicSocketState &tcb, const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this << rs.m_ackedBytes);
+
+  uint32_t ackedBytes = rs.m_ackedBytes;
+  uint32_t cWnd = tcb.m_cWnd;
+  uint32_t target = GetInflight (tcb, m_cWndGain);
+  if (m_packetConservation)
+    {
+      cWnd = std::max (cWnd, tcb.m_bytesInFlight.Get () + ackedBytes);
+    }
+  else if (m_filledPipe)
+    {
+      cWnd = std::min (cWnd + ackedBytes, target);
+    }
+  else if (cWnd < target || rs.m_totalDelivered < tcb.m_initialCWnd)
+    {
+      cWnd += ackedBytes;
+    }
+  cWnd = std::max (cWnd, m_minCwndSegments * tcb.m_segmentSize);
+  if (m_mode == BBR_PROBE_RTT)
+    {
+      cWnd = std::min (cWnd, m_minCwndSegments * tcb.m_segmentSize);
+    }
+  tcb.m_cWnd = cWnd;
+  NS_LOG_LOGIC (BbrModeName[m_mode] << " cWnd " << cWnd << " target " << target
+                << " bw " << GetMaxBandwidth () << " minRtt " << m_minRtt);
+}
+
+} // namespace ns3
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICBBR_H
+#define QUICBBR_H
+
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+#include "quic-congestion-ops.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief BBR congestion control for QUIC
+ *
+ * Model-based congestion control (draft-cardwell-iccrg-bbr-congestion-control).
+ * BBR estimates the bottleneck bandwidth with a windowed max filter on the
+ * delivery rate and the round-trip propagation delay with a windowed min
+ * filter on the RTT samples, and paces at a gain-scaled multiple of the
+ * bandwidth estimate. The congestion window is a gain-scaled multiple of the
+ * estimated bandwidth-delay product.
+ *
+ * The pacing rate is written in TcpSocketState::m_currentPacingRate; pacing must be
+ * enabled in the socket (attribute ns3::QuicSocketBase::EnablePacing) for it
+ * to take effect.
+ */
+class QuicBbr : public QuicCongestionOps
+{
+public:
+  /**
+   * \brief BBR state machine modes
+   */
+  typedef enum
+  {
+    BBR_STARTUP,    //!< Ramp up quickly to find the bottleneck bandwidth
+    BBR_DRAIN,      //!< Drain the queue created in startup
+    BBR_PROBE_BW,   //!< Cycle the pacing gain to probe for more bandwidth
+    BBR_PROBE_RTT   //!< Cut inflight to probe the round-trip propagation delay
+  } BbrMode_t;
+
+  /**
+   * \brief Literal names of BBR modes for use in log messages
+   */
+  static const char* const BbrModeName[BBR_PROBE_RTT + 1];
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicBbr ();
+  QuicBbr (const QuicBbr& sock);
+  ~QuicBbr ();
+
+  std::string GetName () const;
+  Ptr<TcpCongestionOps> Fork ();
+
+  void OnPacketSent (QuicSocketState &tcb, SequenceNumber64 packetNumber, bool isAckOnly);
+  void OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack, QuicSocketTxItemSpan newAcks,
+                      const QuicRateSample &rs);
+  void OnPacketsLost (QuicSocketState &tcb, QuicSocketTxItemSpan lostPackets,
+                      const QuicRateSample &rs);
+  bool HasPacingRate () const;
+
+  /**
+   * \brief Get the current mode of the BBR state machine
+   *
+   * \return the current mode
+   */
+  BbrMode_t GetMode () const;
+
+  /**
+   * \brief Get the output of the max bandwidth filter
+   *
+   * \return the estimated bottleneck bandwidth
+   */
+  DataRate GetMaxBandwidth () const;
+
+  /**
+   * \brief Get the output of the min RTT filter
+   *
+   * \return the estimated round-trip propagation delay
+   */
+  Time GetMinRtt () const;
+
+protected:
+  /**
+   * \brief Window growth is driven by the BBR model, not by each acked packet
+   *
+   * \param tcb the congestion state of the socket
+   * \param ackedPacket the acked packet
+   */
+  void OnPacketAckedCC (QuicSocketState &tcb, QuicSocketTxItem & ackedPacket);
+
+private:
+  /**
+   * \brief A sample of the windowed max bandwidth filter
+   */
+  struct BandwidthSample
+  {
+    DataRate m_rate;   //!< Delivery rate
+    uint64_t m_round;  //!< Round in which the rate was measured
+  };
+
+  /**
+   * \brief Update the windowed max filter with a new delivery rate sample,
+   *   keeping the best, second best and third best samples of the window
+   *
+   * \param sample the delivery rate sample
+   */
+  void UpdateMaxBandwidth (DataRate sample);
+
+  /**
+   * \brief Update the min RTT filter, entering probe-RTT when it expires
+   *
+   * \param tcb the socket state
+   * \param rtt the RTT sample
+   */
+  void UpdateMinRtt (QuicSocketState &tcb, Time rtt);
+
+  /**
+   * \brief Advance the probe-bandwidth gain cycle if the current phase is over
+   *
+   * \param tcb the socket state
+   * \param priorInFlight the bytes in flight before the ACK
+   */
+  void CheckCyclePhase (QuicSocketState &tcb, uint32_t priorInFlight);
+
+  /**
+   * \brief Detect when the bandwidth estimate stops growing in startup
+   */
+  void CheckFullPipe ();
+
+  /**
+   * \brief Move from startup to drain, and from drain to probe-bandwidth
+   *
+   * \param tcb the socket state
+   */
+  void CheckDrain (QuicSocketState &tcb);
+
+  /**
+   * \brief Hold the window low for the probe-RTT duration and one round
+   *
+   * \param tcb the socket state
+   * \param rs the delivery rate sample of the ACK
+   */
+  void CheckProbeRtt (QuicSocketState &tcb, const QuicRateSample &rs);
+
+  /**
+   * \brief Enter the startup mode
+   */
+  void EnterStartup ();
+
+  /**
+   * \brief Enter the probe-bandwidth mode at a random phase of the gain cycle
+   */
+  void EnterProbeBw ();
+
+  /**
+   * \brief Compute the amount of data in flight for a given gain on the
+   *   estimated bandwidth-delay product
+   *
+   * \param tcb the socket state
+   * \param gain the gain
+   * \return the target inflight in bytes
+   */
+  uint32_t GetInflight (const QuicSocketState &tcb, double gain) const;
+
+  /**
+   * \brief Set the pacing rate in the tcb from the bandwidth estimate
+   *
+   * \param tcb the socket state
+   */
+  void SetPacingRate (QuicSocketState &tcb);
+
+  /**
+   * \brief Set the congestion window in the tcb from the BDP estimate
+   *
+   * \param tcb the socket state
+   * \param rs the delivery rate sample of the ACK
+   */
+  void SetCwnd (QuicSocketState &tcb, const QuicRateSample &rs);
+
+  // Parameters
+  double m_highGain;                 //!< Pacing and cwnd gain in startup
+  uint32_t m_bandwidthWindowLength;  //!< Length of the max bandwidth filter, in rounds
+  Time m_minRttWindowLength;         //!< Length of the min RTT filter
+  Time m_probeRttDuration;           //!< Minimum time spent in probe-RTT
+  uint32_t m_minCwndSegments;        //!< Minimum congestion window, in segments
+
+  // State machine
+  BbrMode_t m_mode;                  //!< Current mode
+  double m_pacingGain;               //!< Current pacing gain
+  double m_cWndGain;                 //!< Current cwnd gain
+  uint32_t m_cycleIndex;             //!< Phase of the probe-bandwidth gain cycle
+  Time m_cycleStamp;                 //!< Start of the current gain cycle phase
+  bool m_filledPipe;                 //!< True once the bandwidth estimate stops growing in startup
+  DataRate m_fullBandwidth;          //!< Bandwidth at the last startup growth check
+  uint32_t m_fullBandwidthCount;     //!< Rounds without significant bandwidth growth
+  Ptr<UniformRandomVariable> m_uv;   //!< Random variable to pick the initial gain cycle phase
+
+  // Bandwidth estimation
+  uint64_t m_roundCount;             //!< Count of packet-timed round trips
+  uint64_t m_nextRoundDelivered;     //!< Delivered count marking the end of the current round
+  bool m_roundStart;                 //!< True if the current ACK started a new round
+  BandwidthSample m_maxBandwidth[3]; //!< Best samples of the windowed max bandwidth filter
+
+  // Min RTT filter and probe-RTT
+  Time m_minRtt;                     //!< Estimated round-trip propagation delay
+  Time m_minRttStamp;                //!< Time at which m_minRtt was measured
+  Time m_probeRttDoneStamp;          //!< End of the probe-RTT duration (zero if not started)
+  bool m_probeRttRoundDone;          //!< True once a round elapsed in probe-RTT
+
+  // Loss recovery
+  uint32_t m_priorCwnd;              //!< Congestion window saved before recovery or probe-RTT
+  bool m_packetConservation;         //!< True in the first round of a recovery epoch
+  bool m_inRecovery;                 //!< True during a loss recovery epoch
+};
+
+} // namespace ns3
+
+#endif /* QUICBBR_H */
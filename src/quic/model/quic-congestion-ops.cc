@@ -81,46 +81,46 @@ QuicCongestionOps::Fork ()
 // Quic DRAFT 10
 
 void
-QuicCongestionOps::OnPacketSent (Ptr<TcpSocketState> tcb,
-                                     SequenceNumber32 packetNumber,
+QuicCongestionOps::OnPacketSent (QuicSocketState &tcb,
+                                     SequenceNumber64 packetNumber,
                                      bool isAckOnly)
 {
   NS_LOG_FUNCTION (this << packetNumber << isAckOnly);
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
 
-  tcbd->m_timeOfLastSentPacket = Now ();
-  tcbd->m_highTxMark = packetNumber;
+  if (!isAckOnly)
+    {
+      tcb.m_timeOfLastSentPacket = Now ();
+    }
+  tcb.m_highTxPacketNumber = packetNumber;
 }
 
 void
-QuicCongestionOps::OnAckReceived (Ptr<TcpSocketState> tcb,
+QuicCongestionOps::OnAckReceived (QuicSocketState &tcb,
                                       QuicSubheader &ack,
-                                      std::vector<QuicSocketTxItem*> newAcks)
+                                      QuicSocketTxItemSpan newAcks,
+                                      const QuicRateSample &rs)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
-
-  tcbd->m_largestAckedPacket = SequenceNumber32 (
+  tcb.m_largestAckedPacket = SequenceNumber64 (
       ack.GetLargestAcknowledged ());
   
   // newAcks are ordered from the highest packet number to the smalles
-  QuicSocketTxItem* lastAcked = newAcks.at (0);
+  QuicSocketTxItem* lastAcked = newAcks.front ();
 
   NS_LOG_LOGIC ("Updating RTT estimate");
   // If the largest acked is newly acked, update the RTT.
-  if (lastAcked->m_packetNumber == tcbd->m_largestAckedPacket)
+  if (lastAcked->m_packetNumber == tcb.m_largestAckedPacket)
     {
-      tcbd->m_lastRtt = Now () - lastAcked->m_lastSent;
-      UpdateRtt (tcbd, tcbd->m_lastRtt, Time (ack.GetAckDelay ()));
+      tcb.m_lastRtt = Now () - lastAcked->m_lastSent;
+      UpdateRtt (tcb, tcb.m_lastRtt, MicroSeconds (ack.GetAckDelay ()));
     }
 
   NS_LOG_LOGIC ("Processing acknowledged packets");
   // Process each acked packet
-  for (auto it = newAcks.rbegin (); it != newAcks.rend (); ++it)
+  for (auto it = newAcks.end (); it != newAcks.begin (); )
     {
+      --it;
       if ((*it)->m_acked)
         {
           OnPacketAcked (tcb, (**it));
@@ -129,86 +129,61 @@ QuicCongestionOps::OnAckReceived (Ptr<TcpSocketState> tcb,
 }
 
 void
-QuicCongestionOps::UpdateRtt (Ptr<TcpSocketState> tcb, Time latestRtt,
+QuicCongestionOps::UpdateRtt (QuicSocketState &tcb, Time latestRtt,
                                   Time ackDelay)
 {
   NS_LOG_FUNCTION (this);
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
+
+  // The first sample initializes the estimate - RFC 9002, Sec. 5.3
+  if (tcb.m_firstRttSample.IsZero ())
+    {
+      tcb.m_firstRttSample = Now ();
+      tcb.m_minRtt = latestRtt;
+      tcb.m_smoothedRtt = latestRtt;
+      tcb.m_rttVar = latestRtt / 2;
+      return;
+    }
 
   // m_minRtt ignores ack delay.
-  tcbd->m_minRtt = std::min (tcbd->m_minRtt, latestRtt);
+  tcb.m_minRtt = std::min (tcb.m_minRtt, latestRtt);
 
   NS_LOG_LOGIC ("Correct for ACK delay");
-  // Adjust for ack delay if it's plausible.
-  if (latestRtt - tcbd->m_minRtt > ackDelay)
+  // Adjust for ack delay if it's plausible, the peer does not delay more than max_ack_delay
+  ackDelay = std::min (ackDelay, tcb.GetMaxAckDelay ());
+  if (latestRtt >= tcb.m_minRtt + ackDelay)
     {
       latestRtt -= ackDelay;
-      // TODO check this condition
-      // Only save into max ack delay if it's used for rtt calculation and is not ack only
-//        if (!tcbd->m_sentPackets[tcbd->m_largestAckedPacket]->m_ackOnly)
-//          {
-//            tcbd->m_maxAckDelay = std::max (tcbd->m_maxAckDelay, ackDelay);
-//          }
     }
 
   NS_LOG_LOGIC ("Update smoothed RTT");
-  // Based on [RFC6298].
-  if (tcbd->m_smoothedRtt == 0)
-    {
-      tcbd->m_smoothedRtt = latestRtt;
-      tcbd->m_rttVar = latestRtt / 2;
-    }
-  else
-    {
-      Time rttVarSample = Time (
-          std::abs ((tcbd->m_smoothedRtt - latestRtt).GetDouble ()));
-      tcbd->m_rttVar = 3 / 4 * tcbd->m_rttVar + 1 / 4 * rttVarSample;
-      tcbd->m_smoothedRtt = 7 / 8 * tcbd->m_smoothedRtt + 1 / 8 * latestRtt;
-    }
-
+  Time rttVarSample = Abs (tcb.m_smoothedRtt - latestRtt);
+  tcb.m_rttVar = (3 * tcb.m_rttVar + rttVarSample) / 4;
+  tcb.m_smoothedRtt = (7 * tcb.m_smoothedRtt + latestRtt) / 8;
 }
 
 void
-QuicCongestionOps::OnPacketAcked (Ptr<TcpSocketState> tcb,
+QuicCongestionOps::OnPacketAcked (QuicSocketState &tcb,
                                       QuicSocketTxItem &ackedPacket)
 {
   NS_LOG_FUNCTION (this);
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
 
-  OnPacketAckedCC (tcbd, ackedPacket);
-
-  NS_LOG_LOGIC ("Handle possible RTO");
-  // If a packet sent prior to RTO was acked, then the RTO  was spurious. Otherwise, inform congestion control.
-  if (tcbd->m_rtoCount > 0
-      and ackedPacket.m_packetNumber > tcbd->m_largestSentBeforeRto)
-    {
-      OnRetransmissionTimeoutVerified (tcb);
-    }
-  tcbd->m_handshakeCount = 0;
-  tcbd->m_tlpCount = 0;
-  tcbd->m_rtoCount = 0;
+  OnPacketAckedCC (tcb, ackedPacket);
 }
 
 bool
-QuicCongestionOps::InRecovery (Ptr<TcpSocketState> tcb,
-                                   SequenceNumber32 packetNumber)
+QuicCongestionOps::InRecovery (const QuicSocketState &tcb,
+                                   SequenceNumber64 packetNumber) const
 {
   NS_LOG_FUNCTION (this << packetNumber.GetValue ());
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
 
-  return packetNumber <= tcbd->m_endOfRecovery;
+  return packetNumber <= tcb.m_endOfRecovery;
 }
 
 void
-QuicCongestionOps::OnPacketAckedCC (Ptr<TcpSocketState> tcb,
+QuicCongestionOps::OnPacketAckedCC (QuicSocketState &tcb,
                                         QuicSocketTxItem & ackedPacket)
 {
   NS_LOG_FUNCTION (this);
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
 
   NS_LOG_INFO ("Updating congestion window");
   if (InRecovery (tcb, ackedPacket.m_packetNumber))
@@ -217,55 +192,95 @@ QuicCongestionOps::OnPacketAckedCC (Ptr<TcpSocketState> tcb,
       // Do not increase congestion window in recovery period.
       return;
     }
-  if (tcbd->m_cWnd < tcbd->m_ssThresh)
+  if (tcb.m_cWnd < tcb.m_ssThresh)
     {
       NS_LOG_LOGIC ("In slow start");
       // Slow start.
-      tcbd->m_cWnd += ackedPacket.m_packet->GetSize ();
+      tcb.m_cWnd += ackedPacket.m_size;
     }
   else
     {
       NS_LOG_LOGIC ("In congestion avoidance");
       // Congestion Avoidance.
-      tcbd->m_cWnd += tcbd->m_segmentSize * ackedPacket.m_packet->GetSize ()
-        / tcbd->m_cWnd;
+      tcb.m_cWnd += tcb.m_segmentSize * ackedPacket.m_size
+        / tcb.m_cWnd;
     }
 }
 
 void
 QuicCongestionOps::OnPacketsLost (
-  Ptr<TcpSocketState> tcb, std::vector<QuicSocketTxItem*> lostPackets)
+  QuicSocketState &tcb, QuicSocketTxItemSpan lostPackets, const QuicRateSample &rs)
 {
   NS_LOG_LOGIC (this);
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
 
-  auto largestLostPacket = *(lostPackets.end () - 1);
+  auto largestLostPacket = lostPackets.back ();
 
   NS_LOG_INFO ("Go in recovery mode");
   // Start a new recovery epoch if the lost packet is larger than the end of the previous recovery epoch.
-  if (!InRecovery (tcbd, largestLostPacket->m_packetNumber))
+  if (!InRecovery (tcb, largestLostPacket->m_packetNumber))
+    {
+      tcb.m_endOfRecovery = tcb.m_highTxPacketNumber;
+      tcb.m_cWnd *= tcb.m_kLossReductionFactor;
+      if (tcb.m_cWnd < tcb.m_kMinimumWindow)
+        {
+          tcb.m_cWnd = tcb.m_kMinimumWindow;
+        }
+      tcb.m_ssThresh = tcb.m_cWnd;
+    }
+
+  if (InPersistentCongestion (tcb, lostPackets))
+    {
+      OnPersistentCongestion (tcb);
+    }
+}
+
+bool
+QuicCongestionOps::InPersistentCongestion (const QuicSocketState &tcb,
+                                           QuicSocketTxItemSpan lostPackets) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (tcb.m_firstRttSample.IsZero ())
+    {
+      return false;
+    }
+
+  Time duration = tcb.GetProbeTimeout () * tcb.m_kPersistentCongestionThreshold;
+  const QuicSocketTxItem *first = 0;
+  for (auto it = lostPackets.begin (); it != lostPackets.end (); ++it)
     {
-      tcbd->m_endOfRecovery = tcbd->m_highTxMark;
-      tcbd->m_cWnd *= tcbd->m_kLossReductionFactor;
-      if (tcbd->m_cWnd < tcbd->m_kMinimumWindow)
+      // the packets sent before the first RTT sample do not count
+      if ((*it)->m_lastSent < tcb.m_firstRttSample)
+        {
+          continue;
+        }
+      if (first == 0 || (*it)->m_packetNumber != (*(it - 1))->m_packetNumber + 1)
+        {
+          first = *it;
+        }
+      else if ((*it)->m_lastSent - first->m_lastSent > duration)
         {
-          tcbd->m_cWnd = tcbd->m_kMinimumWindow;
+          NS_LOG_INFO ("Packets " << first->m_packetNumber << " to " << (*it)->m_packetNumber
+                                  << " lost in " << ((*it)->m_lastSent - first->m_lastSent).GetSeconds ()
+                                  << " s, persistent congestion");
+          return true;
         }
-      tcbd->m_ssThresh = tcbd->m_cWnd;
     }
+  return false;
+}
+
+bool
+QuicCongestionOps::HasPacingRate () const
+{
+  return false;
 }
 
 void
-QuicCongestionOps::OnRetransmissionTimeoutVerified (
-  Ptr<TcpSocketState> tcb)
+QuicCongestionOps::OnPersistentCongestion (QuicSocketState &tcb)
 {
   NS_LOG_FUNCTION (this);
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-  NS_ASSERT_MSG (tcbd != 0, "tcb is not a QuicSocketState");
-  NS_LOG_INFO ("Loss state");
-  tcbd->m_cWnd = tcbd->m_kMinimumWindow;
-  tcbd->m_congState = TcpSocketState::CA_LOSS;
+  NS_LOG_INFO ("Collapse the congestion window");
+  tcb.m_cWnd = tcb.m_kMinimumWindow;
 }
 
 } // namespace ns3
@@ -56,6 +56,10 @@ namespace ns3 {
  * control implementations, as well as the possibility of extending it with new
  * QUIC-related capabilities.
  *
+ * The QUIC callbacks take the QuicSocketState of the socket by reference and
+ * views of the acked and lost items, so that no cast nor copy happens per ACK.
+ * The TCP congestion controls are plugged in by QuicTcpCongestionAdapter.
+ *
  */
 class QuicCongestionOps : public TcpNewReno
 {
@@ -90,30 +94,42 @@ public:
   /**
    * \brief Method called when a packet is sent. It updates the quantities in the tcb
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    * \param packetNumber the packet number
    * \param isAckOnly a flag to signal if the packet has only an ACK frame
    */
-  void OnPacketSent (Ptr<TcpSocketState> tcb, SequenceNumber32 packetNumber, bool isAckOnly);
+  virtual void OnPacketSent (QuicSocketState &tcb, SequenceNumber64 packetNumber, bool isAckOnly);
 
   /**
    * \brief Method called when an ack is received. It process the received ack and updates 
    *   the quantities in the tcb.
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    * \param ack the received ACK
-   * \param newAcks the newly acked packets
+   * \param newAcks the newly acked packets, from the highest packet number
+   * \param rs the delivery rate sample generated by the ACK
    */
-  void OnAckReceived (Ptr<TcpSocketState> tcb, QuicSubheader &ack, std::vector<QuicSocketTxItem*> newAcks);
+  virtual void OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack, QuicSocketTxItemSpan newAcks,
+                              const QuicRateSample &rs);
 
   /**
    * \brief Method called when a packet is lost. It process the lost packets and updates 
    *   the quantities in the tcb.
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
-   * \param lostPackets the lost packets
+   * \param tcb the congestion state of the socket
+   * \param lostPackets the lost packets, at least one
+   * \param rs the latest delivery rate sample of the connection
+   */
+  virtual void OnPacketsLost (QuicSocketState &tcb, QuicSocketTxItemSpan lostPackets,
+                              const QuicRateSample &rs);
+
+  /**
+   * \brief Check whether the congestion control sets the pacing rate in the tcb.
+   *   If not, the socket paces at the congestion window over the smoothed RTT
+   *
+   * \return true if the congestion control sets the pacing rate
    */
-  void OnPacketsLost (Ptr<TcpSocketState> tcb, std::vector<QuicSocketTxItem*> lostPackets);
+  virtual bool HasPacingRate () const;
 
 protected:
   // QuicCongestionControl Draft10
@@ -121,44 +137,59 @@ protected:
   /**
    * \brief Method called to update the Rtt. It updates the quantities in the tcb.
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    * \param latestRtt the latest Rtt
    * \param ackDelay the ack delay
    */
-  void UpdateRtt (Ptr<TcpSocketState> tcb, Time latestRtt, Time ackDelay);
+  void UpdateRtt (QuicSocketState &tcb, Time latestRtt, Time ackDelay);
 
   /**
    * \brief Method called when a packet is acked. It process the acked packet and updates 
    *   the quantities in the tcb.
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    * \param ackedPacked the acked packet
    */
-  void OnPacketAcked (Ptr<TcpSocketState> tcb, QuicSocketTxItem &ackedPacked);
+  void OnPacketAcked (QuicSocketState &tcb, QuicSocketTxItem &ackedPacked);
 
   /**
    * \brief Check if in recovery period
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    * \param packetNumber to be checked
    * \return true if in recovery, false otherwhise
    */
-  bool InRecovery (Ptr<TcpSocketState> tcb, SequenceNumber32 packetNumber);
+  bool InRecovery (const QuicSocketState &tcb, SequenceNumber64 packetNumber) const;
 
   /**
    * \brief Method called when a packet is acked. It updates the quantities in the tcb.
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    * \param ackedPacked the acked packet
    */
-  void OnPacketAckedCC (Ptr<TcpSocketState> tcb, QuicSocketTxItem & ackedPacket);
+  virtual void OnPacketAckedCC (QuicSocketState &tcb, QuicSocketTxItem & ackedPacket);
+
+  /**
+   * \brief Check whether the lost packets establish a persistent congestion (RFC 9002, Sec. 7.6)
+   *
+   * The packets sent after the first RTT sample, with consecutive packet
+   * numbers, are all lost over a period longer than kPersistentCongestionThreshold
+   * probe timeouts. A gap in the packet numbers ends the period, as the
+   * missing packet may have been acked.
+   *
+   * \param tcb the congestion state of the socket
+   * \param lostPackets the lost packets, from the smallest packet number
+   * \return true if the congestion is persistent
+   */
+  bool InPersistentCongestion (const QuicSocketState &tcb, QuicSocketTxItemSpan lostPackets) const;
 
   /**
-   * \brief Method called when retransmission timeout fires. It updates the quantities in the tcb.
+   * \brief Method called when the losses establish a persistent congestion.
+   *   It collapses the congestion window to the minimum window.
    *
-   * \param tcb a smart pointer to the SocketState (it accepts a QuicSocketState)
+   * \param tcb the congestion state of the socket
    */
-  void OnRetransmissionTimeoutVerified (Ptr<TcpSocketState> tcb);
+  virtual void OnPersistentCongestion (QuicSocketState &tcb);
 
 };
 
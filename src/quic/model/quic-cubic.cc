@@ -0,0 +1,379 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "quic-cubic.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicCubic");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicCubic);
+
+TypeId
+QuicCubic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicCubic")
+    .SetParent<QuicCongestionOps> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicCubic> ()
+    .AddAttribute ("Beta", "Multiplicative decrease factor of the window on loss",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&QuicCubic::m_beta),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("C", "Scaling factor of the cubic function, in segments per second cubed",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&QuicCubic::m_c),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("FastConvergence", "Release bandwidth faster when a loss happens below W_max",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuicCubic::m_fastConvergence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HyStart", "Leave slow start on a delay increase (HyStart++)",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuicCubic::m_hyStart),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HyStartMinRttThresh", "Lower bound of the delay increase that ends slow start",
+                   TimeValue (MilliSeconds (4)),
+                   MakeTimeAccessor (&QuicCubic::m_minRttThresh),
+                   MakeTimeChecker ())
+    .AddAttribute ("HyStartMaxRttThresh", "Upper bound of the delay increase that ends slow start",
+                   TimeValue (MilliSeconds (16)),
+                   MakeTimeAccessor (&QuicCubic::m_maxRttThresh),
+                   MakeTimeChecker ())
+    .AddAttribute ("HyStartMinRttDivisor",
+                   "The delay increase threshold is the RTT of the previous round over this divisor",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&QuicCubic::m_minRttDivisor),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HyStartRttSamples", "RTT samples in a round before checking the delay increase",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&QuicCubic::m_rttSamples),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HyStartCssGrowthDivisor", "Window growth reduction in conservative slow start",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&QuicCubic::m_cssGrowthDivisor),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HyStartCssRounds", "Rounds of conservative slow start before congestion avoidance",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&QuicCubic::m_cssRoundsLimit),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+QuicCubic::QuicCubic (void)
+  : QuicCongestionOps (),
+    m_beta (0.7),
+    m_c (0.4),
+    m_fastConvergence (true),
+    m_hyStart (true),
+    m_minRttThresh (MilliSeconds (4)),
+    m_maxRttThresh (MilliSeconds (16)),
+    m_minRttDivisor (8),
+    m_rttSamples (8),
+    m_cssGrowthDivisor (4),
+    m_cssRoundsLimit (5),
+    m_wMax (0),
+    m_k (0),
+    m_wEst (0),
+    m_epochStart (Seconds (-1)),
+    m_cWndFraction (0),
+    m_hyStartState (HYSTART_SS),
+    m_windowEnd (0),
+    m_lastRoundMinRtt (Time::Max ()),
+    m_currentRoundMinRtt (Time::Max ()),
+    m_rttSampleCount (0),
+    m_cssBaselineMinRtt (Time::Max ()),
+    m_cssRounds (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicCubic::QuicCubic (const QuicCubic& sock)
+  : QuicCongestionOps (sock),
+    m_beta (sock.m_beta),
+    m_c (sock.m_c),
+    m_fastConvergence (sock.m_fastConvergence),
+    m_hyStart (sock.m_hyStart),
+    m_minRttThresh (sock.m_minRttThresh),
+    m_maxRttThresh (sock.m_maxRttThresh),
+    m_minRttDivisor (sock.m_minRttDivisor),
+    m_rttSamples (sock.m_rttSamples),
+    m_cssGrowthDivisor (sock.m_cssGrowthDivisor),
+    m_cssRoundsLimit (sock.m_cssRoundsLimit),
+    m_wMax (sock.m_wMax),
+    m_k (sock.m_k),
+    m_wEst (sock.m_wEst),
+    m_epochStart (sock.m_epochStart),
+    m_cWndFraction (sock.m_cWndFraction),
+    m_hyStartState (sock.m_hyStartState),
+    m_windowEnd (sock.m_windowEnd),
+    m_lastRoundMinRtt (sock.m_lastRoundMinRtt),
+    m_currentRoundMinRtt (sock.m_currentRoundMinRtt),
+    m_rttSampleCount (sock.m_rttSampleCount),
+    m_cssBaselineMinRtt (sock.m_cssBaselineMinRtt),
+    m_cssRounds (sock.m_cssRounds)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicCubic::~QuicCubic (void)
+{
+}
+
+std::string
+QuicCubic::GetName () const
+{
+  return "QuicCubic";
+}
+
+Ptr<TcpCongestionOps>
+QuicCubic::Fork ()
+{
+  return CopyObject<QuicCubic> (this);
+}
+
+QuicCubic::HyStartState_t
+QuicCubic::GetHyStartState () const
+{
+  return m_hyStartState;
+}
+
+void
+QuicCubic::OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack,
+                          QuicSocketTxItemSpan newAcks,
+                          const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!newAcks.empty (), "ACK without newly acked packets");
+
+  // the delay checks come first, so that the ACK grows the window at the new pace
+  if (m_hyStart && m_hyStartState != HYSTART_DONE && tcb.m_cWnd < tcb.m_ssThresh)
+    {
+      UpdateHyStart (tcb, ack.GetLargestAcknowledged (), *newAcks.front ());
+    }
+
+  QuicCongestionOps::OnAckReceived (tcb, ack, newAcks, rs);
+
+  // The base class passes on the packets acked in order: the ones acked
+  // past a gap grow the window too
+  for (auto it = newAcks.begin (); it != newAcks.end (); ++it)
+    {
+      if (!(*it)->m_acked)
+        {
+          OnPacketAckedCC (tcb, **it);
+        }
+    }
+}
+
+void
+QuicCubic::UpdateHyStart (QuicSocketState &tcb, uint64_t largestAcked,
+                          const QuicSocketTxItem &lastAcked)
+{
+  NS_LOG_FUNCTION (this << largestAcked);
+
+  if (largestAcked >= m_windowEnd)
+    {
+      // A packet sent in the current round was acked: start a new round
+      m_lastRoundMinRtt = m_currentRoundMinRtt;
+      m_currentRoundMinRtt = Time::Max ();
+      m_rttSampleCount = 0;
+      m_windowEnd = tcb.m_highTxPacketNumber.Get ().GetValue () + 1;
+      if (m_hyStartState == HYSTART_CSS && ++m_cssRounds >= m_cssRoundsLimit)
+        {
+          NS_LOG_INFO ("End of conservative slow start, cwnd " << tcb.m_cWnd);
+          m_hyStartState = HYSTART_DONE;
+          tcb.m_ssThresh = tcb.m_cWnd;
+          return;
+        }
+    }
+
+  if (lastAcked.m_packetNumber.GetValue () == largestAcked)
+    {
+      m_currentRoundMinRtt = std::min (m_currentRoundMinRtt, Now () - lastAcked.m_lastSent);
+      m_rttSampleCount++;
+    }
+  if (m_rttSampleCount < m_rttSamples || m_currentRoundMinRtt == Time::Max ()
+      || m_lastRoundMinRtt == Time::Max ())
+    {
+      return;
+    }
+
+  if (m_hyStartState == HYSTART_SS)
+    {
+      Time rttThresh = std::max (m_minRttThresh,
+                                 std::min (m_lastRoundMinRtt / m_minRttDivisor, m_maxRttThresh));
+      if (m_currentRoundMinRtt >= m_lastRoundMinRtt + rttThresh)
+        {
+          NS_LOG_INFO ("Delay increase from " << m_lastRoundMinRtt << " to "
+                                              << m_currentRoundMinRtt << ", cwnd " << tcb.m_cWnd
+                                              << ": conservative slow start");
+          m_hyStartState = HYSTART_CSS;
+          m_cssBaselineMinRtt = m_currentRoundMinRtt;
+          m_cssRounds = 0;
+        }
+    }
+  else if (m_currentRoundMinRtt < m_cssBaselineMinRtt)
+    {
+      // The delay increase was spurious
+      NS_LOG_INFO ("RTT back to " << m_currentRoundMinRtt << ": standard slow start");
+      m_hyStartState = HYSTART_SS;
+      m_cssBaselineMinRtt = Time::Max ();
+    }
+}
+
+void
+QuicCubic::OnPacketAckedCC (QuicSocketState &tcb,
+                            QuicSocketTxItem & ackedPacket)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (InRecovery (tcb, ackedPacket.m_packetNumber))
+    {
+      NS_LOG_LOGIC ("In recovery");
+      return;
+    }
+  if (tcb.m_cWnd < tcb.m_ssThresh)
+    {
+      NS_LOG_LOGIC ("In slow start");
+      uint32_t increase = ackedPacket.m_size;
+      if (m_hyStartState == HYSTART_CSS)
+        {
+          increase /= m_cssGrowthDivisor;
+        }
+      tcb.m_cWnd += increase;
+      return;
+    }
+  NS_LOG_LOGIC ("In congestion avoidance");
+  CongestionAvoidance (tcb, ackedPacket.m_size);
+}
+
+double
+QuicCubic::GetCubicWindow (double t, double segmentSize) const
+{
+  double d = t - m_k;
+  return m_c * d * d * d * segmentSize + m_wMax;
+}
+
+void
+QuicCubic::CongestionAvoidance (QuicSocketState &tcb, uint32_t ackedBytes)
+{
+  NS_LOG_FUNCTION (this << ackedBytes);
+
+  double segmentSize = tcb.m_segmentSize;
+  double cWnd = tcb.m_cWnd;
+  if (m_epochStart.IsStrictlyNegative ())
+    {
+      m_epochStart = Now ();
+      m_wEst = cWnd;
+      if (m_wMax <= cWnd)
+        {
+          // no congestion event, or the window was not reduced below W_max
+          m_wMax = cWnd;
+          m_k = 0;
+        }
+      else
+        {
+          m_k = std::cbrt ((m_wMax - cWnd) / (m_c * segmentSize));
+        }
+      NS_LOG_INFO ("New epoch, W_max " << m_wMax << " K " << m_k);
+    }
+
+  Time rtt = tcb.m_smoothedRtt.IsZero () ? tcb.m_lastRtt.Get () : tcb.m_smoothedRtt;
+  double t = (Now () - m_epochStart).GetSeconds ();
+
+  // the target is the window one RTT ahead, between the window and 1.5 times it
+  double target = GetCubicWindow (t + rtt.GetSeconds (), segmentSize);
+  target = std::max (cWnd, std::min (target, 1.5 * cWnd));
+
+  // Reno-friendly estimate, with the AIMD increase that matches the decrease by beta
+  double alpha = 3 * (1 - m_beta) / (1 + m_beta);
+  m_wEst += alpha * ackedBytes * segmentSize / cWnd;
+
+  double increase;
+  if (GetCubicWindow (t, segmentSize) < m_wEst)
+    {
+      increase = std::max (m_wEst - cWnd, 0.0);
+    }
+  else
+    {
+      increase = (target - cWnd) * ackedBytes / cWnd;
+    }
+  m_cWndFraction += increase;
+  uint32_t bytes = static_cast<uint32_t> (m_cWndFraction);
+  m_cWndFraction -= bytes;
+  tcb.m_cWnd += bytes;
+}
+
+void
+QuicCubic::OnPacketsLost (QuicSocketState &tcb,
+                          QuicSocketTxItemSpan lostPackets,
+                          const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto largestLostPacket = lostPackets.back ();
+  if (InRecovery (tcb, largestLostPacket->m_packetNumber))
+    {
+      NS_LOG_LOGIC ("Loss in the current recovery period");
+    }
+  else
+    {
+      double cWnd = tcb.m_cWnd;
+      if (m_fastConvergence && cWnd < m_wMax)
+        {
+          m_wMax = cWnd * (1 + m_beta) / 2;
+        }
+      else
+        {
+          m_wMax = cWnd;
+        }
+      tcb.m_endOfRecovery = tcb.m_highTxPacketNumber;
+      tcb.m_ssThresh = std::max (static_cast<uint32_t> (cWnd * m_beta), tcb.m_kMinimumWindow);
+      tcb.m_cWnd = tcb.m_ssThresh;
+      m_epochStart = Seconds (-1);
+      m_cWndFraction = 0;
+      m_hyStartState = HYSTART_DONE;
+      NS_LOG_INFO ("Enter recovery, W_max " << m_wMax << " cwnd " << tcb.m_cWnd);
+    }
+
+  if (InPersistentCongestion (tcb, lostPackets))
+    {
+      OnPersistentCongestion (tcb);
+    }
+}
+
+void
+QuicCubic::OnPersistentCongestion (QuicSocketState &tcb)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_epochStart = Seconds (-1);
+  m_cWndFraction = 0;
+  m_hyStartState = HYSTART_DONE;
+  QuicCongestionOps::OnPersistentCongestion (tcb);
+}
+
+} // namespace ns3
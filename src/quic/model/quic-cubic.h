@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICCUBIC_H
+#define QUICCUBIC_H
+
+#include "quic-congestion-ops.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief CUBIC congestion control for QUIC, with HyStart++
+ *
+ * In congestion avoidance the window follows the cubic function of the time
+ * since the last congestion event (RFC 9438), W_cubic(t) = C (t - K)^3 + W_max,
+ * where W_max is the window before the reduction and K the time to reach it
+ * again. The window never grows slower than the Reno-friendly estimate.
+ *
+ * Slow start ends on a delay increase (HyStart++, RFC 9406): when the minimum
+ * RTT of a round exceeds the one of the previous round by a threshold, the
+ * window grows by a quarter of the acked bytes (conservative slow start) for
+ * a few rounds, and then congestion avoidance starts, unless the RTT goes back
+ * down in the meantime.
+ *
+ * The window is updated per acked packet. As in RFC 9002, a recovery period
+ * starts on the first loss of a packet sent after the previous one: the
+ * packets sent before do not grow the window, nor reduce it again.
+ */
+class QuicCubic : public QuicCongestionOps
+{
+public:
+  /**
+   * \brief States of HyStart++
+   */
+  typedef enum
+  {
+    HYSTART_SS,    //!< Standard slow start, looking for a delay increase
+    HYSTART_CSS,   //!< Conservative slow start
+    HYSTART_DONE   //!< Slow start is over
+  } HyStartState_t;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicCubic ();
+  QuicCubic (const QuicCubic& sock);
+  ~QuicCubic ();
+
+  std::string GetName () const;
+  Ptr<TcpCongestionOps> Fork ();
+
+  void OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack, QuicSocketTxItemSpan newAcks,
+                      const QuicRateSample &rs);
+  void OnPacketsLost (QuicSocketState &tcb, QuicSocketTxItemSpan lostPackets,
+                      const QuicRateSample &rs);
+
+  /**
+   * \brief Get the current state of HyStart++
+   *
+   * \return the current state
+   */
+  HyStartState_t GetHyStartState () const;
+
+protected:
+  /**
+   * \brief Grow the window by slow start or by the cubic function
+   *
+   * \param tcb the congestion state of the socket
+   * \param ackedPacket the acked packet
+   */
+  void OnPacketAckedCC (QuicSocketState &tcb, QuicSocketTxItem & ackedPacket);
+
+  void OnPersistentCongestion (QuicSocketState &tcb);
+
+private:
+  /**
+   * \brief Track the rounds and the RTT samples of HyStart++ and
+   *   leave standard or conservative slow start
+   *
+   * \param tcb the congestion state of the socket
+   * \param largestAcked the largest packet number acknowledged by the ACK
+   * \param lastAcked the newly acked packet with the highest packet number
+   */
+  void UpdateHyStart (QuicSocketState &tcb, uint64_t largestAcked,
+                      const QuicSocketTxItem &lastAcked);
+
+  /**
+   * \brief Grow the window in congestion avoidance
+   *
+   * \param tcb the congestion state of the socket
+   * \param ackedBytes the bytes of the acked packet
+   */
+  void CongestionAvoidance (QuicSocketState &tcb, uint32_t ackedBytes);
+
+  /**
+   * \brief Evaluate the cubic function
+   *
+   * \param t the time since the start of the epoch, in seconds
+   * \param segmentSize the segment size
+   * \return the window at time t, in bytes
+   */
+  double GetCubicWindow (double t, double segmentSize) const;
+
+  // Parameters
+  double m_beta;                   //!< Multiplicative decrease factor
+  double m_c;                      //!< Scaling factor of the cubic function
+  bool m_fastConvergence;          //!< Lower W_max when the window did not reach it again
+  bool m_hyStart;                  //!< Enable HyStart++
+  Time m_minRttThresh;             //!< Lower bound of the delay increase threshold
+  Time m_maxRttThresh;             //!< Upper bound of the delay increase threshold
+  uint32_t m_minRttDivisor;        //!< Fraction of the RTT of the previous round that is the threshold
+  uint32_t m_rttSamples;           //!< RTT samples in a round before checking the delay increase
+  uint32_t m_cssGrowthDivisor;     //!< Window growth reduction in conservative slow start
+  uint32_t m_cssRoundsLimit;       //!< Rounds of conservative slow start before congestion avoidance
+
+  // Cubic
+  double m_wMax;                   //!< Window before the last reduction, in bytes
+  double m_k;                      //!< Time to reach W_max in the epoch, in seconds
+  double m_wEst;                   //!< Reno-friendly window estimate, in bytes
+  Time m_epochStart;               //!< Start of the congestion avoidance epoch (negative if not started)
+  double m_cWndFraction;           //!< Window growth below a byte, not applied yet
+
+  // HyStart++
+  HyStartState_t m_hyStartState;   //!< State of HyStart++
+  uint64_t m_windowEnd;            //!< Packet number whose ACK ends the round
+  Time m_lastRoundMinRtt;          //!< Minimum RTT of the previous round
+  Time m_currentRoundMinRtt;       //!< Minimum RTT of the current round
+  uint32_t m_rttSampleCount;       //!< RTT samples in the current round
+  Time m_cssBaselineMinRtt;        //!< Minimum RTT when conservative slow start started
+  uint32_t m_cssRounds;            //!< Rounds spent in conservative slow start
+};
+
+} // namespace ns3
+
+#endif /* QUICCUBIC_H */
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "quic-flow-controller.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicFlowController");
+
+QuicFlowController::QuicFlowController ()
+  : m_window (0),
+    m_maxWindow (0),
+    m_lastUpdate (Seconds (-1)),
+    m_updateThreshold (0.5),
+    m_consumed (0),
+    m_advertisedLimit (0),
+    m_windowChanged (false),
+    m_resendLimit (false),
+    m_blockedLimit (0),
+    m_blocked (false)
+{
+}
+
+void
+QuicFlowController::SetInitialLimit (uint64_t limit)
+{
+  NS_LOG_FUNCTION (this << limit);
+  m_advertisedLimit = limit;
+  m_windowChanged = false;
+}
+
+void
+QuicFlowController::SetWindow (uint64_t window)
+{
+  NS_LOG_FUNCTION (this << window);
+  m_windowChanged = m_windowChanged or window != m_window;
+  m_window = window;
+}
+
+uint64_t
+QuicFlowController::GetWindow () const
+{
+  return m_window;
+}
+
+void
+QuicFlowController::SetMaxWindow (uint64_t maxWindow)
+{
+  NS_LOG_FUNCTION (this << maxWindow);
+  m_maxWindow = maxWindow;
+}
+
+uint64_t
+QuicFlowController::AutoTune (Time now, Time rtt)
+{
+  NS_LOG_FUNCTION (this << now << rtt);
+
+  Time lastUpdate = m_lastUpdate;
+  m_lastUpdate = now;
+  if (m_window >= m_maxWindow or lastUpdate.IsStrictlyNegative () or rtt.IsZero ()
+      or now - lastUpdate >= 2 * rtt)
+    {
+      return 0;
+    }
+
+  uint64_t increase = std::min (m_window, m_maxWindow - m_window);
+  NS_LOG_LOGIC ("Credit consumed in " << (now - lastUpdate).GetSeconds () << " s, rtt "
+                                      << rtt.GetSeconds () << " s: grow the window by " << increase);
+  return increase;
+}
+
+void
+QuicFlowController::SetUpdateThreshold (double threshold)
+{
+  NS_LOG_FUNCTION (this << threshold);
+  NS_ABORT_MSG_IF (threshold <= 0 or threshold > 1, "Invalid flow control update threshold " << threshold);
+  m_updateThreshold = threshold;
+}
+
+void
+QuicFlowController::AddConsumed (uint64_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+  m_consumed += bytes;
+}
+
+uint64_t
+QuicFlowController::GetConsumed () const
+{
+  return m_consumed;
+}
+
+uint64_t
+QuicFlowController::GetLimit () const
+{
+  return m_advertisedLimit;
+}
+
+bool
+QuicFlowController::IsUpdateDue () const
+{
+  if (m_resendLimit)
+    {
+      return true;
+    }
+  // the limit never decreases
+  if (m_consumed + m_window <= m_advertisedLimit)
+    {
+      return false;
+    }
+  if (m_windowChanged)
+    {
+      return true;
+    }
+  // the credit left to the peer is below the unconsumed part of the window
+  uint64_t credit = m_advertisedLimit - m_consumed;
+  return credit <= m_window - (uint64_t) (m_updateThreshold * m_window);
+}
+
+uint64_t
+QuicFlowController::Advertise ()
+{
+  NS_LOG_FUNCTION (this);
+  m_advertisedLimit = std::max (m_advertisedLimit, m_consumed + m_window);
+  m_windowChanged = false;
+  m_resendLimit = false;
+  NS_LOG_LOGIC ("Advertise limit " << m_advertisedLimit << " consumed " << m_consumed
+                                   << " window " << m_window);
+  return m_advertisedLimit;
+}
+
+void
+QuicFlowController::OnPeerBlocked (uint64_t limit)
+{
+  NS_LOG_FUNCTION (this << limit);
+  if (limit < m_advertisedLimit)
+    {
+      NS_LOG_LOGIC ("Peer blocked at " << limit << ", limit " << m_advertisedLimit << " lost");
+      m_resendLimit = true;
+    }
+}
+
+bool
+QuicFlowController::OnBlocked (uint64_t peerLimit)
+{
+  NS_LOG_FUNCTION (this << peerLimit);
+  if (m_blocked and m_blockedLimit == peerLimit)
+    {
+      return false;
+    }
+  m_blocked = true;
+  m_blockedLimit = peerLimit;
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICFLOWCONTROLLER_H
+#define QUICFLOWCONTROLLER_H
+
+#include <stdint.h>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ *
+ * \brief Flow control credit of a stream or of the whole connection
+ *
+ * On the receive side it tracks the data consumed and the limit advertised
+ * to the peer, and tells when a new limit (MAX_DATA or MAX_STREAM_DATA) is
+ * worth sending: when the consumed data crosses a fraction of the window
+ * since the last advertisement, when the window changes, or when the peer
+ * reports that it is blocked at a stale limit.
+ *
+ * On the send side it remembers the peer limit at which a blocked signal
+ * (BLOCKED or STREAM_BLOCKED) was sent, so that it is sent once per limit.
+ *
+ * The receive window can be autotuned as in the dynamic right-sizing of
+ * Linux: if the application consumes the credit of an update within two
+ * RTTs of the previous update, the window is the bottleneck and doubles,
+ * up to a maximum window.
+ */
+class QuicFlowController
+{
+public:
+  QuicFlowController ();
+
+  /**
+   * \brief Set the limit advertised in the transport parameters
+   *
+   * \param limit the initial limit
+   */
+  void SetInitialLimit (uint64_t limit);
+
+  /**
+   * \brief Set the receive window, i.e., the credit granted beyond the consumed data
+   *
+   * \param window the window in bytes
+   */
+  void SetWindow (uint64_t window);
+
+  /**
+   * \brief Get the receive window
+   *
+   * \return the window in bytes
+   */
+  uint64_t GetWindow () const;
+
+  /**
+   * \brief Set the largest window that autotuning can reach
+   *
+   * \param maxWindow the maximum window in bytes, autotuning is disabled if
+   *        it is not larger than the window
+   */
+  void SetMaxWindow (uint64_t maxWindow);
+
+  /**
+   * \brief Compute the growth of the window at a limit update
+   *
+   * The time of the update is recorded. The window doubles, up to the
+   * maximum window, if the previous update is less than two RTTs old.
+   *
+   * \param now the time of the update
+   * \param rtt the RTT of the connection, zero if unknown
+   * \return the growth of the window in bytes
+   */
+  uint64_t AutoTune (Time now, Time rtt);
+
+  /**
+   * \brief Set the fraction of the window to consume before a new limit is advertised
+   *
+   * \param threshold the fraction, in (0, 1]
+   */
+  void SetUpdateThreshold (double threshold);
+
+  /**
+   * \brief Record data consumed by the application
+   *
+   * \param bytes the amount of data consumed
+   */
+  void AddConsumed (uint64_t bytes);
+
+  /**
+   * \brief Get the data consumed by the application
+   *
+   * \return the consumed data in bytes
+   */
+  uint64_t GetConsumed () const;
+
+  /**
+   * \brief Get the limit the peer must not exceed
+   *
+   * \return the last advertised limit
+   */
+  uint64_t GetLimit () const;
+
+  /**
+   * \brief Check whether a new limit should be sent to the peer
+   *
+   * \return true if an update is due
+   */
+  bool IsUpdateDue () const;
+
+  /**
+   * \brief Advertise the current credit
+   *
+   * \return the limit to send to the peer
+   */
+  uint64_t Advertise ();
+
+  /**
+   * \brief Process a blocked signal of the peer
+   *
+   * If the peer is blocked below the advertised limit, the update that
+   * raised it was lost, and the limit is sent again.
+   *
+   * \param limit the limit at which the peer is blocked
+   */
+  void OnPeerBlocked (uint64_t limit);
+
+  /**
+   * \brief Check whether the sender should signal that it is blocked
+   *
+   * \param peerLimit the limit of the peer that blocks the sender
+   * \return true the first time the sender is blocked at this limit
+   */
+  bool OnBlocked (uint64_t peerLimit);
+
+private:
+  uint64_t m_window;               //!< Receive window
+  uint64_t m_maxWindow;            //!< Largest window reached by autotuning
+  Time m_lastUpdate;               //!< Time of the last limit update, negative if none
+  double m_updateThreshold;        //!< Fraction of the window consumed before an update
+  uint64_t m_consumed;             //!< Data consumed by the application
+  uint64_t m_advertisedLimit;      //!< Last limit advertised to the peer
+  bool m_windowChanged;            //!< True if the window changed since the last advertisement
+  bool m_resendLimit;              //!< True if the peer missed the last advertised limit
+  uint64_t m_blockedLimit;         //!< Peer limit of the last blocked signal
+  bool m_blocked;                  //!< True if a blocked signal was sent at m_blockedLimit
+};
+
+} // namespace ns3
+
+#endif /* QUICFLOWCONTROLLER_H */
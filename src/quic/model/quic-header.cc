@@ -236,21 +236,22 @@ QuicHeader::Deserialize (Buffer::Iterator start)
       SetVersion (i.ReadNtohU32 ());
       if (!IsVersionNegotiation ())
         {
-          SetPacketNumber (SequenceNumber32 (i.ReadNtohU32 ()));
+          SetPacketNumber (SequenceNumber64 (i.ReadNtohU32 ()));
         }
     }
   else
     {
+      // keep the length used on the wire, the value may be truncated
       switch (m_type)
         {
         case ONE_OCTECT:
-          SetPacketNumber (SequenceNumber32 (i.ReadU8 ()));
+          m_packetNumber = SequenceNumber64 (i.ReadU8 ());
           break;
         case TWO_OCTECTS:
-          SetPacketNumber (SequenceNumber32 (i.ReadNtohU16 ()));
+          m_packetNumber = SequenceNumber64 (i.ReadNtohU16 ());
           break;
         case FOUR_OCTECTS:
-          SetPacketNumber (SequenceNumber32 (i.ReadNtohU32 ()));
+          m_packetNumber = SequenceNumber64 (i.ReadNtohU32 ());
           break;
         }
     }
@@ -291,7 +292,7 @@ QuicHeader::Print (std::ostream &os) const
 }
 
 QuicHeader
-QuicHeader::CreateInitial (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber)
+QuicHeader::CreateInitial (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber)
 {
   NS_LOG_INFO ("Create Initial Helper called");
 
@@ -307,7 +308,7 @@ QuicHeader::CreateInitial (uint64_t connectionId, uint32_t version, SequenceNumb
 
 
 QuicHeader
-QuicHeader::CreateRetry (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber)
+QuicHeader::CreateRetry (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber)
 {
   NS_LOG_INFO ("Create Retry Helper called");
 
@@ -322,7 +323,7 @@ QuicHeader::CreateRetry (uint64_t connectionId, uint32_t version, SequenceNumber
 }
 
 QuicHeader
-QuicHeader::CreateHandshake (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber)
+QuicHeader::CreateHandshake (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber)
 {
   NS_LOG_INFO ("Create Handshake Helper called ");
 
@@ -337,7 +338,7 @@ QuicHeader::CreateHandshake (uint64_t connectionId, uint32_t version, SequenceNu
 }
 
 QuicHeader
-QuicHeader::Create0RTT (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber)
+QuicHeader::Create0RTT (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber)
 {
   NS_LOG_INFO ("Create 0RTT Helper called");
 
@@ -352,7 +353,7 @@ QuicHeader::Create0RTT (uint64_t connectionId, uint32_t version, SequenceNumber3
 }
 
 QuicHeader
-QuicHeader::CreateShort (uint64_t connectionId, SequenceNumber32 packetNumber, bool connectionIdFlag, bool keyPhaseBit)
+QuicHeader::CreateShort (uint64_t connectionId, SequenceNumber64 packetNumber, bool connectionIdFlag, bool keyPhaseBit)
 {
   NS_LOG_INFO ("Create Short Helper called");
 
@@ -440,14 +441,14 @@ QuicHeader::SetConnectionID (uint64_t connID)
     }
 }
 
-SequenceNumber32
+SequenceNumber64
 QuicHeader::GetPacketNumber () const
 {
   return m_packetNumber;
 }
 
 void
-QuicHeader::SetPacketNumber (SequenceNumber32 packNum)
+QuicHeader::SetPacketNumber (SequenceNumber64 packNum)
 {
   NS_LOG_INFO (packNum);
   m_packetNumber = packNum;
@@ -468,6 +469,34 @@ QuicHeader::SetPacketNumber (SequenceNumber32 packNum)
     }
 }
 
+SequenceNumber64
+QuicHeader::DecodePacketNumber (SequenceNumber64 largestReceived) const
+{
+  uint32_t bits = GetPacketNumLen ();
+  if (bits < 32)
+    {
+      return m_packetNumber;
+    }
+
+  uint64_t expected = largestReceived.GetValue () + 1;
+  uint64_t window = (uint64_t) 1 << bits;
+  uint64_t halfWindow = window / 2;
+  uint64_t candidate = (expected & ~(window - 1))
+    | (m_packetNumber.GetValue () & (window - 1));
+
+  if (candidate + halfWindow <= expected
+      and candidate < ((uint64_t) 1 << 62) - window)
+    {
+      candidate += window;
+    }
+  else if (candidate > expected + halfWindow and candidate >= window)
+    {
+      candidate -= window;
+    }
+  NS_LOG_LOGIC ("Packet number " << m_packetNumber << " decoded as " << candidate);
+  return SequenceNumber64 (candidate);
+}
+
 uint32_t
 QuicHeader::GetVersion () const
 {
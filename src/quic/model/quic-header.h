@@ -34,6 +34,26 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup quic
+ * 64 bit Sequence number, for the QUIC packet numbers.
+ */
+typedef SequenceNumber<uint64_t, int64_t> SequenceNumber64;
+
+namespace TracedValueCallback {
+
+/**
+ * \ingroup quic
+ * TracedValue callback signature for SequenceNumber64
+ *
+ * \param [in] oldValue original value of the traced variable
+ * \param [in] newValue new value of the traced variable
+ */
+typedef void (* SequenceNumber64)(SequenceNumber64 oldValue,
+                                  SequenceNumber64 newValue);
+
+}  // namespace TracedValueCallback
+
 /**
  * \ingroup quic
  * \brief Header for the QUIC Protocol
@@ -121,7 +141,7 @@ public:
    * \param packetNumber the packet number
    * \return the generated QuicHeader
    */
-  static QuicHeader CreateInitial (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber);
+  static QuicHeader CreateInitial (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber);
 
   /**
    * Create a Retry header
@@ -131,7 +151,7 @@ public:
    * \param packetNumber the packet number
    * \return the generated QuicHeader
    */
-  static QuicHeader CreateRetry (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber);
+  static QuicHeader CreateRetry (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber);
 
   /**
    * Create the header for the Handshake server->client packet
@@ -141,7 +161,7 @@ public:
    * \param packetNumber the packet number
    * \return the generated QuicHeader
    */
-  static QuicHeader CreateHandshake (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber);
+  static QuicHeader CreateHandshake (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber);
 
   /**
    * Create the header for a 0-Rtt Protected packet
@@ -151,7 +171,7 @@ public:
    * \param packetNumber the packet number
    * \return the generated QuicHeader
    */
-  static QuicHeader Create0RTT (uint64_t connectionId, uint32_t version, SequenceNumber32 packetNumber);
+  static QuicHeader Create0RTT (uint64_t connectionId, uint32_t version, SequenceNumber64 packetNumber);
 
   /**
    * Create the header for a Version Negotiation packet, sends to the client a list of supported versions
@@ -172,7 +192,7 @@ public:
    * \param keyPhaseBit the key phase, which allows a recipient of a packet to identify the packet protection keys that are used to protect the packet.
    * \return the generated QuicHeader
    */
-  static QuicHeader CreateShort (uint64_t connectionId, SequenceNumber32 packetNumber, bool connectionIdFlag = true, bool keyPhaseBit = QuicHeader::PHASE_ZERO);
+  static QuicHeader CreateShort (uint64_t connectionId, SequenceNumber64 packetNumber, bool connectionIdFlag = true, bool keyPhaseBit = QuicHeader::PHASE_ZERO);
 
   // Getters, Setters and Controls
 
@@ -204,7 +224,7 @@ public:
    * \brief Get the packet number
    * \return The packet number for this QuicHeader
    */
-  SequenceNumber32 GetPacketNumber () const;
+  SequenceNumber64 GetPacketNumber () const;
 
   /**
    * \brief Calculates the packet number length (in bits)
@@ -220,7 +240,20 @@ public:
    * \brief Set the packet number
    * \param packNumber the packet number for this QuicHeader
    */
-  void SetPacketNumber (SequenceNumber32 packNumber);
+  void SetPacketNumber (SequenceNumber64 packNumber);
+
+  /**
+   * \brief Recover the full packet number of a received header
+   *
+   * Packet numbers of 32 bits on the wire are truncated, so the full value
+   * is the one closest to the next expected packet number (RFC 9000,
+   * Appendix A.3). Shorter encodings are only used for packet numbers that
+   * fit in them, and are returned as they are.
+   *
+   * \param largestReceived the largest packet number received so far
+   * \return the full packet number
+   */
+  SequenceNumber64 DecodePacketNumber (SequenceNumber64 largestReceived) const;
 
   /**
    * \brief Get the version
@@ -339,7 +372,7 @@ private:
   bool m_k;                         //!< Key phase bit
   uint8_t m_type;                   //!< Type byte
   uint64_t m_connectionId;          //!< Connection Id
-  SequenceNumber32 m_packetNumber;  //!< Packet number
+  SequenceNumber64 m_packetNumber;  //!< Packet number
   uint32_t m_version;               //!< Version
 };
 
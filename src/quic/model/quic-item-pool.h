@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICITEMPOOL_H
+#define QUICITEMPOOL_H
+
+#include <stdint.h>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ *
+ * \brief Free list of the items of a QUIC buffer
+ *
+ * The buffers allocate one item per frame or packet. The pool keeps the
+ * released items and hands them out again, so that a buffer in steady state
+ * does not go to the heap at all.
+ *
+ * Items are handed out as owning handles: an item goes back to the pool when
+ * its handle is destroyed, e.g., when it is erased from a container of the
+ * buffer. The pool must outlive all of its handles, i.e., it must be declared
+ * before the containers that hold them.
+ */
+template <typename Item>
+class QuicItemPool
+{
+public:
+  /**
+   * \brief Deleter of the handles, which returns the item to its pool
+   */
+  class Releaser
+  {
+public:
+    /**
+     * \brief Constructor
+     *
+     * \param pool the pool of the item
+     */
+    Releaser (QuicItemPool *pool = 0)
+      : m_pool (pool)
+    {
+    }
+
+    /**
+     * \brief Return an item to the pool
+     *
+     * \param item the item
+     */
+    void operator() (Item *item) const
+    {
+      m_pool->Release (item);
+    }
+
+private:
+    QuicItemPool *m_pool;  //!< Pool of the item
+  };
+
+  typedef std::unique_ptr<Item, Releaser> Handle;  //!< Owning handle of an item
+
+  QuicItemPool ()
+    : m_allocated (0)
+  {
+  }
+
+  ~QuicItemPool ()
+  {
+    for (auto it = m_free.begin (); it != m_free.end (); ++it)
+      {
+        delete *it;
+      }
+  }
+
+  /**
+   * \brief Get a default-constructed item
+   *
+   * \return the handle of the item
+   */
+  Handle Acquire ()
+  {
+    Item *item;
+    if (m_free.empty ())
+      {
+        item = new Item ();
+        ++m_allocated;
+      }
+    else
+      {
+        item = m_free.back ();
+        m_free.pop_back ();
+      }
+    return Handle (item, Releaser (this));
+  }
+
+  /**
+   * \brief Get a copy of an item
+   *
+   * \param other the item to copy
+   * \return the handle of the copy
+   */
+  Handle Acquire (const Item &other)
+  {
+    Handle item = Acquire ();
+    item->~Item ();
+    new (item.get ()) Item (other);
+    return item;
+  }
+
+  /**
+   * \brief Get the number of items allocated by the pool
+   *
+   * \return the number of items, in use or free
+   */
+  uint32_t GetAllocated () const
+  {
+    return m_allocated;
+  }
+
+  /**
+   * \brief Get the number of free items
+   *
+   * \return the number of items ready to be reused
+   */
+  uint32_t GetFree () const
+  {
+    return m_free.size ();
+  }
+
+private:
+  QuicItemPool (const QuicItemPool &);
+  QuicItemPool &operator= (const QuicItemPool &);
+
+  /**
+   * \brief Reset an item and put it in the free list
+   *
+   * The item is reset at once, so that it does not hold packets while free.
+   *
+   * \param item the item
+   */
+  void Release (Item *item)
+  {
+    item->~Item ();
+    new (item) Item ();
+    m_free.push_back (item);
+  }
+
+  std::vector<Item*> m_free;  //!< Items ready to be reused
+  uint32_t m_allocated;       //!< Number of items allocated
+};
+
+} // namespace ns3
+
+#endif /* QUICITEMPOOL_H */
@@ -26,6 +26,7 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/object-vector.h"
 #include "ns3/pointer.h"
 
@@ -134,14 +135,26 @@ QuicL4Protocol::GetTypeId (void)
                    TypeIdValue (QuicCongestionOps::GetTypeId ()),
                    MakeTypeIdAccessor (&QuicL4Protocol::m_congestionTypeId),
                    MakeTypeIdChecker ())
+    .AddAttribute ("MaxAuthAddresses",
+                   "Maximum number of authenticated peer addresses to remember.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&QuicL4Protocol::m_maxAuthAddresses),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("AuthAddressTtl",
+                   "Time after which an idle authenticated peer address is forgotten (0 to disable).",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&QuicL4Protocol::m_authAddressTtl),
+                   MakeTimeChecker ())
+    .AddAttribute ("ReceiveWindowBudget",
+                   "Memory (bytes) that the autotuning of the receive windows can add "
+                   "over all the connections and streams of the node",
+                   UintegerValue (1 << 26),
+                   MakeUintegerAccessor (&QuicL4Protocol::m_receiveWindowBudget),
+                   MakeUintegerChecker<uint64_t> ())
     .AddAttribute ("SocketList", "The list of UDP and QUIC sockets associated to this protocol.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QuicL4Protocol::m_quicUdpBindingList),
                    MakeObjectVectorChecker<QuicUdpBinding> ())
-    /*.AddAttribute ("AuthAddresses", "The list of Authenticated addresses associated to this protocol.",
-                                           ObjectVectorValue (),
-                                           MakeObjectVectorAccessor (&QuicL4Protocol::m_authAddresses),
-                                           MakeObjectVectorChecker<Address> ())*/
   ;
   return tid;
 }
@@ -149,7 +162,11 @@ QuicL4Protocol::GetTypeId (void)
 QuicL4Protocol::QuicL4Protocol ()
   : m_node (0),
     m_0RTTHandshakeStart (false),
+    m_maxAuthAddresses (4096),
+    m_authAddressTtl (Seconds (0)),
     m_isServer(false),
+    m_receiveWindowBudget (1 << 26),
+    m_reservedReceiveWindow (0),
     m_endPoints (new Ipv4EndPointDemux ()), 
     m_endPoints6 (new Ipv6EndPointDemux ())
 {
@@ -426,10 +443,54 @@ QuicL4Protocol::IsServer (void)  const
   return m_isServer;
 }
 
-const std::vector<Address>& 
-QuicL4Protocol::GetAuthAddresses () const
+bool
+QuicL4Protocol::IsAuthenticated (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+
+  auto index_it = m_authAddressIndex.find (address);
+  if (index_it == m_authAddressIndex.end ())
+    {
+      return false;
+    }
+
+  AuthAddressList::iterator entry = index_it->second;
+  if (!m_authAddressTtl.IsZero () && Simulator::Now () - entry->second > m_authAddressTtl)
+    {
+      NS_LOG_LOGIC (this << " Authentication of " << address << " expired");
+      m_authAddresses.erase (entry);
+      m_authAddressIndex.erase (index_it);
+      return false;
+    }
+
+  entry->second = Simulator::Now ();
+  m_authAddresses.splice (m_authAddresses.begin (), m_authAddresses, entry);
+  return true;
+}
+
+void
+QuicL4Protocol::AddAuthAddress (Ipv4Address address)
 {
-  return m_authAddresses;
+  NS_LOG_FUNCTION (this << address);
+
+  auto index_it = m_authAddressIndex.find (address);
+  if (index_it != m_authAddressIndex.end ())
+    {
+      // refresh the last use time and move to the front
+      index_it->second->second = Simulator::Now ();
+      m_authAddresses.splice (m_authAddresses.begin (), m_authAddresses, index_it->second);
+      return;
+    }
+
+  while (m_authAddresses.size () >= m_maxAuthAddresses)
+    {
+      NS_LOG_LOGIC (this << " Evict authenticated address " << m_authAddresses.back ().first);
+      m_authAddressIndex.erase (m_authAddresses.back ().first);
+      m_authAddresses.pop_back ();
+    }
+
+  m_authAddresses.push_front (std::make_pair (address, Simulator::Now ()));
+  m_authAddressIndex[address] = m_authAddresses.begin ();
 }
 
 void
@@ -477,16 +538,13 @@ QuicL4Protocol::ForwardUp (Ptr<Socket> sock)
                           " if source and destination IP address and port are sufficient to identify a connection");
         }
 
-      QuicUdpBindingList::iterator it;
       Ptr<QuicSocketBase> socket;
-      for (it = m_quicUdpBindingList.begin (); it != m_quicUdpBindingList.end (); ++it)
+      Ptr<QuicUdpBinding> binding;
+      auto index_it = m_connectionIdIndex.find (connectionId);
+      if (index_it != m_connectionIdIndex.end ())
         {
-          Ptr<QuicUdpBinding> item = *it;
-          if (item->m_quicSocket->GetConnectionId () == connectionId)
-            {
-              socket = item->m_quicSocket;
-              break;
-            }
+          binding = index_it->second;
+          socket = binding->m_quicSocket;
         }
 
       NS_LOG_LOGIC ((socket == nullptr));
@@ -500,33 +558,33 @@ QuicL4Protocol::ForwardUp (Ptr<Socket> sock)
       if (header.IsInitial () and m_isServer and socket == nullptr) 
         {
           NS_LOG_LOGIC (this << " Cloning listening socket " << m_quicUdpBindingList.front()->m_quicSocket);
-          socket = CloneSocket (m_quicUdpBindingList.front()->m_quicSocket);
-          socket->SetConnectionId (connectionId);
+          socket = CloneSocket (m_quicUdpBindingList.front()->m_quicSocket, connectionId);
           socket->Connect (from);
           socket->SetupCallback ();
+          binding = FindBinding (socket);
 
         }
       else if (header.IsHandshake () and m_isServer and socket != nullptr)
         {
           NS_LOG_LOGIC ("CONNECTION AUTHENTICATED - Server authenticated Client " << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " <<
                         InetSocketAddress::ConvertFrom (from).GetPort () << "");
-          m_authAddresses.push_back (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
+          AddAuthAddress (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
         }
       else if (header.IsHandshake () and !m_isServer and socket != nullptr)
         {
           NS_LOG_LOGIC ("CONNECTION AUTHENTICATED - Client authenticated Server " << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " <<
                         InetSocketAddress::ConvertFrom (from).GetPort () << "");
-          m_authAddresses.push_back (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
+          AddAuthAddress (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
         }
       else if (header.IsORTT () and m_isServer)
         {
-          auto result = std::find (m_authAddresses.begin (), m_authAddresses.end (), InetSocketAddress::ConvertFrom (from).GetIpv4 ());
+          bool authenticated = IsAuthenticated (InetSocketAddress::ConvertFrom (from).GetIpv4 ());
           // check if a 0-RTT is allowed with this endpoint - or if the attribute m_0RTTHandshakeStart has been forced to be true
-          if (result == m_authAddresses.end () && m_0RTTHandshakeStart)
+          if (!authenticated && m_0RTTHandshakeStart)
             {
-              m_authAddresses.push_back (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
+              AddAuthAddress (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
             }
-          else if (result == m_authAddresses.end () && !m_0RTTHandshakeStart)
+          else if (!authenticated && !m_0RTTHandshakeStart)
             {
               NS_LOG_WARN ( this << " CONNECTION ABORTED: 0RTT Packet from unauthenticated address " << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " <<
                             InetSocketAddress::ConvertFrom (from).GetPort ());
@@ -536,21 +594,21 @@ QuicL4Protocol::ForwardUp (Ptr<Socket> sock)
           NS_LOG_LOGIC ("CONNECTION AUTHENTICATED - Server authenticated Client " << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " <<
                         InetSocketAddress::ConvertFrom (from).GetPort () << "");
           NS_LOG_LOGIC ( this << " Cloning listening socket " << m_quicUdpBindingList.front()->m_quicSocket);
-          socket = CloneSocket (m_quicUdpBindingList.front()->m_quicSocket);
-          socket->SetConnectionId (connectionId);
+          socket = CloneSocket (m_quicUdpBindingList.front()->m_quicSocket, connectionId);
           socket->Connect (from);
           socket->SetupCallback ();
+          binding = FindBinding (socket);
 
         }
       else if (header.IsShort ())
         {
-          auto result = std::find (m_authAddresses.begin (), m_authAddresses.end (), InetSocketAddress::ConvertFrom (from).GetIpv4 ());
+          bool authenticated = IsAuthenticated (InetSocketAddress::ConvertFrom (from).GetIpv4 ());
 
-          if (result == m_authAddresses.end () && m_0RTTHandshakeStart)
+          if (!authenticated && m_0RTTHandshakeStart)
             {
-              m_authAddresses.push_back (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
+              AddAuthAddress (InetSocketAddress::ConvertFrom (from).GetIpv4 ()); //add to the list of authenticated sockets
             }
-          else if (result == m_authAddresses.end () && !m_0RTTHandshakeStart)
+          else if (!authenticated && !m_0RTTHandshakeStart)
             {
               NS_LOG_WARN ( this << " CONNECTION ABORTED: Short Packet from unauthenticated address " << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " <<
                             InetSocketAddress::ConvertFrom (from).GetPort ());
@@ -559,10 +617,10 @@ QuicL4Protocol::ForwardUp (Ptr<Socket> sock)
         }
 
       // Handle callback for the correct socket
-      if (!m_socketHandlers[socket].IsNull ())
+      if (binding != nullptr && !binding->m_handler.IsNull ())
         {
           NS_LOG_LOGIC (this << " waking up handler of socket " << socket);
-          m_socketHandlers[socket] (packet, header, from);
+          binding->m_handler (packet, header, from);
         }
       else
         {
@@ -576,11 +634,14 @@ QuicL4Protocol::SetRecvCallback (Callback<void, Ptr<Packet>, const QuicHeader&,
 {
   NS_LOG_FUNCTION (this);
 
-  m_socketHandlers.insert ( std::pair< Ptr<Socket>, Callback<void, Ptr<Packet>, const QuicHeader&, Address& > > (sock,handler));
   QuicUdpBindingList::iterator it;
   for (it = m_quicUdpBindingList.begin (); it != m_quicUdpBindingList.end (); ++it)
     {
       Ptr<QuicUdpBinding> item = *it;
+      if (item->m_quicSocket == sock && item->m_handler.IsNull ())
+        {
+          item->m_handler = handler;
+        }
       if (item->m_quicSocket == sock && item->m_budpSocket != 0)
         {
           item->m_budpSocket->SetRecvCallback (MakeCallback (&QuicL4Protocol::ForwardUp, this));
@@ -629,6 +690,9 @@ QuicL4Protocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_quicUdpBindingList.clear ();
+  m_connectionIdIndex.clear ();
+  m_authAddresses.clear ();
+  m_authAddressIndex.clear ();
 
   m_node = 0;
 //  m_downTarget.Nullify ();
@@ -637,9 +701,9 @@ QuicL4Protocol::DoDispose (void)
 }
 
 Ptr<QuicSocketBase>
-QuicL4Protocol::CloneSocket (Ptr<QuicSocketBase> oldsock)
+QuicL4Protocol::CloneSocket (Ptr<QuicSocketBase> oldsock, uint64_t connectionId)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << connectionId);
   Ptr<QuicSocketBase> newsock = CopyObject<QuicSocketBase> (oldsock);
   NS_LOG_LOGIC (this << " cloned socket " << oldsock << " to socket " << newsock);
   QuicUdpBinding* udpBinding = new QuicUdpBinding ();
@@ -647,10 +711,66 @@ QuicL4Protocol::CloneSocket (Ptr<QuicSocketBase> oldsock)
   udpBinding->m_budpSocket6 = nullptr;
   udpBinding->m_quicSocket = newsock;
   m_quicUdpBindingList.insert (m_quicUdpBindingList.end (), udpBinding);
+  // index the clone before it takes the connection ID, so that
+  // UpdateConnectionId finds its binding without scanning the list
+  m_connectionIdIndex[connectionId] = udpBinding;
+  newsock->SetConnectionId (connectionId);
 
   return newsock;
 }
 
+Ptr<QuicUdpBinding>
+QuicL4Protocol::FindBinding (Ptr<QuicSocketBase> socket) const
+{
+  NS_LOG_FUNCTION (this << socket);
+
+  auto index_it = m_connectionIdIndex.find (socket->GetConnectionId ());
+  if (index_it != m_connectionIdIndex.end ()
+      && index_it->second->m_quicSocket == socket)
+    {
+      return index_it->second;
+    }
+
+  for (auto it = m_quicUdpBindingList.begin (); it != m_quicUdpBindingList.end (); ++it)
+    {
+      if ((*it)->m_quicSocket == socket)
+        {
+          return *it;
+        }
+    }
+  return 0;
+}
+
+void
+QuicL4Protocol::UpdateConnectionId (Ptr<QuicSocketBase> socket, uint64_t oldConnectionId)
+{
+  NS_LOG_FUNCTION (this << socket << oldConnectionId << socket->GetConnectionId ());
+
+  auto index_it = m_connectionIdIndex.find (oldConnectionId);
+  Ptr<QuicUdpBinding> binding;
+  if (index_it != m_connectionIdIndex.end () && index_it->second->m_quicSocket == socket)
+    {
+      binding = index_it->second;
+      m_connectionIdIndex.erase (index_it);
+    }
+  else
+    {
+      binding = FindBinding (socket);
+    }
+
+  if (binding == nullptr)
+    {
+      return;
+    }
+  // keep the first socket registered with a connection ID, as the previous linear demux did
+  auto inserted = m_connectionIdIndex.insert (std::make_pair (socket->GetConnectionId (), binding));
+  if (!inserted.second && inserted.first->second != binding)
+    {
+      NS_LOG_WARN (this << " Connection ID " << socket->GetConnectionId () << " already in use by socket "
+                        << inserted.first->second->m_quicSocket);
+    }
+}
+
 
 
 Ptr<Socket>
@@ -684,28 +804,19 @@ QuicL4Protocol::CreateSocket (TypeId congestionTypeId)
   // sockets associated to this L4 protocol
   Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
 
-  bool found = false;
   uint64_t connectionId;
-  while (not found)
+  do
     {
       connectionId = uint64_t (rand->GetValue (0, pow (2, 64) - 1));
-      found = true;
-      for (auto it = m_quicUdpBindingList.begin (); it != m_quicUdpBindingList.end (); ++it)
-        {
-          found = false;
-          if (connectionId == (*it)->m_quicSocket->GetConnectionId ())
-            {
-              break;
-            }
-          found = true;
-        }
     }
-  socket->SetConnectionId (connectionId);
+  while (m_connectionIdIndex.find (connectionId) != m_connectionIdIndex.end ());
+
   QuicUdpBinding* udpBinding = new QuicUdpBinding ();
   udpBinding->m_budpSocket = nullptr;
   udpBinding->m_budpSocket6 = nullptr;
   udpBinding->m_quicSocket = socket;
   m_quicUdpBindingList.insert (m_quicUdpBindingList.end (), udpBinding);
+  socket->SetConnectionId (connectionId);
 
   return socket;
 }
@@ -796,16 +907,11 @@ QuicL4Protocol::SendPacket (Ptr<QuicSocketBase> socket, Ptr<Packet> pkt, const Q
   //packetSent->Print (std::clog);
   // NS_LOG_INFO ("");
 
-  QuicUdpBindingList::const_iterator it;
-  for (it = m_quicUdpBindingList.begin (); it != m_quicUdpBindingList.end (); ++it)
-  {
-    Ptr<QuicUdpBinding> item = *it;
-    if (item->m_quicSocket == socket)
-      {
-        UdpSend (item->m_budpSocket, packetSent, 0);
-        break;
-      }
-  }
+  Ptr<QuicUdpBinding> item = FindBinding (socket);
+  if (item != nullptr)
+    {
+      UdpSend (item->m_budpSocket, packetSent, 0);
+    }
 }
 
 
@@ -826,6 +932,11 @@ QuicL4Protocol::RemoveSocket (Ptr<QuicSocketBase> socket)
         if (item->m_listenerBinding){
           closedListener = true;
         }
+        auto index_it = m_connectionIdIndex.find (socket->GetConnectionId ());
+        if (index_it != m_connectionIdIndex.end () && index_it->second == item)
+          {
+            m_connectionIdIndex.erase (index_it);
+          }
         m_quicUdpBindingList.erase (iter);
 
         break;
@@ -846,6 +957,30 @@ QuicL4Protocol::RemoveSocket (Ptr<QuicSocketBase> socket)
   return found;
 }
 
+uint64_t
+QuicL4Protocol::ReserveReceiveWindow (uint64_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+
+  uint64_t granted = 0;
+  if (m_reservedReceiveWindow < m_receiveWindowBudget)
+    {
+      granted = std::min (bytes, m_receiveWindowBudget - m_reservedReceiveWindow);
+    }
+  m_reservedReceiveWindow += granted;
+  NS_LOG_LOGIC ("Granted " << granted << " bytes, " << m_reservedReceiveWindow
+                           << " of " << m_receiveWindowBudget << " reserved");
+  return granted;
+}
+
+void
+QuicL4Protocol::ReleaseReceiveWindow (uint64_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+  NS_ASSERT (bytes <= m_reservedReceiveWindow);
+  m_reservedReceiveWindow -= bytes;
+}
+
 Ipv4EndPoint *
 QuicL4Protocol::Allocate (void)
 {
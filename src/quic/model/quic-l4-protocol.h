@@ -27,11 +27,14 @@
 
 #include <stdint.h>
 #include <map>
+#include <list>
+#include <unordered_map>
 #include "ns3/node.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ip-l4-protocol.h"
+#include "ns3/nstime.h"
 #include "quic-header.h"
 #include "ns3/socket.h"
 
@@ -61,6 +64,7 @@ public:
   Ptr<Socket> m_budpSocket6;         //!< The IPv6 UDP this binding is associated with
   Ptr<QuicSocketBase> m_quicSocket;  //!< The quic socket associated with this binding
   bool m_listenerBinding;            //!< A flag that indicates if in this binding resides the listening socket
+  Callback<void, Ptr<Packet>, const QuicHeader&, Address& > m_handler;  //!< Receive callback of the quic socket
 };
 
 /**
@@ -100,6 +104,12 @@ public:
   QuicL4Protocol ();
   virtual ~QuicL4Protocol ();
 
+  /**
+   * \brief QuicL4ProtocolTestCase friend class (for tests).
+   * \relates QuicL4ProtocolTestCase
+   */
+  friend class QuicL4ProtocolTestCase;
+
   /**
    * \brief Set the node associated with this stack
    *
@@ -238,11 +248,15 @@ public:
   void BindToNetDevice (Ptr<QuicSocketBase> socket, Ptr<NetDevice> netdevice);
 
   /**
-   * \brief Get the authenticated addresses vector
+   * \brief Check if a peer address has been authenticated
+   *
+   * A successful lookup marks the address as the most recently used one.
+   * Addresses not used for longer than the AuthAddressTtl attribute are removed.
    *
-   * \return The authenticated addresses vector for this L4 Protocol
+   * \param address the IPv4 address of the peer
+   * \return true if the address is in the authenticated addresses cache
    */
-  const std::vector<Address >& GetAuthAddresses () const;
+  bool IsAuthenticated (Ipv4Address address);
 
   /**
    * \brief This method is called by the underlying UDP socket upon receiving a packet
@@ -277,6 +291,32 @@ public:
    */
   bool RemoveSocket (Ptr<QuicSocketBase> socket);
 
+  /**
+   * \brief Reserve memory for the growth of a receive window
+   *
+   * The receive windows autotuned by the sockets of the node share the
+   * ReceiveWindowBudget.
+   *
+   * \param bytes the growth requested
+   * \return the growth granted, limited by the memory left in the budget
+   */
+  uint64_t ReserveReceiveWindow (uint64_t bytes);
+
+  /**
+   * \brief Return memory reserved with ReserveReceiveWindow to the budget
+   *
+   * \param bytes the memory released
+   */
+  void ReleaseReceiveWindow (uint64_t bytes);
+
+  /**
+   * \brief Re-index a socket whose connection ID has changed
+   *
+   * \param socket a smart pointer to the socket
+   * \param oldConnectionId the connection ID the socket was indexed with
+   */
+  void UpdateConnectionId (Ptr<QuicSocketBase> socket, uint64_t oldConnectionId);
+
   /**
    * \brief Set the listener QuicSocketBase
    *
@@ -426,20 +466,47 @@ private:
   /**
    * \brief Clone a QuicSocket and add it to the list of sockets associated to this protocol
    *
-   * \param sock a smart pointer to the socket to be cloned
+   * The clone is indexed with its own connection ID.
+   *
+   * \param oldsock a smart pointer to the socket to be cloned
+   * \param connectionId the connection ID of the clone
    * \return a smart pointer to the new cloned socket
    */
-  Ptr<QuicSocketBase> CloneSocket (Ptr<QuicSocketBase> oldsock);
+  Ptr<QuicSocketBase> CloneSocket (Ptr<QuicSocketBase> oldsock, uint64_t connectionId);
+
+  /**
+   * \brief Find the binding of a QuicSocket
+   *
+   * \param socket a smart pointer to the socket
+   * \return the binding, or 0 if the socket is not bound to this protocol
+   */
+  Ptr<QuicUdpBinding> FindBinding (Ptr<QuicSocketBase> socket) const;
 
   Ptr<Node> m_node;           //!< The node this stack is associated with
   TypeId m_rttTypeId;         //!< The type of RttEstimator objects
   TypeId m_congestionTypeId;  //!< The socket type of QUIC objects
   bool m_0RTTHandshakeStart;  //!< A flag indicating if the L4 Protocol allows the 0-RTT Hansdhake start
-  std::map <Ptr<Socket>, Callback<void, Ptr<Packet>, const QuicHeader&, Address& > > m_socketHandlers;  //!< Callback handlers for sockets
 
-  std::vector<Address > m_authAddresses;    //!< Authenticated addresses for this L4 Protocol
+  /**
+   * \brief Add a peer address to the authenticated addresses cache
+   *
+   * If the cache is full, the least recently used address is evicted.
+   *
+   * \param address the IPv4 address of the peer
+   */
+  void AddAuthAddress (Ipv4Address address);
+
+  typedef std::list<std::pair<Ipv4Address, Time> > AuthAddressList;  //!< authenticated addresses and last use times, most recently used first
+
+  AuthAddressList m_authAddresses;  //!< Authenticated addresses for this L4 Protocol
+  std::unordered_map<Ipv4Address, AuthAddressList::iterator, Ipv4AddressHash> m_authAddressIndex;  //!< Index of m_authAddresses
+  uint32_t m_maxAuthAddresses;      //!< Capacity of the authenticated addresses cache
+  Time m_authAddressTtl;            //!< Idle lifetime of an authenticated address (0 means no expiration)
   QuicUdpBindingList m_quicUdpBindingList;  //!< List of QuicUdp bindings
+  std::unordered_map<uint64_t, Ptr<QuicUdpBinding> > m_connectionIdIndex;  //!< QuicUdp bindings indexed by connection ID
   bool m_isServer;                          //!< A flag indicating if the L4 Protocol is server
+  uint64_t m_receiveWindowBudget;           //!< Memory that autotuning can add to the receive windows of the node
+  uint64_t m_reservedReceiveWindow;         //!< Memory added to the receive windows of the node by autotuning
 
   Ipv4EndPointDemux *m_endPoints;   //!< A list of IPv4 end points.
   Ipv6EndPointDemux *m_endPoints6;  //!< A list of IPv6 end points.
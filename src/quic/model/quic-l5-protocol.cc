@@ -26,7 +26,8 @@
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
-#include "ns3/object-vector.h"
+#include "ns3/object-map.h"
+#include "ns3/pointer.h"
 
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -63,23 +64,32 @@ QuicL5Protocol::GetTypeId (void)
     TypeId ("ns3::QuicL5Protocol").SetParent<QuicSocketBase> ().SetGroupName (
       "Internet").AddConstructor<QuicL5Protocol> ()
       .AddAttribute (
-                     "StreamList", "The list of streams associated to this protocol.",
-                     ObjectVectorValue (),
-                     MakeObjectVectorAccessor (&QuicL5Protocol::m_streams),
-                     MakeObjectVectorChecker<QuicStreamBase> ());
+                     "StreamList", "The streams opened by this protocol, indexed by stream ID.",
+                     ObjectMapValue (),
+                     MakeObjectMapAccessor (&QuicL5Protocol::m_streams),
+                     MakeObjectMapChecker<QuicStreamBase> ())
+      .AddAttribute ("StreamScheduler", "The scheduler of the streams with data to send.",
+                     PointerValue (),
+                     MakePointerAccessor (&QuicL5Protocol::SetStreamScheduler,
+                                          &QuicL5Protocol::GetStreamScheduler),
+                     MakePointerChecker<QuicStreamScheduler> ());
   return tid;
 }
 
 QuicL5Protocol::QuicL5Protocol ()
   : m_socket (0),
     m_node (0),
-    m_connectionId ()
+    m_connectionId (),
+    m_nextWriteIndex (0),
+    m_nextLocalStreamId (1),
+    m_sentData (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_LOGIC ("Made a QuicL5Protocol " << this);
   m_socket = 0;
   m_node = 0;
   m_connectionId = 0;
+  m_scheduler = CreateObject<QuicStreamRoundRobinScheduler> ();
 }
 
 QuicL5Protocol::~QuicL5Protocol ()
@@ -87,12 +97,25 @@ QuicL5Protocol::~QuicL5Protocol ()
   NS_LOG_FUNCTION (this);
 }
 
-void
+Ptr<QuicStreamBase>
 QuicL5Protocol::CreateStream (
-  const QuicStreamBase::QuicStreamDirectionTypes_t streamDirectionType)
+  const QuicStream::QuicStreamDirectionTypes_t streamDirectionType,
+  uint64_t streamId)
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_INFO ("Create the stream with ID " << m_streams.size ());
+  NS_LOG_FUNCTION (this << streamId);
+
+  if (streamId > m_socket->GetMaxStreamId ())   // TODO separate unidirectional and bidirectional
+    {
+      NS_LOG_INFO ("MaxStreamId " << m_socket->GetMaxStreamId ());
+      SignalAbortConnection (
+        QuicSubheader::TransportErrorCodes_t::STREAM_ID_ERROR,
+        "Initiating Stream with higher StreamID with respect to what already negotiated");
+      return 0;
+    }
+
+  NS_ASSERT_MSG (m_streams.find (streamId) == m_streams.end (),
+                 "Stream " << streamId << " already open");
+  NS_LOG_INFO ("Create the stream with ID " << streamId);
   Ptr<QuicStreamBase> stream = CreateObject<QuicStreamBase> ();
 
   stream->SetQuicL5 (this);
@@ -101,11 +124,11 @@ QuicL5Protocol::CreateStream (
 
   stream->SetConnectionId (m_connectionId);
 
-  stream->SetStreamId ((uint64_t) m_streams.size ());
+  stream->SetStreamId (streamId);
 
   uint64_t mask = 0x00000003;
-  if ((m_streams.size () & mask) == QuicStream::CLIENT_INITIATED_BIDIRECTIONAL
-      or (m_streams.size () & mask)
+  if ((streamId & mask) == QuicStream::CLIENT_INITIATED_BIDIRECTIONAL
+      or (streamId & mask)
       == QuicStream::SERVER_INITIATED_BIDIRECTIONAL)
     {
       stream->SetStreamDirectionType (QuicStream::BIDIRECTIONAL);
@@ -119,41 +142,27 @@ QuicL5Protocol::CreateStream (
   if (stream->GetStreamId () > 0)
     {
       stream->SetMaxStreamData (m_socket->GetInitialMaxStreamData ());
+      stream->SetFlowControlLimit (m_socket->GetAdvertisedMaxStreamData ());
+      stream->SetFlowControlUpdateThreshold (m_socket->GetFlowControlUpdateThreshold ());
+      stream->SetMaxReceiveWindow (m_socket->GetMaxStreamReceiveWindow ());
     }
   else
     {
       stream->SetMaxStreamData (UINT32_MAX);
     }
 
-  m_streams.push_back (stream);
-
-}
-
-void
-QuicL5Protocol::CreateStream (
-  const QuicStream::QuicStreamDirectionTypes_t streamDirectionType,
-  uint64_t streamNum)
-{
-
-  NS_LOG_FUNCTION (this << m_streams.size () << streamNum);
-
-
-  if (streamNum > m_socket->GetMaxStreamId ())   // TODO separate unidirectional and bidirectional
-    {
-      NS_LOG_INFO ("MaxStreamId " << m_socket->GetMaxStreamId ());
-      SignalAbortConnection (
-        QuicSubheader::TransportErrorCodes_t::STREAM_ID_ERROR,
-        "Initiating Stream with higher StreamID with respect to what already negotiated");
-      return;
-    }
+  m_streams[streamId] = stream;
 
-  // create streamNum streams
-  while (m_streams.size () <= streamNum)
+  // stream 0 bypasses the scheduler
+  if (stream->GetStreamId () > 0
+      and (stream->GetStreamDirectionType () == QuicStream::SENDER
+           or stream->GetStreamDirectionType () == QuicStream::BIDIRECTIONAL))
     {
-      NS_LOG_INFO ("Create stream " << m_streams.size ());
-      CreateStream (streamDirectionType);
+      m_sendStreams.push_back (stream);
+      m_scheduler->AddStream (stream);
     }
 
+  return stream;
 }
 
 void
@@ -170,35 +179,52 @@ QuicL5Protocol::DispatchSend (Ptr<Packet> data)
 
   int sentData = 0;
 
-  // if the streams are not created yet, open the streams
-  if (m_streams.size () != m_socket->GetMaxStreamId ())
+  // Pick the next open stream in round-robin that can buffer the whole packet,
+  // stream 0 is used only for handshake and is not in the list
+  Ptr<QuicStreamBase> stream = 0;
+  uint32_t index = m_nextWriteIndex;
+  for (uint32_t i = 0; i < m_sendStreams.size (); ++i)
     {
-      NS_LOG_INFO ("Create the missing streams");
-      CreateStream (QuicStream::SENDER, m_socket->GetMaxStreamId ());   // TODO open up to max_stream_uni and max_stream_bidi
+      index = (m_nextWriteIndex + i) % m_sendStreams.size ();
+      if (m_sendStreams[index]->GetStreamTxAvailable () >= data->GetSize ())
+        {
+          stream = m_sendStreams[index];
+          break;
+        }
     }
 
-  std::vector<Ptr<Packet> > disgregated = DisgregateSend (data);
-
-  std::vector<Ptr<QuicStreamBase> >::iterator jt = m_streams.begin () + 1;   // Avoid Send on stream <0>, which is used only for handshake
-
-  for (std::vector<Ptr<Packet> >::iterator it = disgregated.begin ();
-       it != disgregated.end (); ++jt)
+  // open a new stream only if every open stream is full
+  if (stream == 0)
     {
-      if (jt == m_streams.end ())             // Sending Remaining Load
+      while (m_nextLocalStreamId <= m_socket->GetMaxStreamId ()
+             and m_streams.find (m_nextLocalStreamId) != m_streams.end ())
         {
-          jt = m_streams.begin () + 1;
+          ++m_nextLocalStreamId;
         }
-      NS_LOG_LOGIC (
-        this << " " << (uint64_t)(*jt)->GetStreamDirectionType () << (uint64_t) QuicStream::SENDER << (uint64_t) QuicStream::BIDIRECTIONAL);
-
-      if ((*jt)->GetStreamDirectionType () == QuicStream::SENDER
-          or (*jt)->GetStreamDirectionType () == QuicStream::BIDIRECTIONAL)
+      if (m_nextLocalStreamId <= m_socket->GetMaxStreamId ())
         {
-          NS_LOG_INFO (
-            "Sending data on stream " << (*jt)->GetStreamId ());
-          sentData = (*jt)->Send ((*it));
-          ++it;
+          NS_LOG_INFO ("Open stream " << m_nextLocalStreamId);
+          stream = CreateStream (QuicStream::SENDER, m_nextLocalStreamId++);
+          index = m_sendStreams.size () - 1;
         }
+      else if (!m_sendStreams.empty ())
+        {
+          index = m_nextWriteIndex % m_sendStreams.size ();
+          stream = m_sendStreams[index];  // every stream is full, the write will fail
+        }
+    }
+
+  if (stream == 0)
+    {
+      NS_LOG_WARN ("No stream can send data");
+      return -1;
+    }
+
+  NS_LOG_INFO ("Sending data on stream " << stream->GetStreamId ());
+  sentData = stream->Send (data);
+  if (sentData > 0)
+    {
+      m_nextWriteIndex = index + 1;
     }
 
   return sentData;
@@ -211,16 +237,15 @@ QuicL5Protocol::DispatchSend (Ptr<Packet> data, uint64_t streamId)
 
   NS_LOG_INFO ("Send packet on (specified) stream " << streamId);
 
-  Ptr<QuicStreamBase> stream = SearchStream (streamId);
+  Ptr<QuicStreamBase> stream = GetOrCreateStream (streamId);
+  int sentData = 0;
 
-  if (stream == nullptr)
+  if (stream == 0)
     {
-      CreateStream (QuicStream::SENDER, streamId);
+      NS_LOG_WARN ("Stream " << streamId << " cannot be opened");
+      return -1;
     }
 
-  stream = SearchStream (streamId);
-  int sentData = 0;
-
   if (stream->GetStreamDirectionType () == QuicStream::SENDER
       or stream->GetStreamDirectionType () == QuicStream::BIDIRECTIONAL)
     {
@@ -247,10 +272,9 @@ QuicL5Protocol::DispatchRecv (Ptr<Packet> data, Address &address)
     }
 
   bool onlyAckFrames = true;
-  uint64_t currStreamNum = m_streams.size () - 1;
-  for (auto &elem : disgregated)
+  for (auto it = disgregated.begin (); it != disgregated.end (); ++it)
     {
-      QuicSubheader sub = elem.second;
+      QuicSubheader sub = (*it).second;
 
       // check if this is an ack frame
       if (!sub.IsAck ())
@@ -258,28 +282,20 @@ QuicL5Protocol::DispatchRecv (Ptr<Packet> data, Address &address)
           onlyAckFrames = false;
         }
 
-      if (sub.GetStreamId () > currStreamNum)
-        {
-          currStreamNum = sub.GetStreamId ();
-        }
-    }
-
-  CreateStream (QuicStream::RECEIVER, currStreamNum);
-
-  for (auto it = disgregated.begin (); it != disgregated.end (); ++it)
-    {
-      QuicSubheader sub = (*it).second;
-
       if (sub.IsRstStream () or sub.IsMaxStreamData ()
           or sub.IsStreamBlocked () or sub.IsStopSending ()
           or sub.IsStream ())
         {
+          // the streams opened by the peer are created on their first frame
           Ptr<QuicStreamBase> stream = SearchStream (sub.GetStreamId ());
+          if (stream == nullptr)
+            {
+              stream = CreateStream (QuicStream::RECEIVER, sub.GetStreamId ());
+            }
 
-          if (stream != nullptr
-              and (stream->GetStreamDirectionType () == QuicStream::RECEIVER
-                   or stream->GetStreamDirectionType ()
-                   == QuicStream::BIDIRECTIONAL))
+          // the stream checks the direction of the frame, MAX_STREAM_DATA
+          // and STOP_SENDING refer to its send side
+          if (stream != nullptr)
             {
               NS_LOG_INFO (
                 "Receiving frame on stream " << stream->GetStreamId () <<
@@ -318,40 +334,129 @@ QuicL5Protocol::Recv (Ptr<Packet> frame, Address &address)
   return frame->GetSize ();
 }
 
-std::vector<Ptr<Packet> >
-QuicL5Protocol::DisgregateSend (Ptr<Packet> data)
+uint32_t
+QuicL5Protocol::PullFrames (uint32_t maxBytes, uint32_t maxNewBytes)
 {
-  NS_LOG_FUNCTION (this);
-
-  uint32_t dataSizeByte = data->GetSize ();
-  std::vector< Ptr<Packet> > disgregated;
-  //data->Print(std::cout);
+  NS_LOG_FUNCTION (this << maxBytes << maxNewBytes);
 
-  // Equally distribute load on all streams except on stream 0
-  uint32_t loadPerStream = dataSizeByte / (m_streams.size () - 1);
-  uint32_t remainingLoad = dataSizeByte - loadPerStream * (m_streams.size () - 1);
-  if (loadPerStream < 1)
+  uint32_t pulled = 0;
+  // the lost data was already counted against the flow control limits
+  std::set<uint64_t>::iterator lostIt = m_lostStreams.begin ();
+  while (lostIt != m_lostStreams.end () and pulled < maxBytes)
     {
-	    loadPerStream = 1;
+      Ptr<QuicStreamBase> stream = SearchStream (*lostIt);
+      if (stream == 0 or stream->GetLostSize () == 0)
+        {
+          lostIt = m_lostStreams.erase (lostIt);
+          continue;
+        }
+      int size = stream->SendLostFrame (maxBytes - pulled);
+      if (size <= 0)
+        {
+          break;
+        }
+      pulled += size;
     }
 
-  for (uint32_t start = 0; start < dataSizeByte; start += loadPerStream)
+  maxBytes = std::min (maxBytes, pulled + maxNewBytes);
+  while (pulled < maxBytes)
     {
-      if (remainingLoad > 0 && start + remainingLoad == dataSizeByte)
+      Ptr<QuicStreamBase> stream = m_scheduler->SelectStream ();
+      if (stream == 0)
         {
-          Ptr<Packet> remainingfragment = data->CreateFragment (
-              start, remainingLoad);
-          disgregated.push_back (remainingfragment);
+          NS_LOG_INFO ("No stream has data to send");
+          break;
         }
-      else
+
+      uint64_t sentSize = stream->GetSentSize ();
+      int size = stream->SendNextFrame (maxBytes - pulled);
+      if (size <= 0)
         {
-          Ptr<Packet> fragment = data->CreateFragment (start, loadPerStream);
-          disgregated.push_back (fragment);
+          break;
         }
+      m_sentData += stream->GetSentSize () - sentSize;
+      m_scheduler->OnFrameSent (stream, size);
+      pulled += size;
+    }
+
+  NS_LOG_INFO ("Pulled " << pulled << " bytes from the streams");
+  return pulled;
+}
 
+void
+QuicL5Protocol::OnStreamFrameAcked (const QuicStreamFrameRange &frame)
+{
+  NS_LOG_FUNCTION (this << frame.m_streamId << frame.m_offset << frame.m_length);
+
+  Ptr<QuicStreamBase> stream = SearchStream (frame.m_streamId);
+  if (stream != 0)
+    {
+      stream->OnFrameAcked (frame.m_offset, frame.m_length);
     }
+}
 
-  return disgregated;
+void
+QuicL5Protocol::OnStreamFrameLost (const QuicStreamFrameRange &frame)
+{
+  NS_LOG_FUNCTION (this << frame.m_streamId << frame.m_offset << frame.m_length);
+
+  Ptr<QuicStreamBase> stream = SearchStream (frame.m_streamId);
+  if (stream != 0)
+    {
+      stream->OnFrameLost (frame.m_offset, frame.m_length);
+      m_lostStreams.insert (frame.m_streamId);
+    }
+}
+
+uint64_t
+QuicL5Protocol::AutoTuneReceiveWindow (QuicFlowController &flowControl)
+{
+  NS_LOG_FUNCTION (this);
+  return m_socket->AutoTuneReceiveWindow (flowControl);
+}
+
+bool
+QuicL5Protocol::HasSendableData () const
+{
+  for (auto stream : m_sendStreams)
+    {
+      if (stream->GetSendableSize () > 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint64_t
+QuicL5Protocol::GetSentData () const
+{
+  return m_sentData;
+}
+
+void
+QuicL5Protocol::NotifyStreamDataAvailable ()
+{
+  NS_LOG_FUNCTION (this);
+  m_socket->ScheduleSendPendingData ();
+}
+
+void
+QuicL5Protocol::SetStreamScheduler (Ptr<QuicStreamScheduler> scheduler)
+{
+  NS_LOG_FUNCTION (this << scheduler);
+  m_scheduler = scheduler;
+
+  for (auto stream : m_sendStreams)
+    {
+      m_scheduler->AddStream (stream);
+    }
+}
+
+Ptr<QuicStreamScheduler>
+QuicL5Protocol::GetStreamScheduler () const
+{
+  return m_scheduler;
 }
 
 std::vector< std::pair<Ptr<Packet>, QuicSubheader> >
@@ -389,17 +494,24 @@ QuicL5Protocol::DisgregateRecv (Ptr<Packet> data)
 Ptr<QuicStreamBase>
 QuicL5Protocol::SearchStream (uint64_t streamId)
 {
-  NS_LOG_FUNCTION (this);
-  std::vector<Ptr<QuicStreamBase> >::iterator it = m_streams.begin ();
-  Ptr<QuicStreamBase> stream;
-  while (it != m_streams.end ())
+  NS_LOG_FUNCTION (this << streamId);
+  std::unordered_map<uint64_t, Ptr<QuicStreamBase> >::iterator it = m_streams.find (streamId);
+  if (it == m_streams.end ())
     {
-      if ((*it)->GetStreamId () == streamId)
-        {
-          stream = *it;
-          break;
-        }
-      ++it;
+      return 0;
+    }
+  return it->second;
+}
+
+Ptr<QuicStreamBase>
+QuicL5Protocol::GetOrCreateStream (uint64_t streamId)
+{
+  NS_LOG_FUNCTION (this << streamId);
+
+  Ptr<QuicStreamBase> stream = SearchStream (streamId);
+  if (stream == nullptr)
+    {
+      stream = CreateStream (QuicStream::SENDER, streamId);
     }
   return stream;
 }
@@ -446,32 +558,19 @@ QuicL5Protocol::SignalAbortConnection (uint16_t transportErrorCode,
 }
 
 void
-QuicL5Protocol::UpdateInitialMaxStreamData (uint32_t newMaxStreamData)
+QuicL5Protocol::UpdateInitialMaxStreamData (uint64_t newMaxStreamData)
 {
   NS_LOG_FUNCTION (this << newMaxStreamData);
 
   // TODO handle in a different way bidirectional and unidirectional streams
-  for (auto stream : m_streams)
+  for (auto &elem : m_streams)
     {
-      if (stream->GetStreamId () > 0) // stream 0 is set to UINT32_MAX and not modified
+      if (elem.first > 0) // stream 0 is set to UINT32_MAX and not modified
         {
-          stream->SetMaxStreamData (newMaxStreamData);
+          elem.second->SetMaxStreamData (newMaxStreamData);
         }
     }
 }
 
-uint64_t
-QuicL5Protocol::GetMaxData ()
-{
-  NS_LOG_FUNCTION(this);
-  
-  uint64_t maxData = 0;
-  for (auto stream : m_streams)
-    {
-      maxData += stream->SendMaxStreamData();
-    }
-  return maxData;
-}
-
 } // namespace ns3
 
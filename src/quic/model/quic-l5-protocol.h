@@ -28,12 +28,17 @@
 #include "quic-transport-parameters.h"
 #include "quic-stream.h"
 #include "quic-subheader.h"
+#include "quic-stream-scheduler.h"
+#include <unordered_map>
+#include <set>
 
 
 namespace ns3 {
 
 class QuicSocketBase;
 class QuicStreamBase;
+class QuicFlowController;
+class QuicStreamFrameRange;
 
 /**
  * This class handles the creation and management of QUIC streams
@@ -49,14 +54,20 @@ class QuicStreamBase;
  * - the binding of the QUIC socket to the QUIC streams
  *
  * The creation of QuicStreams are handled in the method CreateStream.
+ * Streams are opened lazily, the first time they are used to send data or
+ * a frame of the peer refers to them, and are indexed by stream ID, so that
+ * allowing many streams per connection costs nothing until they are used.
  * Upon creation, this class is responsible to the stream initialization and 
  * handle multiplexing/demultiplexing of data. Demultiplexing is done by 
  * receiving packets from a QUIC Socket, and forwards them to its associated 
- * streams. Multiplexing is done through the DispatchSend function, which sends
- * the frames down the stack.
+ * streams. Multiplexing is done at packetization time: the data written
+ * through the DispatchSend function is buffered in the streams, and the
+ * socket pulls frames with PullFrames each time it builds a packet. A
+ * QuicStreamScheduler decides which stream fills each frame.
  *
  * \see CreateStream
  * \see DispatchSend
+ * \see PullFrames
 */
 class QuicL5Protocol : public Object
 {
@@ -95,10 +106,13 @@ public:
   /**
    * \brief Send a packet to the streams associated to this L5 protocol
    *
-   * The streams are created if not present. Stream 0 is not used (only for handshake)
+   * Stream 0 is not used (only for handshake).
+   * The packet is written as a whole on one stream; consecutive writes are
+   * assigned in round-robin to the open streams with enough room in their TX
+   * buffer, and a new stream is opened only if none of them has.
    *
    * \param data a smart pointer to a packet
-   * \return always 0
+   * \return the size of the packet, or -1 if it could not be buffered
    */
   int DispatchSend (Ptr<Packet> data);
 
@@ -109,7 +123,8 @@ public:
    *
    * \param data a smart pointer to a packet
    * \param streamId the stream ID for the packet
-   * \return always 0
+   * \return the size of the packet, 0 if the stream cannot send data, or -1 if the
+   *   packet could not be buffered or the stream ID is not allowed
    */
   int DispatchSend (Ptr<Packet> data, uint64_t streamId);
 
@@ -147,12 +162,68 @@ public:
   int Recv (Ptr<Packet> frame, Address &address);
 
   /**
-   * \brief Create a vector with fragments of packets to be sent in different streams
+   * \brief Move frames of the streams selected by the stream scheduler to the socket TX buffer
    *
-   * \param data a smart pointer to a Packet
-   * \return a vector of packet fragmets
+   * Called by the socket when it builds a packet. The lost data of the
+   * streams is retransmitted first, from the lowest stream ID; then the
+   * stream scheduler picks the streams that send new data.
+   *
+   * \param maxBytes the maximum number of bytes, subheaders included
+   * \param maxNewBytes the maximum number of bytes of new data, which is
+   *   counted against the connection limit of the peer
+   * \return the number of bytes passed to the socket
+   */
+  uint32_t PullFrames (uint32_t maxBytes, uint32_t maxNewBytes);
+
+  /**
+   * \brief Notify a stream that the peer acknowledged some of its data
+   *
+   * \param frame the acknowledged stream data
+   */
+  void OnStreamFrameAcked (const QuicStreamFrameRange &frame);
+
+  /**
+   * \brief Notify a stream that some of its data was lost, so that the next
+   *   packets retransmit it
+   *
+   * \param frame the lost stream data
+   */
+  void OnStreamFrameLost (const QuicStreamFrameRange &frame);
+
+  /**
+   * \brief Check whether a stream has data that the stream limits allow to send
+   *
+   * \return true if PullFrames would find a frame, regardless of the connection limit
+   */
+  bool HasSendableData () const;
+
+  /**
+   * \brief Get the amount of new stream data passed to the socket, stream 0 excluded
+   *
+   * This is the data counted against the connection limit of the peer.
+   *
+   * \return the amount of data sent on the connection
+   */
+  uint64_t GetSentData () const;
+
+  /**
+   * \brief Method called by a stream when it has new data that can be sent
+   */
+  void NotifyStreamDataAvailable ();
+
+  /**
+   * \brief Set the stream scheduler, registering the existing streams
+   *
+   * \param scheduler the stream scheduler
    */
-  std::vector<Ptr<Packet> > DisgregateSend (Ptr<Packet> data);
+  void SetStreamScheduler (Ptr<QuicStreamScheduler> scheduler);
+
+  /**
+   * \brief Get the stream scheduler
+   *
+   * \return the stream scheduler
+   */
+  Ptr<QuicStreamScheduler> GetStreamScheduler () const;
 
   /**
    * \brief Create a vector of frames, corresponding to frames of different streams aggregated in a single QUIC packet
@@ -163,28 +234,34 @@ public:
   std::vector< std::pair<Ptr<Packet>, QuicSubheader> > DisgregateRecv (Ptr<Packet> data);
 
   /**
-   * \brief get the stream associated to the ID
+   * \brief get the stream associated to the ID, in constant time
    *
    * \param streamId the ID of the stream
-   * \return a smart pointer to the stream object
+   * \return a smart pointer to the stream object, or 0 if the stream is not open
    */
   Ptr<QuicStreamBase> SearchStream (uint64_t streamId);
 
   /**
-   * \brief Create a stream with ID equal to the number of already created streams
+   * \brief get the stream associated to the ID, creating it if not present
    *
-   * \param streamDirectionType the stream direction
+   * \param streamId the ID of the stream
+   * \return a smart pointer to the stream object, or 0 if the ID is not allowed
    */
-  void CreateStream (const QuicStream::QuicStreamDirectionTypes_t streamDirectionType);
+  Ptr<QuicStreamBase> GetOrCreateStream (uint64_t streamId);
 
   /**
-   * \brief create streamNum streams to be associated to this L5 object
+   * \brief Open the stream with the given ID
+   *
+   * The streams with a lower ID are not created: they are opened only when
+   * they are used. The connection is aborted if the ID exceeds the negotiated
+   * maximum.
    *
-   * \param streamDirectionType the QUIC stream direction type,
-   *   i.e., unidirectional or bidirectional
-   * \param the number of streams to be created
+   * \param streamDirectionType the QUIC stream direction type of a unidirectional stream,
+   *   bidirectional stream IDs are always BIDIRECTIONAL
+   * \param streamId the stream ID
+   * \return the stream, or 0 if the ID is not allowed
    */
-  void CreateStream (const QuicStream::QuicStreamDirectionTypes_t streamDirectionType, uint64_t streamNum);
+  Ptr<QuicStreamBase> CreateStream (const QuicStream::QuicStreamDirectionTypes_t streamDirectionType, uint64_t streamId);
 
   /**
    * \brief Get the maximum packet size from the underlying socket
@@ -220,20 +297,27 @@ public:
    *
    * \param newMaxStreamData the updated value
    */
-  void UpdateInitialMaxStreamData (uint32_t newMaxStreamData);
-  
+  void UpdateInitialMaxStreamData (uint64_t newMaxStreamData);
+
   /**
-   * \brief Return MAX_DATA for flow control (i.e., the sum of MAX_STREAM_DATA for all streams)
-   * 
-   * \returns the new max data value
+   * \brief Grow the receive window of a stream at a limit update
+   *
+   * \param flowControl the flow controller of the stream
+   * \return the receive window of the stream
    */
-  uint64_t GetMaxData ();
+  uint64_t AutoTuneReceiveWindow (QuicFlowController &flowControl);
 
 private:
   Ptr<QuicSocketBase> m_socket;                 //!< The Quic socket this stack is associated with
   Ptr<Node> m_node;                             //!< The node this stack is associated with
   uint64_t m_connectionId;                      //!< The connection id this stack is associated with
-  std::vector<Ptr<QuicStreamBase> > m_streams;  //!< The streams this stack is associated with
+  std::unordered_map<uint64_t, Ptr<QuicStreamBase> > m_streams;  //!< The open streams, indexed by stream ID
+  std::vector<Ptr<QuicStreamBase> > m_sendStreams;  //!< The open streams that can send data (stream 0 excluded)
+  Ptr<QuicStreamScheduler> m_scheduler;         //!< The scheduler of the streams with data to send
+  uint32_t m_nextWriteIndex;                    //!< Index in m_sendStreams of the first stream tried by the next write without stream ID
+  uint64_t m_nextLocalStreamId;                 //!< Lowest stream ID that a write without stream ID may open
+  uint64_t m_sentData;                          //!< New stream data passed to the socket, stream 0 excluded
+  std::set<uint64_t> m_lostStreams;             //!< IDs of the streams that may have lost data to retransmit
 };
 
 } // namespace ns3
@@ -49,9 +49,11 @@
 #include "ns3/trace-source-accessor.h"
 #include "quic-socket-base.h"
 #include "quic-congestion-ops.h"
+#include "quic-tcp-congestion-adapter.h"
 #include "ns3/tcp-congestion-ops.h"
 #include "quic-header.h"
 #include "quic-l4-protocol.h"
+#include "quic-stream-base.h"
 #include "ns3/ipv4-end-point.h"
 #include "ns3/ipv6-end-point.h"
 #include "ns3/ipv6-l3-protocol.h"
@@ -102,11 +104,29 @@ QuicSocketBase::GetTypeId (void)
                    "Stream Maximum Data",
                    UintegerValue (4294967295),      // according to the QUIC RFC this value should default to 0, and be increased by the client/server
                    MakeUintegerAccessor (&QuicSocketBase::m_initial_max_stream_data),
-                   MakeUintegerChecker<uint32_t> ())
+                   MakeUintegerChecker<uint64_t> (0, QuicSubheader::MAX_VARINT))
     .AddAttribute ("MaxData",
                    "Connection Maximum Data",
                    UintegerValue (4294967295),      // according to the QUIC RFC this value should default to 0, and be increased by the client/server
                    MakeUintegerAccessor (&QuicSocketBase::m_max_data),
+                   MakeUintegerChecker<uint64_t> (0, QuicSubheader::MAX_VARINT))
+    .AddAttribute ("FlowControlUpdateThreshold",
+                   "Fraction of the receive window consumed by the application "
+                   "before MAX_DATA or MAX_STREAM_DATA frames grant new credit",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&QuicSocketBase::m_flowControlUpdateThreshold),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("MaxReceiveWindow",
+                   "Largest connection receive window (bytes) reached by autotuning, "
+                   "which is disabled if it is not larger than SocketRcvBufSize",
+                   UintegerValue (24 * 1024 * 1024),
+                   MakeUintegerAccessor (&QuicSocketBase::m_maxReceiveWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxStreamReceiveWindow",
+                   "Largest stream receive window (bytes) reached by autotuning, "
+                   "which is disabled if it is not larger than QuicStreamBase::StreamRcvBufSize",
+                   UintegerValue (16 * 1024 * 1024),
+                   MakeUintegerAccessor (&QuicSocketBase::m_maxStreamReceiveWindow),
                    MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("MaxStreamIdBidi",
                    "Maximum StreamId for Bidirectional Streams",
@@ -158,11 +178,6 @@ QuicSocketBase::GetTypeId (void)
                    "AckDelayExponent", "Ack Delay Exponent", UintegerValue (3),
                    MakeUintegerAccessor (&QuicSocketBase::m_ack_delay_exponent),
                    MakeUintegerChecker<uint8_t> ())
-    .AddAttribute ("kMaxTLPs",
-                   "Maximum number of tail loss probes before an RTO fires",
-                   UintegerValue (2),
-                   MakeUintegerAccessor (&QuicSocketState::m_kMaxTLPs),
-                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute (
                    "kReorderingThreshold",
                    "Maximum reordering in packet number space before FACK style loss detection considers a packet lost",
@@ -172,26 +187,26 @@ QuicSocketBase::GetTypeId (void)
     .AddAttribute (
                    "kTimeReorderingFraction",
                    "Maximum reordering in time space before time based loss detection considers a packet lost",
-                   DoubleValue (9 / 8),
+                   DoubleValue (9.0 / 8),
                    MakeDoubleAccessor (&QuicSocketState::m_kTimeReorderingFraction),
                    MakeDoubleChecker<double> (0))
     .AddAttribute (
                    "kUsingTimeLossDetection",
-                   "Whether time based loss detection is in use", BooleanValue (false),
+                   "Whether time based loss detection is in use", BooleanValue (true),
                    MakeBooleanAccessor (&QuicSocketState::m_kUsingTimeLossDetection),
                    MakeBooleanChecker ())
     .AddAttribute (
-                   "kMinTLPTimeout",
-                   "Minimum time in the future a tail loss probe alarm may be set for",
-                   TimeValue (MilliSeconds (10)),
-                   MakeTimeAccessor (&QuicSocketState::m_kMinTLPTimeout),
+                   "kGranularity",
+                   "Timer granularity, lower bound of the loss delay and of the probe timeout",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&QuicSocketState::m_kGranularity),
                    MakeTimeChecker ())
     .AddAttribute (
-                   "kMinRTOTimeout",
-                   "Minimum time in the future an RTO alarm may be set for",
-                   TimeValue (MilliSeconds (200)),
-                   MakeTimeAccessor (&QuicSocketState::m_kMinRTOTimeout),
-                   MakeTimeChecker ())
+                   "kPersistentCongestionThreshold",
+                   "Number of probe timeouts spanned by the losses of a persistent congestion",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&QuicSocketState::m_kPersistentCongestionThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute (
                    "kDelayedAckTimeout", "The length of the peer's delayed ACK timer",
                    TimeValue (MilliSeconds (25)),
@@ -216,12 +231,50 @@ QuicSocketBase::GetTypeId (void)
                                          &QuicSocketBase::SetInitialPacketSize),
                    MakeUintegerChecker<uint32_t> (
                     QuicSocketBase::MIN_INITIAL_PACKET_SIZE, UINT32_MAX))
-//    .AddAttribute (
-//                   "LegacyCongestionControl",
-//                   "When true, use TCP implementations for the congestion control",
-//                   BooleanValue (false),
-//                   MakeBooleanAccessor (&QuicSocketBase::m_quicCongestionControlLegacy),
-//                   MakeBooleanChecker ())
+    .AddAttribute ("EnablePacing",
+                   "Pace data packets at the rate in the QuicSocketState",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuicSocketBase::SetPacing,
+                                        &QuicSocketBase::GetPacing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PacingGain",
+                   "Gain applied to cWnd/sRTT to compute the pacing rate",
+                   DoubleValue (1.25),
+                   MakeDoubleAccessor (&QuicSocketBase::m_pacingGain),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("PacingBurst",
+                   "Number of packets that can be sent back-to-back when pacing",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&QuicSocketBase::m_pacingBurst),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StreamSchedulerType",
+                   "The type of the scheduler that multiplexes the streams in packets",
+                   TypeIdValue (QuicStreamRoundRobinScheduler::GetTypeId ()),
+                   MakeTypeIdAccessor (&QuicSocketBase::m_streamSchedulerTypeId),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("MinAckDelay",
+                   "The smallest delayed ACK timeout the peer can request with ACK_FREQUENCY frames "
+                   "(min_ack_delay transport parameter); zero disables the ACK frequency extension",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&QuicSocketBase::m_minAckDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxAckElicitingThreshold",
+                   "The largest ack-eliciting threshold requested to the peer with ACK_FREQUENCY frames",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&QuicSocketBase::m_maxAckElicitingThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("AckElicitingThreshold",
+                   "The number of ack-eliciting packets received before an immediate ACK, "
+                   "until the peer requests a different value",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&QuicSocketBase::m_ackElicitingThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AckReorderingThreshold",
+                   "The packet reordering that triggers an immediate ACK (0 to disable), "
+                   "until the peer requests a different value",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&QuicSocketBase::m_ackReorderingThreshold),
+                   MakeUintegerChecker<uint32_t> ())
     // .AddTraceSource ("RTO", "Retransmission timeout",
     //                  MakeTraceSourceAccessor (&QuicSocketBase::m_rto),
     //                  "ns3::Time::TracedValueCallback").AddTraceSource (
@@ -242,11 +295,11 @@ QuicSocketBase::GetTypeId (void)
     .AddTraceSource ("NextTxSequence",
                      "Next sequence number to send (SND.NXT)",
                      MakeTraceSourceAccessor (&QuicSocketBase::m_nextTxSequenceTrace),
-                     "ns3::SequenceNumber32TracedValueCallback")
+                     "ns3::TracedValueCallback::SequenceNumber64")
     .AddTraceSource ("HighestSequence",
                      "Highest sequence number ever sent in socket's life time",
                      MakeTraceSourceAccessor (&QuicSocketBase::m_highTxMarkTrace),
-                     "ns3::SequenceNumber32TracedValueCallback")
+                     "ns3::TracedValueCallback::SequenceNumber64")
     // .AddTraceSource ("State",
     //                  "TCP state",
     //                  MakeTraceSourceAccessor (&QuicSocketBase::m_state),
@@ -279,6 +332,10 @@ QuicSocketBase::GetTypeId (void)
                      "The TCP connection's congestion window",
                      MakeTraceSourceAccessor (&QuicSocketBase::m_cWndTrace),
                      "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("PacingRate",
+                     "The QUIC connection's pacing rate",
+                     MakeTraceSourceAccessor (&QuicSocketBase::m_pacingRateTrace),
+                     "ns3::QuicSocketState::PacingRateTracedCallback")
     .AddTraceSource ("SlowStartThreshold",
                      "TCP slow start threshold (bytes)",
                      MakeTraceSourceAccessor (&QuicSocketBase::m_ssThTrace),
@@ -291,6 +348,10 @@ QuicSocketBase::GetTypeId (void)
                      "Receive QUIC packet from UDP protocol",
                      MakeTraceSourceAccessor (&QuicSocketBase::m_rxTrace),
                      "ns3::QuicSocketBase::QuicTxRxTracedCallback")
+    .AddTraceSource ("DeliveryRate",
+                     "Delivery rate sampled on the reception of an ACK",
+                     MakeTraceSourceAccessor (&QuicSocketBase::m_deliveryRateTrace),
+                     "ns3::QuicSocketBase::DeliveryRateTracedCallback")
   ;
   return tid;
 }
@@ -302,11 +363,6 @@ QuicSocketState::GetTypeId (void)
     TypeId ("ns3::QuicSocketState")
     .SetParent<TcpSocketState> ()
     .SetGroupName ("Internet")
-    .AddAttribute ("kMaxTLPs",
-                   "Maximum number of tail loss probes before an RTO fires",
-                   UintegerValue (2),
-                   MakeUintegerAccessor (&QuicSocketState::m_kMaxTLPs),
-                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("kReorderingThreshold",
                    "Maximum reordering in packet number space before FACK style loss detection considers a packet lost",
                    UintegerValue (3),
@@ -314,23 +370,23 @@ QuicSocketState::GetTypeId (void)
                    MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("kTimeReorderingFraction",
                    "Maximum reordering in time space before time based loss detection considers a packet lost",
-                   DoubleValue (9 / 8),
+                   DoubleValue (9.0 / 8),
                    MakeDoubleAccessor (&QuicSocketState::m_kTimeReorderingFraction),
                    MakeDoubleChecker<double> (0))
     .AddAttribute ("kUsingTimeLossDetection",
-                   "Whether time based loss detection is in use", BooleanValue (false),
+                   "Whether time based loss detection is in use", BooleanValue (true),
                    MakeBooleanAccessor (&QuicSocketState::m_kUsingTimeLossDetection),
                    MakeBooleanChecker ())
-    .AddAttribute ("kMinTLPTimeout",
-                   "Minimum time in the future a tail loss probe alarm may be set for",
-                   TimeValue (MilliSeconds (10)),
-                   MakeTimeAccessor (&QuicSocketState::m_kMinTLPTimeout),
-                   MakeTimeChecker ())
-    .AddAttribute ("kMinRTOTimeout",
-                   "Minimum time in the future an RTO alarm may be set for",
-                   TimeValue (MilliSeconds (200)),
-                   MakeTimeAccessor (&QuicSocketState::m_kMinRTOTimeout),
+    .AddAttribute ("kGranularity",
+                   "Timer granularity, lower bound of the loss delay and of the probe timeout",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&QuicSocketState::m_kGranularity),
                    MakeTimeChecker ())
+    .AddAttribute ("kPersistentCongestionThreshold",
+                   "Number of probe timeouts spanned by the losses of a persistent congestion",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&QuicSocketState::m_kPersistentCongestionThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("kDelayedAckTimeout", "The lenght of the peer's delayed ack timer",
                    TimeValue (MilliSeconds (25)),
                    MakeTimeAccessor (&QuicSocketState::m_kDelayedAckTimeout),
@@ -344,69 +400,62 @@ QuicSocketState::GetTypeId (void)
                    "The maximum number of packets without sending an ACK",
                    UintegerValue (20),
                    MakeUintegerAccessor (&QuicSocketState::m_kMaxPacketsReceivedBeforeAckSend),
-                   MakeUintegerChecker<uint32_t> ());
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("NextTxPacketNumber",
+                     "Next packet number to be sent",
+                     MakeTraceSourceAccessor (&QuicSocketState::m_nextTxPacketNumber),
+                     "ns3::TracedValueCallback::SequenceNumber64")
+    .AddTraceSource ("HighestTxPacketNumber",
+                     "Highest packet number ever sent",
+                     MakeTraceSourceAccessor (&QuicSocketState::m_highTxPacketNumber),
+                     "ns3::TracedValueCallback::SequenceNumber64");
   return tid;
 }
 
 QuicSocketState::QuicSocketState ()
   : TcpSocketState (),
-    m_lossDetectionAlarm (),
-    m_handshakeCount (0),
-    m_tlpCount (
-      0),
-    m_rtoCount (0),
-    m_largestSentBeforeRto (0),
+    m_ptoCount (0),
     m_timeOfLastSentPacket (
       Seconds (0)),
+    m_firstRttSample (Seconds (0)),
     m_largestAckedPacket (0),
     m_smoothedRtt (Seconds (0)),
     m_rttVar (0),
-    m_minRtt (
-      Seconds (0)),
     m_maxAckDelay (Seconds (0)),
     m_lossTime (Seconds (0)),
     m_kMinimumWindow (
       2 * m_segmentSize),
     m_kLossReductionFactor (0.5),
     m_endOfRecovery (0),
-    m_kMaxTLPs (
-      2),
     m_kReorderingThreshold (3),
-    m_kTimeReorderingFraction (9 / 8),
+    m_kTimeReorderingFraction (9.0 / 8),
     m_kUsingTimeLossDetection (
-      false),
-    m_kMinTLPTimeout (MilliSeconds (10)),
-    m_kMinRTOTimeout (
-      MilliSeconds (200)),
+      true),
+    m_kGranularity (MilliSeconds (1)),
+    m_kPersistentCongestionThreshold (3),
     m_kDelayedAckTimeout (MilliSeconds (25)),
     m_alarmType (0),
     m_nextAlarmTrigger (Seconds (100)),
     m_kDefaultInitialRtt (
       MilliSeconds (100)),
-    m_kMaxPacketsReceivedBeforeAckSend (20)
+    m_kMaxPacketsReceivedBeforeAckSend (20),
+    m_nextTxPacketNumber (0),
+    m_highTxPacketNumber (0)
 {
-  m_lossDetectionAlarm.Cancel ();
 }
 
 QuicSocketState::QuicSocketState (const QuicSocketState &other)
   : TcpSocketState (other),
-    m_lossDetectionAlarm (other.m_lossDetectionAlarm),
-    m_handshakeCount (
-      other.m_handshakeCount),
-    m_tlpCount (other.m_tlpCount),
-    m_rtoCount (
-      other.m_rtoCount),
-    m_largestSentBeforeRto (
-      other.m_largestSentBeforeRto),
+    m_ptoCount (
+      other.m_ptoCount),
     m_timeOfLastSentPacket (
       other.m_timeOfLastSentPacket),
+    m_firstRttSample (other.m_firstRttSample),
     m_largestAckedPacket (
       other.m_largestAckedPacket),
     m_smoothedRtt (
       other.m_smoothedRtt),
     m_rttVar (other.m_rttVar),
-    m_minRtt (
-      other.m_minRtt),
     m_maxAckDelay (other.m_maxAckDelay),
     m_lossTime (
       other.m_lossTime),
@@ -415,23 +464,53 @@ QuicSocketState::QuicSocketState (const QuicSocketState &other)
       other.m_kLossReductionFactor),
     m_endOfRecovery (
       other.m_endOfRecovery),
-    m_kMaxTLPs (other.m_kMaxTLPs),
     m_kReorderingThreshold (
       other.m_kReorderingThreshold),
     m_kTimeReorderingFraction (
       other.m_kTimeReorderingFraction),
     m_kUsingTimeLossDetection (
       other.m_kUsingTimeLossDetection),
-    m_kMinTLPTimeout (
-      other.m_kMinTLPTimeout),
-    m_kMinRTOTimeout (other.m_kMinRTOTimeout),
+    m_kGranularity (
+      other.m_kGranularity),
+    m_kPersistentCongestionThreshold (other.m_kPersistentCongestionThreshold),
     m_kDelayedAckTimeout (
       other.m_kDelayedAckTimeout),
     m_kDefaultInitialRtt (
       other.m_kDefaultInitialRtt),
-    m_kMaxPacketsReceivedBeforeAckSend (other.m_kMaxPacketsReceivedBeforeAckSend)
+    m_kMaxPacketsReceivedBeforeAckSend (other.m_kMaxPacketsReceivedBeforeAckSend),
+    m_nextTxPacketNumber (other.m_nextTxPacketNumber),
+    m_highTxPacketNumber (other.m_highTxPacketNumber)
+{
+}
+
+Time
+QuicSocketState::GetMaxAckDelay () const
 {
-  m_lossDetectionAlarm.Cancel ();
+  return m_maxAckDelay.IsZero () ? m_kDelayedAckTimeout : m_maxAckDelay;
+}
+
+Time
+QuicSocketState::GetProbeTimeout () const
+{
+  Time smoothedRtt = m_smoothedRtt;
+  Time rttVar = m_rttVar;
+  if (m_firstRttSample.IsZero ())
+    {
+      smoothedRtt = m_kDefaultInitialRtt;
+      rttVar = m_kDefaultInitialRtt / 2;
+    }
+  return smoothedRtt + std::max (4 * rttVar, m_kGranularity) + GetMaxAckDelay ();
+}
+
+Time
+QuicSocketState::GetLossDelay () const
+{
+  Time rtt = std::max (m_smoothedRtt, m_lastRtt.Get ());
+  if (rtt.IsZero ())
+    {
+      rtt = m_kDefaultInitialRtt;
+    }
+  return std::max (rtt * int64x64_t (m_kTimeReorderingFraction), m_kGranularity);
 }
 
 QuicSocketBase::QuicSocketBase (void)
@@ -457,6 +536,11 @@ QuicSocketBase::QuicSocketBase (void)
     m_initial_max_stream_data (
       0),
     m_max_data (0),
+    m_advertisedMaxStreamData (0),
+    m_flowControlUpdateThreshold (0.5),
+    m_maxReceiveWindow (24 * 1024 * 1024),
+    m_maxStreamReceiveWindow (16 * 1024 * 1024),
+    m_reservedReceiveWindow (0),
     m_initial_max_stream_id_bidi (0),
     m_idleTimeout (
       Seconds (300.0)),
@@ -475,18 +559,39 @@ QuicSocketBase::QuicSocketBase (void)
       0),
     m_lastRtt (Seconds(0.0)),
     m_queue_ack (false),
-    m_numPacketsReceivedSinceLastAckSent (0)
+    m_numPacketsReceivedSinceLastAckSent (0),
+    m_minAckDelay (MilliSeconds (1)),
+    m_maxAckElicitingThreshold (10),
+    m_ackElicitingThreshold (2),
+    m_ackReorderingThreshold (1),
+    m_ackDelayTimeout (Seconds (0)),
+    m_nextRxAckFrequencySequence (0),
+    m_immediateAckRequested (false),
+    m_largestReportedAck (0),
+    m_peerMinAckDelay (Seconds (0)),
+    m_nextTxAckFrequencySequence (0),
+    m_requestedAckElicitingThreshold (0),
+    m_requestedMaxAckDelay (Seconds (0)),
+    m_ackFrequencyPending (false),
+    m_ackFrequencyPacket (0),
+    m_immediateAckPending (false),
+    m_pacingGain (1.25),
+    m_pacingBurst (2),
+    m_tracedPacingRate (0),
+    m_nextPacingTime (Seconds (0)),
+    m_streamSchedulerTypeId (QuicStreamRoundRobinScheduler::GetTypeId ())
 {
   NS_LOG_FUNCTION (this);
 
   m_rxBuffer = CreateObject<QuicSocketRxBuffer> ();
   m_txBuffer = CreateObject<QuicSocketTxBuffer> ();
-  m_receivedPacketNumbers = std::vector<SequenceNumber32> ();
+  m_receivedPacketNumbers.Clear ();
+  m_sentAckFrames.clear ();
+  CreateTimers ();
 
   m_tcb = CreateObject<QuicSocketState> ();
   m_tcb->m_cWnd = m_tcb->m_initialCWnd;
   m_tcb->m_ssThresh = m_tcb->m_initialSsThresh;
-  m_quicCongestionControlLegacy = false;
   /**
    * [IETF DRAFT 10 - Quic Transport: sec 5.7.1]
    *
@@ -495,13 +600,10 @@ QuicSocketBase::QuicSocketBase (void)
    * However, in this implementation, we set the sequence number to 0
    *
    */
-  if (!m_quicCongestionControlLegacy)
-    {
-      Ptr<UniformRandomVariable> rand =
-        CreateObject<UniformRandomVariable> ();
-      m_tcb->m_nextTxSequence = SequenceNumber32 (0);
-      // (uint32_t) rand->GetValue (0, pow (2, 32) - 1025));
-    }
+  Ptr<UniformRandomVariable> rand =
+    CreateObject<UniformRandomVariable> ();
+  m_tcb->m_nextTxPacketNumber = SequenceNumber64 (0);
+  // (uint32_t) rand->GetValue (0, pow (2, 32) - 1025));
 
   // connect callbacks
   bool ok;
@@ -517,11 +619,11 @@ QuicSocketBase::QuicSocketBase (void)
                                           MakeCallback (&QuicSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
 
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
+  ok = m_tcb->TraceConnectWithoutContext ("NextTxPacketNumber",
                                           MakeCallback (&QuicSocketBase::UpdateNextTxSequence, this));
   NS_ASSERT (ok == true);
 
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
+  ok = m_tcb->TraceConnectWithoutContext ("HighestTxPacketNumber",
                                           MakeCallback (&QuicSocketBase::UpdateHighTxMark, this));
 }
 
@@ -543,6 +645,12 @@ QuicSocketBase::QuicSocketBase (const QuicSocketBase& sock)   // Copy constructo
     m_lastReceived(sock.m_lastReceived),
     m_initial_max_stream_data (sock.m_initial_max_stream_data),
     m_max_data (sock.m_max_data),
+    m_advertisedMaxStreamData (sock.m_advertisedMaxStreamData),
+    m_connectionFlowControl (sock.m_connectionFlowControl),
+    m_flowControlUpdateThreshold (sock.m_flowControlUpdateThreshold),
+    m_maxReceiveWindow (sock.m_maxReceiveWindow),
+    m_maxStreamReceiveWindow (sock.m_maxStreamReceiveWindow),
+    m_reservedReceiveWindow (0),
     m_initial_max_stream_id_bidi (sock.m_initial_max_stream_id_bidi),
     m_idleTimeout (sock.m_idleTimeout),
     m_omit_connection_id (sock.m_omit_connection_id),
@@ -554,11 +662,32 @@ QuicSocketBase::QuicSocketBase (const QuicSocketBase& sock)   // Copy constructo
     m_rto (sock.m_rto),
     m_drainingPeriodTimeout (sock.m_drainingPeriodTimeout),
     m_lastRtt (sock.m_lastRtt),
-    m_quicCongestionControlLegacy (sock.m_quicCongestionControlLegacy),
     m_queue_ack (sock.m_queue_ack),
     m_numPacketsReceivedSinceLastAckSent (sock.m_numPacketsReceivedSinceLastAckSent),
+    m_minAckDelay (sock.m_minAckDelay),
+    m_maxAckElicitingThreshold (sock.m_maxAckElicitingThreshold),
+    m_ackElicitingThreshold (sock.m_ackElicitingThreshold),
+    m_ackReorderingThreshold (sock.m_ackReorderingThreshold),
+    m_ackDelayTimeout (Seconds (0)),
+    m_nextRxAckFrequencySequence (0),
+    m_immediateAckRequested (false),
+    m_largestReportedAck (0),
+    m_peerMinAckDelay (Seconds (0)),
+    m_nextTxAckFrequencySequence (0),
+    m_requestedAckElicitingThreshold (0),
+    m_requestedMaxAckDelay (Seconds (0)),
+    m_ackFrequencyPending (false),
+    m_ackFrequencyPacket (0),
+    m_immediateAckPending (false),
+    m_pacingGain (sock.m_pacingGain),
+    m_pacingBurst (sock.m_pacingBurst),
+    m_tracedPacingRate (sock.m_tracedPacingRate),
+    m_nextPacingTime (Seconds (0)),
+    m_streamSchedulerTypeId (sock.m_streamSchedulerTypeId),
+    m_initialPacketSize (sock.m_initialPacketSize),
     m_txTrace (sock.m_txTrace),
-    m_rxTrace (sock.m_rxTrace)
+    m_rxTrace (sock.m_rxTrace),
+    m_deliveryRateTrace (sock.m_deliveryRateTrace)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC (this << " invoked the copy constructor");
@@ -572,14 +701,15 @@ QuicSocketBase::QuicSocketBase (const QuicSocketBase& sock)   // Copy constructo
 //  SetRecvCallback (vPS);
   m_txBuffer = CopyObject (sock.m_txBuffer);
   m_rxBuffer = CopyObject (sock.m_rxBuffer);
-  m_receivedPacketNumbers = std::vector<SequenceNumber32> ();
+  m_receivedPacketNumbers.Clear ();
+  m_sentAckFrames.clear ();
+  CreateTimers ();
 
   m_tcb = CopyObject (sock.m_tcb);
   if (sock.m_congestionControl)
     {
-      m_congestionControl = sock.m_congestionControl->Fork ();
+      m_congestionControl = DynamicCast<QuicCongestionOps> (sock.m_congestionControl->Fork ());
     }
-  m_quicCongestionControlLegacy = sock.m_quicCongestionControlLegacy;
 
   /**
    * [IETF DRAFT 10 - Quic Transport: sec 5.7.1]
@@ -588,13 +718,10 @@ QuicSocketBase::QuicSocketBase (const QuicSocketBase& sock)   // Copy constructo
    * 0 and 2^32 -1025 (inclusive).
    *
    */
-  if (!m_quicCongestionControlLegacy)
-    {
-      Ptr<UniformRandomVariable> rand =
-        CreateObject<UniformRandomVariable> ();
-      m_tcb->m_nextTxSequence = SequenceNumber32 (0);
-      // (uint32_t) rand->GetValue (0, pow (2, 32) - 1025));
-    }
+  Ptr<UniformRandomVariable> rand =
+    CreateObject<UniformRandomVariable> ();
+  m_tcb->m_nextTxPacketNumber = SequenceNumber64 (0);
+  // (uint32_t) rand->GetValue (0, pow (2, 32) - 1025));
 }
 
 QuicSocketBase::~QuicSocketBase (void)
@@ -617,7 +744,34 @@ QuicSocketBase::~QuicSocketBase (void)
       NS_ASSERT (m_endPoint6 == nullptr);
     }
   m_quicl4 = 0;
-  //CancelAllTimers ();
+  // the timer handlers hold a raw pointer to the socket
+  if (m_timers != 0)
+    {
+      m_timers->Dispose ();
+    }
+}
+
+void
+QuicSocketBase::CreateTimers ()
+{
+  m_timers = CreateObject<QuicTimerMultiplexer> ();
+  // the timers are added in the order of QuicTimer_t
+  uint32_t timer;
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::SendPendingDataTimeout, this));
+  NS_ASSERT (timer == SEND_PENDING_TIMER);
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::IdleTimeout, this));
+  NS_ASSERT (timer == IDLE_TIMER);
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::DrainingPeriodTimeout, this));
+  NS_ASSERT (timer == DRAINING_TIMER);
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::SendAck, this));
+  NS_ASSERT (timer == SEND_ACK_TIMER);
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::SendAck, this));
+  NS_ASSERT (timer == DELAYED_ACK_TIMER);
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::ReTxTimeout, this));
+  NS_ASSERT (timer == LOSS_DETECTION_TIMER);
+  timer = m_timers->AddTimer (MakeCallback (&QuicSocketBase::NotifyPacingPerformed, this));
+  NS_ASSERT (timer == PACING_TIMER);
+  NS_UNUSED (timer);
 }
 
 /* Inherit from Socket class: Bind socket to an end-point in QuicL4Protocol */
@@ -829,11 +983,7 @@ QuicSocketBase::Connect (const Address & address)
     }
 
   // check if the address is in a list of known and authenticated addresses
-  auto result = std::find (
-      m_quicl4->GetAuthAddresses ().begin (), m_quicl4->GetAuthAddresses ().end (),
-      InetSocketAddress::ConvertFrom (address).GetIpv4 ());
-
-  if (result != m_quicl4->GetAuthAddresses ().end ()
+  if (m_quicl4->IsAuthenticated (InetSocketAddress::ConvertFrom (address).GetIpv4 ())
       || m_quicl4->Is0RTTHandshakeAllowed ())
     {
       NS_LOG_INFO (
@@ -903,15 +1053,7 @@ QuicSocketBase::AppendingTx (Ptr<Packet> frame)
         }
 
 
-      if (m_socketState != IDLE)
-        {
-          if (!m_sendPendingDataEvent.IsRunning ())
-            {
-              m_sendPendingDataEvent = Simulator::Schedule (
-                  TimeStep (1), &QuicSocketBase::SendPendingData, this,
-                  m_connected);
-            }
-        }
+      ScheduleSendPendingData ();
       if (done)
         {
           return frame->GetSize ();
@@ -926,25 +1068,129 @@ QuicSocketBase::AppendingTx (Ptr<Packet> frame)
     }
 }
 
+void
+QuicSocketBase::ScheduleSendPendingData ()
+{
+  NS_LOG_FUNCTION (this);
+
+  // a paced socket sends the new data in its next transmission slot
+  if (m_socketState != IDLE and !m_timers->IsRunning (SEND_PENDING_TIMER)
+      and !m_timers->IsRunning (PACING_TIMER))
+    {
+      m_timers->Schedule (SEND_PENDING_TIMER, TimeStep (1));
+    }
+}
+
+void
+QuicSocketBase::SendPendingDataTimeout ()
+{
+  NS_LOG_FUNCTION (this);
+  SendPendingData (m_connected);
+}
+
+void
+QuicSocketBase::PullStreamFrames ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_txBuffer->AppSize () < GetSegSize ())
+    {
+      uint32_t room = GetSegSize () - m_txBuffer->AppSize ();
+      uint32_t credit = ConnectionWindow ();
+      m_quicl5->PullFrames (room, credit);
+
+      // the connection limit of the peer keeps data in the streams
+      if (credit < room and m_quicl5->HasSendableData ()
+          and m_connectionFlowControl.OnBlocked (m_max_data))
+        {
+          NS_LOG_INFO ("Send BLOCKED at " << m_max_data);
+          QuicSubheader sub = QuicSubheader::CreateBlocked (m_max_data);
+          Ptr<Packet> frame = Create<Packet> ();
+          frame->AddHeader (sub);
+          AppendingTx (frame);
+        }
+    }
+}
+
+void
+QuicSocketBase::MaybeSendMaxData ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_connectionFlowControl.IsUpdateDue () or m_socketState != OPEN)
+    {
+      return;
+    }
+
+  // the socket buffer holds the data that the application has not read yet
+  uint64_t window = AutoTuneReceiveWindow (m_connectionFlowControl);
+  if (window > GetSocketRcvBufSize ())
+    {
+      SetSocketRcvBufSize (window);
+    }
+
+  QuicSubheader sub = QuicSubheader::CreateMaxData (m_connectionFlowControl.Advertise ());
+  NS_LOG_INFO ("Send MAX_DATA " << sub.GetMaxData ());
+  Ptr<Packet> frame = Create<Packet> ();
+  frame->AddHeader (sub);
+  AppendingTx (frame);
+}
+
+void
+QuicSocketBase::SetStreamPriority (uint64_t streamId, uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << streamId << (uint32_t) priority);
+  NS_ABORT_MSG_IF (m_quicl5 == 0, "The streams are created when the socket connects");
+  Ptr<QuicStreamBase> stream = m_quicl5->GetOrCreateStream (streamId);
+  NS_ABORT_MSG_IF (stream == 0, "Stream " << streamId << " exceeds the maximum stream ID");
+  stream->SetPriority (priority);
+}
+
+void
+QuicSocketBase::SetStreamWeight (uint64_t streamId, uint32_t weight)
+{
+  NS_LOG_FUNCTION (this << streamId << weight);
+  NS_ABORT_MSG_IF (m_quicl5 == 0, "The streams are created when the socket connects");
+  Ptr<QuicStreamBase> stream = m_quicl5->GetOrCreateStream (streamId);
+  NS_ABORT_MSG_IF (stream == 0, "Stream " << streamId << " exceeds the maximum stream ID");
+  stream->SetWeight (weight);
+}
+
+void
+QuicSocketBase::SetStreamDeadline (uint64_t streamId, Time deadline)
+{
+  NS_LOG_FUNCTION (this << streamId << deadline);
+  NS_ABORT_MSG_IF (m_quicl5 == 0, "The streams are created when the socket connects");
+  Ptr<QuicStreamBase> stream = m_quicl5->GetOrCreateStream (streamId);
+  NS_ABORT_MSG_IF (stream == 0, "Stream " << streamId << " exceeds the maximum stream ID");
+  stream->SetDeadline (deadline);
+}
+
 uint32_t
 QuicSocketBase::SendPendingData (bool withAck)
 {
   NS_LOG_FUNCTION (this << withAck);
 
+  // the streams hand over the frames of the next packet only now
+  PullStreamFrames ();
+
   if (m_txBuffer->AppSize () == 0)
     {
       NS_LOG_INFO ("Nothing to send");
+      m_txBuffer->CheckAppLimited (m_tcb->m_cWnd);
       return false;
     }
 
   uint32_t nPacketsSent = 0;
 
+  ComputePacingRate ();
+
   // prioritize stream 0
   while (m_txBuffer->GetNumFrameStream0InBuffer () > 0)
     {
       NS_LOG_DEBUG ("Send a frame for stream 0");
-      SequenceNumber32 next = ++m_tcb->m_nextTxSequence;
-      NS_LOG_INFO ("SN " << m_tcb->m_nextTxSequence);
+      SequenceNumber64 next = ++m_tcb->m_nextTxPacketNumber;
+      NS_LOG_INFO ("SN " << m_tcb->m_nextTxPacketNumber);
 
       uint32_t win = AvailableWindow ();
       uint32_t connWin = ConnectionWindow ();
@@ -995,7 +1241,19 @@ QuicSocketBase::SendPendingData (bool withAck)
           break;
         }
 
-      SequenceNumber32 next = ++m_tcb->m_nextTxSequence;
+      // wait for the next transmission slot if the data is paced
+      bool paced = m_tcb->m_pacing && m_tcb->m_currentPacingRate.GetBitRate () > 0;
+      if (paced && m_nextPacingTime > Simulator::Now ())
+        {
+          NS_LOG_INFO ("Pacing, next packet at " << m_nextPacingTime.GetSeconds ());
+          if (!m_timers->IsRunning (PACING_TIMER))
+            {
+              m_timers->Schedule (PACING_TIMER, m_nextPacingTime - Simulator::Now ());
+            }
+          break;
+        }
+
+      SequenceNumber64 next = ++m_tcb->m_nextTxPacketNumber;
 
       uint32_t s = std::min (availableWindow, GetSegSize ());
 
@@ -1009,7 +1267,15 @@ QuicSocketBase::SendPendingData (bool withAck)
                                    << " BufferedSize " << m_txBuffer->AppSize ()
                                    << " MaxPacketSize " << GetSegSize ());
 
-      SendDataPacket (next, s, withAck);
+      uint32_t sz = SendDataPacket (next, s, withAck);
+
+      if (paced)
+        {
+          // after an idle period, up to m_pacingBurst packets can be sent back-to-back
+          DataRate rate = m_tcb->m_currentPacingRate;
+          Time earliest = Simulator::Now () - rate.CalculateBytesTxTime ((m_pacingBurst - 1) * GetSegSize ());
+          m_nextPacingTime = std::max (m_nextPacingTime, earliest) + rate.CalculateBytesTxTime (sz);
+        }
 
       win = AvailableWindow ();
       connWin = ConnectionWindow ();
@@ -1023,10 +1289,17 @@ QuicSocketBase::SendPendingData (bool withAck)
 
       ++nPacketsSent;
 
+      PullStreamFrames ();
       availableWindow = AvailableWindow ();
 
     }
 
+  if (m_txBuffer->AppSize () == 0)
+    {
+      // The window is not used up because the application has no data
+      m_txBuffer->CheckAppLimited (m_tcb->m_cWnd);
+    }
+
   if (nPacketsSent > 0)
     {
       NS_LOG_INFO ("SendPendingData sent " << nPacketsSent << " packets");
@@ -1059,14 +1332,14 @@ QuicSocketBase::GetSegSize (void) const
 }
 
 void
-QuicSocketBase::MaybeQueueAck ()
+QuicSocketBase::MaybeQueueAck (uint64_t packetNumber)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << packetNumber);
   ++m_numPacketsReceivedSinceLastAckSent;
   NS_LOG_INFO ("m_numPacketsReceivedSinceLastAckSent " << m_numPacketsReceivedSinceLastAckSent << " m_queue_ack " << m_queue_ack);
 
   // handle the list of m_receivedPacketNumbers
-  if (m_receivedPacketNumbers.empty ())
+  if (m_receivedPacketNumbers.IsEmpty ())
     {
       NS_LOG_INFO ("Nothing to ACK");
       m_queue_ack = false;
@@ -1083,54 +1356,70 @@ QuicSocketBase::MaybeQueueAck ()
     {
       NS_LOG_INFO ("immediately send ACK - max number of unacked packets reached");
       m_queue_ack = true;
-      if (!m_sendAckEvent.IsRunning ())
-        {
-          m_sendAckEvent = Simulator::Schedule (TimeStep (1), &QuicSocketBase::SendAck, this);
-        }
     }
 
-  if (HasReceivedMissing ())  // immediately queue the ACK
+  if (m_immediateAckRequested)
+    {
+      NS_LOG_INFO ("immediately send ACK - requested by the peer");
+      m_immediateAckRequested = false;
+      m_queue_ack = true;
+    }
+
+  if (HasReceivedMissing (packetNumber))
     {
       NS_LOG_INFO ("immediately send ACK - some packets have been received out of order");
       m_queue_ack = true;
-      if (!m_sendAckEvent.IsRunning ())
-        {
-          m_sendAckEvent = Simulator::Schedule (TimeStep (1), &QuicSocketBase::SendAck, this);
-        }
     }
 
-  if (!m_queue_ack)
+  if (m_numPacketsReceivedSinceLastAckSent > m_ackElicitingThreshold)
     {
-      if (m_numPacketsReceivedSinceLastAckSent > 2) // QUIC decimation option
-        {
-          NS_LOG_INFO ("immediately send ACK - more than 2 packets received");
-          m_queue_ack = true;
-          if (!m_sendAckEvent.IsRunning ())
-            {
-              m_sendAckEvent = Simulator::Schedule (TimeStep (1), &QuicSocketBase::SendAck, this);
-            }
-        }
-      else
+      NS_LOG_INFO ("immediately send ACK - more than " << m_ackElicitingThreshold << " packets received");
+      m_queue_ack = true;
+    }
+
+  if (m_queue_ack)
+    {
+      if (!m_timers->IsRunning (SEND_ACK_TIMER))
         {
-          if (!m_delAckEvent.IsRunning ())
-            {
-              NS_LOG_INFO ("Schedule a delayed ACK");
-              // schedule a delayed ACK
-              m_delAckEvent = Simulator::Schedule (
-                  m_tcb->m_kDelayedAckTimeout, &QuicSocketBase::SendAck, this);
-            }
-          else
-            {
-              NS_LOG_INFO ("Delayed ACK timer already running");
-            }
+          m_timers->Schedule (SEND_ACK_TIMER, TimeStep (1));
         }
     }
+  else if (!m_timers->IsRunning (DELAYED_ACK_TIMER))
+    {
+      NS_LOG_INFO ("Schedule a delayed ACK");
+      Time ackDelay = m_ackDelayTimeout.IsZero () ? m_tcb->m_kDelayedAckTimeout : m_ackDelayTimeout;
+      m_timers->Schedule (DELAYED_ACK_TIMER, ackDelay);
+    }
+  else
+    {
+      NS_LOG_INFO ("Delayed ACK timer already running");
+    }
 }
 
 bool
-QuicSocketBase::HasReceivedMissing ()
+QuicSocketBase::HasReceivedMissing (uint64_t packetNumber)
 {
-  // TODO implement this
+  NS_LOG_FUNCTION (this << packetNumber);
+
+  if (m_ackReorderingThreshold == 0)
+    {
+      return false;
+    }
+
+  uint64_t largest = m_receivedPacketNumbers.GetLargest ();
+  if (m_ackReorderingThreshold == 1 and packetNumber < largest)
+    {
+      NS_LOG_LOGIC ("Packet " << packetNumber << " received out of order");
+      return true;
+    }
+
+  // the holes below the largest acknowledged of the last ACK frame are already reported
+  uint64_t missing = m_receivedPacketNumbers.GetSmallestMissingAbove (m_largestReportedAck);
+  if (missing < largest and largest - missing >= m_ackReorderingThreshold)
+    {
+      NS_LOG_LOGIC ("Packet " << missing << " missing, largest received " << largest);
+      return true;
+    }
   return false;
 }
 
@@ -1138,15 +1427,15 @@ void
 QuicSocketBase::SendAck ()
 {
   NS_LOG_FUNCTION (this);
-  m_delAckEvent.Cancel ();
-  m_sendAckEvent.Cancel ();
+  m_timers->Cancel (SEND_ACK_TIMER);
+  m_timers->Cancel (DELAYED_ACK_TIMER);
   m_queue_ack = false;
 
   m_numPacketsReceivedSinceLastAckSent = 0;
 
   Ptr<Packet> p = Create<Packet> ();
   p->AddAtEnd (OnSendingAckFrame ());
-  SequenceNumber32 packetNumber = ++m_tcb->m_nextTxSequence;
+  SequenceNumber64 packetNumber = ++m_tcb->m_nextTxPacketNumber;
 
   QuicHeader head;
 
@@ -1197,19 +1486,38 @@ QuicSocketBase::SendAck ()
   m_txTrace (p, head, this);
 }
 
+void
+QuicSocketBase::RefreshIdleTimeout ()
+{
+  m_timers->Schedule (IDLE_TIMER, m_idleTimeout.Get ());
+}
+
+void
+QuicSocketBase::IdleTimeout ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO (this << " Idle timeout expired at time " << Simulator::Now ().GetSeconds ());
+  Close ();
+}
+
+void
+QuicSocketBase::DrainingPeriodTimeout ()
+{
+  NS_LOG_FUNCTION (this);
+  DoClose ();
+}
+
 uint32_t
-QuicSocketBase::SendDataPacket (SequenceNumber32 packetNumber,
+QuicSocketBase::SendDataPacket (SequenceNumber64 packetNumber,
                                 uint32_t maxSize, bool withAck)
 {
   NS_LOG_FUNCTION (this << packetNumber << maxSize << withAck);
 
-  if (!m_drainingPeriodEvent.IsRunning ())
+  if (!m_timers->IsRunning (DRAINING_TIMER))
     {
-      m_idleTimeoutEvent.Cancel ();
       NS_LOG_LOGIC (
         this << " SendDataPacket Schedule Close at time " << Simulator::Now ().GetSeconds () << " to expire at time " << (Simulator::Now () + m_idleTimeout.Get ()).GetSeconds ());
-      m_idleTimeoutEvent = Simulator::Schedule (m_idleTimeout,
-                                                &QuicSocketBase::Close, this);
+      RefreshIdleTimeout ();
     }
   else
     {
@@ -1227,8 +1535,6 @@ QuicSocketBase::SendDataPacket (SequenceNumber32 packetNumber,
     {
       NS_LOG_LOGIC (
         this << " SendDataPacket - sending packet " << packetNumber.GetValue () << " of size " << maxSize << " at time " << Simulator::Now ().GetSeconds ());
-      m_idleTimeoutEvent = Simulator::Schedule (m_idleTimeout,
-                                                &QuicSocketBase::Close, this);
       p = m_txBuffer->NextSequence (maxSize, packetNumber);
     }
 
@@ -1236,9 +1542,43 @@ QuicSocketBase::SendDataPacket (SequenceNumber32 packetNumber,
 
   bool isAckOnly = ((sz == 0) & (withAck));
 
-  if (withAck && !m_receivedPacketNumbers.empty ())
+  if (withAck && !m_receivedPacketNumbers.IsEmpty ())
     {
       p->AddAtEnd (OnSendingAckFrame ());
+      // remember which ACK frame this packet carries, to prune the
+      // tracked ranges once the peer acknowledges it; the packets
+      // carrying only ACK frames are never acknowledged
+      if (!isAckOnly)
+        {
+          m_sentAckFrames[packetNumber] = m_receivedPacketNumbers.GetLargest ();
+        }
+    }
+
+  // the ACK frequency frames travel with data, to be acknowledged
+  if (sz > 0 and m_socketState == OPEN
+      and !m_minAckDelay.IsZero () and !m_peerMinAckDelay.IsZero ())
+    {
+      if (m_ackFrequencyPending)
+        {
+          QuicSubheader sub = QuicSubheader::CreateAckFrequency (
+              m_nextTxAckFrequencySequence++, m_requestedAckElicitingThreshold,
+              m_requestedMaxAckDelay.GetMicroSeconds (),
+              std::max<uint32_t> (m_tcb->m_kReorderingThreshold, 2) - 1);
+          Ptr<Packet> frame = Create<Packet> ();
+          frame->AddHeader (sub);
+          p->AddAtEnd (frame);
+          m_ackFrequencyPending = false;
+          m_ackFrequencyPacket = packetNumber;
+          // until the frame is acknowledged the peer may use either delay
+          m_tcb->m_maxAckDelay = std::max (m_tcb->m_maxAckDelay, m_requestedMaxAckDelay);
+        }
+      if (m_immediateAckPending)
+        {
+          Ptr<Packet> frame = Create<Packet> ();
+          frame->AddHeader (QuicSubheader::CreateImmediateAck ());
+          p->AddAtEnd (frame);
+          m_immediateAckPending = false;
+        }
     }
 
 
@@ -1289,11 +1629,8 @@ QuicSocketBase::SendDataPacket (SequenceNumber32 packetNumber,
   m_txTrace (p, head, this);
   NotifyDataSent (sz);
 
-  if (!m_quicCongestionControlLegacy)
-    {
-      DynamicCast<QuicCongestionOps> (m_congestionControl)->OnPacketSent (
-        m_tcb, packetNumber, isAckOnly);
-    }
+  m_tcb->m_bytesInFlight = BytesInFlight ();
+  m_congestionControl->OnPacketSent (*m_tcb, packetNumber, isAckOnly);
   if (!isAckOnly)
     {
       SetReTxTimeout ();
@@ -1304,81 +1641,59 @@ QuicSocketBase::SendDataPacket (SequenceNumber32 packetNumber,
 void
 QuicSocketBase::SetReTxTimeout ()
 {
-  //TODO check for special packets
   NS_LOG_FUNCTION (this);
 
-  // Don't arm the alarm if there are no packets with retransmittable data in flight.
-  //if (numRetransmittablePacketsOutstanding == 0)
-  if (false)
+  // Don't arm the alarm if there are no packets with stream data in flight.
+  if (m_socketState == OPEN && BytesInFlight () == 0)
     {
-      m_tcb->m_lossDetectionAlarm.Cancel ();
+      m_timers->Cancel (LOSS_DETECTION_TIMER);
       return;
     }
   
-  if (m_tcb->m_kUsingTimeLossDetection)
-    {
-      m_tcb->m_lossTime = Simulator::Now() + m_tcb->m_kTimeReorderingFraction * m_tcb->m_smoothedRtt;
-    }
-
   Time alarmDuration;
   // Handshake packets are outstanding
   if (m_socketState == CONNECTING_CLT || m_socketState == CONNECTING_SVR)
     {
       NS_LOG_INFO ("Connecting, set alarm");
       // Handshake retransmission alarm.
-      if (m_tcb->m_smoothedRtt == 0)
-        {
-          alarmDuration = 2 * m_tcb->m_kDefaultInitialRtt;
-        }
-      else
-        {
-          alarmDuration = 2 * m_tcb->m_smoothedRtt;
-        }
-      alarmDuration = std::max (alarmDuration + m_tcb->m_maxAckDelay,
-                                m_tcb->m_kMinTLPTimeout);
-      alarmDuration = alarmDuration * (2 ^ m_tcb->m_handshakeCount);
+      alarmDuration = m_tcb->GetProbeTimeout () * GetProbeTimeoutBackoff ();
       m_tcb->m_alarmType = 0;
     }
-  else if (m_tcb->m_lossTime != 0)
+  else if (!m_tcb->m_lossTime.IsZero ())
     {
-      NS_LOG_INFO ("Early retransmit timer");
-      // Early retransmit timer or time loss detection.
-      alarmDuration = m_tcb->m_lossTime - m_tcb->m_timeOfLastSentPacket;
+      NS_LOG_INFO ("Loss detection timer");
+      // Time threshold loss detection - RFC 9002, Sec. 6.1.2
+      alarmDuration = std::max (m_tcb->m_lossTime - Simulator::Now (), Seconds (0));
       m_tcb->m_alarmType = 1;
     }
-  else if (m_tcb->m_tlpCount < m_tcb->m_kMaxTLPs)
-    {
-      NS_LOG_LOGIC ("m_tcb->m_tlpCount < m_tcb->m_kMaxTLPs");
-      // Tail Loss Probe
-      alarmDuration = std::max (
-          (3 / 2) * m_tcb->m_smoothedRtt + m_tcb->m_maxAckDelay,
-          m_tcb->m_kMinTLPTimeout);
-      m_tcb->m_alarmType = 2;
-    }
   else
     {
-      NS_LOG_LOGIC ("RTO");
-      alarmDuration = m_tcb->m_smoothedRtt + 4 * m_tcb->m_rttVar
-        + m_tcb->m_maxAckDelay;
-      alarmDuration = std::max (alarmDuration, m_tcb->m_kMinRTOTimeout);
-      alarmDuration = alarmDuration * (2 ^ m_tcb->m_rtoCount);
-      m_tcb->m_alarmType = 3;
+      NS_LOG_LOGIC ("PTO");
+      // Probe timeout, from the last ack-eliciting packet - RFC 9002, Sec. 6.2.1
+      alarmDuration = m_tcb->m_timeOfLastSentPacket
+        + m_tcb->GetProbeTimeout () * GetProbeTimeoutBackoff () - Simulator::Now ();
+      alarmDuration = std::max (alarmDuration, Seconds (0));
+      m_tcb->m_alarmType = 2;
     }
   NS_LOG_INFO ("Schedule ReTxTimeout at time " << Simulator::Now ().GetSeconds () << " to expire at time " << (Simulator::Now () + alarmDuration).GetSeconds ());
   NS_LOG_INFO ("Alarm after " << alarmDuration.GetSeconds () << " seconds");
-  m_tcb->m_lossDetectionAlarm = Simulator::Schedule (alarmDuration,
-                                                     &QuicSocketBase::ReTxTimeout, this);
   m_tcb->m_nextAlarmTrigger = Simulator::Now () + alarmDuration;
+  m_timers->Schedule (LOSS_DETECTION_TIMER, alarmDuration);
 }
 
 void
-QuicSocketBase::DoRetransmit (std::vector<QuicSocketTxItem*> lostPackets)
+QuicSocketBase::DoRetransmit ()
 {
   NS_LOG_FUNCTION (this);
-  // Get packets to retransmit
-  SequenceNumber32 next = ++m_tcb->m_nextTxSequence;
-  uint32_t toRetx = m_txBuffer->Retransmission (next);
-  NS_LOG_DEBUG ("Send the retransmitted frame");
+  // The streams retransmit their lost data in the next packets, together
+  // with new data; only the control frames are queued again as they were
+  std::vector<QuicStreamFrameRange> lostFrames;
+  uint32_t toRetx = m_txBuffer->Retransmission (lostFrames);
+  for (auto it = lostFrames.begin (); it != lostFrames.end (); ++it)
+    {
+      m_quicl5->OnStreamFrameLost (*it);
+    }
+  NS_LOG_DEBUG ("Send the retransmitted frames, " << toRetx << " bytes of control frames");
   uint32_t win = AvailableWindow ();
   uint32_t connWin = ConnectionWindow ();
   uint32_t bytesInFlight = BytesInFlight ();
@@ -1390,18 +1705,12 @@ QuicSocketBase::DoRetransmit (std::vector<QuicSocketTxItem*> lostPackets)
                                << " MaxPacketSize " << GetSegSize ());
 
   // Send the retransmitted data
-  NS_LOG_INFO ("Retransmitted packet, next sequence number " << m_tcb->m_nextTxSequence);
-  SendDataPacket (next, toRetx, m_connected);
+  SendPendingData (m_connected);
 }
 
 void
 QuicSocketBase::ReTxTimeout ()
 {
-  if (Simulator::Now () < m_tcb->m_nextAlarmTrigger)
-    {
-      NS_LOG_INFO ("Canceled alarm");
-      return;
-    }
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO ("ReTxTimeout Expired at time " << Simulator::Now ().GetSeconds ());
   // Handshake packets are outstanding)
@@ -1410,72 +1719,71 @@ QuicSocketBase::ReTxTimeout ()
       // Handshake retransmission alarm.
       //TODO retransmit handshake packets
       //RetransmitAllHandshakePackets();
-      m_tcb->m_handshakeCount++;
+      m_tcb->m_ptoCount++;
     }
-  else if (m_tcb->m_alarmType == 1 && m_tcb->m_lossTime != 0)
+  else if (m_tcb->m_alarmType == 1 && !m_tcb->m_lossTime.IsZero ())
     {
-      std::vector<QuicSocketTxItem*> lostPackets = m_txBuffer->DetectLostPackets ();
-      NS_LOG_INFO ("RTO triggered: early retransmit");
-      // Early retransmit or Time Loss Detection.
-      if (m_quicCongestionControlLegacy)
+      // Time threshold loss detection - RFC 9002, Sec. 6.1.2
+      NS_LOG_INFO ("Loss detection timer triggered");
+      m_lostPackets.clear ();
+      m_txBuffer->MarkLostPackets (*m_tcb, m_lostPackets);
+      if (!m_lostPackets.empty ())
         {
-          // TCP early retransmit logic [RFC 5827]: enter recovery (RFC 6675, Sec. 5)
-          if (m_tcb->m_congState != TcpSocketState::CA_RECOVERY)
+          m_tcb->m_bytesInFlight = BytesInFlight ();
+          m_congestionControl->OnPacketsLost (*m_tcb, m_lostPackets, m_txBuffer->GetRateSample ());
+        }
+      // Retransmit all lost packets immediately
+      DoRetransmit ();
+      SetReTxTimeout ();
+    }
+  else if (m_tcb->m_alarmType == 2)
+    {
+      // Probe timeout. Send up to two ack-eliciting packets with new data or,
+      // if there is none, with the data of the oldest packet in flight - RFC 9002, Sec. 6.2.4
+      NS_LOG_INFO ("PTO triggered");
+      PullStreamFrames ();
+      if (m_txBuffer->AppSize () == 0 && m_txBuffer->MarkOldestAsLost ())
+        {
+          // the packet is not declared lost to the congestion control
+          std::vector<QuicStreamFrameRange> lostFrames;
+          m_txBuffer->Retransmission (lostFrames);
+          for (auto it = lostFrames.begin (); it != lostFrames.end (); ++it)
             {
-              m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
-              m_tcb->m_cWnd = m_tcb->m_ssThresh;
-              m_tcb->m_endOfRecovery = m_tcb->m_highTxMark;
-              m_congestionControl->CongestionStateSet (
-                m_tcb, TcpSocketState::CA_RECOVERY);
-              m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (
-                  m_tcb, BytesInFlight ());
+              m_quicl5->OnStreamFrameLost (*it);
             }
+          PullStreamFrames ();
         }
-      else
+      if (m_txBuffer->AppSize () == 0)
         {
-          Ptr<QuicCongestionOps> cc = dynamic_cast<QuicCongestionOps*> (&(*m_congestionControl));
-          cc->OnPacketsLost (m_tcb, lostPackets);
+          NS_LOG_INFO ("No data to probe with");
+          return;
         }
-      // Retransmit all lost packets immediately
-      DoRetransmit (lostPackets);
-    }
-  else if (m_tcb->m_alarmType == 2 && m_tcb->m_tlpCount < m_tcb->m_kMaxTLPs)
-    {
-      // Tail Loss Probe. Send one new data packet, do not retransmit - IETF Draft QUIC Recovery, Sec. 4.3.2
-      SequenceNumber32 next = ++m_tcb->m_nextTxSequence;
-      NS_LOG_INFO ("TLP triggered");
-      uint32_t s = std::min (ConnectionWindow (), GetSegSize ());
-      SendDataPacket (next, s, m_connected);
-      m_tcb->m_tlpCount++;
-    }
-  else if (m_tcb->m_alarmType == 3)
-    {
-      // RTO.
-      if (m_tcb->m_rtoCount == 0)
+      m_tcb->m_ptoCount++;
+      // the probes are acknowledged without delay, and are not limited by the window
+      m_immediateAckPending = true;
+      for (uint32_t probe = 0; probe < 2 && m_txBuffer->AppSize () > 0; ++probe)
         {
-          m_tcb->m_largestSentBeforeRto = m_tcb->m_highTxMark;
+          SequenceNumber64 next = ++m_tcb->m_nextTxPacketNumber;
+          SendDataPacket (next, GetSegSize (), m_connected);
+          PullStreamFrames ();
         }
-      // RTO. Send two new data packets, do not retransmit - IETF Draft QUIC Recovery, Sec. 4.3.3
-      NS_LOG_INFO ("RTO triggered");
-      SequenceNumber32 next = ++m_tcb->m_nextTxSequence;
-      uint32_t s = std::min (AvailableWindow (), GetSegSize ());
-      SendDataPacket (next, s, m_connected);
-      next = ++m_tcb->m_nextTxSequence;
-
-      s = std::min (AvailableWindow (), GetSegSize ());
-      SendDataPacket (next, s, m_connected);
-
-      m_tcb->m_rtoCount++;
     }
 }
 
+uint32_t
+QuicSocketBase::GetProbeTimeoutBackoff () const
+{
+  // the shift is bounded, a connection this idle closes on the idle timeout anyway
+  return 1 << std::min<uint32_t> (m_tcb->m_ptoCount, 16);
+}
+
 uint32_t
 QuicSocketBase::AvailableWindow () const
 {
   NS_LOG_FUNCTION (this);
 
-  NS_LOG_DEBUG ("m_max_data " << m_max_data << " m_tcb->m_cWnd.Get () " << m_tcb->m_cWnd.Get ());
-  uint32_t win = std::min (m_max_data, m_tcb->m_cWnd.Get ());   // Number of bytes allowed to be outstanding
+  // the connection limit of the peer is applied when the stream frames are pulled
+  uint32_t win = m_tcb->m_cWnd.Get ();   // Number of bytes allowed to be outstanding
   uint32_t inflight = BytesInFlight ();   // Number of outstanding bytes
 
   if (inflight > win)
@@ -1496,12 +1804,14 @@ QuicSocketBase::ConnectionWindow () const
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t inFlight = BytesInFlight ();
+  uint64_t sent = (m_quicl5 != 0) ? m_quicl5->GetSentData () : 0;
 
   NS_LOG_INFO (
-    "Returning calculated Connection: MaxData " << m_max_data << " InFlight: " << inFlight);
+    "Returning calculated Connection: MaxData " << m_max_data << " Sent: " << sent);
 
-  return (inFlight > m_max_data) ? 0 : m_max_data - inFlight;
+  // the peer limit is an offset, limits beyond 32 bits saturate
+  return (sent > m_max_data) ? 0
+         : std::min<uint64_t> (m_max_data - sent, UINT32_MAX);
 }
 
 uint32_t
@@ -1538,6 +1848,11 @@ QuicSocketBase::Recv (uint32_t maxSize, uint32_t flags)
       return Create<Packet> ();
     }
   Ptr<Packet> outPacket = m_rxBuffer->Extract (maxSize);
+  if (outPacket != nullptr and outPacket->GetSize () > 0)
+    {
+      m_connectionFlowControl.AddConsumed (outPacket->GetSize ());
+      MaybeSendMaxData ();
+    }
   return outPacket;
 }
 
@@ -1552,6 +1867,9 @@ QuicSocketBase::RecvFrom (uint32_t maxSize, uint32_t flags,
 
   if (packet != nullptr && packet->GetSize () != 0)
     {
+      m_connectionFlowControl.AddConsumed (packet->GetSize ());
+      MaybeSendMaxData ();
+
       if (m_endPoint != nullptr)
         {          
           fromAddress = InetSocketAddress (m_endPoint->GetPeerAddress (), m_endPoint->GetPeerPort ());
@@ -1577,39 +1895,33 @@ QuicSocketBase::Close (void)
 
   m_receivedTransportParameters = false;
 
-  if (m_idleTimeoutEvent.IsRunning () and m_socketState != IDLE
+  if (m_timers->IsRunning (IDLE_TIMER) and m_socketState != IDLE
       and m_socketState != CLOSING)   //Connection Close from application signal
     {
       SetState (CLOSING);
-      m_drainingPeriodEvent.Cancel ();
-      m_idleTimeoutEvent.Cancel ();
+      m_timers->Cancel (IDLE_TIMER);
       NS_LOG_LOGIC (
         this << " Close Schedule DoClose at time " << Simulator::Now ().GetSeconds () << " to expire at time " << (Simulator::Now () + m_drainingPeriodTimeout.Get ()).GetSeconds ());
-      m_drainingPeriodEvent = Simulator::Schedule (m_drainingPeriodTimeout,
-                                                   &QuicSocketBase::DoClose,
-                                                   this);
+      m_timers->Schedule (DRAINING_TIMER, m_drainingPeriodTimeout);
       SendConnectionClosePacket (0, "Scheduled connection close - no error");
     }
-  else if (m_idleTimeoutEvent.IsExpired () and m_socketState != CLOSING
+  else if (!m_timers->IsRunning (IDLE_TIMER) and m_socketState != CLOSING
            and m_socketState != IDLE and m_socketState != LISTENING) //Connection Close due to Idle Period termination
     {
       SetState (CLOSING);
-      m_drainingPeriodEvent.Cancel ();
       NS_LOG_LOGIC (
         this << " Close Schedule DoClose at time " << Simulator::Now ().GetSeconds () << " to expire at time " << (Simulator::Now () + m_drainingPeriodTimeout.Get ()).GetSeconds ());
-      m_drainingPeriodEvent = Simulator::Schedule (m_drainingPeriodTimeout,
-                                                   &QuicSocketBase::DoClose,
-                                                   this);
+      m_timers->Schedule (DRAINING_TIMER, m_drainingPeriodTimeout);
     }
-  else if (m_idleTimeoutEvent.IsExpired ()
-           and m_drainingPeriodEvent.IsExpired () and m_socketState != CLOSING
+  else if (!m_timers->IsRunning (IDLE_TIMER)
+           and !m_timers->IsRunning (DRAINING_TIMER) and m_socketState != CLOSING
            and m_socketState != IDLE) //close last listening sockets
     {
       NS_LOG_LOGIC (this << " Closing listening socket");
       DoClose ();
     }
-  else if (m_idleTimeoutEvent.IsExpired ()
-           and m_drainingPeriodEvent.IsExpired () and m_socketState == IDLE)
+  else if (!m_timers->IsRunning (IDLE_TIMER)
+           and !m_timers->IsRunning (DRAINING_TIMER) and m_socketState == IDLE)
     {
       NS_LOG_LOGIC (this << " Has already been closed");
     }
@@ -1624,7 +1936,7 @@ QuicSocketBase::SendConnectionClosePacket (uint16_t errorCode, std::string phras
   NS_LOG_FUNCTION (this);
 
   Ptr<Packet> p = Create<Packet> ();
-  SequenceNumber32 packetNumber = ++m_tcb->m_nextTxSequence;
+  SequenceNumber64 packetNumber = ++m_tcb->m_nextTxPacketNumber;
 
   QuicSubheader qsb = QuicSubheader::CreateConnectionClose (errorCode, phrase.c_str ());
   p->AddHeader (qsb);
@@ -1783,7 +2095,12 @@ QuicSocketBase::SetConnectionId (uint64_t connectionId)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
+  uint64_t oldConnectionId = m_connectionId;
   m_connectionId = connectionId;
+  if (m_quicl4 != 0)
+    {
+      m_quicl4->UpdateConnectionId (this, oldConnectionId);
+    }
 }
 
 uint64_t
@@ -1830,6 +2147,10 @@ QuicSocketBase::CreateStreamController ()
   quicl5->SetNode (m_node);
   quicl5->SetConnectionId (m_connectionId);
 
+  ObjectFactory schedulerFactory;
+  schedulerFactory.SetTypeId (m_streamSchedulerTypeId);
+  quicl5->SetStreamScheduler (schedulerFactory.Create<QuicStreamScheduler> ());
+
   return quicl5;
 }
 
@@ -1996,8 +2317,9 @@ QuicSocketBase::OnReceivedFrame (QuicSubheader &sub)
       break;
 
     case QuicSubheader::BLOCKED:
-      // TODO
-      NS_LOG_INFO ("Received BLOCKED frame");
+      NS_LOG_INFO ("Received BLOCKED frame at " << sub.GetOffset ());
+      m_connectionFlowControl.OnPeerBlocked (sub.GetOffset ());
+      MaybeSendMaxData ();
       break;
 
     case QuicSubheader::STREAM_ID_BLOCKED:
@@ -2022,6 +2344,17 @@ QuicSocketBase::OnReceivedFrame (QuicSubheader &sub)
       NS_LOG_INFO ("Received PATH_RESPONSE frame");
       break;
 
+    case QuicSubheader::ACK_FREQUENCY:
+      NS_LOG_INFO ("Received ACK_FREQUENCY frame");
+      OnReceivedAckFrequencyFrame (sub);
+      break;
+
+    case QuicSubheader::IMMEDIATE_ACK:
+      // the ACK is sent by MaybeQueueAck once the whole packet is processed
+      NS_LOG_INFO ("Received IMMEDIATE_ACK frame");
+      m_immediateAckRequested = true;
+      break;
+
     default:
       AbortConnection (
         QuicSubheader::TransportErrorCodes_t::PROTOCOL_VIOLATION,
@@ -2036,60 +2369,77 @@ QuicSocketBase::OnSendingAckFrame ()
 {
   NS_LOG_FUNCTION (this);
 
-  NS_ABORT_MSG_IF (m_receivedPacketNumbers.empty (),
+  NS_ABORT_MSG_IF (m_receivedPacketNumbers.IsEmpty (),
                    " Sending Ack Frame without packets to acknowledge");
 
-//m_delAckEvent.Cancel();
-//m_delAckCount = 0;
-
   NS_LOG_INFO ("Attach an ACK frame to the packet");
 
-  std::sort (m_receivedPacketNumbers.begin (), m_receivedPacketNumbers.end (),
-             std::greater<SequenceNumber32> ());
+  SequenceNumber64 largestAcknowledged = SequenceNumber64 (
+      m_receivedPacketNumbers.GetLargest ());
 
-  SequenceNumber32 largestAcknowledged = *(m_receivedPacketNumbers.begin ());
+  // The peer does not acknowledge the packets carrying only ACK frames, so the
+  // ranges may never be pruned: keep those an ACK can report, plus a few that
+  // reordered packets may still fill
+  m_receivedPacketNumbers.DiscardOldest (m_maxTrackedGaps + 1 + m_tcb->m_kReorderingThreshold);
 
-  uint32_t ackBlockCount = 0;
-  std::vector<uint32_t> additionalAckBlocks;
-  std::vector<uint32_t> gaps;
+  // Limit the number of gaps that are sent in an ACK (older packets have already been retransmitted)
+  m_receivedPacketNumbers.BuildAckBlocks (m_maxTrackedGaps, m_ackRanges);
 
-  std::vector<SequenceNumber32>::const_iterator curr_rec_it =
-    m_receivedPacketNumbers.begin ();
-  std::vector<SequenceNumber32>::const_iterator next_rec_it =
-    m_receivedPacketNumbers.begin () + 1;
-
-  for (; next_rec_it != m_receivedPacketNumbers.end ();
-       ++curr_rec_it, ++next_rec_it)
-    {
-
-      if (((*curr_rec_it) - (*next_rec_it) - 1 > 0)
-          and ((*curr_rec_it) != (*next_rec_it)))
-        {
-          //std::clog << "curr " << (*curr_rec_it) << " next " << (*next_rec_it) << " ";
-          additionalAckBlocks.push_back ((*next_rec_it).GetValue ());
-          gaps.push_back ((*curr_rec_it).GetValue () - 1);
-          ackBlockCount++;
-        }
-      // Limit the number of gaps that are sent in an ACK (older packets have already been retransmitted)
-      if (ackBlockCount >= m_maxTrackedGaps) {
-          break;
-      }
-    }
-  
+  m_largestReportedAck = largestAcknowledged.GetValue ();
 
   Time delay = Simulator::Now() - m_lastReceived;
   uint64_t ack_delay = delay.GetMicroSeconds();
   QuicSubheader sub = QuicSubheader::CreateAck (
       largestAcknowledged.GetValue (), ack_delay, largestAcknowledged.GetValue (),
-      gaps, additionalAckBlocks);
-  QuicSubheader maxData = QuicSubheader::CreateMaxData(m_quicl5->GetMaxData());
+      m_ackRanges);
 
   Ptr<Packet> ackFrame = Create<Packet> ();
   ackFrame->AddHeader (sub);
-  ackFrame->AddHeader(maxData);
   return ackFrame;
 }
 
+void
+QuicSocketBase::OnReceivedAckFrequencyFrame (QuicSubheader &sub)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_minAckDelay.IsZero ())
+    {
+      AbortConnection (
+        QuicSubheader::TransportErrorCodes_t::PROTOCOL_VIOLATION,
+        "Received ACK_FREQUENCY frame without min_ack_delay");
+      return;
+    }
+  if (sub.GetSequence () < m_nextRxAckFrequencySequence)
+    {
+      NS_LOG_INFO ("Ignore stale ACK_FREQUENCY frame " << sub.GetSequence ());
+      return;
+    }
+  Time requestedMaxAckDelay = MicroSeconds (sub.GetRequestMaxAckDelay ());
+  if (requestedMaxAckDelay < m_minAckDelay)
+    {
+      AbortConnection (
+        QuicSubheader::TransportErrorCodes_t::PROTOCOL_VIOLATION,
+        "Requested Max Ack Delay below min_ack_delay");
+      return;
+    }
+
+  m_nextRxAckFrequencySequence = sub.GetSequence () + 1;
+  m_ackElicitingThreshold = sub.GetAckElicitingThreshold ();
+  m_ackDelayTimeout = requestedMaxAckDelay;
+  m_ackReorderingThreshold = sub.GetReorderingThreshold ();
+  NS_LOG_INFO ("Ack-eliciting threshold " << m_ackElicitingThreshold
+                                          << " max ACK delay " << m_ackDelayTimeout.GetSeconds ()
+                                          << " reordering threshold " << m_ackReorderingThreshold);
+
+  // an armed delayed ACK must not wait longer than requested now
+  if (m_timers->IsRunning (DELAYED_ACK_TIMER)
+      and m_timers->GetDeadline (DELAYED_ACK_TIMER) > Simulator::Now () + m_ackDelayTimeout)
+    {
+      m_timers->Schedule (DELAYED_ACK_TIMER, m_ackDelayTimeout);
+    }
+}
+
 void
 QuicSocketBase::OnReceivedAckFrame (QuicSubheader &sub)
 {
@@ -2098,145 +2448,107 @@ QuicSocketBase::OnReceivedAckFrame (QuicSubheader &sub)
 
   uint32_t previousWindow = m_txBuffer->BytesInFlight ();
   
-  std::vector<uint32_t> additionalAckBlocks = sub.GetAdditionalAckBlocks ();
-  std::vector<uint32_t> gaps = sub.GetGaps ();
-  uint32_t largestAcknowledged = sub.GetLargestAcknowledged ();
-  m_tcb->m_lastAckedSeq = largestAcknowledged;
-  uint32_t ackBlockCount = sub.GetAckBlockCount ();
-
-  NS_ABORT_MSG_IF (
-    ackBlockCount != additionalAckBlocks.size ()
-    and ackBlockCount != gaps.size (),
-    "Received Corrupted Ack Frame.");
+  uint64_t largestAcknowledged = sub.GetLargestAcknowledged ();
+  m_tcb->m_lastAckedSeq = SequenceNumber32 ((uint32_t) largestAcknowledged);
 
-  std::vector<QuicSocketTxItem*> ackedPackets = m_txBuffer->OnAckUpdate (
-      m_tcb, largestAcknowledged, additionalAckBlocks, gaps);
+  // Process the ACK and find the lost packets
+  m_txBuffer->OnAckUpdate (*m_tcb, largestAcknowledged, sub.GetAckRanges (),
+                           m_ackedPackets, m_lostPackets);
 
   // Count newly acked bytes
   uint32_t ackedBytes = previousWindow - m_txBuffer->BytesInFlight ();
 
-  // RTO packet acknowledged - IETF Draft QUIC Recovery, Sec. 4.3.3
-  if (m_tcb->m_rtoCount > 0)
+  // The streams discard the acknowledged data
+  for (auto acked_it = m_ackedPackets.begin (); acked_it != m_ackedPackets.end (); ++acked_it)
     {
-      // Packets after the RTO have been acknowledged
-      if (m_tcb->m_largestSentBeforeRto.GetValue () < largestAcknowledged)
+      for (auto frame_it = (*acked_it)->m_streamFrames.begin ();
+           frame_it != (*acked_it)->m_streamFrames.end (); ++frame_it)
         {
-
-          uint32_t newPackets = (largestAcknowledged
-                                 - m_tcb->m_largestSentBeforeRto.GetValue ()) / GetSegSize ();
-          uint32_t inFlightBeforeRto = m_txBuffer->BytesInFlight ();
-          m_txBuffer->ResetSentList (newPackets);
-          std::vector<QuicSocketTxItem*> lostPackets =
-            m_txBuffer->DetectLostPackets ();
-          if (m_quicCongestionControlLegacy && !lostPackets.empty ())
-            {
-              // Reset congestion window and go into loss mode
-              m_tcb->m_cWnd = m_tcb->m_kMinimumWindow;
-              m_tcb->m_endOfRecovery = m_tcb->m_highTxMark;
-              m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (
-                  m_tcb, inFlightBeforeRto);
-              m_tcb->m_congState = TcpSocketState::CA_LOSS;
-              m_congestionControl->CongestionStateSet (
-                m_tcb, TcpSocketState::CA_LOSS);
-            }
-        }
-      else
-        {
-          m_tcb->m_rtoCount = 0;
+          m_quicl5->OnStreamFrameAcked (*frame_it);
         }
     }
 
-  // Tail loss probe packet acknowledged - IETF Draft QUIC Recovery, Sec. 4.3.2
-  if (m_tcb->m_tlpCount > 0 && !ackedPackets.empty ())
+  const QuicRateSample &rateSample = m_txBuffer->GetRateSample ();
+  if (rateSample.IsValid ())
     {
-      m_tcb->m_tlpCount = 0;
+      m_deliveryRateTrace (rateSample.m_deliveryRate, rateSample.m_isAppLimited);
     }
 
-  // Find lost packets
-  std::vector<QuicSocketTxItem*> lostPackets =
-    m_txBuffer->DetectLostPackets ();
-  // Recover from losses
-  if (!lostPackets.empty ())
+  // The peer has received one of our ACK frames: stop reporting the ranges
+  // it covered, keeping those still in the peer's reordering window
+  std::map<SequenceNumber64, uint64_t>::iterator ackFrameIt = m_sentAckFrames.end ();
+  for (auto acked_it = m_ackedPackets.begin (); acked_it != m_ackedPackets.end ();
+       ++acked_it)
     {
-      if (m_quicCongestionControlLegacy)
+      std::map<SequenceNumber64, uint64_t>::iterator it =
+        m_sentAckFrames.find ((*acked_it)->m_packetNumber);
+      if (it != m_sentAckFrames.end ()
+          && (ackFrameIt == m_sentAckFrames.end () || ackFrameIt->first < it->first))
         {
-          //Enter recovery (RFC 6675, Sec. 5)
-          if (m_tcb->m_congState != TcpSocketState::CA_RECOVERY)
-            {
-              m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
-              m_tcb->m_endOfRecovery = m_tcb->m_highTxMark;
-              m_congestionControl->CongestionStateSet (
-                m_tcb, TcpSocketState::CA_RECOVERY);
-              m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (
-                  m_tcb, BytesInFlight ());
-              m_tcb->m_cWnd = m_tcb->m_ssThresh;
-            }
-          NS_ASSERT (m_tcb->m_congState == TcpSocketState::CA_RECOVERY);
+          ackFrameIt = it;
         }
-      else
+    }
+  for (auto acked_it = m_ackedPackets.begin (); acked_it != m_ackedPackets.end ()
+       and m_ackFrequencyPacket.GetValue () > 0; ++acked_it)
+    {
+      if ((*acked_it)->m_packetNumber == m_ackFrequencyPacket)
         {
-          DynamicCast<QuicCongestionOps> (m_congestionControl)->OnPacketsLost (
-            m_tcb, lostPackets);
+          // the peer applies the requested delay from now on
+          m_ackFrequencyPacket = SequenceNumber64 (0);
+          m_tcb->m_maxAckDelay = m_requestedMaxAckDelay;
         }
-      DoRetransmit (lostPackets);
     }
-  else if (ackedBytes > 0)
+  if (m_ackFrequencyPacket.GetValue () > 0
+      and largestAcknowledged >= m_ackFrequencyPacket.GetValue () + m_tcb->m_kReorderingThreshold)
+    {
+      NS_LOG_INFO ("ACK_FREQUENCY frame in packet " << m_ackFrequencyPacket << " lost");
+      m_ackFrequencyPacket = SequenceNumber64 (0);
+      m_ackFrequencyPending = true;
+    }
+
+  if (ackFrameIt != m_sentAckFrames.end ())
     {
-      if (!m_quicCongestionControlLegacy)
+      uint64_t largestReported = ackFrameIt->second;
+      if (largestReported > m_tcb->m_kReorderingThreshold)
         {
-          NS_LOG_INFO ("Update the variables in the congestion control (QUIC)");
-          // Process the ACK
-          DynamicCast<QuicCongestionOps> (m_congestionControl)->OnAckReceived (
-            m_tcb, sub, ackedPackets);
-          m_lastRtt = m_tcb->m_lastRtt;
+          m_receivedPacketNumbers.DiscardBelow (
+            largestReported - m_tcb->m_kReorderingThreshold);
         }
-      else
+      m_sentAckFrames.erase (m_sentAckFrames.begin (), ++ackFrameIt);
+    }
+
+  // A newly acked packet shows that the path delivers again - RFC 9002, Sec. 6.2.1
+  if (!m_ackedPackets.empty ())
+    {
+      m_tcb->m_ptoCount = 0;
+    }
+
+  m_tcb->m_bytesInFlight = BytesInFlight ();
+  // Recover from losses
+  if (!m_lostPackets.empty ())
+    {
+      // The ACK may also deliver new data: account for it before the losses
+      if (!m_ackedPackets.empty ())
         {
-          uint32_t ackedSegments = ackedBytes / GetSegSize ();
-          
-          NS_LOG_INFO ("Update the variables in the congestion control (legacy), ackedBytes "
-                       << ackedBytes << " ackedSegments " << ackedSegments);
-          // new acks are ordered from the highest packet number to the smalles
-          QuicSocketTxItem* lastAcked = ackedPackets.at (0);
-
-          NS_LOG_LOGIC ("Updating RTT estimate");
-          // If the largest acked is newly acked, update the RTT.
-          if (lastAcked->m_packetNumber >= m_tcb->m_largestAckedPacket)
-            {
-              Time ackDelay = MicroSeconds(sub.GetAckDelay());
-              m_tcb->m_lastRtt = Now () - lastAcked->m_lastSent - ackDelay;
-              m_lastRtt = m_tcb->m_lastRtt;
-            }
-          if (m_tcb->m_congState != TcpSocketState::CA_RECOVERY
-              && m_tcb->m_congState != TcpSocketState::CA_LOSS)
-            {
-              // Increase the congestion window
-              m_congestionControl->PktsAcked (m_tcb, ackedSegments,
-                                              m_tcb->m_lastRtt);
-              m_congestionControl->IncreaseWindow (m_tcb, ackedSegments);
-            }
-          else
-            {
-              if (m_tcb->m_endOfRecovery.GetValue () > largestAcknowledged)
-                {
-                  m_congestionControl->PktsAcked (m_tcb, ackedSegments,
-                                                  m_tcb->m_lastRtt);
-                  m_congestionControl->IncreaseWindow (m_tcb, ackedSegments);
-                }
-              else
-                {
-                  m_tcb->m_congState = TcpSocketState::CA_OPEN;
-                  m_congestionControl->PktsAcked (m_tcb, ackedSegments, m_tcb->m_lastRtt);
-                  m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
-                }
-            }
+          m_congestionControl->OnAckReceived (*m_tcb, sub, m_ackedPackets, rateSample);
+          m_lastRtt = m_tcb->m_lastRtt;
         }
+      m_congestionControl->OnPacketsLost (*m_tcb, m_lostPackets, rateSample);
+      DoRetransmit ();
+    }
+  else if (ackedBytes > 0)
+    {
+      NS_LOG_INFO ("Update the variables in the congestion control");
+      m_congestionControl->OnAckReceived (*m_tcb, sub, m_ackedPackets, rateSample);
+      m_lastRtt = m_tcb->m_lastRtt;
     }
   else
     {
       NS_LOG_INFO ("Received an ACK to ack an ACK");
     }
 
+  UpdateAckFrequency ();
+
   // notify the application that more data can be sent
   if (GetTxAvailable () > 0)
     {
@@ -2261,6 +2573,13 @@ QuicSocketBase::OnSendingTransportParameters ()
       (uint16_t) m_idleTimeout.Get ().GetSeconds (),
       (uint8_t) m_omit_connection_id, m_tcb->m_segmentSize,
       m_ack_delay_exponent, m_initial_max_stream_id_uni);
+  transportParameters.SetMinAckDelay (m_minAckDelay.GetMicroSeconds ());
+
+  // the limits of the data received are the advertised ones
+  m_advertisedMaxStreamData = m_initial_max_stream_data;
+  m_connectionFlowControl.SetInitialLimit (m_max_data);
+  m_connectionFlowControl.SetUpdateThreshold (m_flowControlUpdateThreshold);
+  m_connectionFlowControl.SetMaxWindow (m_maxReceiveWindow);
 
   return transportParameters;
 }
@@ -2280,6 +2599,9 @@ QuicSocketBase::OnReceivedTransportParameters (
     }
   m_receivedTransportParameters = true;
 
+  // the ACK frequency extension does not depend on the stream limits below
+  m_peerMinAckDelay = MicroSeconds (transportParameters.GetMinAckDelay ());
+
 // TODO: A client MUST NOT include a stateless reset token. A server MUST treat receipt of a stateless_reset_token_transport
 //   parameter as a connection error of type TRANSPORT_PARAMETER_ERROR
 
@@ -2439,7 +2761,10 @@ QuicSocketBase::DoClose (void)
       SetState (IDLE);
     }
 
+  m_timers->CancelAll ();
   SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  m_quicl4->ReleaseReceiveWindow (m_reservedReceiveWindow);
+  m_reservedReceiveWindow = 0;
   return m_quicl4->RemoveSocket (this);
 }
 
@@ -2454,19 +2779,25 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
   NS_LOG_INFO ("Received packet of size " << p->GetSize ());
 
   // check if this packet is not received during the draining period
-  if (!m_drainingPeriodEvent.IsRunning ())
+  if (!m_timers->IsRunning (DRAINING_TIMER))
     {
-      m_idleTimeoutEvent.Cancel ();   // reset the IDLE timeout
+      // reset the IDLE timeout
       NS_LOG_LOGIC (
         this << " ReceivedData Schedule Close at time " << Simulator::Now ().GetSeconds () << " to expire at time " << (Simulator::Now () + m_idleTimeout.Get ()).GetSeconds ());
-      m_idleTimeoutEvent = Simulator::Schedule (m_idleTimeout,
-                                                &QuicSocketBase::Close, this);
+      RefreshIdleTimeout ();
     }
   else   // If the socket is in Draining Period, discard the packets
     {
       return;
     }
 
+  uint64_t packetNumber = quicHeader.GetPacketNumber ().GetValue ();
+  if (!m_receivedPacketNumbers.IsEmpty ())
+    {
+      packetNumber = quicHeader.DecodePacketNumber (
+          SequenceNumber64 (m_receivedPacketNumbers.GetLargest ())).GetValue ();
+    }
+
   int onlyAckFrames = 0;
   bool unsupportedVersion = false;
 
@@ -2483,7 +2814,7 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
       m_couldContainTransportParameters = true;
 
       onlyAckFrames = m_quicl5->DispatchRecv (p, address);
-      m_receivedPacketNumbers.push_back (quicHeader.GetPacketNumber ());
+      m_receivedPacketNumbers.Add (packetNumber);
 
       m_connected = true;
       m_keyPhase == QuicHeader::PHASE_ONE ? m_keyPhase =
@@ -2519,7 +2850,7 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
         }
 
       onlyAckFrames = m_quicl5->DispatchRecv (p, address);
-      m_receivedPacketNumbers.push_back (quicHeader.GetPacketNumber ());
+      m_receivedPacketNumbers.Add (packetNumber);
 
       if (IsVersionSupported (quicHeader.GetVersion ()))
         {
@@ -2540,7 +2871,7 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
       NS_LOG_INFO ("Client receives HANDSHAKE");
 
       onlyAckFrames = m_quicl5->DispatchRecv (p, address);
-      m_receivedPacketNumbers.push_back (quicHeader.GetPacketNumber ());
+      m_receivedPacketNumbers.Add (packetNumber);
 
       SetState (OPEN);
       Simulator::ScheduleNow(&QuicSocketBase::ConnectionSucceeded, this);
@@ -2551,12 +2882,24 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
       SendInitialHandshake (QuicHeader::HANDSHAKE, quicHeader, p);
       return;
     }
+  else if (quicHeader.IsHandshake () and m_socketState == OPEN
+           and !m_receivedTransportParameters)
+    {
+      // the server transport parameters may follow its first HANDSHAKE packet
+      NS_LOG_INFO ("Client receives late HANDSHAKE");
+
+      m_couldContainTransportParameters = true;
+      onlyAckFrames = m_quicl5->DispatchRecv (p, address);
+      m_receivedPacketNumbers.Add (packetNumber);
+      m_couldContainTransportParameters = false;
+      return;
+    }
   else if (quicHeader.IsHandshake () and m_socketState == CONNECTING_SVR)
     {
       NS_LOG_INFO ("Server receives HANDSHAKE");
 
       onlyAckFrames = m_quicl5->DispatchRecv (p, address);
-      m_receivedPacketNumbers.push_back (quicHeader.GetPacketNumber ());
+      m_receivedPacketNumbers.Add (packetNumber);
 
       SetState (OPEN);
       Simulator::ScheduleNow(&QuicSocketBase::ConnectionSucceeded, this);
@@ -2621,7 +2964,7 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
       // we need to check if the packet contains only an ACK frame
       // in this case we cannot explicitely ACK it!
       // check if delayed ACK is used
-      m_receivedPacketNumbers.push_back (quicHeader.GetPacketNumber ());
+      m_receivedPacketNumbers.Add (packetNumber);
       onlyAckFrames = m_quicl5->DispatchRecv (p, address);
 
     }
@@ -2644,27 +2987,77 @@ QuicSocketBase::ReceivedData (Ptr<Packet> p, const QuicHeader& quicHeader,
     {
       m_lastReceived = Simulator::Now();
       NS_LOG_DEBUG ("Call MaybeQueueAck");
-      MaybeQueueAck ();
+      MaybeQueueAck (packetNumber);
     }
 
 }
 
-uint32_t
+uint64_t
 QuicSocketBase::GetInitialMaxStreamData () const
 {
   return m_initial_max_stream_data;
 }
 
-uint32_t
+uint64_t
+QuicSocketBase::GetAdvertisedMaxStreamData () const
+{
+  return m_advertisedMaxStreamData;
+}
+
+double
+QuicSocketBase::GetFlowControlUpdateThreshold () const
+{
+  return m_flowControlUpdateThreshold;
+}
+
+uint64_t
+QuicSocketBase::GetMaxStreamReceiveWindow () const
+{
+  return m_maxStreamReceiveWindow;
+}
+
+uint64_t
+QuicSocketBase::AutoTuneReceiveWindow (QuicFlowController &flowControl)
+{
+  NS_LOG_FUNCTION (this);
+
+  // a receiver that sends no stream data may have no RTT sample at all
+  Time rtt = m_tcb->m_smoothedRtt.IsZero () ? m_tcb->m_lastRtt.Get () : m_tcb->m_smoothedRtt;
+  if (rtt.IsZero ())
+    {
+      rtt = m_tcb->m_kDefaultInitialRtt;
+    }
+  uint64_t increase = flowControl.AutoTune (Simulator::Now (), rtt);
+  if (increase > 0)
+    {
+      // the node budget may grant less than the increase, or nothing
+      increase = m_quicl4->ReserveReceiveWindow (increase);
+    }
+  if (increase > 0)
+    {
+      m_reservedReceiveWindow += increase;
+      flowControl.SetWindow (flowControl.GetWindow () + increase);
+      NS_LOG_INFO ("Receive window grown to " << flowControl.GetWindow ());
+    }
+  return flowControl.GetWindow ();
+}
+
+uint64_t
 QuicSocketBase::GetConnectionMaxData () const
 {
   return m_max_data;
 }
 
 void
-QuicSocketBase::SetConnectionMaxData (uint32_t maxData)
+QuicSocketBase::SetConnectionMaxData (uint64_t maxData)
 {
-  m_max_data = maxData;
+  NS_LOG_FUNCTION (this << maxData);
+  // the limit never decreases, reordered updates are ignored
+  if (maxData > m_max_data)
+    {
+      m_max_data = maxData;
+      ScheduleSendPendingData ();
+    }
 }
 
 QuicSocket::QuicStates_t
@@ -2737,24 +3130,24 @@ QuicSocketBase::AbortConnection (uint16_t transportErrorCode,
     {
     case CONNECTING_CLT:
       quicHeader = QuicHeader::CreateInitial (m_connectionId, m_vers,
-                                              m_tcb->m_nextTxSequence++);
+                                              m_tcb->m_nextTxPacketNumber++);
       break;
     case CONNECTING_SVR:
       quicHeader = QuicHeader::CreateHandshake (m_connectionId, m_vers,
-                                                m_tcb->m_nextTxSequence++);
+                                                m_tcb->m_nextTxPacketNumber++);
       break;
     case OPEN:
       quicHeader =
         !m_connected ?
         QuicHeader::CreateHandshake (m_connectionId, m_vers,
-                                     m_tcb->m_nextTxSequence++) :
+                                     m_tcb->m_nextTxPacketNumber++) :
         QuicHeader::CreateShort (m_connectionId,
-                                 m_tcb->m_nextTxSequence++,
+                                 m_tcb->m_nextTxPacketNumber++,
                                  !m_omit_connection_id, m_keyPhase);
       break;
     case CLOSING:
       quicHeader = QuicHeader::CreateShort (m_connectionId,
-                                            m_tcb->m_nextTxSequence++,
+                                            m_tcb->m_nextTxPacketNumber++,
                                             !m_omit_connection_id,
                                             m_keyPhase);
       break;
@@ -2800,7 +3193,8 @@ QuicSocketBase::CheckIfPacketOverflowMaxDataLimit (
         }
     }
 
-  if ((m_max_data < m_rxBuffer->Size () + validPacketSize))
+  uint64_t credit = m_connectionFlowControl.GetLimit () - m_connectionFlowControl.GetConsumed ();
+  if (credit < m_rxBuffer->Size () + validPacketSize)
     {
       return true;
     }
@@ -2835,18 +3229,12 @@ void
 QuicSocketBase::SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo)
 {
   NS_LOG_FUNCTION (this << algo);
-  if (DynamicCast<QuicCongestionOps> (algo) != 0)
-    {
-      NS_LOG_INFO ("Non-legacy congestion control");
-      m_quicCongestionControlLegacy = false;
-    }
-  else
+  m_congestionControl = DynamicCast<QuicCongestionOps> (algo);
+  if (m_congestionControl == 0)
     {
-      NS_LOG_INFO (
-        "Legacy congestion control, using only TCP standard functions");
-      m_quicCongestionControlLegacy = true;
+      NS_LOG_INFO ("TCP congestion control, run through the adapter");
+      m_congestionControl = CreateObject<QuicTcpCongestionAdapter> (algo);
     }
-  m_congestionControl = algo;
 }
 
 void
@@ -2869,6 +3257,7 @@ QuicSocketBase::SetSocketRcvBufSize (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   m_socketRxBufferSize = size;
   m_rxBuffer->SetMaxBufferSize (size);
+  m_connectionFlowControl.SetWindow (size);
 }
 
 uint32_t
@@ -2897,17 +3286,19 @@ QuicSocketBase::UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
 }
 
 void
-QuicSocketBase::UpdateNextTxSequence (SequenceNumber32 oldValue,
-                                      SequenceNumber32 newValue)
+QuicSocketBase::UpdateNextTxSequence (SequenceNumber64 oldValue,
+                                      SequenceNumber64 newValue)
 
 {
-  m_nextTxSequenceTrace (oldValue.GetValue (), newValue.GetValue ());
+  m_tcb->m_nextTxSequence = SequenceNumber32 ((uint32_t) newValue.GetValue ());
+  m_nextTxSequenceTrace (oldValue, newValue);
 }
 
 void
-QuicSocketBase::UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 newValue)
+QuicSocketBase::UpdateHighTxMark (SequenceNumber64 oldValue, SequenceNumber64 newValue)
 {
-  m_highTxMarkTrace (oldValue.GetValue (), newValue.GetValue ());
+  m_tcb->m_highTxMark = SequenceNumber32 ((uint32_t) newValue.GetValue ());
+  m_highTxMarkTrace (oldValue, newValue);
 }
 
 void
@@ -2938,4 +3329,93 @@ QuicSocketBase::GetInitialPacketSize () const
   return m_initialPacketSize;
 }
 
+void
+QuicSocketBase::SetPacing (bool pacing)
+{
+  m_tcb->m_pacing = pacing;
+}
+
+bool
+QuicSocketBase::GetPacing () const
+{
+  return m_tcb->m_pacing;
+}
+
+void
+QuicSocketBase::ComputePacingRate ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_tcb->m_pacing)
+    {
+      return;
+    }
+  if (m_congestionControl->HasPacingRate ())
+    {
+      NS_LOG_LOGIC ("Pacing rate set by the congestion control: " << m_tcb->m_currentPacingRate);
+    }
+  else
+    {
+      Time rtt = m_tcb->m_smoothedRtt;
+      if (rtt.IsZero ())
+        {
+          rtt = m_tcb->m_lastRtt.Get ().IsZero () ? m_tcb->m_kDefaultInitialRtt : m_tcb->m_lastRtt.Get ();
+        }
+      DataRate rate = DataRate (m_pacingGain * m_tcb->m_cWnd.Get () * 8 / rtt.GetSeconds ());
+      if (m_tcb->m_maxPacingRate.GetBitRate () > 0 && m_tcb->m_maxPacingRate < rate)
+        {
+          rate = m_tcb->m_maxPacingRate;
+        }
+      m_tcb->m_currentPacingRate = rate;
+      NS_LOG_LOGIC ("Pacing rate " << rate << " cWnd " << m_tcb->m_cWnd << " RTT " << rtt);
+    }
+
+  if (m_tcb->m_currentPacingRate != m_tracedPacingRate)
+    {
+      m_pacingRateTrace (m_tracedPacingRate, m_tcb->m_currentPacingRate);
+      m_tracedPacingRate = m_tcb->m_currentPacingRate;
+    }
+}
+
+void
+QuicSocketBase::NotifyPacingPerformed ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("Performing Pacing");
+  SendPendingData (m_connected);
+}
+
+void
+QuicSocketBase::UpdateAckFrequency ()
+{
+  NS_LOG_FUNCTION (this);
+
+  Time rtt = m_tcb->m_smoothedRtt.IsZero () ? m_tcb->m_lastRtt.Get () : m_tcb->m_smoothedRtt;
+  if (m_minAckDelay.IsZero () or m_peerMinAckDelay.IsZero () or rtt.IsZero ())
+    {
+      return;
+    }
+
+  // about four ACKs per window: one every cWnd / 4 packets, i.e., after
+  // more than cWnd / 4 - 1 ack-eliciting packets
+  uint32_t packetsPerAck = std::max<uint32_t> (m_tcb->m_cWnd.Get () / GetSegSize () / 4, 2);
+  uint32_t threshold = std::min (packetsPerAck - 1, m_maxAckElicitingThreshold);
+  Time maxAckDelay = MicroSeconds (rtt.GetMicroSeconds () / 4);
+  maxAckDelay = std::max (std::min (maxAckDelay, m_tcb->m_kDelayedAckTimeout), m_peerMinAckDelay);
+
+  // skip the small changes of the RTT estimate
+  Time delayChange = maxAckDelay > m_requestedMaxAckDelay ? maxAckDelay - m_requestedMaxAckDelay
+    : m_requestedMaxAckDelay - maxAckDelay;
+  if (threshold == m_requestedAckElicitingThreshold
+      and delayChange.GetMicroSeconds () * 4 <= m_requestedMaxAckDelay.GetMicroSeconds ())
+    {
+      return;
+    }
+
+  NS_LOG_INFO ("Request ack-eliciting threshold " << threshold << " max ACK delay " << maxAckDelay.GetSeconds ());
+  m_requestedAckElicitingThreshold = threshold;
+  m_requestedMaxAckDelay = maxAckDelay;
+  m_ackFrequencyPending = true;
+}
+
 } // namespace ns3
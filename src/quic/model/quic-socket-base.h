@@ -35,17 +35,22 @@
 #include "ns3/event-id.h"
 #include "quic-socket-rx-buffer.h"
 #include "quic-socket-tx-buffer.h"
+#include "quic-ack-range-tracker.h"
 #include "quic-header.h"
 #include "quic-subheader.h"
 #include "quic-transport-parameters.h"
+#include "quic-timer-multiplexer.h"
+#include "quic-flow-controller.h"
 // #include "ns3/ipv4-end-point.h"
 #include "ns3/tcp-socket-base.h"
 #include "ns3/tcp-congestion-ops.h"
+#include "ns3/data-rate.h"
 
 namespace ns3 {
 
 class QuicL5Protocol;
 class QuicL4Protocol;
+class QuicCongestionOps;
 
 /**
  * \brief Data structure that records the congestion state of a connection
@@ -69,51 +74,81 @@ public:
   {
   }
 
+  /**
+   * \brief Get the maximum time the peer delays an ACK
+   *
+   * \return the max ack delay requested to the peer, or the peer's delayed ACK timer
+   */
+  Time GetMaxAckDelay () const;
+
+  /**
+   * \brief Get the probe timeout, without the exponential backoff (RFC 9002, Sec. 6.2.1)
+   *
+   * Before the first RTT sample, the RTT is the default initial RTT.
+   *
+   * \return smoothed_rtt + max (4 * rttvar, kGranularity) + max_ack_delay
+   */
+  Time GetProbeTimeout () const;
+
+  /**
+   * \brief Get the time after which a packet sent before an acknowledged one is
+   *   lost (RFC 9002, Sec. 6.1.2)
+   *
+   * \return max (kTimeThreshold * max (smoothed_rtt, latest_rtt), kGranularity)
+   */
+  Time GetLossDelay () const;
+
   // Loss Detection variables of interest
-  EventId m_lossDetectionAlarm;            //!< Multi-modal alarm used for loss detection.
-  uint32_t m_handshakeCount;               /**< The number of times the handshake packets have been retransmitted
-                                            *   without receiving an ack. */
-  uint32_t m_tlpCount;                     /**< The number of times a tail loss probe has been sent without
-                                            *   receiving an ack. */
-  uint32_t m_rtoCount;                      //!< The number of times an rto has been sent without receiving an ack.
-  SequenceNumber32 m_largestSentBeforeRto;  //!< The last packet number sent prior to the first retransmission timeout.
-  Time m_timeOfLastSentPacket;              //!< The time the most recent packet was sent.
-  SequenceNumber32 m_largestAckedPacket;    //!< The largest packet number acknowledged in an ACK frame.
+  uint32_t m_ptoCount;                      //!< The number of times a PTO has expired without receiving an ack.
+  Time m_timeOfLastSentPacket;              //!< The time the most recent ack-eliciting packet was sent.
+  Time m_firstRttSample;                    //!< The time of the first RTT sample (zero if none).
+  SequenceNumber64 m_largestAckedPacket;    //!< The largest packet number acknowledged in an ACK frame.
   Time m_latestRtt;                         /**< The most recent RTT measurement made when receiving an ack for a
                                              *   previously unacked packet. */
   Time m_smoothedRtt;                       //!< The smoothed RTT of the connection, computed as described in [RFC6298].
   Time m_rttVar;                            //!< The RTT variance, computed as described in [RFC6298].
-  Time m_minRtt;                            //!< The minimum RTT seen in the connection, ignoring ack delay.
   Time m_maxAckDelay;                       /**< The maximum ack delay in an incoming ACK frame for this connection.
                                              *   Excludes ack delays for ack only packets and those that create an
                                              *   RTT sample less than m_minRtt. */
   Time m_lossTime;                          /**< The time at which the next packet will be considered lost based
-                                             *   on early transmit or exceeding the reordering window in time. */
+                                             *   on exceeding the reordering window in time (zero if none). */
 
   // Congestion Control constants of interests
   uint32_t m_kMinimumWindow;      //!< Default minimum congestion window.
   double m_kLossReductionFactor;  //!< Reduction in congestion window when a new loss event is detected.
 
   // Congestion Control variables of interests
-  SequenceNumber32 m_endOfRecovery;  /**< The largest packet number sent when QUIC detects a loss. When a larger packet
+  SequenceNumber64 m_endOfRecovery;  /**< The largest packet number sent when QUIC detects a loss. When a larger packet
                                       *   is acknowledged, QUIC exits recovery. */
 
   // Loss Detection constants of interest
-  uint32_t m_kMaxTLPs;                          //!< Maximum number of tail loss probes before an RTO fires.
   uint32_t m_kReorderingThreshold;              /**< Maximum reordering in packet number space before FACK style loss
                                                  *   detection considers a packet lost. */
   double m_kTimeReorderingFraction;               /**< Maximum reordering in time space before time based loss detection
                                                  *   considers a packet lost. In fraction of an RTT. */
   bool m_kUsingTimeLossDetection;               /**< Whether time based loss detection is in use. If false, uses FACK
                                                  *   style loss detection. */
-  Time m_kMinTLPTimeout;                        //!< Minimum time in the future a tail loss probe alarm may be set for.
-  Time m_kMinRTOTimeout;                        //!< Minimum time in the future an RTO alarm may be set for.
+  Time m_kGranularity;                          //!< Timer granularity, lower bound of the loss delay and of the PTO.
+  uint32_t m_kPersistentCongestionThreshold;    /**< Number of PTOs without any acknowledged packet after which
+                                                 *   the losses are a persistent congestion. */
   Time m_kDelayedAckTimeout;                    //!< The lenght of the peer's delayed ack timer.
   uint8_t m_alarmType;                          //!< The type of the next alarm
   Time m_nextAlarmTrigger;                      //<! Time of the next alarm
   Time m_kDefaultInitialRtt;                    //!< The default RTT used before an RTT sample is taken.
   uint32_t m_kMaxPacketsReceivedBeforeAckSend;  //!< The number of packets to be received before an ACK is triggered
 
+  // Packet number space
+  TracedValue<SequenceNumber64> m_nextTxPacketNumber;  //!< Next packet number to be sent
+  TracedValue<SequenceNumber64> m_highTxPacketNumber;  //!< Highest packet number ever sent
+
+  /**
+   * \brief TracedCallback signature for the pacing rate
+   *
+   * \param [in] oldValue original value of the pacing rate
+   * \param [in] newValue new value of the pacing rate
+   */
+  typedef void (* PacingRateTracedCallback)(const DataRate oldValue, const DataRate newValue);
+
 };
 
 /**
@@ -175,6 +210,18 @@ public:
    */
   virtual TypeId GetInstanceTypeId () const;
 
+  /**
+   * \brief QuicProbeTimeoutTestCase friend class (for tests).
+   * \relates QuicProbeTimeoutTestCase
+   */
+  friend class QuicProbeTimeoutTestCase;
+
+  /**
+   * \brief QuicPacingTestCase friend class (for tests).
+   * \relates QuicPacingTestCase
+   */
+  friend class QuicPacingTestCase;
+
   QuicSocketBase (void);
   QuicSocketBase (const QuicSocketBase&);
 
@@ -183,6 +230,8 @@ public:
   /**
    * \brief Install a congestion control algorithm on this socket
    *
+   * The TCP congestion controls are wrapped in a QuicTcpCongestionAdapter.
+   *
    * \param algo Algorithm to be installed
    */
   void SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo);
@@ -230,6 +279,17 @@ public:
    */
   Ptr<Packet> OnSendingAckFrame ();
 
+  /**
+   * \brief Called when an ACK_FREQUENCY frame is received
+   *
+   * Applies the ack-eliciting threshold, the delayed ACK timeout and the
+   * reordering threshold requested by the peer, unless the frame is older
+   * than the last one applied.
+   *
+   * \param sub the QuicSubheader of the ACK_FREQUENCY frame
+   */
+  void OnReceivedAckFrequencyFrame (QuicSubheader &sub);
+
   /**
    * \brief Return an object with the transport parameters of this socket
    *
@@ -252,6 +312,39 @@ public:
    */
   int AppendingTx (Ptr<Packet> frame);
 
+  /**
+   * \brief Schedule a call to SendPendingData, unless one is already pending
+   *        or the socket is waiting for the next pacing slot
+   */
+  void ScheduleSendPendingData ();
+
+  /**
+   * \brief Set the priority of a stream for the strict priority scheduler,
+   *   creating the stream if needed
+   *
+   * \param streamId the stream ID
+   * \param priority the priority, lower values are served first
+   */
+  void SetStreamPriority (uint64_t streamId, uint8_t priority);
+
+  /**
+   * \brief Set the weight of a stream for the weighted fair scheduler,
+   *   creating the stream if needed
+   *
+   * \param streamId the stream ID
+   * \param weight the weight
+   */
+  void SetStreamWeight (uint64_t streamId, uint32_t weight);
+
+  /**
+   * \brief Set the deadline of a stream for the earliest deadline first
+   *   scheduler, creating the stream if needed
+   *
+   * \param streamId the stream ID
+   * \param deadline the time within which the written data should be sent
+   */
+  void SetStreamDeadline (uint64_t streamId, Time deadline);
+
   /**
    * \brief Add a stream frame to the RX buffer and call NotifyDataRecv
    *
@@ -315,14 +408,14 @@ public:
    *
    * \return the maximum amount of data that can be sent on the connection
    */
-  uint32_t GetConnectionMaxData () const;
+  uint64_t GetConnectionMaxData () const;
 
   /**
    * \brief Set the maximum amount of data that can be sent on the connection
    *
    * \param maxData the maximum amount of data that can be sent on the connection
    */
-  void SetConnectionMaxData (uint32_t maxData);
+  void SetConnectionMaxData (uint64_t maxData);
 
   /**
    * \brief Get the maximum amount of data per stream
@@ -331,7 +424,39 @@ public:
    *
    * \return the maximum amount of data per stream
    */
-  uint32_t GetInitialMaxStreamData () const;
+  uint64_t GetInitialMaxStreamData () const;
+
+  /**
+   * \brief Get the initial maximum stream data advertised to the peer
+   *
+   * \return the limit of the data the peer can send on a new stream
+   */
+  uint64_t GetAdvertisedMaxStreamData () const;
+
+  /**
+   * \brief Get the fraction of a receive window to consume before new credit is sent
+   *
+   * \return the flow control update threshold
+   */
+  double GetFlowControlUpdateThreshold () const;
+
+  /**
+   * \brief Get the largest stream receive window that autotuning can reach
+   *
+   * \return the maximum stream receive window
+   */
+  uint64_t GetMaxStreamReceiveWindow () const;
+
+  /**
+   * \brief Grow a receive window of the connection or of one of its streams at a limit update
+   *
+   * The window grows if the application drains it within two RTTs, as long
+   * as the receive window budget of the node allows it.
+   *
+   * \param flowControl the flow controller of the window
+   * \return the receive window
+   */
+  uint64_t AutoTuneReceiveWindow (QuicFlowController &flowControl);
 
   /**
    * \brief Get the state in the Congestion state machine
@@ -429,9 +554,11 @@ public:
   uint32_t GetSocketRcvBufSize (void) const;
 
   /**
-   * \brief Schedule a queue ACK has if needed
+   * \brief Schedule an immediate or a delayed ACK after an ack-eliciting packet
+   *
+   * \param packetNumber the packet number of the received packet
    */
-  void MaybeQueueAck ();
+  void MaybeQueueAck (uint64_t packetNumber);
 
   /**
    * \brief Callback function to hook to QuicSocketState congestion window
@@ -459,20 +586,26 @@ public:
                         TcpSocketState::TcpCongState_t newValue);
 
   /**
-   * \brief Callback function to hook to QuicSocketState high tx mark
+   * \brief Callback function to hook to QuicSocketState highest packet number
+   *
+   * The value is mirrored, modulo 2^32, in the TcpSocketState high tx mark
+   * for the congestion controls that read it.
    *
-   * \param oldValue old high tx mark
-   * \param newValue new high tx mark
+   * \param oldValue old highest packet number
+   * \param newValue new highest packet number
    */
-  void UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 newValue);
+  void UpdateHighTxMark (SequenceNumber64 oldValue, SequenceNumber64 newValue);
 
   /**
-   * \brief Callback function to hook to QuicSocketState next tx sequence
+   * \brief Callback function to hook to QuicSocketState next packet number
    *
-   * \param oldValue old nextTxSeq value
-   * \param newValue new nextTxSeq value
+   * The value is mirrored, modulo 2^32, in the TcpSocketState next tx
+   * sequence for the congestion controls that read it.
+   *
+   * \param oldValue old next packet number
+   * \param newValue new next packet number
    */
-  void UpdateNextTxSequence (SequenceNumber32 oldValue, SequenceNumber32 newValue);
+  void UpdateNextTxSequence (SequenceNumber64 oldValue, SequenceNumber64 newValue);
 
   /**
    * \brief Set the initial Slow Start Threshold.
@@ -503,6 +636,20 @@ public:
    */
   uint32_t GetInitialPacketSize (void) const;
 
+  /**
+   * \brief Enable or disable the pacing of data packets
+   *
+   * \param pacing true to pace data packets
+   */
+  void SetPacing (bool pacing);
+
+  /**
+   * \brief Check if the pacing of data packets is enabled
+   *
+   * \returns true if pacing is enabled
+   */
+  bool GetPacing (void) const;
+
   // Implementation of ns3::Socket virtuals
   
   /**
@@ -552,6 +699,14 @@ public:
   typedef void (*QuicTxRxTracedCallback)(const Ptr<const Packet> packet, const QuicHeader& header,
                                          const Ptr<const QuicSocketBase> socket);
 
+  /**
+   * \brief TracedCallback signature for delivery rate samples.
+   *
+   * \param [in] rate The delivery rate measured by an ACK
+   * \param [in] isAppLimited True if the sample was taken while application limited
+   */
+  typedef void (*DeliveryRateTracedCallback)(const DataRate rate, bool isAppLimited);
+
 protected:
 
   // Implementation of QuicSocket virtuals
@@ -566,19 +721,56 @@ protected:
   Ptr<QuicL5Protocol> CreateStreamController ();
 
   /**
-   * \brief Set the RTO timer (called when packets or ACKs are sent)
+   * \brief Set the loss detection timer (called when packets or ACKs are sent)
+   *
+   * The timer expires at the loss time of the packets sent before the largest
+   * acknowledged one, if any, or else at the probe timeout
    */
   void SetReTxTimeout ();
 
   /**
-   * \brief Handle what happens in case of an RTO
+   * \brief Handle the expiration of the loss detection timer
+   *
+   * The alarm expires at m_nextAlarmTrigger
    */
   void ReTxTimeout ();
 
+  /**
+   * \brief Get the exponential backoff of the probe timeout
+   *
+   * \return 2 to the number of probe timeouts without an ACK
+   */
+  uint32_t GetProbeTimeoutBackoff () const;
+
+  /**
+   * \brief Push the idle timeout deadline after the last packet sent or received
+   */
+  void RefreshIdleTimeout ();
+
+  /**
+   * \brief Close the connection if no packet was sent or received in the idle timeout
+   */
+  void IdleTimeout ();
+
+  /**
+   * \brief Release the connection at the end of the draining period
+   */
+  void DrainingPeriodTimeout ();
+
+  /**
+   * \brief Send the pending data after the micro-delay that batches the writes
+   */
+  void SendPendingDataTimeout ();
+
+  /**
+   * \brief Create m_timers and add the timers of the connection
+   */
+  void CreateTimers ();
+
   /**
    * \brief Handle retransmission after loss
    */
-  void DoRetransmit (std::vector<QuicSocketTxItem*> lostPackets);
+  void DoRetransmit ();
 
   /**
    * \brief Extract at most maxSize bytes from the TxBuffer at sequence packetNumber, add the
@@ -593,7 +785,7 @@ protected:
    * \param withAck forces an ACK to be sent
    * \returns the number of bytes sent
    */
-  uint32_t SendDataPacket (SequenceNumber32 packetNumber, uint32_t maxSize,
+  uint32_t SendDataPacket (SequenceNumber64 packetNumber, uint32_t maxSize,
                            bool withAck);
 
   /**
@@ -613,6 +805,40 @@ protected:
    */
   uint32_t SendPendingData (bool withAck = false);
 
+  /**
+   * \brief Pull stream frames from the stream scheduler until the TX buffer
+   *        holds a full packet or no stream has data that can be sent
+   */
+  void PullStreamFrames ();
+
+  /**
+   * \brief Send a MAX_DATA frame if the peer needs more credit on the connection
+   */
+  void MaybeSendMaxData ();
+
+  /**
+   * \brief Set the pacing rate to the congestion window over the smoothed RTT,
+   *        scaled by the pacing gain, unless the congestion control sets it
+   *
+   * The rate is kept in TcpSocketState::m_currentPacingRate, and its changes
+   * are reported by the PacingRate trace source.
+   */
+  void ComputePacingRate ();
+
+  /**
+   * \brief Tune the ACK frequency requested to the peer from cWnd and the smoothed RTT
+   *
+   * The peer is asked for about four ACKs per congestion window and for a
+   * delayed ACK timeout of a quarter of the smoothed RTT; a new ACK_FREQUENCY
+   * frame is queued only when these values change.
+   */
+  void UpdateAckFrequency ();
+
+  /**
+   * \brief Send pending data when the pacing timer expires
+   */
+  void NotifyPacingPerformed ();
+
   /**
    * \brief Perform the real connection tasks: start the initial handshake for non-0-RTT
    *
@@ -659,11 +885,18 @@ protected:
   bool IsVersionSupported (uint32_t version);
 
   /**
-   * \brief Check if there are missing packets in the m_receivedPacketNumbers list
+   * \brief Check if the received packets are reordered enough to ACK them immediately
    *
+   * With a reordering threshold of 1, as in RFC 9000 (Sec. 13.2.1), a packet
+   * received out of order or a hole below the largest received packet
+   * triggers the ACK. With larger thresholds, the ACK is sent when the largest
+   * received packet is at least the threshold above the smallest hole not yet
+   * reported in an ACK frame (draft-ietf-quic-ack-frequency, Sec. 6.2).
+   *
+   * \param packetNumber the packet number of the received packet
    * \return true if there are missing packets
    */
-  bool HasReceivedMissing ();
+  bool HasReceivedMissing (uint64_t packetNumber);
 
   /**
    * \brief Send an ACK packet
@@ -687,7 +920,11 @@ protected:
   Ptr<QuicSocketTxBuffer> m_txBuffer;                     //!< TX buffer
   uint32_t m_socketTxBufferSize;                          //!< Size of the socket TX buffer
   uint32_t m_socketRxBufferSize;                          //!< Size of the socket RX buffer
-  std::vector<SequenceNumber32> m_receivedPacketNumbers;  //!< Received packet number vector
+  QuicAckRangeTracker m_receivedPacketNumbers;            //!< Ranges of received packet numbers
+  QuicAckRanges m_ackRanges;                              //!< Ranges of the ACK frame being built, reused across ACKs
+  std::map<SequenceNumber64, uint64_t> m_sentAckFrames;   //!< Largest acknowledged in the ACK frame carried by each sent packet
+  std::vector<QuicSocketTxItem*> m_ackedPackets;          //!< Packets acked by the last ACK, reused across ACKs
+  std::vector<QuicSocketTxItem*> m_lostPackets;           //!< Packets lost at the last ACK or loss timeout, reused across ACKs
 
   // State-related attributes
   TracedValue<QuicStates_t> m_socketState;  //!< State in the Congestion state machine
@@ -701,8 +938,14 @@ protected:
   Time m_lastReceived;                      //!< Time of last received packet
 
   // Transport Parameters values
-  uint32_t m_initial_max_stream_data;    //!< The initial value for the maximum data that can be sent on any newly created stream
-  uint32_t m_max_data;                   //!< The maximum amount of data that can be sent on the connection
+  uint64_t m_initial_max_stream_data;    //!< The initial value for the maximum data that can be sent on any newly created stream
+  uint64_t m_max_data;                   //!< The maximum amount of data that can be sent on the connection
+  uint64_t m_advertisedMaxStreamData;    //!< The initial maximum stream data advertised to the peer
+  QuicFlowController m_connectionFlowControl;  //!< Credit granted to the peer and blocked signals of the connection
+  double m_flowControlUpdateThreshold;   //!< Fraction of a receive window consumed before new credit is sent
+  uint32_t m_maxReceiveWindow;           //!< Largest connection receive window reached by autotuning
+  uint32_t m_maxStreamReceiveWindow;     //!< Largest stream receive window reached by autotuning
+  uint64_t m_reservedReceiveWindow;      //!< Memory of the node budget added to the receive windows of the connection
   uint32_t m_initial_max_stream_id_bidi; //!< The the initial maximum number of application-owned bidirectional streams the peer may initiate
   TracedValue<Time> m_idleTimeout;       //!< The idle timeout value in seconds
   bool m_omit_connection_id;             //!< The flag that indicates if the connection id is required in the upcoming connection
@@ -716,23 +959,56 @@ protected:
   bool m_couldContainTransportParameters;  //!< Check if in the actual conditions can receive Transport Parameters
 
   // Timers and Events
-  EventId m_sendPendingDataEvent;             //!< Micro-delay event to send pending data
-  EventId m_retxEvent;                        //!< Retransmission event
-  EventId m_idleTimeoutEvent;                 //!< Event triggered upon receiving or sending a packet, when it expires the connection closes
-  EventId m_drainingPeriodEvent;              //!< Event triggered upon idle timeout or immediate connection close, when it expires all closes
+  /**
+   * \brief The timers of the connection, in m_timers
+   */
+  typedef enum
+  {
+    SEND_PENDING_TIMER = 0,  //!< Micro-delay to send pending data
+    IDLE_TIMER,              //!< Pushed at each packet sent or received, when it expires the connection closes
+    DRAINING_TIMER,          //!< Armed upon idle timeout or immediate connection close, when it expires all closes
+    SEND_ACK_TIMER,          //!< Micro-delay to send an immediate ACK
+    DELAYED_ACK_TIMER,       //!< Delayed ACK timeout
+    LOSS_DETECTION_TIMER,    //!< Multi-modal alarm used for loss detection
+    PACING_TIMER             //!< Transmission slot of the next paced packet
+  } QuicTimer_t;
+
+  Ptr<QuicTimerMultiplexer> m_timers;         //!< The timers of the connection, sharing one scheduler event
   TracedValue<Time> m_rto;                    //!< Retransmit timeout
   TracedValue<Time> m_drainingPeriodTimeout;  //!< Draining Period timeout
-  EventId m_sendAckEvent;                     //!< Send ACK timeout event
-  EventId m_delAckEvent;                      //!< Delayed ACK timeout event
 
   // Congestion Control
   Ptr<QuicSocketState> m_tcb;                     //!< Congestion control informations
-  Ptr<TcpCongestionOps> m_congestionControl;      //!< Congestion control
+  Ptr<QuicCongestionOps> m_congestionControl;     //!< Congestion control
   TracedValue<Time> m_lastRtt;                                 //!< Latest measured RTT
-  bool m_quicCongestionControlLegacy;             //!< Quic Congestion control if true, TCP Congestion control if false
   bool m_queue_ack;                               //!< Indicates a request for a queue ACK if true
   uint32_t m_numPacketsReceivedSinceLastAckSent;  //!< Number of packets received since last ACK sent
 
+  // ACK frequency (draft-ietf-quic-ack-frequency)
+  Time m_minAckDelay;                             //!< Smallest delayed ACK timeout the peer can request, zero disables ACK_FREQUENCY
+  uint32_t m_maxAckElicitingThreshold;            //!< Largest ack-eliciting threshold requested to the peer
+  uint32_t m_ackElicitingThreshold;               //!< Ack-eliciting packets received before an immediate ACK
+  uint32_t m_ackReorderingThreshold;              //!< Packet reordering that triggers an immediate ACK, 0 to disable
+  Time m_ackDelayTimeout;                         //!< Delayed ACK timeout requested by the peer, zero to use kDelayedAckTimeout
+  uint64_t m_nextRxAckFrequencySequence;          //!< Smallest sequence number of a new ACK_FREQUENCY frame from the peer
+  bool m_immediateAckRequested;                   //!< True if the packet being received carries an IMMEDIATE_ACK frame
+  uint64_t m_largestReportedAck;                  //!< Largest acknowledged in the last ACK frame sent
+  Time m_peerMinAckDelay;                         //!< min_ack_delay of the peer, zero if it does not support ACK_FREQUENCY
+  uint64_t m_nextTxAckFrequencySequence;          //!< Sequence number of the next ACK_FREQUENCY frame sent
+  uint32_t m_requestedAckElicitingThreshold;      //!< Ack-eliciting threshold requested to the peer
+  Time m_requestedMaxAckDelay;                    //!< Delayed ACK timeout requested to the peer
+  bool m_ackFrequencyPending;                     //!< True if the next packet with data carries an ACK_FREQUENCY frame
+  SequenceNumber64 m_ackFrequencyPacket;          //!< Packet with the last ACK_FREQUENCY frame, 0 once acknowledged
+  bool m_immediateAckPending;                     //!< True if the next packet with data carries an IMMEDIATE_ACK frame
+
+  // Pacing
+  double m_pacingGain;                            //!< Gain applied to cWnd/sRTT to get the pacing rate
+  uint32_t m_pacingBurst;                         //!< Number of packets that can be sent back-to-back when pacing
+  DataRate m_tracedPacingRate;                    //!< Pacing rate last reported by the PacingRate trace
+  Time m_nextPacingTime;                          //!< Earliest time at which the next data packet can be paced out
+
+  TypeId m_streamSchedulerTypeId;                 //!< The stream scheduler type
+
   uint32_t m_initialPacketSize; //!< size of the first packet to be sent durin the handshake (at least 1200 bytes, per RFC)
 
   /**
@@ -750,15 +1026,20 @@ protected:
   */
   TracedCallback<TcpSocketState::TcpCongState_t, TcpSocketState::TcpCongState_t> m_congStateTrace;
 
+  /**
+  * \brief Callback pointer for pacing rate trace chaining
+  */
+  TracedCallback<DataRate, DataRate> m_pacingRateTrace;
+
   /**
   * \brief Callback pointer for high transmission mark trace chaining
   */
-  TracedCallback<uint32_t, uint32_t> m_highTxMarkTrace;
+  TracedCallback<SequenceNumber64, SequenceNumber64> m_highTxMarkTrace;
 
   /**
   * \brief Callback pointer for tx sequence trace chaining
   */
-  TracedCallback<uint32_t, uint32_t> m_nextTxSequenceTrace;
+  TracedCallback<SequenceNumber64, SequenceNumber64> m_nextTxSequenceTrace;
 
   // The following two traces pass a packet with a QUIC header
   TracedCallback<Ptr<const Packet>, const QuicHeader&,
@@ -766,6 +1047,8 @@ protected:
 
   TracedCallback<Ptr<const Packet>, const QuicHeader&,
                  Ptr<const QuicSocketBase> > m_rxTrace; //!< Trace of received packets
+
+  TracedCallback<DataRate, bool> m_deliveryRateTrace; //!< Trace of delivery rate samples
 };
 
 } //namespace ns3
@@ -155,7 +155,7 @@ private:
 
   QuicSocketRxPacketList m_socketRecvList;  //!< List of received packets with additional info
   uint32_t m_recvSize;                      //!< Current buffer occupancy
-  uint32_t m_recvSizeTot;                   //!< Total number of bytes received
+  uint64_t m_recvSizeTot;                   //!< Total number of bytes received
   uint32_t m_maxBuffer;                     //!< Maximum buffer size
 
 };
@@ -39,8 +39,23 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("QuicSocketTxBuffer");
 
+QuicStreamFrameRange::QuicStreamFrameRange ()
+  : m_streamId (0),
+    m_offset (0),
+    m_length (0)
+{
+}
+
+QuicStreamFrameRange::QuicStreamFrameRange (uint64_t streamId, uint64_t offset, uint32_t length)
+  : m_streamId (streamId),
+    m_offset (offset),
+    m_length (length)
+{
+}
+
 QuicSocketTxItem::QuicSocketTxItem ()
   : m_packet (0),
+    m_size (0),
     m_packetNumber (0),
     m_lost (false),
     m_retrans (false),
@@ -50,13 +65,18 @@ QuicSocketTxItem::QuicSocketTxItem ()
     m_isStream (false),
     m_isStream0 (false),
     m_lastSent (
-      Time::Min ())
+      Time::Min ()),
+    m_delivered (0),
+    m_deliveredTime (Seconds (0)),
+    m_firstSentTime (Seconds (0)),
+    m_isAppLimited (false)
 {
 
 }
 
 QuicSocketTxItem::QuicSocketTxItem (const QuicSocketTxItem &other)
   : m_packet (other.m_packet),
+    m_size (other.m_size),
     m_packetNumber (other.m_packetNumber),
     m_lost (
       other.m_lost),
@@ -67,7 +87,12 @@ QuicSocketTxItem::QuicSocketTxItem (const QuicSocketTxItem &other)
       other.m_isStream),
     m_isStream0 (other.m_isStream0),
     m_lastSent (
-      other.m_lastSent)
+      other.m_lastSent),
+    m_delivered (other.m_delivered),
+    m_deliveredTime (other.m_deliveredTime),
+    m_firstSentTime (other.m_firstSentTime),
+    m_isAppLimited (other.m_isAppLimited),
+    m_streamFrames (other.m_streamFrames)
 {
 
 }
@@ -77,7 +102,7 @@ QuicSocketTxItem::Print (std::ostream &os) const
 {
   NS_LOG_FUNCTION (this);
   os << "[SN " << m_packetNumber.GetValue () << " - Last Sent: " << m_lastSent
-     << " size " << m_packet->GetSize () << "]";
+     << " size " << (m_packet != 0 ? m_packet->GetSize () : m_size) << "]";
 
   if (m_lost)
     {
@@ -95,6 +120,26 @@ QuicSocketTxItem::Print (std::ostream &os) const
 
 NS_OBJECT_ENSURE_REGISTERED (QuicSocketTxBuffer);
 
+QuicRateSample::QuicRateSample ()
+  : m_deliveryRate (0),
+    m_isAppLimited (false),
+    m_interval (Seconds (0)),
+    m_delivered (0),
+    m_priorDelivered (0),
+    m_priorTime (Seconds (0)),
+    m_sendElapsed (Seconds (0)),
+    m_ackElapsed (Seconds (0)),
+    m_ackedBytes (0),
+    m_totalDelivered (0)
+{
+}
+
+bool
+QuicRateSample::IsValid () const
+{
+  return m_interval.IsStrictlyPositive ();
+}
+
 TypeId
 QuicSocketTxBuffer::GetTypeId (void)
 {
@@ -110,35 +155,68 @@ QuicSocketTxBuffer::GetTypeId (void)
 }
 
 QuicSocketTxBuffer::QuicSocketTxBuffer ()
-  : m_maxBuffer (32768),
+  : m_sentHead (0),
+    m_sentBase (0),
+    m_sentSpan (0),
+    m_sentCount (0),
+    m_lossCheckFrom (0),
+    m_largestAcked (0),
+    m_maxBuffer (32768),
     m_appSize (0),
     m_sentSize (0),
+    m_bytesInFlight (0),
     m_numFrameStream0InBuffer (
-      0)
+      0),
+    m_delivered (0),
+    m_deliveredTime (Seconds (0)),
+    m_firstSentTime (Seconds (0)),
+    m_appLimited (0),
+    m_rateSampleItem (0)
 {
-  m_appList = QuicTxPacketList ();
-  m_sentList = QuicTxPacketList ();
 }
 
-QuicSocketTxBuffer::~QuicSocketTxBuffer (void)
+QuicSocketTxBuffer::QuicSocketTxBuffer (const QuicSocketTxBuffer &other)
+  : Object (other),
+    m_sentHead (other.m_sentHead),
+    m_sentBase (other.m_sentBase),
+    m_sentSpan (other.m_sentSpan),
+    m_sentCount (other.m_sentCount),
+    m_lossCheckFrom (other.m_lossCheckFrom),
+    m_largestAcked (other.m_largestAcked),
+    m_maxBuffer (other.m_maxBuffer),
+    m_appSize (other.m_appSize),
+    m_sentSize (other.m_sentSize),
+    m_bytesInFlight (other.m_bytesInFlight),
+    m_numFrameStream0InBuffer (other.m_numFrameStream0InBuffer),
+    m_delivered (other.m_delivered),
+    m_deliveredTime (other.m_deliveredTime),
+    m_firstSentTime (other.m_firstSentTime),
+    m_appLimited (other.m_appLimited),
+    m_rateSample (other.m_rateSample),
+    m_rateSampleItem (0)
 {
-  QuicTxPacketList::iterator it;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (QuicTxPacketList::const_iterator it = other.m_appList.begin (); it != other.m_appList.end (); ++it)
     {
-      QuicSocketTxItem *item = *it;
-      m_sentSize -= item->m_packet->GetSize ();
-      delete item;
+      m_appList.push_back (m_itemPool.Acquire (**it));
     }
-
-  for (it = m_appList.begin (); it != m_appList.end (); ++it)
+  m_sentRing.resize (other.m_sentRing.size ());
+  for (uint32_t index = 0; index < other.m_sentRing.size (); ++index)
     {
-      QuicSocketTxItem *item = *it;
-      m_appSize -= item->m_packet->GetSize ();
-      delete item;
+      if (other.m_sentRing[index])
+        {
+          m_sentRing[index] = m_itemPool.Acquire (*other.m_sentRing[index]);
+          if (m_sentRing[index]->m_lost)
+            {
+              m_lostItems.push_back (m_sentRing[index].get ());
+            }
+        }
     }
 }
 
+QuicSocketTxBuffer::~QuicSocketTxBuffer (void)
+{
+}
+
 void
 QuicSocketTxBuffer::Print (std::ostream & os) const
 {
@@ -147,9 +225,12 @@ QuicSocketTxBuffer::Print (std::ostream & os) const
   std::stringstream ss;
   std::stringstream as;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (uint32_t index = 0; index < m_sentSpan; ++index)
     {
-      (*it)->Print (ss);
+      if (SentSlot (index) != 0)
+        {
+          SentSlot (index)->Print (ss);
+        }
     }
 
   for (it = m_appList.begin (); it != m_appList.end (); ++it)
@@ -159,7 +240,7 @@ QuicSocketTxBuffer::Print (std::ostream & os) const
 
   os << Simulator::Now ().GetSeconds () << "\nApp list: \n" << as.str () << "\n\nSent list: \n" << ss.str ()
      << "\n\nCurrent Status: " << "\nNumber of transmissions = "
-     << m_sentList.size () << "\nApplication Size = " << m_appSize
+     << m_sentCount << "\nApplication Size = " << m_appSize
      << "\nSent Size = " << m_sentSize;
 }
 
@@ -176,7 +257,7 @@ QuicSocketTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          QuicSocketTxItem *item = new QuicSocketTxItem ();
+          QuicSocketTxItemHandle item = m_itemPool.Acquire ();
           item->m_packet = p->Copy ();
           // check to which stream this packet belongs to
           uint32_t streamId = 0;
@@ -191,9 +272,15 @@ QuicSocketTxBuffer::Add (Ptr<Packet> p)
               NS_ABORT_MSG ("No QuicSubheader in this QUIC frame " << p);
             }
           item->m_isStream = isStream;
-          item->m_isStream0 = (streamId == 0);
-          m_numFrameStream0InBuffer += (streamId == 0);
-          m_appList.insert (m_appList.end (), item);
+          // control frames are not merged with stream data
+          item->m_isStream0 = (streamId == 0 or !isStream);
+          m_numFrameStream0InBuffer += item->m_isStream0;
+          if (!item->m_isStream0)
+            {
+              item->m_streamFrames.push_back (QuicStreamFrameRange (streamId, qsb.GetOffset (),
+                                                                    p->GetSize () - headerSize));
+            }
+          m_appList.push_back (std::move (item));
           m_appSize += p->GetSize ();
 
           NS_LOG_INFO ("Update: Application Size = " << m_appSize << ", offset " << qsb.GetOffset ());
@@ -210,29 +297,25 @@ QuicSocketTxBuffer::Add (Ptr<Packet> p)
 }
 
 Ptr<Packet>
-QuicSocketTxBuffer::NextStream0Sequence (const SequenceNumber32 seq)
+QuicSocketTxBuffer::NextStream0Sequence (const SequenceNumber64 seq)
 {
   NS_LOG_FUNCTION (this << seq);
 
-  QuicSocketTxItem* outItem = new QuicSocketTxItem ();
-
   QuicTxPacketList::iterator it = m_appList.begin ();
   while (it != m_appList.end ())
     {
-      Ptr<Packet> currentPacket = (*it)->m_packet;
-
       if ((*it)->m_isStream0)
         {
+          QuicSocketTxItemHandle outItem = std::move (*it);
+          m_appList.erase (it);
           outItem->m_packetNumber = seq;
           outItem->m_lastSent = Now ();
-          outItem->m_packet = currentPacket;
-          outItem->m_isStream0 = (*it)->m_isStream0;
-          m_appList.erase (it);
-          m_appSize -= currentPacket->GetSize ();
-          m_sentList.insert (m_sentList.end (), outItem);
-          m_sentSize += outItem->m_packet->GetSize ();
-          --m_numFrameStream0InBuffer;
+          m_appSize -= outItem->m_packet->GetSize ();
+          OnPacketSentRate (outItem.get ());
+          // the frames are kept to be sent again if the packet is lost
           Ptr<Packet> toRet = outItem->m_packet->Copy ();
+          AddSent (std::move (outItem));
+          --m_numFrameStream0InBuffer;
           return toRet;
         }
       it++;
@@ -242,18 +325,23 @@ QuicSocketTxBuffer::NextStream0Sequence (const SequenceNumber32 seq)
 
 Ptr<Packet>
 QuicSocketTxBuffer::NextSequence (uint32_t numBytes,
-                                  const SequenceNumber32 seq)
+                                  const SequenceNumber64 seq)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
-  QuicSocketTxItem* outItem = GetNewSegment (numBytes);
+  QuicSocketTxItemHandle outItem = GetNewSegment (numBytes);
 
-  if (outItem != nullptr)
+  if (outItem)
     {
       NS_LOG_INFO ("Extracting " << outItem->m_packet->GetSize () << " bytes");
       outItem->m_packetNumber = seq;
       outItem->m_lastSent = Now ();
-      Ptr<Packet> toRet = outItem->m_packet->Copy ();
+      OnPacketSentRate (outItem.get ());
+      QuicSocketTxItem *item = outItem.get ();
+      AddSent (std::move (outItem));
+      // the stream data stays in the stream buffers until it is acked
+      Ptr<Packet> toRet = item->m_packet;
+      item->m_packet = 0;
       return toRet;
     }
   else
@@ -264,281 +352,265 @@ QuicSocketTxBuffer::NextSequence (uint32_t numBytes,
 
 }
 
-QuicSocketTxItem*
+QuicItemPool<QuicSocketTxItem>::Handle
 QuicSocketTxBuffer::GetNewSegment (uint32_t numBytes)
 {
   NS_LOG_FUNCTION (this << numBytes);
 
-  bool toInsert = false;
-  bool firstSegment = true;
-  Ptr<Packet> currentPacket = 0;
-  QuicSocketTxItem *currentItem = 0;
-  QuicSocketTxItem *outItem = new QuicSocketTxItem ();
+  QuicSocketTxItemHandle outItem = m_itemPool.Acquire ();
   outItem->m_isStream = true;   // Packets sent with this method are always stream packets
   outItem->m_isStream0 = false;
   outItem->m_packet = Create<Packet> ();
   uint32_t outItemSize = 0;
-  QuicTxPacketList::iterator it = m_appList.begin ();
 
-  while (it != m_appList.end () && outItemSize < numBytes)
+  // Merge complete frames from the head of the application list
+  while (!m_appList.empty ()
+         && outItemSize + m_appList.front ()->m_packet->GetSize () <= numBytes)
     {
-      currentItem = *it;
-      currentPacket = currentItem->m_packet;
-
-      if (outItemSize + currentItem->m_packet->GetSize ()   /*- subheaderSize*/
-          <= numBytes)       // Merge
-        {
-          NS_LOG_LOGIC ("Add complete frame to the outItem - size "
-                        << currentItem->m_packet->GetSize ()
-                        << " m_appSize " << m_appSize);
-          QuicSubheader qsb;
-          currentPacket->PeekHeader (qsb);
-          toInsert = true;
-          MergeItems (*outItem, *currentItem);
-          outItemSize += currentItem->m_packet->GetSize ();
+      QuicSocketTxItem *currentItem = m_appList.front ().get ();
+      uint32_t currentSize = currentItem->m_packet->GetSize ();
+      NS_LOG_LOGIC ("Add complete frame to the outItem - size " << currentSize);
+      MergeItems (*outItem, *currentItem);
+      outItemSize += currentSize;
+      m_appSize -= currentSize;
+      m_appList.pop_front ();
+    }
 
-          m_appList.erase (it);
-          m_appSize -= currentItem->m_packet->GetSize ();
+  // We cannot transmit the next frame in full, so split it and update the subheaders
+  if (!m_appList.empty () && outItemSize < numBytes)
+    {
+      QuicSocketTxItem *currentItem = m_appList.front ().get ();
+      Ptr<Packet> currentPacket = currentItem->m_packet;
+      QuicSubheader qsb;
+      currentPacket->PeekHeader (qsb);
 
-          delete currentItem;
+      uint64_t oldOffset = qsb.GetOffset ();
+      bool oldOffBit = !(oldOffset == 0);
+      uint32_t available = numBytes - outItemSize;
+      uint32_t fixedSize = QuicSubheader::GetStreamSubHeaderSize (qsb.GetStreamId (), oldOffset, 0, oldOffBit, false);
 
-          it = m_appList.begin ();   // restart to identify if there are other packets that can be merged
-          NS_LOG_LOGIC ("Updating application buffer size: " << m_appSize);
-          continue;
-        }
-      else if (firstSegment)  // we cannot transmit a full packet, so let's split it and update the subheaders
+      if (available > fixedSize + 1)
         {
-          firstSegment = false;
-
-          // subtract the whole packet from m_appSize, then add the remaining fragment (need to account for headers)
-          uint32_t removed = currentItem->m_packet->GetSize ();
-          m_appSize -= removed;
-
-          // get the currentPacket subheader
-          QuicSubheader qsb;
-          currentPacket->PeekHeader (qsb);
-
-          // new packet size
-          int newPacketSizeInt = (int)numBytes - outItemSize - qsb.GetSerializedSize ();
-          if (newPacketSizeInt <= 0)
-            {
-              NS_LOG_LOGIC ("Not enough bytes even for the header");
-              m_appSize += removed;
-              break;
-            }
+          // the length field of the first part cannot be longer than the one needed for the whole space
+          uint32_t newPacketSize = available - fixedSize
+            - QuicSubheader::GetVarInt64Size (available - fixedSize) / 8;
+          uint32_t removed = currentPacket->GetSize ();
           currentPacket->RemoveHeader (qsb);
-          uint32_t newPacketSize = (uint32_t)newPacketSizeInt;
+          uint32_t totPacketSize = currentPacket->GetSize ();
+          NS_ASSERT_MSG (newPacketSize > 0 && newPacketSize < totPacketSize,
+                         "Wrong split size " << newPacketSize << " of " << totPacketSize);
 
           NS_LOG_LOGIC ("Add incomplete frame to the outItem");
-          toInsert = true;
-          uint32_t totPacketSize = currentItem->m_packet->GetSize ();
-          NS_LOG_LOGIC ("Extracted " << outItemSize << " bytes");
-
-          uint32_t oldOffset = qsb.GetOffset ();
-          uint32_t newOffset = oldOffset + newPacketSize;
-          bool oldOffBit = !(oldOffset == 0);
-          bool newOffBit = true;
-          uint32_t oldLength = qsb.GetLength ();
-          uint32_t newLength = 0;
-          bool newLengthBit = true;
-          newLength = totPacketSize - newPacketSize;
-          if (oldLength == 0)
-            {
-              newLengthBit = false;
-            }
-          bool lengthBit = true;
-          bool oldFinBit = qsb.IsStreamFin ();
-          bool newFinBit = false;
+          uint64_t newOffset = oldOffset + newPacketSize;
+          uint32_t newLength = totPacketSize - newPacketSize;
+          bool newLengthBit = !(qsb.GetLength () == 0);
 
           QuicSubheader newQsbToTx = QuicSubheader::CreateStreamSubHeader (qsb.GetStreamId (),
-                                                                           oldOffset, newPacketSize, oldOffBit, lengthBit, newFinBit);
+                                                                           oldOffset, newPacketSize, oldOffBit, true, false);
           QuicSubheader newQsbToBuffer = QuicSubheader::CreateStreamSubHeader (qsb.GetStreamId (),
-                                                                               newOffset, newLength, newOffBit, newLengthBit, oldFinBit);
+                                                                               newOffset, newLength, true, newLengthBit, qsb.IsStreamFin ());
           newQsbToTx.SetMaxStreamData (qsb.GetMaxStreamData ());
           newQsbToBuffer.SetMaxStreamData (qsb.GetMaxStreamData ());
 
-          Ptr<Packet> firstPartPacket = currentItem->m_packet->CreateFragment (
-              0, newPacketSize);
-          NS_ASSERT_MSG (firstPartPacket->GetSize () == newPacketSize,
-                         "Wrong size " << firstPartPacket->GetSize ());
+          Ptr<Packet> firstPartPacket = currentPacket->CreateFragment (0, newPacketSize);
           firstPartPacket->AddHeader (newQsbToTx);
-          firstPartPacket->Print (std::cerr);
 
           NS_LOG_LOGIC ("Split packet, putting second part back in application buffer");
 
-          Ptr<Packet> secondPartPacket = currentItem->m_packet->CreateFragment (
-              newPacketSize, newLength);
+          Ptr<Packet> secondPartPacket = currentPacket->CreateFragment (newPacketSize, newLength);
           secondPartPacket->AddHeader (newQsbToBuffer);
 
-          QuicSocketTxItem *toBeBuffered = new QuicSocketTxItem (*currentItem);
-          toBeBuffered->m_packet = secondPartPacket;
-          currentItem->m_packet = firstPartPacket;
-
-          MergeItems (*outItem, *currentItem);
-          outItemSize += currentItem->m_packet->GetSize ();
-
-          m_appList.erase (it);
-          m_appList.push_front (toBeBuffered);
-          m_appSize += toBeBuffered->m_packet->GetSize ();
-          // check correctness of application size
-          uint32_t check = m_appSize;
-          for (auto itc = m_appList.begin ();
-               itc != m_appList.end () and !m_appList.empty (); ++itc)
-            {
-              check -= (*itc)->m_packet->GetSize ();
-            }
-          if (check != 0)
-            {
-              outItemSize += 0;
-            }
-
-          delete currentItem;
+          // the first part is sent, the item keeps the second one at the head of the list
+          QuicSocketTxItem firstPart (*currentItem);
+          firstPart.m_packet = firstPartPacket;
+          firstPart.m_streamFrames.assign (1, QuicStreamFrameRange (qsb.GetStreamId (), oldOffset, newPacketSize));
+          currentItem->m_packet = secondPartPacket;
+          currentItem->m_streamFrames.assign (1, QuicStreamFrameRange (qsb.GetStreamId (), newOffset, newLength));
 
-          NS_LOG_LOGIC ("Buffer size: " << m_appSize << " (put back " << toBeBuffered->m_packet->GetSize () << " bytes)");
+          MergeItems (*outItem, firstPart);
+          outItemSize += firstPartPacket->GetSize ();
+          m_appSize -= removed;
+          m_appSize += secondPartPacket->GetSize ();
 
-          it = m_appList.begin ();   // restart to identify if there are other packets that can be merged
-          break; // at most one segment
+          NS_LOG_LOGIC ("Buffer size: " << m_appSize << " (put back " << secondPartPacket->GetSize () << " bytes)");
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Not enough bytes even for the header");
         }
-
-      it++;
     }
 
-  if (toInsert)
+  NS_LOG_INFO ("Update: remaining App Size " << m_appSize << " object size " << outItemSize);
+
+  if (outItemSize == 0)
     {
-      NS_LOG_LOGIC ("Adding packet to sent buffer");
-      m_sentList.insert (m_sentList.end (), outItem);
-      m_sentSize += outItem->m_packet->GetSize ();
+      return QuicSocketTxItemHandle ();
     }
-
-  NS_LOG_INFO ("Update: Sent Size = " << m_sentSize << " remaining App Size " << m_appSize << " object size " << outItemSize);
-
-  //Print(std::cout);
-
   return outItem;
 }
 
-std::vector<QuicSocketTxItem*>
+void
 QuicSocketTxBuffer::OnAckUpdate (
-  Ptr<TcpSocketState> tcb, const uint32_t largestAcknowledged,
-  const std::vector<uint32_t> &additionalAckBlocks,
-  const std::vector<uint32_t> &gaps)
+  QuicSocketState &tcb, const uint64_t largestAcknowledged,
+  const std::vector<uint64_t> &additionalAckBlocks,
+  const std::vector<uint64_t> &gaps,
+  std::vector<QuicSocketTxItem*> &newlyAcked,
+  std::vector<QuicSocketTxItem*> &lost)
 {
-  NS_LOG_FUNCTION (this);
-  std::vector<uint32_t> compAckBlocks = additionalAckBlocks;
-  std::vector<uint32_t> compGaps = gaps;
-
-  std::vector<QuicSocketTxItem*> newlyAcked;
-  Ptr<QuicSocketState> tcbd = dynamic_cast<QuicSocketState*> (&(*tcb));
-
-  compAckBlocks.insert (compAckBlocks.begin (), largestAcknowledged);
-  uint32_t ackBlockCount = compAckBlocks.size ();
-
-  std::vector<uint32_t>::const_iterator ack_it = compAckBlocks.begin ();
-  std::vector<uint32_t>::const_iterator gap_it = compGaps.begin ();
-
-  std::stringstream gap_print;
-  for (auto i = gaps.begin (); i != gaps.end (); ++i)
-    {
-      gap_print << (*i) << " ";
-    }
-
-  std::stringstream block_print;
-  for (auto i = compAckBlocks.begin (); i != compAckBlocks.end (); ++i)
+  NS_ASSERT (additionalAckBlocks.size () == gaps.size ());
+  QuicAckRanges ackRanges;
+  for (uint32_t i = 0; i < gaps.size (); ++i)
     {
-      block_print << (*i) << " ";
+      ackRanges.Add (gaps[i], additionalAckBlocks[i]);
     }
+  OnAckUpdate (tcb, largestAcknowledged, ackRanges, newlyAcked, lost);
+}
 
-  NS_LOG_INFO ("Largest ACK: " << largestAcknowledged
-                               << ", blocks: " << block_print.str () << ", gaps: " << gap_print.str ());
-
-  // Iterate over the ACK blocks and gaps
-  for (uint32_t numAckBlockAnalyzed = 0; numAckBlockAnalyzed < ackBlockCount;
-       ++numAckBlockAnalyzed, ++ack_it, ++gap_it)
+void
+QuicSocketTxBuffer::OnAckUpdate (QuicSocketState &tcb, const uint64_t largestAcknowledged,
+                                 const QuicAckRanges &ackRanges,
+                                 std::vector<QuicSocketTxItem*> &newlyAcked,
+                                 std::vector<QuicSocketTxItem*> &lost)
+{
+  NS_LOG_FUNCTION (this);
+  // the items removed since the last ACK are no longer referenced
+  m_retired.clear ();
+
+  newlyAcked.clear ();
+  lost.clear ();
+  uint32_t ackedBytes = 0;
+  m_rateSampleItem = 0;
+
+  NS_LOG_INFO ("Largest ACK: " << largestAcknowledged << ", " << ackRanges.GetCount () << " gaps");
+
+  // ACK block 0 covers the packet numbers in (gap 0, largestAcknowledged],
+  // ACK block i > 0 covers (gap i, additional block i - 1]; the last block
+  // has no lower gap and extends down to the oldest packet
+  uint32_t ackBlockCount = ackRanges.GetCount () + 1;
+  for (uint32_t numAckBlockAnalyzed = 0; numAckBlockAnalyzed < ackBlockCount && m_sentSpan > 0;
+       ++numAckBlockAnalyzed)
     {
-      for (auto sent_it = m_sentList.rbegin ();
-           sent_it != m_sentList.rend () and !m_sentList.empty (); ++sent_it)  // Visit sentList in reverse Order for optimization
+      uint64_t ack = numAckBlockAnalyzed == 0 ? largestAcknowledged
+        : ackRanges.GetBlock (numAckBlockAnalyzed - 1);
+      uint64_t high = std::min (ack, m_sentBase + m_sentSpan - 1);
+      uint64_t low = m_sentBase;
+      if (numAckBlockAnalyzed < ackRanges.GetCount ()
+          && ackRanges.GetGap (numAckBlockAnalyzed) + 1 > low)
         {
-          NS_LOG_LOGIC ("Consider packet " << (*sent_it)->m_packetNumber
-                                           << " (ACK block " << SequenceNumber32 ((*ack_it)) << ")");
-          // The packet is in the next gap
-          bool inGap = (gap_it != compGaps.end ()) && ((*sent_it)->m_packetNumber <= SequenceNumber32 ((*gap_it)));
-          if (inGap)   // Just for optimization we suppose All is perfectly ordered
-            {
-              NS_LOG_LOGIC ("Packet " << (*sent_it)->m_packetNumber << " missing");
-              break;
-            }
-          // The packet is in the current block: ACK it
-          NS_LOG_LOGIC ("Packet " << (*sent_it)->m_packetNumber << " ACKed");
-          bool notInGap = ((gap_it == compGaps.end ()) || ((*sent_it)->m_packetNumber > SequenceNumber32 ((*gap_it))));
-
-          if ((*sent_it)->m_packetNumber <= SequenceNumber32 ((*ack_it))
-              and notInGap
-              and (*sent_it)->m_sacked == false)
+          low = ackRanges.GetGap (numAckBlockAnalyzed) + 1;
+        }
+      if (low > high)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("ACK block [" << low << ", " << high << "]");
+      // visit the block in reverse order, so that newly acked packets are ordered from the highest
+      for (uint32_t index = high - m_sentBase + 1; index-- > (uint32_t) (low - m_sentBase); )
+        {
+          QuicSocketTxItem *item = SentSlot (index);
+          if (item != 0 && item->m_sacked == false)
             {
-              (*sent_it)->m_sacked = true;
-              (*sent_it)->m_ackTime = Now ();
-              newlyAcked.push_back ((*sent_it));
+              NS_LOG_LOGIC ("Packet " << item->m_packetNumber << " ACKed");
+              item->m_sacked = true;
+              item->m_ackTime = Now ();
+              if (CountsInFlight (item))
+                {
+                  m_bytesInFlight -= item->m_size;
+                }
+              ackedBytes += item->m_size;
+              OnPacketDeliveredRate (item);
+              newlyAcked.push_back (item);
             }
-
         }
     }
-  NS_LOG_LOGIC ("Mark lost packets");
-  // Mark packets as lost as in RFC (Sec. 4.2.1 of draft-ietf-quic-recovery-15)
-  uint32_t index = m_sentList.size ();
-  bool lost = false;
-  bool outstanding = false;
-  auto acked_it = m_sentList.rend ();
-  // Iterate over the sent packet list in reverse
-  for (auto sent_it = m_sentList.rbegin ();
-       sent_it != m_sentList.rend () and !m_sentList.empty ();
-       ++sent_it, --index)
+
+  GenerateRateSample (tcb, ackedBytes);
+
+  m_largestAcked = std::max (m_largestAcked, largestAcknowledged);
+  MarkLostPackets (tcb, lost);
+
+  // Clean up acked packets
+  CleanSentList ();
+}
+
+void
+QuicSocketTxBuffer::MarkLostPackets (QuicSocketState &tcb, std::vector<QuicSocketTxItem*> &lost)
+{
+  NS_LOG_FUNCTION (this);
+  tcb.m_lossTime = Seconds (0);
+  std::size_t firstLost = lost.size ();
+
+  // Mark packets as lost as in RFC 9002, Sec. 6.1. Packets below
+  // m_lossCheckFrom are already either acked or lost, so the scan starts
+  // from the point reached with the previous largest ACK
+  Time lossDelay = tcb.GetLossDelay ();
+  uint64_t lowest = std::max (m_lossCheckFrom, m_sentBase);
+  uint64_t highest = std::min (m_largestAcked, m_sentBase + m_sentSpan);
+  bool lostBelow = false;
+  for (uint64_t pn = highest; pn-- > lowest; )
     {
+      QuicSocketTxItem *item = GetSent (pn);
+      if (item == 0 || item->m_sacked || item->m_lost)
+        {
+          continue;
+        }
       // All previous packets are lost
-      if (lost)
+      if (lostBelow)
         {
-          if (!(*sent_it)->m_sacked)
-            {
-              (*sent_it)->m_lost = true;
-              NS_LOG_LOGIC ("Packet " << (*sent_it)->m_packetNumber << " lost");
-            }
+          SetLost (item);
+          lost.push_back (item);
+          NS_LOG_LOGIC ("Packet " << item->m_packetNumber << " lost");
+          continue;
         }
-      else
+      // Packet threshold
+      if (m_largestAcked - pn >= tcb.m_kReorderingThreshold)
+        {
+          SetLost (item);
+          lost.push_back (item);
+          lostBelow = true;
+          NS_LOG_INFO ("Largest ACK " << m_largestAcked << ", lost packet " << pn << " - reordering " << tcb.m_kReorderingThreshold);
+        }
+      // Time threshold
+      else if (tcb.m_kUsingTimeLossDetection)
         {
-          // The packet is the last ACKed packet
-          if ((*sent_it)->m_packetNumber.GetValue () == largestAcknowledged)
+          if (item->m_lastSent + lossDelay <= Now ())
             {
-              // Mark the packet as ACKed
-              acked_it = sent_it;
-              outstanding = true;
+              SetLost (item);
+              lost.push_back (item);
+              lostBelow = true;
+              NS_LOG_INFO ("Largest ACK " << m_largestAcked << ", lost packet " << pn << " - time " << lossDelay.GetSeconds ());
             }
-          else if (outstanding && !(*sent_it)->m_sacked)
+          else if (tcb.m_lossTime.IsZero () || item->m_lastSent + lossDelay < tcb.m_lossTime)
             {
-              //ACK-based detection
-              if (largestAcknowledged - (*sent_it)->m_packetNumber.GetValue () >= tcbd->m_kReorderingThreshold)
-                {
-                  (*sent_it)->m_lost = true;
-                  lost = true;
-                  NS_LOG_INFO ("Largest ACK " << largestAcknowledged << ", lost packet " << (*sent_it)->m_packetNumber.GetValue () << " - reordering " << tcbd->m_kReorderingThreshold);
-                }
-              // Time-based detection (optional)
-              if (tcbd->m_kUsingTimeLossDetection)
-                {
-                  double lhsComparison = ((*acked_it)->m_ackTime - (*sent_it)->m_lastSent).GetSeconds();
-                  double rhsComparison = tcbd->m_kTimeReorderingFraction * tcbd->m_smoothedRtt.GetSeconds();
-                  if (lhsComparison >= rhsComparison)
-                    {
-                      NS_LOG_UNCOND ("Largest ACK " << largestAcknowledged << ", lost packet " << (*sent_it)->m_packetNumber.GetValue () << " - time " << rhsComparison);
-                      (*sent_it)->m_lost = true;
-                      lost = true;
-                    }
-                }
+              // the packet will be lost if it is not acked by then
+              tcb.m_lossTime = item->m_lastSent + lossDelay;
             }
         }
     }
+  // the scan went down from the highest packet number
+  std::reverse (lost.begin () + firstLost, lost.end ());
+  if (m_largestAcked + 1 > tcb.m_kReorderingThreshold)
+    {
+      m_lossCheckFrom = std::max (m_lossCheckFrom,
+                                  m_largestAcked + 1 - tcb.m_kReorderingThreshold);
+    }
+}
 
-  // Clean up acked packets and return new ACKed packet vector
-  CleanSentList ();
-  return newlyAcked;
+bool
+QuicSocketTxBuffer::MarkOldestAsLost ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t index = 0; index < m_sentSpan; ++index)
+    {
+      QuicSocketTxItem *item = SentSlot (index);
+      // only the packets counted in flight arm the probe timeout
+      if (item != 0 && CountsInFlight (item) && !item->m_sacked && !item->m_lost)
+        {
+          SetLost (item);
+          return true;
+        }
+    }
+  return false;
 }
 
 void
@@ -546,116 +618,329 @@ QuicSocketTxBuffer::ResetSentList (uint32_t keepItems)
 {
   NS_LOG_FUNCTION (this << keepItems);
   uint32_t kept = 0;
-  for (auto sent_it = m_sentList.rbegin ();
-       sent_it != m_sentList.rend () and !m_sentList.empty ();
-       ++sent_it, kept++)
+  for (uint32_t index = m_sentSpan; index-- > 0; )
     {
-      if (kept >= keepItems && !(*sent_it)->m_sacked)
+      QuicSocketTxItem *item = SentSlot (index);
+      if (item == 0)
         {
-          (*sent_it)->m_lost = true;
+          continue;
+        }
+      if (kept >= keepItems && !item->m_sacked)
+        {
+          SetLost (item);
         }
+      kept++;
     }
 }
 
 bool
-QuicSocketTxBuffer::MarkAsLost (const SequenceNumber32 seq)
+QuicSocketTxBuffer::MarkAsLost (const SequenceNumber64 seq)
 {
   NS_LOG_FUNCTION (this << seq);
-  bool found = false;
-  for (auto sent_it = m_sentList.begin ();
-       sent_it != m_sentList.end () and !m_sentList.empty (); ++sent_it)
+  QuicSocketTxItem *item = GetSent (seq.GetValue ());
+  if (item != 0)
     {
-      if ((*sent_it)->m_packetNumber == seq)
-        {
-          found = true;
-          (*sent_it)->m_lost = true;
-        }
+      SetLost (item);
+      return true;
     }
-  return found;
+  return false;
 }
 
 uint32_t
-QuicSocketTxBuffer::Retransmission (SequenceNumber32 packetNumber)
+QuicSocketTxBuffer::Retransmission (std::vector<QuicStreamFrameRange> &lostFrames)
 {
   NS_LOG_FUNCTION (this);
   uint32_t toRetx = 0;
-  // First pass: add lost packets to the application buffer
-  for (auto sent_it = m_sentList.rbegin (); sent_it != m_sentList.rend ();
-       ++sent_it)
+  // First pass, from the highest packet number: hand the stream data back to
+  // the streams, and add the other lost frames to the application buffer
+  std::sort (m_lostItems.begin (), m_lostItems.end (),
+             [] (const QuicSocketTxItem *a, const QuicSocketTxItem *b)
+             { return a->m_packetNumber > b->m_packetNumber; });
+  for (auto it = m_lostItems.begin (); it != m_lostItems.end (); ++it)
     {
-      QuicSocketTxItem *item = *sent_it;
-      if (item->m_lost)
+      QuicSocketTxItem *item = *it;
+      if (!item->m_isStream0)
         {
-          // Add lost packet contents to app buffer
-          QuicSocketTxItem *retx = new QuicSocketTxItem ();
-          retx->m_packetNumber = packetNumber;
-          retx->m_isStream = item->m_isStream;
-          retx->m_isStream0 = item->m_isStream0;
-          retx->m_packet = Create<Packet> ();
-          NS_LOG_LOGIC ("Add packet " << retx->m_packetNumber.GetValue () << " to retx packet");
-          MergeItems (*retx, *item);
-          retx->m_lost = false;
-          retx->m_retrans = true;
-          m_appList.insert (m_appList.begin (), retx);
-          m_appSize += retx->m_packet->GetSize ();
-          toRetx += retx->m_packet->GetSize ();
-          NS_LOG_INFO ("Retransmit packet " << (*sent_it)->m_packetNumber);
+          NS_LOG_INFO ("Packet " << item->m_packetNumber << " lost, " << item->m_streamFrames.size ()
+                                 << " stream frames to retransmit");
+          lostFrames.insert (lostFrames.end (), item->m_streamFrames.begin (), item->m_streamFrames.end ());
+          continue;
         }
+      // Add lost packet contents to app buffer
+      QuicSocketTxItemHandle retx = m_itemPool.Acquire ();
+      retx->m_isStream = item->m_isStream;
+      retx->m_isStream0 = item->m_isStream0;
+      retx->m_packet = Create<Packet> ();
+      MergeItems (*retx, *item);
+      retx->m_lost = false;
+      retx->m_retrans = true;
+      m_appSize += retx->m_packet->GetSize ();
+      ++m_numFrameStream0InBuffer;
+      toRetx += retx->m_packet->GetSize ();
+      m_appList.push_front (std::move (retx));
+      NS_LOG_INFO ("Retransmit packet " << item->m_packetNumber);
     }
 
   NS_LOG_LOGIC ("Remove retransmitted packets from sent list");
-  auto sent_it = m_sentList.begin ();
   // Remove lost packets from the sent list
-  while (!m_sentList.empty () && sent_it != m_sentList.end ())
+  for (auto it = m_lostItems.begin (); it != m_lostItems.end (); ++it)
     {
-      QuicSocketTxItem *item = *sent_it;
-      if (item->m_lost)
-        {
-          // Remove lost packet from sent vector
-          m_sentSize -= item->m_packet->GetSize ();
-          sent_it = m_sentList.erase (sent_it);
-        }
-      else
-        {
-          sent_it++;
-        }
+      RemoveSent ((*it)->m_packetNumber.GetValue () - m_sentBase);
     }
+  m_lostItems.clear ();
+  TrimSent ();
   return toRetx;
 }
 
-std::vector<QuicSocketTxItem*>
-QuicSocketTxBuffer::DetectLostPackets ()
+void
+QuicSocketTxBuffer::DetectLostPackets (std::vector<QuicSocketTxItem*> &lost)
+{
+  NS_LOG_FUNCTION (this);
+  lost.assign (m_lostItems.begin (), m_lostItems.end ());
+  std::sort (lost.begin (), lost.end (),
+             [] (const QuicSocketTxItem *a, const QuicSocketTxItem *b)
+             { return a->m_packetNumber < b->m_packetNumber; });
+  NS_LOG_INFO (lost.size () << " packets lost");
+}
+
+void
+QuicSocketTxBuffer::CleanSentList ()
 {
   NS_LOG_FUNCTION (this);
-  std::vector<QuicSocketTxItem*> lost;
+  TrimSent ();
+  // All packets up to here are ACKed (already sent to the receiver app)
+  while (m_sentSpan > 0 && SentSlot (0)->m_sacked && !SentSlot (0)->m_lost)
+    {
+      // Remove ACKed packet from sent vector
+      QuicSocketTxItem *item = SentSlot (0);
+      item->m_acked = true;
+      NS_LOG_LOGIC ("Packet " << item->m_packetNumber << " received and ACKed. Removing from sent buffer");
+      RemoveSent (0);
+      TrimSent ();
+    }
+}
+
+void
+QuicSocketTxBuffer::AddSent (QuicSocketTxItemHandle item)
+{
+  NS_LOG_FUNCTION (this << item->m_packetNumber);
+
+  uint64_t packetNumber = item->m_packetNumber.GetValue ();
+  if (m_sentCount == 0)
+    {
+      m_sentBase = packetNumber;
+      m_sentSpan = 0;
+    }
+  NS_ABORT_MSG_IF (packetNumber < m_sentBase + m_sentSpan,
+                   "Packet " << packetNumber << " sent after packet " << m_sentBase + m_sentSpan - 1);
 
-  for (auto sent_it = m_sentList.begin ();
-       sent_it != m_sentList.end () and !m_sentList.empty (); ++sent_it)
+  uint32_t index = packetNumber - m_sentBase;
+  if (index >= m_sentRing.size ())
     {
-      if ((*sent_it)->m_lost)
+      // grow the ring, moving the oldest packet to the first slot
+      uint32_t size = std::max<uint32_t> (m_sentRing.size (), 64);
+      while (size <= index)
         {
-          lost.push_back ((*sent_it));
-          NS_LOG_INFO ("Packet " << (*sent_it)->m_packetNumber << " is lost");
+          size *= 2;
         }
+      std::vector<QuicSocketTxItemHandle> ring (size);
+      for (uint32_t i = 0; i < m_sentSpan; ++i)
+        {
+          ring[i] = std::move (SentHandle (i));
+        }
+      m_sentRing.swap (ring);
+      m_sentHead = 0;
+    }
+
+  for (uint32_t i = m_sentSpan; i < index; ++i)
+    {
+      SentHandle (i).reset ();
+    }
+  item->m_size = item->m_packet->GetSize ();
+  m_sentSize += item->m_size;
+  if (CountsInFlight (item.get ()) && !item->m_sacked)
+    {
+      m_bytesInFlight += item->m_size;
+    }
+  SentHandle (index) = std::move (item);
+  m_sentSpan = index + 1;
+  ++m_sentCount;
+}
+
+bool
+QuicSocketTxBuffer::SetLost (QuicSocketTxItem *item)
+{
+  if (item->m_lost)
+    {
+      return false;
+    }
+  item->m_lost = true;
+  m_lostItems.push_back (item);
+  return true;
+}
+
+bool
+QuicSocketTxBuffer::CountsInFlight (const QuicSocketTxItem *item)
+{
+  return item->m_isStream && !item->m_isStream0;
+}
+
+QuicSocketTxItem*
+QuicSocketTxBuffer::GetSent (uint64_t packetNumber) const
+{
+  if (packetNumber < m_sentBase || packetNumber - m_sentBase >= m_sentSpan)
+    {
+      return 0;
+    }
+  return SentSlot (packetNumber - m_sentBase);
+}
+
+QuicSocketTxBuffer::QuicSocketTxItemHandle&
+QuicSocketTxBuffer::SentHandle (uint32_t index)
+{
+  return m_sentRing[(m_sentHead + index) & (m_sentRing.size () - 1)];
+}
+
+QuicSocketTxItem*
+QuicSocketTxBuffer::SentSlot (uint32_t index) const
+{
+  return m_sentRing[(m_sentHead + index) & (m_sentRing.size () - 1)].get ();
+}
+
+void
+QuicSocketTxBuffer::RemoveSent (uint32_t index)
+{
+  QuicSocketTxItemHandle &item = SentHandle (index);
+  NS_ASSERT (item);
+  m_sentSize -= item->m_size;
+  if (CountsInFlight (item.get ()) && !item->m_sacked)
+    {
+      m_bytesInFlight -= item->m_size;
     }
-  return lost;
+  m_retired.push_back (std::move (item));
+  --m_sentCount;
 }
 
 void
-QuicSocketTxBuffer::CleanSentList ()
+QuicSocketTxBuffer::TrimSent ()
+{
+  while (m_sentSpan > 0 && SentSlot (0) == 0)
+    {
+      m_sentHead = (m_sentHead + 1) & (m_sentRing.size () - 1);
+      ++m_sentBase;
+      --m_sentSpan;
+    }
+}
+
+void
+QuicSocketTxBuffer::OnPacketSentRate (QuicSocketTxItem *item)
 {
   NS_LOG_FUNCTION (this);
-  auto sent_it = m_sentList.begin ();
-  // All packets up to here are ACKed (already sent to the receiver app)
-  while (!m_sentList.empty () && (*sent_it)->m_sacked && !(*sent_it)->m_lost)
+
+  if (m_sentCount == 0)
     {
-      // Remove ACKed packet from sent vector
-      QuicSocketTxItem *item = *sent_it;
-      item->m_acked = true;
-      m_sentSize -= item->m_packet->GetSize ();
-      m_sentList.erase (sent_it);
-      NS_LOG_LOGIC ("Packet " << (*sent_it)->m_packetNumber << " received and ACKed. Removing from sent buffer");
-      sent_it = m_sentList.begin ();
+      // Start a new delivery interval after an idle period
+      m_firstSentTime = Now ();
+      m_deliveredTime = Now ();
+    }
+  item->m_delivered = m_delivered;
+  item->m_deliveredTime = m_deliveredTime;
+  item->m_firstSentTime = m_firstSentTime;
+  item->m_isAppLimited = m_appLimited != 0;
+}
+
+void
+QuicSocketTxBuffer::OnPacketDeliveredRate (QuicSocketTxItem *item)
+{
+  NS_LOG_FUNCTION (this << item->m_packetNumber);
+
+  m_delivered += item->m_size;
+  m_deliveredTime = Now ();
+
+  if (m_rateSampleItem == 0
+      || item->m_lastSent > m_rateSampleItem->m_lastSent
+      || (item->m_lastSent == m_rateSampleItem->m_lastSent
+          && item->m_delivered > m_rateSampleItem->m_delivered))
+    {
+      m_rateSampleItem = item;
+      // The next interval starts with the transmission of this packet
+      m_firstSentTime = item->m_lastSent;
+    }
+}
+
+void
+QuicSocketTxBuffer::GenerateRateSample (const QuicSocketState &tcb, uint32_t ackedBytes)
+{
+  NS_LOG_FUNCTION (this << ackedBytes);
+
+  if (m_appLimited != 0 && m_delivered > m_appLimited)
+    {
+      NS_LOG_LOGIC ("Application limited phase over");
+      m_appLimited = 0;
+    }
+
+  QuicRateSample rs;
+  rs.m_ackedBytes = ackedBytes;
+  rs.m_totalDelivered = m_delivered;
+  if (m_rateSampleItem == 0)
+    {
+      m_rateSample = rs;
+      return;
+    }
+
+  QuicSocketTxItem *item = m_rateSampleItem;
+  m_rateSampleItem = 0;
+  rs.m_priorDelivered = item->m_delivered;
+  rs.m_priorTime = item->m_deliveredTime;
+  rs.m_isAppLimited = item->m_isAppLimited;
+  rs.m_delivered = m_delivered - item->m_delivered;
+  rs.m_sendElapsed = item->m_lastSent - item->m_firstSentTime;
+  rs.m_ackElapsed = m_deliveredTime - item->m_deliveredTime;
+  Time interval = std::max (rs.m_sendElapsed, rs.m_ackElapsed);
+
+  // An interval shorter than the RTT comes from ACK compression or
+  // from a bogus delivery state, and would overestimate the rate
+  Time minRtt = Now () - item->m_lastSent;
+  if (tcb.m_minRtt.IsStrictlyPositive ())
+    {
+      minRtt = std::min (minRtt, tcb.m_minRtt);
+    }
+  if (interval < minRtt)
+    {
+      NS_LOG_LOGIC ("Rate sample interval " << interval << " below min RTT " << minRtt);
+      m_rateSample = rs;
+      return;
+    }
+
+  rs.m_interval = interval;
+  rs.m_deliveryRate = DataRate (rs.m_delivered * 8 / interval.GetSeconds ());
+  m_rateSample = rs;
+  NS_LOG_INFO ("Rate sample " << rs.m_deliveryRate << " delivered " << rs.m_delivered
+                              << " interval " << interval << " app limited " << rs.m_isAppLimited);
+}
+
+const QuicRateSample&
+QuicSocketTxBuffer::GetRateSample () const
+{
+  return m_rateSample;
+}
+
+uint64_t
+QuicSocketTxBuffer::GetDelivered () const
+{
+  return m_delivered;
+}
+
+void
+QuicSocketTxBuffer::CheckAppLimited (uint32_t cWnd)
+{
+  NS_LOG_FUNCTION (this << cWnd);
+
+  uint32_t inFlight = BytesInFlight ();
+  if (m_appSize == 0 && inFlight < cWnd)
+    {
+      m_appLimited = std::max<uint64_t> (m_delivered + inFlight, 1);
+      NS_LOG_LOGIC ("Application limited until " << m_appLimited << " bytes are delivered");
     }
 }
 
@@ -700,6 +985,7 @@ QuicSocketTxBuffer::MergeItems (QuicSocketTxItem &t1,
     }
 
   t1.m_packet->AddAtEnd (t2.m_packet);
+  t1.m_streamFrames.insert (t1.m_streamFrames.end (), t2.m_streamFrames.begin (), t2.m_streamFrames.end ());
 }
 
 uint32_t
@@ -736,24 +1022,10 @@ uint32_t
 QuicSocketTxBuffer::BytesInFlight () const
 {
   NS_LOG_FUNCTION (this);
-
-  uint32_t inFlight = 0;
-
-  for (auto sent_it = m_sentList.begin ();
-       sent_it != m_sentList.end () and !m_sentList.empty (); ++sent_it)
-    {
-      if (!(*sent_it)->m_isStream0 && (*sent_it)->m_isStream
-          && !(*sent_it)->m_sacked)
-        {
-          inFlight += (*sent_it)->m_packet->GetSize ();
-        }
-    }
-
-  NS_LOG_INFO ("Compute bytes in flight " << inFlight
-                                          << " m_sentSize " << m_sentSize
-                                          << " m_appSize " << m_appSize);
-  return inFlight;
-
+  NS_LOG_INFO ("Bytes in flight " << m_bytesInFlight
+                                  << " m_sentSize " << m_sentSize
+                                  << " m_appSize " << m_appSize);
+  return m_bytesInFlight;
 }
 
 }
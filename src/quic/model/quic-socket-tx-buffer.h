@@ -25,20 +25,58 @@
 #ifndef QUICSOCKETTXBUFFER_H
 #define QUICSOCKETTXBUFFER_H
 
+#include <vector>
+#include <list>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
 #include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "quic-header.h"
 #include "quic-subheader.h"
 #include "ns3/packet.h"
 #include "ns3/tcp-socket-base.h"
+#include "quic-item-pool.h"
 
 namespace ns3 {
 
+class QuicSocketState;
+
+/**
+ * \ingroup quic
+ *
+ * \brief Range of stream data carried by a packet
+ *
+ * The data of a lost packet is not sent again as a unit: its ranges are
+ * handed back to the streams, which send them again in new frames.
+ */
+class QuicStreamFrameRange
+{
+public:
+  QuicStreamFrameRange ();
+  /**
+   * \brief Constructor
+   *
+   * \param streamId the stream ID
+   * \param offset the stream offset of the first byte
+   * \param length the number of bytes
+   */
+  QuicStreamFrameRange (uint64_t streamId, uint64_t offset, uint32_t length);
+
+  uint64_t m_streamId;              //!< stream ID
+  uint64_t m_offset;                //!< stream offset of the first byte
+  uint32_t m_length;                //!< number of bytes
+};
+
 /**
  * \ingroup quic
  *
  * \brief Item that encloses the application packet and some flags for it
+ *
+ * Once a packet with stream data is sent, the item keeps only its metadata:
+ * the stream data stays in the stream TX buffers until it is acked, and is
+ * read again from there if the packet is lost. The frames of stream 0 and
+ * the control frames are kept, to be sent again as they are.
  */
 class QuicSocketTxItem
 {
@@ -52,23 +90,145 @@ public:
    */
   void Print (std::ostream &os) const;
 
-  Ptr<Packet> m_packet;             //!< packet associated to this QuicSocketTxItem
-  SequenceNumber32 m_packetNumber;  //!< sequence number
+  Ptr<Packet> m_packet;             //!< packet associated to this QuicSocketTxItem, 0 for sent stream data
+  uint32_t m_size;                  //!< size of the packet, set when it is sent
+  SequenceNumber64 m_packetNumber;  //!< sequence number
   bool m_lost;                      //!< true if the packet is lost
   bool m_retrans;                   //!< true if it is a retx
   bool m_sacked;                    //!< true if already acknowledged
   bool m_acked;                     //!< true if already passed to the application
   bool m_isStream;                  //!< true for frames of a stream (not control)
-  bool m_isStream0;                 //!< true for a frame from stream 0
+  bool m_isStream0;                 //!< true for a frame from stream 0 or a control frame, sent in its own packet
   Time m_lastSent;                  //!< time at which it was sent
   Time m_ackTime;                   //!< time at which the packet was first acked (if m_sacked is true)
+  uint64_t m_delivered;             //!< bytes delivered by the connection when the packet was sent
+  Time m_deliveredTime;             //!< time of the last delivery when the packet was sent
+  Time m_firstSentTime;             //!< send time of the first packet of the delivery interval
+  bool m_isAppLimited;              //!< true if the connection was application limited when the packet was sent
+  std::vector<QuicStreamFrameRange> m_streamFrames;  //!< stream data carried by the packet (stream 0 excluded)
+
+};
+
+/**
+ * \ingroup quic
+ *
+ * \brief Read-only view of a sequence of items of the TX buffer
+ *
+ * The items acked or lost by an ACK are handed to the congestion control as a
+ * view of the vector filled by the TX buffer, without copying it. The view is
+ * valid as long as the vector is not modified.
+ */
+class QuicSocketTxItemSpan
+{
+public:
+  typedef QuicSocketTxItem* const* const_iterator;  //!< iterator over the items
+
+  QuicSocketTxItemSpan ()
+    : m_begin (0),
+      m_size (0)
+  {
+  }
+
+  /**
+   * \brief Constructor
+   *
+   * \param items the vector of items to view
+   */
+  QuicSocketTxItemSpan (const std::vector<QuicSocketTxItem*> &items)
+    : m_begin (items.data ()),
+      m_size (items.size ())
+  {
+  }
+
+  const_iterator begin () const
+  {
+    return m_begin;
+  }
+
+  const_iterator end () const
+  {
+    return m_begin + m_size;
+  }
+
+  uint32_t size () const
+  {
+    return m_size;
+  }
+
+  bool empty () const
+  {
+    return m_size == 0;
+  }
+
+  QuicSocketTxItem* operator[] (uint32_t index) const
+  {
+    return m_begin[index];
+  }
+
+  QuicSocketTxItem* front () const
+  {
+    return m_begin[0];
+  }
+
+  QuicSocketTxItem* back () const
+  {
+    return m_begin[m_size - 1];
+  }
+
+private:
+  QuicSocketTxItem* const* m_begin;  //!< first item
+  uint32_t m_size;                   //!< number of items
+};
+
+/**
+ * \ingroup quic
+ *
+ * \brief Delivery rate sample generated by an ACK
+ *
+ * The sample covers the delivery interval of the most recently sent packet
+ * among the newly acked ones (draft-cheng-iccrg-delivery-rate-estimation).
+ * The interval is the longer of its send and ACK phases, so that neither
+ * ACK compression nor bursty sending inflate the rate.
+ */
+class QuicRateSample
+{
+public:
+  QuicRateSample ();
 
+  /**
+   * \brief Check whether the sample can be used to estimate the delivery rate
+   *
+   * \return true if the ACK delivered a packet and the interval is plausible
+   */
+  bool IsValid () const;
+
+  DataRate m_deliveryRate;    //!< delivery rate over the interval (zero if not valid)
+  bool m_isAppLimited;        //!< true if the interval was application limited
+  Time m_interval;            //!< length of the sampling interval (zero if not valid)
+  uint64_t m_delivered;       //!< bytes delivered over the interval
+  uint64_t m_priorDelivered;  //!< bytes delivered by the connection at the start of the interval
+  Time m_priorTime;           //!< time of the last delivery at the start of the interval
+  Time m_sendElapsed;         //!< send phase of the interval
+  Time m_ackElapsed;          //!< ACK phase of the interval
+  uint32_t m_ackedBytes;      //!< bytes newly acked by the ACK
+  uint64_t m_totalDelivered;  //!< bytes delivered by the connection up to the ACK
 };
 
 /**
  * \ingroup quic
  *
  * \brief Tx socket buffer for QUIC
+ *
+ * The items of the buffer are taken from a pool owned by the buffer, and go
+ * back to it when they leave the buffer. The items removed from the sent
+ * packets (acked or retransmitted) are retired until the next ACK, so the
+ * pointers collected by OnAckUpdate, MarkLostPackets and DetectLostPackets
+ * stay valid until OnAckUpdate is called again. The caller owns the vectors
+ * they fill, and can reuse them across ACKs.
+ *
+ * The bytes in flight are counted as the packets are sent and acked, and the
+ * packets marked as lost are kept in a list until they are retransmitted, so
+ * that the work done on an ACK does not grow with the packets in flight.
  */
 class QuicSocketTxBuffer : public Object
 {
@@ -80,6 +240,12 @@ public:
   static TypeId GetTypeId (void);
 
   QuicSocketTxBuffer ();
+  /**
+   * \brief Copy constructor, the items are copied in the pool of the new buffer
+   *
+   * \param other the buffer to copy
+   */
+  QuicSocketTxBuffer (const QuicSocketTxBuffer &other);
   virtual ~QuicSocketTxBuffer (void);
 
   /**
@@ -102,24 +268,29 @@ public:
   /**
    * \brief Request the next packet to transmit
    *
+   * The packet is handed over to the caller, and only its metadata is kept
+   * in the sent list.
+   *
    * \param numBytes the number of bytes of the next packet to transmit requested
    * \param seq the sequence number of the next packet to transmit
    * \return the next packet to transmit
    */
-  Ptr<Packet> NextSequence (uint32_t numBytes, const SequenceNumber32 seq);
+  Ptr<Packet> NextSequence (uint32_t numBytes, const SequenceNumber64 seq);
 
   /**
-   * \brief Get a block of data not transmitted yet and move it into SentList
+   * \brief Get a block of data not transmitted yet and remove it from the application list
+   *
+   * The caller is responsible for numbering the item and adding it to the sent packets.
    *
    * \param numBytes number of bytes of the QuicSocketTxItem requested
-   * \return the item that contains the right packet
+   * \return the item that contains the right packet, or an empty handle if no data could be extracted
    */
-  QuicSocketTxItem* GetNewSegment (uint32_t numBytes);
+  QuicItemPool<QuicSocketTxItem>::Handle GetNewSegment (uint32_t numBytes);
 
   /**
    * Process an acknowledgment, set the packets in the send buffer as acknowledged, mark
-   * lost packets (according to the QUIC IETF draft) and return pointers to the newly
-   * acked packets
+   * lost packets (according to the QUIC IETF draft) and collect pointers to the newly
+   * acked and newly lost packets
    *
    * \brief Process an ACK
    *
@@ -127,9 +298,23 @@ public:
    * \param largestAcknowledged The largest acknowledged sequence number
    * \param additionalAckBlocks The sequence numbers that were just acknowledged
    * \param gaps The gaps in the acknowledgment
-   * \return a vector containing the newly acked packets for congestion control purposes
+   * \param newlyAcked Cleared and filled with the newly acked packets, for congestion control purposes
+   * \param lost Cleared and filled with the packets marked as lost by the ACK, see MarkLostPackets
+   */
+  void OnAckUpdate (QuicSocketState &tcb, const uint64_t largestAcknowledged, const std::vector<uint64_t> &additionalAckBlocks, const std::vector<uint64_t> &gaps, std::vector<QuicSocketTxItem*> &newlyAcked, std::vector<QuicSocketTxItem*> &lost);
+
+  /**
+   * \brief Process an ACK
+   *
+   * Same as above, with the ranges read directly from the ACK frame.
+   *
+   * \param tcb The state of the socket (used for loss detection)
+   * \param largestAcknowledged The largest acknowledged sequence number
+   * \param ackRanges The gaps and additional ACK blocks of the ACK frame
+   * \param newlyAcked Cleared and filled with the newly acked packets, for congestion control purposes
+   * \param lost Cleared and filled with the packets marked as lost by the ACK, see MarkLostPackets
    */
-  std::vector<QuicSocketTxItem*> OnAckUpdate (Ptr<TcpSocketState> tcb, const uint32_t largestAcknowledged, const std::vector<uint32_t> &additionalAckBlocks, const std::vector<uint32_t> &gaps);
+  void OnAckUpdate (QuicSocketState &tcb, const uint64_t largestAcknowledged, const QuicAckRanges &ackRanges, std::vector<QuicSocketTxItem*> &newlyAcked, std::vector<QuicSocketTxItem*> &lost);
 
   /**
    * Get the max size of the buffer
@@ -146,11 +331,11 @@ public:
   void SetMaxBufferSize (uint32_t n);
 
   /**
-   * \brief Get all the packets marked as lost
+   * \brief Get all the packets marked as lost and not retransmitted yet
    *
-   * \return a vector containing the packets marked as lost
+   * \param lost Cleared and filled with the packets marked as lost, by increasing packet number
    */
-  std::vector<QuicSocketTxItem*> DetectLostPackets ();
+  void DetectLostPackets (std::vector<QuicSocketTxItem*> &lost);
 
   /**
    * Compute the available space in the buffer
@@ -187,7 +372,7 @@ public:
    * \param seq the sequence number of the packet
    * \return a smart pointer to the packet, 0 if there are no packets from stream 0
    */
-  Ptr<Packet> NextStream0Sequence (const SequenceNumber32 seq);
+  Ptr<Packet> NextStream0Sequence (const SequenceNumber64 seq);
 
   /**
    * \brief Reset the sent list
@@ -201,28 +386,163 @@ public:
    */
   void ResetSentList (uint32_t keepItems = 1);
 
+  /**
+   * \brief Mark as lost the packets sent before the largest acknowledged one by
+   *   the packet or the time threshold (RFC 9002, Sec. 6.1)
+   *
+   * Called on every ACK, and when the loss time expires. The time at which
+   * the oldest of the remaining packets will be lost is set in m_lossTime of
+   * the socket state (zero if none).
+   *
+   * \param tcb The state of the socket
+   * \param lost The packets marked as lost are appended to it, by increasing packet number
+   */
+  void MarkLostPackets (QuicSocketState &tcb, std::vector<QuicSocketTxItem*> &lost);
+
+  /**
+   * \brief Mark the oldest packet in flight as lost, to send its data again in a probe
+   *
+   * \return true if there is a packet in flight
+   */
+  bool MarkOldestAsLost ();
+
   /**
    * Mark a packet as lost
    * \param the sequence number of the packet
    * \return true if the packet is in the send buffer
    */
-  bool MarkAsLost (const SequenceNumber32 seq);
+  bool MarkAsLost (const SequenceNumber64 seq);
+
+  /**
+   * \brief Remove the lost packets from the sent list
+   *
+   * The control and stream 0 frames of the lost packets are put at the
+   * beginning of the application buffer to retransmit them. The stream data
+   * is returned instead, so that the streams send it again in new frames,
+   * possibly together with new data.
+   *
+   * \param lostFrames filled with the stream data of the lost packets
+   * \return the number of bytes put back in the application buffer
+   */
+  uint32_t Retransmission (std::vector<QuicStreamFrameRange> &lostFrames);
+
+  /**
+   * \brief Get the delivery rate sample generated by the last ACK
+   *
+   * \return the sample computed by the last call to OnAckUpdate
+   */
+  const QuicRateSample& GetRateSample () const;
+
+  /**
+   * \brief Get the total number of bytes delivered to the peer
+   *
+   * \return the number of acknowledged bytes since the beginning of the connection
+   */
+  uint64_t GetDelivered () const;
 
   /**
-   * Put the lost packets at the beginning of the application buffer to retransmit them
-   * \param the sequence number of the retransmitted packet
-   * \return the number of lost bytes
+   * \brief Mark the connection as application limited if there is no data to
+   *   send and the congestion window is not full: the delivery rate samples
+   *   taken until the packets in flight are acked do not measure the path
+   *
+   * \param cWnd the congestion window
    */
-  uint32_t Retransmission (SequenceNumber32 packetNumber);
+  void CheckAppLimited (uint32_t cWnd);
 
 private:
-  typedef std::list<QuicSocketTxItem*> QuicTxPacketList;  //!< container for data stored in the buffer
+  typedef QuicItemPool<QuicSocketTxItem>::Handle QuicSocketTxItemHandle;  //!< owning handle of an item
+  typedef std::list<QuicSocketTxItemHandle> QuicTxPacketList;  //!< container for data stored in the buffer
 
   /**
    * \brief Discard acknowledged data from the sent list
    */
   void CleanSentList ();
 
+  /**
+   * \brief Append a sent item to the sent packet ring
+   *
+   * Packet numbers must be strictly increasing; the slots of the packet
+   * numbers that are skipped (e.g., ACK-only packets) are left empty.
+   *
+   * \param item the item, with its packet number already set
+   */
+  void AddSent (QuicSocketTxItemHandle item);
+
+  /**
+   * \brief Mark a sent item as lost, and queue it for retransmission
+   *
+   * \param item the item
+   * \return true if the item was not already marked as lost
+   */
+  bool SetLost (QuicSocketTxItem *item);
+
+  /**
+   * \brief Check whether a sent item is counted in the bytes in flight
+   *
+   * \param item the item
+   * \return true for the packets with stream data, until they are acked
+   */
+  static bool CountsInFlight (const QuicSocketTxItem *item);
+
+  /**
+   * \brief Get the item sent with a given packet number
+   *
+   * \param packetNumber the packet number
+   * \return the item, or 0 if no item with that packet number is in the sent ring
+   */
+  QuicSocketTxItem* GetSent (uint64_t packetNumber) const;
+
+  /**
+   * \brief Get the handle stored in a slot of the sent packet ring
+   *
+   * \param index the slot, counting from the oldest packet number (m_sentBase)
+   * \return the handle, empty if the slot is empty
+   */
+  QuicSocketTxItemHandle& SentHandle (uint32_t index);
+
+  /**
+   * \brief Get the item stored in a slot of the sent packet ring
+   *
+   * \param index the slot, counting from the oldest packet number (m_sentBase)
+   * \return the item, or 0 if the slot is empty
+   */
+  QuicSocketTxItem* SentSlot (uint32_t index) const;
+
+  /**
+   * \brief Remove an item from the sent packet ring (the item is retired until the next ACK)
+   *
+   * \param index the slot, counting from the oldest packet number (m_sentBase)
+   */
+  void RemoveSent (uint32_t index);
+
+  /**
+   * \brief Drop the empty slots at the head of the sent packet ring
+   */
+  void TrimSent ();
+
+  /**
+   * \brief Snapshot the delivery state of the connection in a packet being sent
+   *
+   * \param item the item being sent
+   */
+  void OnPacketSentRate (QuicSocketTxItem *item);
+
+  /**
+   * \brief Account for a newly acked packet, and use it as the start of the
+   *   delivery interval if it is the most recently sent
+   *
+   * \param item the newly acked item
+   */
+  void OnPacketDeliveredRate (QuicSocketTxItem *item);
+
+  /**
+   * \brief Generate the rate sample of an ACK, once all its packets are processed
+   *
+   * \param tcb the state of the socket
+   * \param ackedBytes the number of newly acked bytes
+   */
+  void GenerateRateSample (const QuicSocketState &tcb, uint32_t ackedBytes);
+
   /**
    * \brief Merge two QuicSocketTxItem
    *
@@ -238,12 +558,33 @@ private:
   // Available only for streams
   void SplitItems (QuicSocketTxItem &t1, QuicSocketTxItem &t2, uint32_t size) const;
 
+  QuicItemPool<QuicSocketTxItem> m_itemPool;  //!< Pool of the items, declared first to outlive them
   QuicTxPacketList m_appList;          //!< List of buffered application packets to be transmitted with additional info
-  QuicTxPacketList m_sentList;         //!< List of sent packets with additional info
+  // Sent packets are stored in a ring indexed by packet number: the item
+  // sent with packet number n is in slot (m_sentHead + n - m_sentBase)
+  // modulo the ring size, which is always a power of two
+  std::vector<QuicSocketTxItemHandle> m_sentRing;  //!< Ring of sent packets with additional info
+  std::vector<QuicSocketTxItemHandle> m_retired;   //!< Items removed from the ring since the last ACK
+  std::vector<QuicSocketTxItem*> m_lostItems;      //!< Items of the ring marked as lost, until they are retransmitted
+  uint32_t m_sentHead;                 //!< Ring position of the oldest tracked packet number
+  uint64_t m_sentBase;                 //!< Oldest tracked packet number
+  uint32_t m_sentSpan;                 //!< Number of packet numbers tracked from m_sentBase
+  uint32_t m_sentCount;                //!< Number of items in the sent ring
+  uint64_t m_lossCheckFrom;            //!< Packets below this number are either acked or already marked as lost
+  uint64_t m_largestAcked;             //!< Largest packet number acknowledged by the peer
   uint32_t m_maxBuffer;                //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_appSize;                  //!< Size of all data in the application list
   uint32_t m_sentSize;                 //!< Size of all data in the sent list
+  uint32_t m_bytesInFlight;            //!< Size of the packets of the sent list counted in flight
   uint32_t m_numFrameStream0InBuffer;  //!< Number of Stream 0 frames buffered
+
+  // Delivery rate estimation
+  uint64_t m_delivered;                //!< Bytes delivered to the peer
+  Time m_deliveredTime;                //!< Time of the last delivery
+  Time m_firstSentTime;                //!< Send time of the packet that started the current delivery interval
+  uint64_t m_appLimited;               //!< Delivered count at which the application limited phase ends (0 if not app limited)
+  QuicRateSample m_rateSample;         //!< Rate sample of the last ACK
+  QuicSocketTxItem *m_rateSampleItem;  //!< Most recently sent packet acked by the ACK being processed
 };
 
 
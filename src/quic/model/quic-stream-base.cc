@@ -34,6 +34,7 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/nstime.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "quic-stream-base.h"
@@ -65,6 +66,22 @@ QuicStreamBase::GetTypeId (void)
                    MakeUintegerAccessor (&QuicStreamBase::GetStreamRcvBufSize,
                                          &QuicStreamBase::SetStreamRcvBufSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Priority",
+                   "Stream priority for the strict priority scheduler, lower values are served first",
+                   UintegerValue (3),      // default urgency in RFC 9218
+                   MakeUintegerAccessor (&QuicStreamBase::m_priority),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("Weight",
+                   "Stream weight for the weighted fair scheduler",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&QuicStreamBase::m_weight),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Deadline",
+                   "Time within which the data written on the stream should be sent, "
+                   "for the earliest deadline first scheduler (zero for no deadline)",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&QuicStreamBase::m_deadline),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -89,7 +106,10 @@ QuicStreamBase::QuicStreamBase (void)
     m_maxStreamData (0),
     m_sentSize (0),
     m_recvSize (0),
-    m_fin (false)
+    m_fin (false),
+    m_priority (3),
+    m_weight (1),
+    m_deadline (Seconds (0))
 {
   NS_LOG_FUNCTION (this);
   m_rxBuffer = CreateObject<QuicStreamRxBuffer> ();
@@ -125,11 +145,19 @@ QuicStreamBase::Send (Ptr<Packet> frame)
 
       if ((m_streamStateSend == OPEN or m_streamStateSend == SEND) and AvailableWindow () > 0)
         {
-          if (!m_streamSendPendingDataEvent.IsRunning ())
+          if (m_streamId != 0)
+            {
+              m_quicl5->NotifyStreamDataAvailable ();
+            }
+          else if (!m_streamSendPendingDataEvent.IsRunning ())
             {
               m_streamSendPendingDataEvent = Simulator::Schedule (TimeStep (1), &QuicStreamBase::SendPendingData, this);
             }
         }
+      else
+        {
+          CheckBlocked ();
+        }
       return sent;
     }
   else
@@ -201,7 +229,7 @@ QuicStreamBase::SendPendingData (void)
                     "BytesInFlight " << m_txBuffer->BytesInFlight () << "BufferedSize " << m_txBuffer->AppSize () <<
                     "MaxPacketSize " << (uint32_t)m_quicl5->GetMaxPacketSize ());
 
-      int success = SendDataFrame ((SequenceNumber32)m_sentSize, s);
+      int success = SendDataFrame (SequenceNumber64 (m_sentSize), s);
 
       availableWindow = AvailableWindow ();
 
@@ -232,7 +260,7 @@ QuicStreamBase::SendPendingData (void)
 }
 
 uint32_t
-QuicStreamBase::SendDataFrame (SequenceNumber32 seq, uint32_t maxSize)
+QuicStreamBase::SendDataFrame (SequenceNumber64 seq, uint32_t maxSize)
 {
   NS_LOG_FUNCTION (this);
 
@@ -246,9 +274,7 @@ QuicStreamBase::SendDataFrame (SequenceNumber32 seq, uint32_t maxSize)
   bool lengthBit = true;
 
   QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (m_streamId, (uint64_t)seq.GetValue (), frame->GetSize (), m_sentSize != 0, lengthBit, m_fin);
-  sub.SetMaxStreamData (m_recvSize + m_rxBuffer->Available ());
   m_sentSize += frame->GetSize ();
-  NS_LOG_DEBUG ("Sending RWND = " << sub.GetMaxStreamData ());
 
   frame->AddHeader (sub);
   int size = m_quicl5->Send (frame);
@@ -267,11 +293,148 @@ QuicStreamBase::SendDataFrame (SequenceNumber32 seq, uint32_t maxSize)
   return size;
 }
 
+int
+QuicStreamBase::SendNextFrame (uint32_t maxFrameSize)
+{
+  NS_LOG_FUNCTION (this << maxFrameSize);
+
+  uint32_t sendable = GetSendableSize ();
+  uint32_t headerSize = QuicSubheader::GetStreamSubHeaderSize (m_streamId, m_sentSize, sendable,
+                                                               m_sentSize != 0, true);
+  if (sendable == 0 or maxFrameSize <= headerSize)
+    {
+      NS_LOG_INFO ("No frame fits in " << maxFrameSize << " bytes");
+      return 0;
+    }
+
+  int size = SendDataFrame (SequenceNumber64 (m_sentSize), std::min (sendable, maxFrameSize - headerSize));
+  CheckBlocked ();
+  return size;
+}
+
+int
+QuicStreamBase::SendLostFrame (uint32_t maxFrameSize)
+{
+  NS_LOG_FUNCTION (this << maxFrameSize);
+
+  uint32_t lost = m_txBuffer->GetLostSize ();
+  uint64_t offset = m_txBuffer->GetLostOffset ();
+  uint32_t headerSize = QuicSubheader::GetStreamSubHeaderSize (m_streamId, offset, lost,
+                                                               offset != 0, true);
+  if (lost == 0 or maxFrameSize <= headerSize)
+    {
+      NS_LOG_INFO ("No lost frame fits in " << maxFrameSize << " bytes");
+      return 0;
+    }
+
+  Ptr<Packet> frame = m_txBuffer->NextLostSequence (maxFrameSize - headerSize);
+  uint32_t length = frame->GetSize ();
+  bool fin = m_fin and offset + length == m_sentSize and m_txBuffer->AppSize () == 0;
+  QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (m_streamId, offset, length,
+                                                            offset != 0, true, fin);
+  frame->AddHeader (sub);
+  int size = m_quicl5->Send (frame);
+  if (size < 0)
+    {
+      NS_LOG_WARN ("Sending error - could not append packet to socket buffer. Keeping the data as lost");
+      m_txBuffer->OnFrameLost (offset, length);
+    }
+  else
+    {
+      NS_LOG_INFO ("Retransmit " << length << " bytes at offset " << offset);
+    }
+  return size;
+}
+
+uint32_t
+QuicStreamBase::GetLostSize () const
+{
+  return m_txBuffer->GetLostSize ();
+}
+
+void
+QuicStreamBase::OnFrameAcked (uint64_t offset, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << offset << length);
+  m_txBuffer->OnFrameAcked (offset, length);
+}
+
+void
+QuicStreamBase::OnFrameLost (uint64_t offset, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << offset << length);
+
+  // the data of a reset stream is not delivered anymore
+  if (m_streamStateSend == RESET_SENT or m_streamStateSend == RESET_RECVD)
+    {
+      NS_LOG_INFO ("Stream reset, do not retransmit");
+      return;
+    }
+  m_txBuffer->OnFrameLost (offset, length);
+}
+
+uint32_t
+QuicStreamBase::GetSendableSize () const
+{
+  return std::min (m_txBuffer->AppSize (), AvailableWindow ());
+}
+
+Time
+QuicStreamBase::GetNextDeadline () const
+{
+  if (m_deadline.IsZero () or m_txBuffer->AppSize () == 0)
+    {
+      return Time::Max ();
+    }
+  return m_txBuffer->HeadQueuedTime () + m_deadline;
+}
+
+void
+QuicStreamBase::SetPriority (uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) priority);
+  m_priority = priority;
+}
+
+uint8_t
+QuicStreamBase::GetPriority () const
+{
+  return m_priority;
+}
+
+void
+QuicStreamBase::SetWeight (uint32_t weight)
+{
+  NS_LOG_FUNCTION (this << weight);
+  NS_ABORT_MSG_IF (weight == 0, "The stream weight must be positive");
+  m_weight = weight;
+}
+
+uint32_t
+QuicStreamBase::GetWeight () const
+{
+  return m_weight;
+}
+
+void
+QuicStreamBase::SetDeadline (Time deadline)
+{
+  NS_LOG_FUNCTION (this << deadline);
+  m_deadline = deadline;
+}
+
+Time
+QuicStreamBase::GetDeadline () const
+{
+  return m_deadline;
+}
+
 uint32_t
 QuicStreamBase::AvailableWindow () const
 {
   NS_LOG_FUNCTION (this);
-  uint32_t streamRWnd = (m_streamId != 0) ? StreamWindow () : m_maxStreamData;
+  uint32_t streamRWnd = (m_streamId != 0) ? StreamWindow ()
+    : std::min<uint64_t> (m_maxStreamData, UINT32_MAX);
   return streamRWnd;
 }
 
@@ -279,9 +442,10 @@ uint32_t
 QuicStreamBase::StreamWindow () const
 {
   NS_LOG_FUNCTION (this);
-  uint32_t inFlight = m_txBuffer->BytesInFlight ();
 
-  return (inFlight > m_maxStreamData) ? 0 : m_maxStreamData - inFlight;
+  // the peer limit is an offset, limits beyond 32 bits saturate
+  return (m_sentSize > m_maxStreamData) ? 0
+         : std::min<uint64_t> (m_maxStreamData - m_sentSize, UINT32_MAX);
 }
 
 int
@@ -337,20 +501,30 @@ QuicStreamBase::Recv (Ptr<Packet> frame, const QuicSubheader& sub, Address &addr
         }
       else
         {
-          SetMaxStreamData (sub.GetMaxStreamData ());
+          // the limit never decreases, reordered updates are ignored
+          if (sub.GetMaxStreamData () > m_maxStreamData)
+            {
+              SetMaxStreamData (sub.GetMaxStreamData ());
+            }
           NS_LOG_INFO ("Max stream data (flow control) - " << m_maxStreamData);
+          if (m_streamId != 0 and GetSendableSize () > 0)
+            {
+              m_quicl5->NotifyStreamDataAvailable ();
+            }
         }
 
       break;
 
     case QuicSubheader::STREAM_BLOCKED:
-      // TODO block the stream
       if (!(m_streamDirectionType == RECEIVER or m_streamDirectionType == BIDIRECTIONAL))
         {
           m_quicl5->SignalAbortConnection (QuicSubheader::TransportErrorCodes_t::PROTOCOL_VIOLATION,
                                            "Received STREAM_BLOCKED in send-only Stream");
           return -1;
         }
+      NS_LOG_INFO ("Peer blocked at stream data limit " << sub.GetOffset ());
+      m_flowControl.OnPeerBlocked (sub.GetOffset ());
+      MaybeSendMaxStreamData ();
 
       break;
 
@@ -389,7 +563,7 @@ QuicStreamBase::Recv (Ptr<Packet> frame, const QuicSubheader& sub, Address &addr
           return -1;
         }
 
-      if (m_rxBuffer->Size () + sub.GetLength () > m_maxStreamData)
+      if (m_streamId != 0 and sub.GetOffset () + sub.GetLength () > m_flowControl.GetLimit ())
         {
           m_quicl5->SignalAbortConnection (QuicSubheader::TransportErrorCodes_t::FLOW_CONTROL_ERROR,
                                            "Received more data w.r.t. Max Stream Data limit");
@@ -423,18 +597,18 @@ QuicStreamBase::Recv (Ptr<Packet> frame, const QuicSubheader& sub, Address &addr
 
       SetStreamStateRecvIf (m_streamStateRecv == RECV and m_fin, SIZE_KNOWN);
 
-      if (m_recvSize == sub.GetOffset ())
+      // a retransmission may merge frames whose head has already been received
+      if (sub.GetOffset () == m_recvSize
+          or (sub.GetOffset () < m_recvSize and m_recvSize < sub.GetOffset () + sub.GetLength ()))
         {
+          if (sub.GetOffset () < m_recvSize)
+            {
+              NS_LOG_INFO ("Trimming " << m_recvSize - sub.GetOffset () << " bytes already received");
+              frame->RemoveAtStart (m_recvSize - sub.GetOffset ());
+            }
 
-          NS_LOG_INFO ("Received a frame with the correct order of size " << sub.GetLength ());
-          m_recvSize += sub.GetLength ();
-
-          QuicSubheader sub;
-          sub.SetMaxStreamData (m_recvSize + m_rxBuffer->Available ());
-          // build empty packet
-          Ptr<Packet> maxStream = Create<Packet> (0);
-          maxStream->AddHeader (sub);
-          m_quicl5->Send (maxStream);
+          NS_LOG_INFO ("Received a frame with the correct order of size " << frame->GetSize ());
+          m_recvSize = sub.GetOffset () + sub.GetLength ();
 
           NS_LOG_LOGIC ("Try to Flush RxBuffer if Available - offset " << m_recvSize);
           // check if the packets in the RX buffer can be released (in order release)
@@ -452,12 +626,10 @@ QuicStreamBase::Recv (Ptr<Packet> frame, const QuicSubheader& sub, Address &addr
 
           if (m_streamId != 0 )
             {
-              if (sub.GetMaxStreamData () > 0)
-                {
-                  SetMaxStreamData (sub.GetMaxStreamData ());
-                  NS_LOG_LOGIC ("Received window set to offset " << sub.GetMaxStreamData ());
-                }
+              // the in-order data leaves the stream, and its credit can be granted again
+              m_flowControl.AddConsumed (frame->GetSize ());
               m_quicl5->Recv (frame, address);
+              MaybeSendMaxStreamData ();
             }
           else
             {
@@ -469,15 +641,10 @@ QuicStreamBase::Recv (Ptr<Packet> frame, const QuicSubheader& sub, Address &addr
         }
       else
         {
-          if (m_streamId != 0 && sub.GetMaxStreamData () > 0)
-            {
-              SetMaxStreamData (sub.GetMaxStreamData ());
-              NS_LOG_LOGIC ("Received window set to offset " << sub.GetMaxStreamData ());
-            }
           NS_LOG_INFO ("Buffering unordered received frame - offset " << m_recvSize << ", frame offset "<< sub.GetOffset());
-          if (!m_rxBuffer->Add (frame, sub) && frame->GetSize() > 0)
+          if (m_rxBuffer->Add (frame, sub, m_recvSize) == QuicStreamRxBuffer::NO_ROOM)
             {
-              // Insert failed: No data or RX buffer full
+              // Insert failed: RX buffer full (duplicate data is simply discarded)
               NS_LOG_INFO ("Dropping packet due to full RX buffer");
               // Abort simulation!
               NS_ABORT_MSG ("Aborting Connection");
@@ -539,21 +706,84 @@ QuicStreamBase::Recv (Ptr<Packet> frame, const QuicSubheader& sub, Address &addr
 
 // }
 
-uint32_t
-QuicStreamBase::SendMaxStreamData ()
+void
+QuicStreamBase::MaybeSendMaxStreamData ()
 {
-  return m_recvSize + m_rxBuffer->Available ();
+  NS_LOG_FUNCTION (this);
+
+  if (m_streamId == 0 or !m_flowControl.IsUpdateDue ())
+    {
+      return;
+    }
+
+  // the reordering buffer holds the data beyond the delivered offset
+  uint64_t window = m_quicl5->AutoTuneReceiveWindow (m_flowControl);
+  if (window > GetStreamRcvBufSize ())
+    {
+      SetStreamRcvBufSize (window);
+    }
+
+  QuicSubheader sub = QuicSubheader::CreateMaxStreamData (m_streamId, m_flowControl.Advertise ());
+  NS_LOG_INFO ("Send MAX_STREAM_DATA " << sub.GetMaxStreamData ());
+  Ptr<Packet> frame = Create<Packet> ();
+  frame->AddHeader (sub);
+  m_quicl5->Send (frame);
+}
+
+void
+QuicStreamBase::CheckBlocked ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_streamId == 0 or m_txBuffer->AppSize () == 0 or StreamWindow () > 0
+      or !m_flowControl.OnBlocked (m_maxStreamData))
+    {
+      return;
+    }
+
+  QuicSubheader sub = QuicSubheader::CreateStreamBlocked (m_streamId, m_maxStreamData);
+  NS_LOG_INFO ("Send STREAM_BLOCKED at " << m_maxStreamData);
+  Ptr<Packet> frame = Create<Packet> ();
+  frame->AddHeader (sub);
+  m_quicl5->Send (frame);
 }
 
 void
-QuicStreamBase::SetMaxStreamData (uint32_t maxStreamData)
+QuicStreamBase::SetFlowControlLimit (uint64_t limit)
+{
+  NS_LOG_FUNCTION (this << limit);
+  m_flowControl.SetInitialLimit (limit);
+}
+
+void
+QuicStreamBase::SetFlowControlUpdateThreshold (double threshold)
+{
+  NS_LOG_FUNCTION (this << threshold);
+  m_flowControl.SetUpdateThreshold (threshold);
+}
+
+void
+QuicStreamBase::SetMaxReceiveWindow (uint64_t maxWindow)
+{
+  NS_LOG_FUNCTION (this << maxWindow);
+  m_flowControl.SetMaxWindow (maxWindow);
+}
+
+uint64_t
+QuicStreamBase::GetSentSize () const
+{
+  return m_sentSize;
+}
+
+void
+QuicStreamBase::SetMaxStreamData (uint64_t maxStreamData)
 {
   NS_LOG_FUNCTION (this << maxStreamData);
   NS_LOG_DEBUG ("Update max stream data from " << m_maxStreamData << " to " << maxStreamData);
   m_maxStreamData = maxStreamData;
 }
 
-uint32_t
+uint64_t
 QuicStreamBase::GetMaxStreamData () const
 {
   return m_maxStreamData;
@@ -726,6 +956,8 @@ QuicStreamBase::SetStreamRcvBufSize (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   m_streamRxBufferSize = size;
   m_rxBuffer->SetMaxBufferSize (size);
+  // the peer can send beyond the delivered data as much as the buffer can reorder
+  m_flowControl.SetWindow (size);
 }
 
 uint32_t
@@ -27,6 +27,7 @@
 
 #include "ns3/ptr.h"
 #include "ns3/traced-value.h"
+#include "ns3/nstime.h"
 #include "quic-stream.h"
 #include "ns3/event-id.h"
 #include "quic-stream-rx-buffer.h"
@@ -34,6 +35,7 @@
 #include "quic-subheader.h"
 #include "quic-header.h"
 #include "quic-l5-protocol.h"
+#include "quic-flow-controller.h"
 //#include "quic-frame-manager.h"
 
 
@@ -79,6 +81,9 @@ public:
   /**
    * \brief Insert a frame in the TX buffer and trigger SendPendingData
    *
+   * Stream 0 sends its frames immediately, the other streams wait for the
+   * stream scheduler of the QuicL5Protocol to pull them with SendNextFrame.
+   *
    * \param frame a smart pointer to a packer
    * \return -1 in case of errors, the size of the packet sent otherwise
    */
@@ -133,14 +138,134 @@ public:
    * \param the size of the frame to be sent
    * \return the size of the frame sent
    */
-  uint32_t SendDataFrame (SequenceNumber32 seq, uint32_t maxSize);
+  uint32_t SendDataFrame (SequenceNumber64 seq, uint32_t maxSize);
+
+  /**
+   * \brief Send a single data frame, called when the stream is selected by
+   *   the stream scheduler while the socket builds a packet
+   *
+   * \param maxFrameSize the maximum size of the frame, subheader included
+   * \return the size of the frame passed to the socket, 0 if no frame fits, -1 in case of errors
+   */
+  int SendNextFrame (uint32_t maxFrameSize);
+
+  /**
+   * \brief Send a single frame with lost data, called while the socket
+   *   builds a packet, before any new data is pulled
+   *
+   * The lost data was already counted against the flow control limits.
+   *
+   * \param maxFrameSize the maximum size of the frame, subheader included
+   * \return the size of the frame passed to the socket, 0 if no frame fits, -1 in case of errors
+   */
+  int SendLostFrame (uint32_t maxFrameSize);
+
+  /**
+   * \brief Get the amount of lost data waiting to be retransmitted
+   *
+   * \return the number of lost bytes
+   */
+  uint32_t GetLostSize () const;
+
+  /**
+   * \brief Process the acknowledgment of stream data sent in a packet
+   *
+   * \param offset the stream offset of the first acknowledged byte
+   * \param length the number of acknowledged bytes
+   */
+  void OnFrameAcked (uint64_t offset, uint32_t length);
+
+  /**
+   * \brief Mark stream data sent in a lost packet for retransmission
+   *
+   * \param offset the stream offset of the first lost byte
+   * \param length the number of lost bytes
+   */
+  void OnFrameLost (uint64_t offset, uint32_t length);
+
+  /**
+   * \brief Get the amount of buffered data that flow control allows to send
+   *
+   * \return the number of bytes that can be sent
+   */
+  uint32_t GetSendableSize () const;
+
+  /**
+   * \brief Get the deadline of the oldest data in the TX buffer
+   *
+   * \return the absolute deadline, or Time::Max () if the stream has no deadline or no data
+   */
+  Time GetNextDeadline () const;
+
+  /**
+   * \brief Set the scheduling priority of the stream
+   *
+   * \param priority the priority, lower values are served first
+   */
+  void SetPriority (uint8_t priority);
+
+  /**
+   * \brief Get the scheduling priority of the stream
+   *
+   * \return the priority
+   */
+  uint8_t GetPriority () const;
+
+  /**
+   * \brief Set the weight of the stream in weighted fair scheduling
+   *
+   * \param weight the weight
+   */
+  void SetWeight (uint32_t weight);
+
+  /**
+   * \brief Get the weight of the stream in weighted fair scheduling
+   *
+   * \return the weight
+   */
+  uint32_t GetWeight () const;
+
+  /**
+   * \brief Set the time within which the data written on the stream should be sent
+   *
+   * \param deadline the relative deadline, zero if the stream has no deadline
+   */
+  void SetDeadline (Time deadline);
+
+  /**
+   * \brief Get the time within which the data written on the stream should be sent
+   *
+   * \return the relative deadline
+   */
+  Time GetDeadline () const;
   
   /**
-     * \brief Calculate the maximum amount of data that can be received by this stream
-     *
-     * \return a uint32_t with the maximum amount of data
-     */
-  uint32_t SendMaxStreamData ();
+   * \brief Set the limit advertised to the peer for the data received on this stream
+   *
+   * \param limit the initial maximum stream data of the transport parameters
+   */
+  void SetFlowControlLimit (uint64_t limit);
+
+  /**
+   * \brief Set the fraction of the receive window to consume before a MAX_STREAM_DATA is sent
+   *
+   * \param threshold the fraction, in (0, 1]
+   */
+  void SetFlowControlUpdateThreshold (double threshold);
+
+  /**
+   * \brief Set the largest receive window that autotuning can reach
+   *
+   * \param maxWindow the maximum window in bytes
+   */
+  void SetMaxReceiveWindow (uint64_t maxWindow);
+
+  /**
+   * \brief Get the amount of new data handed over to the socket
+   *
+   * \return the amount of data sent in this stream
+   */
+  uint64_t GetSentSize () const;
 
   // void CommandFlow (uint8_t type);
 
@@ -149,14 +274,14 @@ public:
    *
    * \param maxStreamData a uint32_t with the maximum amount of data
    */
-  void SetMaxStreamData (uint32_t maxStreamData);
+  void SetMaxStreamData (uint64_t maxStreamData);
 
   /**
    * \brief Get the maximum amount of data that can be sent in this stream
    *
    * \return a uint32_t with the maximum amount of data
    */
-  uint32_t GetMaxStreamData () const;
+  uint64_t GetMaxStreamData () const;
 
   /**
    * \brief Set the stream TX buffer size.
@@ -199,6 +324,16 @@ public:
 
 
 protected:
+  /**
+   * \brief Send a MAX_STREAM_DATA frame if the peer needs more credit
+   */
+  void MaybeSendMaxStreamData ();
+
+  /**
+   * \brief Send a STREAM_BLOCKED frame if the data waiting in the stream is blocked by the peer limit
+   */
+  void CheckBlocked ();
+
   QuicStreamTypes_t m_streamType;                    //!< The stream type
   QuicStreamDirectionTypes_t m_streamDirectionType;  //!< The stream direction
   QuicStreamStates_t m_streamStateSend;              //!< The state of the send stream
@@ -209,16 +344,22 @@ protected:
   Ptr<QuicL5Protocol>  m_quicl5;                     //!< The L5 Protocol this stack is associated with
 
   // Flow Control Parameters
-  uint32_t m_maxStreamData;                          //!< Maximum amount of data that can be sent/received on the stream
+  uint64_t m_maxStreamData;                          //!< Maximum offset that can be sent on the stream (peer limit)
   uint64_t m_sentSize;                               //!< Amount of data sent in this stream
   uint64_t m_recvSize;                               //!< Amount of data received in this stream
   bool m_fin;                                        //!< A flag indicating if the FIN bit has already been received/sent
+  QuicFlowController m_flowControl;                  //!< Credit granted to the peer and blocked signals of the stream
   Ptr<QuicStreamRxBuffer> m_rxBuffer;                //!< Rx buffer (reordering buffer)
   Ptr<QuicStreamTxBuffer> m_txBuffer;                //!< Tx buffer
   uint32_t m_streamTxBufferSize;                     //!< Size of the stream TX buffer
   uint32_t m_streamRxBufferSize;                     //!< Size of the stream RX buffer
   EventId m_streamSendPendingDataEvent;              //!< Micro-delay event to send pending data
 
+  // Scheduling Parameters
+  uint8_t m_priority;                                //!< Priority in strict priority scheduling (lower is served first)
+  uint32_t m_weight;                                 //!< Weight in weighted fair scheduling
+  Time m_deadline;                                   //!< Relative deadline of the written data (zero for none)
+
 };
 
 } //namespace ns3
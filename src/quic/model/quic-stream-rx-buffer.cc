@@ -33,6 +33,7 @@
 // #include "ns3/ipv6-l3-protocol.h"
 // #include "ns3/ipv6-routing-protocol.h"
 #include <algorithm>
+#include <iterator>
 #include "quic-stream-rx-buffer.h"
 #include "quic-subheader.h"
 
@@ -43,6 +44,7 @@ NS_LOG_COMPONENT_DEFINE ("QuicStreamRxBuffer");
 QuicStreamRxItem::QuicStreamRxItem ()
   : m_packet (0),
     m_offset (0),
+    m_lastFrameOffset (0),
     m_fin (false)
 {
 }
@@ -50,6 +52,7 @@ QuicStreamRxItem::QuicStreamRxItem ()
 QuicStreamRxItem::QuicStreamRxItem (const QuicStreamRxItem &other)
   : m_packet (other.m_packet),
     m_offset (other.m_offset),
+    m_lastFrameOffset (other.m_lastFrameOffset),
     m_fin (other.m_fin)
 {
 }
@@ -57,7 +60,7 @@ QuicStreamRxItem::QuicStreamRxItem (const QuicStreamRxItem &other)
 void
 QuicStreamRxItem::Print (std::ostream &os) const
 {
-  os << "[OFF " << m_offset << "]";
+  os << "[OFF " << m_offset << " size " << m_packet->GetSize () << "]";
 
   if (m_fin)
     {
@@ -91,74 +94,133 @@ QuicStreamRxBuffer::~QuicStreamRxBuffer ()
 {
 }
 
-bool
-QuicStreamRxBuffer::Add (Ptr<Packet> p, const QuicSubheader& sub)
+QuicStreamRxBuffer::AddResult_t
+QuicStreamRxBuffer::Add (Ptr<Packet> p, const QuicSubheader& sub, uint64_t deliveredOffset)
 {
-  NS_LOG_FUNCTION (this << p << sub);
+  NS_LOG_FUNCTION (this << p << sub << deliveredOffset);
 
   NS_LOG_INFO (
     "Try to append " << p->GetSize () << " bytes " << ", availSize=" << Available ());
 
-  if (p->GetSize () <= Available ())
+  if (p->GetSize () == 0)
     {
-      if (p->GetSize () > 0)
+      NS_LOG_WARN ("Discarded. Trying to insert empty packet.");
+      return DUPLICATE;
+    }
+
+  uint64_t start = sub.GetOffset ();
+  uint64_t end = start + p->GetSize ();
+
+  // FIN packet for the stream
+  if (sub.IsStreamFin ())
+    {
+      NS_LOG_LOGIC ("FIN packet for the stream");
+      m_finalSize = end;
+      m_recvFin = true;
+    }
+
+  // Drop the data that has already been delivered
+  if (end <= deliveredOffset)
+    {
+      NS_LOG_WARN ("Discarded packet below the delivered offset.");
+      return DUPLICATE;
+    }
+  if (start < deliveredOffset)
+    {
+      NS_LOG_LOGIC ("Trimmed " << deliveredOffset - start << " bytes below the delivered offset");
+      p = p->CreateFragment (deliveredOffset - start, end - deliveredOffset);
+      start = deliveredOffset;
+    }
+
+  // Find the blocks that overlap with or are adjacent to the new data
+  QuicStreamRxPacketList::iterator first = m_streamRecvList.upper_bound (start);
+  if (first != m_streamRecvList.begin ())
+    {
+      QuicStreamRxPacketList::iterator prev = std::prev (first);
+      if (prev->first + prev->second->m_packet->GetSize () >= start)
         {
+          first = prev;
+        }
+    }
+  QuicStreamRxPacketList::iterator last = first;
+  uint64_t covered = 0;
+  while (last != m_streamRecvList.end () && last->first <= end)
+    {
+      uint64_t itemEnd = last->first + last->second->m_packet->GetSize ();
+      uint64_t overlapStart = std::max (start, last->first);
+      uint64_t overlapEnd = std::min (end, itemEnd);
+      if (overlapEnd > overlapStart)
+        {
+          covered += overlapEnd - overlapStart;
+        }
+      ++last;
+    }
 
-          QuicStreamRxItem *item = new QuicStreamRxItem ();
-          item->m_packet = p->Copy ();
-          item->m_offset = sub.GetOffset ();
-          item->m_fin = sub.IsStreamFin ();
-
-          QuicStreamRxPacketList::iterator it;
-
-          // FIN packet for the stream
-          if (sub.IsStreamFin ())
-            {
-              NS_LOG_LOGIC ("FIN packet for the stream");
-              m_finalSize = sub.GetOffset () + p->GetSize ();
-              m_recvFin = true;
-              m_streamRecvList.insert (m_streamRecvList.end (), item);
-              return true;
-            }
-
-          // Find the right place to insert packet (TODO: binary search would be more efficient)
-          bool inserted = false;
-          for (it = m_streamRecvList.begin (); it < m_streamRecvList.end ();
-               ++it)
-            {
-              if (item->m_offset == (*it)->m_offset)
-                {
-                  // Duplicate packet
-                  NS_LOG_WARN ("Discarded duplicate packet.");
-                  return false;
-                }
-              if (item->m_offset < (*it)->m_offset)
-                {
-                  m_streamRecvList.insert (it, item);
-                  NS_LOG_LOGIC ("Inserted packet");
-                  inserted = true;
-                  break;
-                }
-            }
-          // The packet is not in the buffer, append it to the end
-          if (!inserted)
-            {
-              NS_LOG_LOGIC ("Appending packet");
-              m_streamRecvList.insert (m_streamRecvList.end (), item);
-            }
-          m_numBytesInBuffer += p->GetSize ();
-          NS_LOG_INFO ("Update: Received Size = " << m_numBytesInBuffer);
-          return true;
+  uint32_t newBytes = p->GetSize () - covered;
+  if (newBytes == 0)
+    {
+      NS_LOG_WARN ("Discarded duplicate packet.");
+      return DUPLICATE;
+    }
+  if (newBytes > Available ())
+    {
+      NS_LOG_WARN ("Rejected. Not enough room to buffer packet.");
+      return NO_ROOM;
+    }
 
+  // Merge the new data with the blocks around it
+  QuicItemPool<QuicStreamRxItem>::Handle item = m_itemPool.Acquire ();
+  item->m_offset = start;
+  item->m_lastFrameOffset = start;
+  item->m_fin = sub.IsStreamFin ();
+  item->m_packet = p->Copy ();
+  if (first != last)
+    {
+      QuicStreamRxItem *firstItem = first->second.get ();
+      if (firstItem->m_offset < start)
+        {
+          Ptr<Packet> head = firstItem->m_packet->CreateFragment (0, start - firstItem->m_offset);
+          head->AddAtEnd (item->m_packet);
+          item->m_packet = head;
+          item->m_offset = firstItem->m_offset;
         }
-      else
+      QuicStreamRxItem *lastItem = std::prev (last)->second.get ();
+      uint64_t lastEnd = lastItem->m_offset + lastItem->m_packet->GetSize ();
+      if (lastEnd > end)
+        {
+          item->m_packet->AddAtEnd (lastItem->m_packet->CreateFragment (end - lastItem->m_offset, lastEnd - end));
+        }
+      if (lastEnd >= end && lastItem->m_lastFrameOffset >= start)
         {
-          NS_LOG_WARN ("Discarded. Trying to insert empty packet.");
-          return false;
+          item->m_lastFrameOffset = lastItem->m_lastFrameOffset;
+          item->m_fin = lastItem->m_fin;
         }
+      m_streamRecvList.erase (first, last);
     }
-  NS_LOG_WARN ("Rejected. Not enough room to buffer packet.");
-  return false;
+  NS_LOG_LOGIC ("Inserted " << newBytes << " new bytes in block with offset " << item->m_offset
+                            << " and size " << item->m_packet->GetSize ());
+  uint64_t offset = item->m_offset;
+  m_streamRecvList.emplace (offset, std::move (item));
+
+  m_numBytesInBuffer += newBytes;
+  NS_LOG_INFO ("Update: Received Size = " << m_numBytesInBuffer);
+  return ADDED;
+}
+
+QuicStreamRxBuffer::QuicStreamRxPacketList::iterator
+QuicStreamRxBuffer::TrimFront (QuicStreamRxPacketList::iterator it, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+
+  QuicItemPool<QuicStreamRxItem>::Handle item = std::move (it->second);
+  NS_ASSERT (size < item->m_packet->GetSize ());
+  item->m_packet = item->m_packet->CreateFragment (size, item->m_packet->GetSize () - size);
+  item->m_offset += size;
+  item->m_lastFrameOffset = std::max (item->m_lastFrameOffset, item->m_offset);
+  m_numBytesInBuffer -= size;
+  m_streamRecvList.erase (it);
+  uint64_t offset = item->m_offset;
+  return m_streamRecvList.emplace (offset, std::move (item)).first;
 }
 
 Ptr<Packet>
@@ -177,32 +239,26 @@ QuicStreamRxBuffer::Extract (uint32_t maxSize)
 
   Ptr<Packet> outPkt = Create<Packet> ();
 
-  QuicStreamRxPacketList::iterator it = m_streamRecvList.begin ();
-
-  while (extractSize > 0 && !m_streamRecvList.empty ()
-         && it != m_streamRecvList.end ())
+  while (extractSize > 0 && !m_streamRecvList.empty ())
     {
-      it = m_streamRecvList.begin ();
-      Ptr<Packet> currentPacket = (*it)->m_packet;
+      QuicStreamRxPacketList::iterator it = m_streamRecvList.begin ();
+      Ptr<Packet> currentPacket = it->second->m_packet;
 
       if (currentPacket->GetSize () <= extractSize)   // Merge
         {
-
           outPkt->AddAtEnd (currentPacket);
-          m_streamRecvList.erase (it);
-          NS_LOG_LOGIC ("Extracted and removed packet " << (*it)->m_offset << " from RxBuffer, bytes to extract: " << extractSize);
-
+          NS_LOG_LOGIC ("Extracted and removed block " << it->first << " from RxBuffer, bytes to extract: " << extractSize);
           m_numBytesInBuffer -= currentPacket->GetSize ();
           extractSize -= currentPacket->GetSize ();
-
-          continue;
+          m_streamRecvList.erase (it);
         }
       else
         {
-          break;
+          NS_LOG_LOGIC ("Extracted " << extractSize << " bytes from block " << it->first);
+          outPkt->AddAtEnd (currentPacket->CreateFragment (0, extractSize));
+          TrimFront (it, extractSize);
+          extractSize = 0;
         }
-
-      it++;
     }
 
   if (outPkt->GetSize () == 0)
@@ -218,23 +274,35 @@ std::pair<uint64_t, uint64_t>
 QuicStreamRxBuffer::GetDeliverable (uint64_t currRecvOffset)
 {
   NS_LOG_FUNCTION (this);
-  uint64_t offsetToExtract = currRecvOffset;
-  uint64_t lengthToExtract = 0;
   NS_LOG_LOGIC ("Calculating deliverable size");
 
-  QuicStreamRxPacketList::iterator i;
-
-  for (i = m_streamRecvList.begin (); i != m_streamRecvList.end (); ++i)
+  // Discard the data that has already been delivered
+  while (!m_streamRecvList.empty ())
     {
-      if ((*i)->m_offset == currRecvOffset + lengthToExtract)
+      QuicStreamRxPacketList::iterator it = m_streamRecvList.begin ();
+      uint64_t size = it->second->m_packet->GetSize ();
+      if (it->first + size <= currRecvOffset)
         {
-          offsetToExtract = (*i)->m_offset;
-          lengthToExtract += (*i)->m_packet->GetSize ();
+          NS_LOG_LOGIC ("Discarded block with offset " << it->first);
+          m_numBytesInBuffer -= size;
+          m_streamRecvList.erase (it);
+          continue;
         }
-      NS_LOG_LOGIC ("Inspected packet with offset " << (*i)->m_offset);
+      if (it->first < currRecvOffset)
+        {
+          NS_LOG_LOGIC ("Trimmed block with offset " << it->first);
+          TrimFront (it, currRecvOffset - it->first);
+        }
+      break;
     }
 
-  return std::make_pair (offsetToExtract, lengthToExtract);
+  if (m_streamRecvList.empty () || m_streamRecvList.begin ()->first != currRecvOffset)
+    {
+      return std::make_pair (currRecvOffset, 0);
+    }
+
+  QuicStreamRxItem *item = m_streamRecvList.begin ()->second.get ();
+  return std::make_pair (item->m_lastFrameOffset, item->m_packet->GetSize ());
 }
 
 uint32_t
@@ -269,7 +337,7 @@ QuicStreamRxBuffer::SetMaxBufferSize (uint32_t s)
   m_maxBuffer = s;
 }
 
-uint32_t
+uint64_t
 QuicStreamRxBuffer::GetFinalSize () const
 {
   return m_finalSize;
@@ -285,11 +353,11 @@ QuicStreamRxBuffer::Print (std::ostream & os) const
 
   for (it = m_streamRecvList.begin (); it != m_streamRecvList.end (); ++it)
     {
-      (*it)->Print (ss);
+      it->second->Print (ss);
     }
 
   os << "Stream Recv list: \n" << ss.str () << "\n\nCurrent Status: "
-     << "\nNumber of receptions = " << m_streamRecvList.size ()
+     << "\nNumber of blocks = " << m_streamRecvList.size ()
      << "\nReceived Size = " << m_numBytesInBuffer;
   if (m_recvFin)
     {
@@ -31,6 +31,7 @@
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
 #include "quic-subheader.h"
+#include "quic-item-pool.h"
 #include "ns3/object.h"
 
 namespace ns3 {
@@ -38,7 +39,7 @@ namespace ns3 {
 /**
  * \ingroup quic
  *
- * \brief Item that encloses the received Quic Stream frame
+ * \brief Item that encloses a contiguous block of received Quic Stream data
  */
 class QuicStreamRxItem
 {
@@ -72,9 +73,10 @@ public:
     return (this->m_offset == other.m_offset)and (this->m_fin == other.m_fin) and (this->m_packet == other.m_packet);
   }
 
-  Ptr<Packet> m_packet;  //!< Stream Frame
-  uint64_t m_offset;     //!< Offset of the Stream Frame
-  bool m_fin;            //!< FIN bit of the Stream Frame
+  Ptr<Packet> m_packet;        //!< Stream data
+  uint64_t m_offset;           //!< Offset of the first byte of the Stream data
+  uint64_t m_lastFrameOffset;  //!< Offset of the last Stream Frame merged in the item
+  bool m_fin;                  //!< FIN bit of the last Stream Frame
 
 };
 
@@ -82,6 +84,9 @@ public:
  * \ingroup quic
  *
  * \brief Rx stream buffer for QUIC
+ *
+ * The blocks of received data are taken from a pool owned by the buffer, and
+ * go back to it when they are delivered or merged.
  */
 class QuicStreamRxBuffer : public Object
 {
@@ -92,6 +97,16 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Outcome of the insertion of a packet
+   */
+  typedef enum
+  {
+    ADDED,       //!< The packet carried new data, which is now in the buffer
+    DUPLICATE,   //!< The packet carried no new data, and was discarded
+    NO_ROOM      //!< The new data does not fit in the buffer
+  } AddResult_t;
+
   QuicStreamRxBuffer ();
   virtual ~QuicStreamRxBuffer ();
 
@@ -126,7 +141,8 @@ public:
 
   /**
    * Check how many bytes can be released from the buffer (i.e., how many in-order bytes
-   * are present from a certain offset)
+   * are present from a certain offset). Data below the offset has already been
+   * delivered, and is discarded from the buffer
    *
    * \param currRecvOffset the current offset in the stream sequence
    * \return a pair with the offset of the last packet to extract and the total number of bytes to extract
@@ -134,13 +150,17 @@ public:
   std::pair<uint64_t, uint64_t> GetDeliverable (uint64_t currRecvOffset);
 
   /**
-   * Add a packet to the receive buffer
+   * Add a packet to the receive buffer. The parts of the packet that are already
+   * in the buffer or below the delivered offset are trimmed, and the new data is
+   * merged with the adjacent blocks
    *
    * \param p a smart pointer to a packet
    * \param sub the QuicSubheader of the packet
-   * \return true if the insertion was successful
+   * \param deliveredOffset the offset up to which the stream data has been delivered
+   * \return ADDED if the insertion was successful, DUPLICATE if the packet carries
+   *         no new data, NO_ROOM if there is not enough room for it
    */
-  bool Add (Ptr<Packet> p, const QuicSubheader& sub);
+  AddResult_t Add (Ptr<Packet> p, const QuicSubheader& sub, uint64_t deliveredOffset);
 
   /**
    * Extract maxSize bytes from the buffer
@@ -156,7 +176,7 @@ public:
    *
    * \return the final size of the stream
    */
-  uint32_t GetFinalSize () const;
+  uint64_t GetFinalSize () const;
 
   /**
    * Return the number of bytes in the buffer
@@ -166,12 +186,21 @@ public:
   uint32_t Size (void) const;
 
 private:
-  // TODO consider replacing std::vector with a ordered data structure
-  typedef std::vector<QuicStreamRxItem*> QuicStreamRxPacketList;  //!< container for data stored in the buffer
+  typedef std::map<uint64_t, QuicItemPool<QuicStreamRxItem>::Handle> QuicStreamRxPacketList;  //!< container for data stored in the buffer, keyed by offset
+
+  /**
+   * Remove the first bytes of an item, re-inserting what is left at the new offset
+   *
+   * \param it the item to trim
+   * \param size the number of bytes to remove
+   * \return the iterator to the trimmed item
+   */
+  QuicStreamRxPacketList::iterator TrimFront (QuicStreamRxPacketList::iterator it, uint32_t size);
 
-  QuicStreamRxPacketList m_streamRecvList;  //!< List of received packets with additional info
+  QuicItemPool<QuicStreamRxItem> m_itemPool;  //!< Pool of the items, declared first to outlive them
+  QuicStreamRxPacketList m_streamRecvList;  //!< Non-overlapping and non-adjacent blocks of received data
   uint32_t m_numBytesInBuffer;              //!< Current buffer occupancy
-  uint32_t m_finalSize;                     //!< Final buffer size
+  uint64_t m_finalSize;                     //!< Final buffer size
   uint32_t m_maxBuffer;                     //!< Maximum buffer size
   bool m_recvFin;                           //!< FIN bit reception flag
 
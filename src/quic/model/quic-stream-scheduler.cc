@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "quic-stream-scheduler.h"
+#include "quic-stream-base.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicStreamScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicStreamScheduler);
+
+TypeId
+QuicStreamScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicStreamScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+QuicStreamScheduler::QuicStreamScheduler ()
+  : Object (),
+    m_nextIndex (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicStreamScheduler::~QuicStreamScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QuicStreamScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_streams.clear ();
+  Object::DoDispose ();
+}
+
+void
+QuicStreamScheduler::AddStream (Ptr<QuicStreamBase> stream)
+{
+  NS_LOG_FUNCTION (this << stream->GetStreamId ());
+
+  std::vector<Ptr<QuicStreamBase> >::iterator it = m_streams.begin ();
+  while (it != m_streams.end () && (*it)->GetStreamId () < stream->GetStreamId ())
+    {
+      ++it;
+    }
+  NS_ASSERT_MSG (it == m_streams.end () || (*it)->GetStreamId () != stream->GetStreamId (),
+                 "Stream " << stream->GetStreamId () << " already registered");
+  uint32_t index = it - m_streams.begin ();
+  m_streams.insert (it, stream);
+
+  // the next visit still starts from the same stream
+  if (index < m_nextIndex)
+    {
+      ++m_nextIndex;
+    }
+}
+
+Ptr<QuicStreamBase>
+QuicStreamScheduler::SelectStream ()
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t n = m_streams.size ();
+  Ptr<QuicStreamBase> best = 0;
+  uint32_t bestIndex = 0;
+
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t index = (m_nextIndex + i) % n;
+      Ptr<QuicStreamBase> candidate = m_streams[index];
+      if (candidate->GetSendableSize () == 0)
+        {
+          continue;
+        }
+      if (best == 0 || IsPreferred (candidate, best))
+        {
+          best = candidate;
+          bestIndex = index;
+        }
+    }
+
+  if (best != 0)
+    {
+      NS_LOG_INFO (GetName () << " selected stream " << best->GetStreamId ());
+      m_nextIndex = bestIndex + 1;
+    }
+  return best;
+}
+
+void
+QuicStreamScheduler::OnFrameSent (Ptr<QuicStreamBase> stream, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << stream->GetStreamId () << bytes);
+}
+
+// Round robin
+
+NS_OBJECT_ENSURE_REGISTERED (QuicStreamRoundRobinScheduler);
+
+TypeId
+QuicStreamRoundRobinScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicStreamRoundRobinScheduler")
+    .SetParent<QuicStreamScheduler> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicStreamRoundRobinScheduler> ()
+  ;
+  return tid;
+}
+
+QuicStreamRoundRobinScheduler::QuicStreamRoundRobinScheduler ()
+  : QuicStreamScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicStreamRoundRobinScheduler::~QuicStreamRoundRobinScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+QuicStreamRoundRobinScheduler::GetName () const
+{
+  return "QuicStreamRoundRobinScheduler";
+}
+
+bool
+QuicStreamRoundRobinScheduler::IsPreferred (Ptr<QuicStreamBase> candidate,
+                                            Ptr<QuicStreamBase> best) const
+{
+  return false;
+}
+
+// Weighted fair queueing
+
+NS_OBJECT_ENSURE_REGISTERED (QuicStreamWeightedFairScheduler);
+
+TypeId
+QuicStreamWeightedFairScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicStreamWeightedFairScheduler")
+    .SetParent<QuicStreamScheduler> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicStreamWeightedFairScheduler> ()
+  ;
+  return tid;
+}
+
+QuicStreamWeightedFairScheduler::QuicStreamWeightedFairScheduler ()
+  : QuicStreamScheduler (),
+    m_virtualTime (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicStreamWeightedFairScheduler::~QuicStreamWeightedFairScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+QuicStreamWeightedFairScheduler::GetName () const
+{
+  return "QuicStreamWeightedFairScheduler";
+}
+
+double
+QuicStreamWeightedFairScheduler::GetStartTime (Ptr<QuicStreamBase> stream) const
+{
+  std::map<uint64_t, double>::const_iterator it = m_finishTime.find (stream->GetStreamId ());
+  if (it == m_finishTime.end ())
+    {
+      return m_virtualTime;
+    }
+  return std::max (it->second, m_virtualTime);
+}
+
+bool
+QuicStreamWeightedFairScheduler::IsPreferred (Ptr<QuicStreamBase> candidate,
+                                              Ptr<QuicStreamBase> best) const
+{
+  return GetStartTime (candidate) < GetStartTime (best);
+}
+
+void
+QuicStreamWeightedFairScheduler::OnFrameSent (Ptr<QuicStreamBase> stream, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << stream->GetStreamId () << bytes);
+
+  m_virtualTime = GetStartTime (stream);
+  m_finishTime[stream->GetStreamId ()] = m_virtualTime
+    + static_cast<double> (bytes) / stream->GetWeight ();
+  NS_LOG_LOGIC ("Stream " << stream->GetStreamId () << " virtual finish time "
+                          << m_finishTime[stream->GetStreamId ()]);
+}
+
+// Strict priority
+
+NS_OBJECT_ENSURE_REGISTERED (QuicStreamPriorityScheduler);
+
+TypeId
+QuicStreamPriorityScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicStreamPriorityScheduler")
+    .SetParent<QuicStreamScheduler> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicStreamPriorityScheduler> ()
+  ;
+  return tid;
+}
+
+QuicStreamPriorityScheduler::QuicStreamPriorityScheduler ()
+  : QuicStreamScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicStreamPriorityScheduler::~QuicStreamPriorityScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+QuicStreamPriorityScheduler::GetName () const
+{
+  return "QuicStreamPriorityScheduler";
+}
+
+bool
+QuicStreamPriorityScheduler::IsPreferred (Ptr<QuicStreamBase> candidate,
+                                          Ptr<QuicStreamBase> best) const
+{
+  return candidate->GetPriority () < best->GetPriority ();
+}
+
+// Earliest deadline first
+
+NS_OBJECT_ENSURE_REGISTERED (QuicStreamEdfScheduler);
+
+TypeId
+QuicStreamEdfScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicStreamEdfScheduler")
+    .SetParent<QuicStreamScheduler> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicStreamEdfScheduler> ()
+  ;
+  return tid;
+}
+
+QuicStreamEdfScheduler::QuicStreamEdfScheduler ()
+  : QuicStreamScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicStreamEdfScheduler::~QuicStreamEdfScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::string
+QuicStreamEdfScheduler::GetName () const
+{
+  return "QuicStreamEdfScheduler";
+}
+
+bool
+QuicStreamEdfScheduler::IsPreferred (Ptr<QuicStreamBase> candidate,
+                                     Ptr<QuicStreamBase> best) const
+{
+  return candidate->GetNextDeadline () < best->GetNextDeadline ();
+}
+
+} // namespace ns3
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICSTREAMSCHEDULER_H
+#define QUICSTREAMSCHEDULER_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+class QuicStreamBase;
+
+/**
+ * \ingroup quic
+ * \defgroup streamScheduler Stream Schedulers.
+ *
+ * The algorithms that multiplex the QUIC streams in packets.
+ */
+
+/**
+ * \ingroup streamScheduler
+ *
+ * \brief Stream scheduler abstract class
+ *
+ * The QuicL5Protocol asks the scheduler which stream fills the next frame
+ * each time the socket builds a packet, so that the data written by the
+ * application stays in the stream TX buffers until it can actually be sent.
+ * Only the streams with data that can be sent (i.e., not blocked by flow
+ * control) are eligible.
+ *
+ * The registered streams are visited in round-robin order, starting after the
+ * last selected one; subclasses define which of the eligible streams is
+ * preferred, and eligible streams that are equally preferred are served in
+ * round-robin.
+ */
+class QuicStreamScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicStreamScheduler ();
+  virtual ~QuicStreamScheduler ();
+
+  /**
+   * \brief Get the name of the scheduler
+   *
+   * \return A string identifying the name
+   */
+  virtual std::string GetName () const = 0;
+
+  /**
+   * \brief Register a stream, keeping the streams ordered by stream ID
+   *
+   * \param stream the stream
+   */
+  void AddStream (Ptr<QuicStreamBase> stream);
+
+  /**
+   * \brief Select the stream that sends the next frame
+   *
+   * \return the selected stream, or 0 if no stream has data that can be sent
+   */
+  Ptr<QuicStreamBase> SelectStream ();
+
+  /**
+   * \brief Account for a frame sent by the stream returned by SelectStream
+   *
+   * \param stream the stream
+   * \param bytes the size of the frame
+   */
+  virtual void OnFrameSent (Ptr<QuicStreamBase> stream, uint32_t bytes);
+
+protected:
+  /**
+   * \brief Compare two eligible streams
+   *
+   * \param candidate the stream visited now
+   * \param best the preferred stream among the ones visited before
+   * \return true if candidate must be served before best
+   */
+  virtual bool IsPreferred (Ptr<QuicStreamBase> candidate, Ptr<QuicStreamBase> best) const = 0;
+
+  virtual void DoDispose (void);
+
+private:
+  std::vector<Ptr<QuicStreamBase> > m_streams;  //!< The registered streams, ordered by stream ID
+  uint32_t m_nextIndex;                         //!< Index of the stream visited first by the next selection
+};
+
+/**
+ * \ingroup streamScheduler
+ *
+ * \brief Round-robin stream scheduler
+ *
+ * The eligible streams send one frame each in turn.
+ */
+class QuicStreamRoundRobinScheduler : public QuicStreamScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicStreamRoundRobinScheduler ();
+  virtual ~QuicStreamRoundRobinScheduler ();
+
+  std::string GetName () const;
+
+protected:
+  bool IsPreferred (Ptr<QuicStreamBase> candidate, Ptr<QuicStreamBase> best) const;
+};
+
+/**
+ * \ingroup streamScheduler
+ *
+ * \brief Weighted fair queueing stream scheduler
+ *
+ * Start-time fair queueing: each stream advances a virtual time by the size of
+ * its frames over its weight (ns3::QuicStreamBase::Weight), and the eligible
+ * stream with the lowest virtual time is served. A stream that becomes
+ * eligible again after being idle restarts from the virtual time of the last
+ * served stream, so that it cannot claim the capacity it did not use.
+ */
+class QuicStreamWeightedFairScheduler : public QuicStreamScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicStreamWeightedFairScheduler ();
+  virtual ~QuicStreamWeightedFairScheduler ();
+
+  std::string GetName () const;
+  void OnFrameSent (Ptr<QuicStreamBase> stream, uint32_t bytes);
+
+protected:
+  bool IsPreferred (Ptr<QuicStreamBase> candidate, Ptr<QuicStreamBase> best) const;
+
+private:
+  /**
+   * \brief Get the virtual time at which the next frame of a stream starts
+   *
+   * \param stream the stream
+   * \return the virtual start time
+   */
+  double GetStartTime (Ptr<QuicStreamBase> stream) const;
+
+  std::map<uint64_t, double> m_finishTime;  //!< Virtual finish time of the last frame of each stream
+  double m_virtualTime;                     //!< Virtual start time of the last served frame
+};
+
+/**
+ * \ingroup streamScheduler
+ *
+ * \brief Strict priority stream scheduler
+ *
+ * The eligible streams with the lowest priority value
+ * (ns3::QuicStreamBase::Priority, as the urgency of RFC 9218) are served
+ * first, in round-robin among themselves.
+ */
+class QuicStreamPriorityScheduler : public QuicStreamScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicStreamPriorityScheduler ();
+  virtual ~QuicStreamPriorityScheduler ();
+
+  std::string GetName () const;
+
+protected:
+  bool IsPreferred (Ptr<QuicStreamBase> candidate, Ptr<QuicStreamBase> best) const;
+};
+
+/**
+ * \ingroup streamScheduler
+ *
+ * \brief Earliest deadline first stream scheduler
+ *
+ * The eligible stream whose oldest unsent data has the earliest deadline
+ * (the time at which the data was written plus ns3::QuicStreamBase::Deadline)
+ * is served first. Streams without a deadline are served, in round-robin,
+ * only when no stream with a deadline has data to send.
+ */
+class QuicStreamEdfScheduler : public QuicStreamScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicStreamEdfScheduler ();
+  virtual ~QuicStreamEdfScheduler ();
+
+  std::string GetName () const;
+
+protected:
+  bool IsPreferred (Ptr<QuicStreamBase> candidate, Ptr<QuicStreamBase> best) const;
+};
+
+} // namespace ns3
+
+#endif /* QUICSTREAMSCHEDULER_H */
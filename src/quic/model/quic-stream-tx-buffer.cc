@@ -23,6 +23,7 @@
  */
 
 #include <algorithm>
+#include <iterator>
 #include <iostream>
 
 #include "ns3/packet.h"
@@ -43,6 +44,7 @@ QuicStreamTxItem::QuicStreamTxItem ()
     m_retrans (false),
     m_sacked (false),
     m_lastSent (Time::Min ()),
+    m_queued (Time::Min ()),
     m_id (0)
 {
 }
@@ -54,6 +56,7 @@ QuicStreamTxItem::QuicStreamTxItem (const QuicStreamTxItem &other)
     m_retrans (other.m_retrans),
     m_sacked (other.m_sacked),
     m_lastSent (other.m_lastSent),
+    m_queued (other.m_queued),
     m_id (other.m_id)
 {
 }
@@ -90,7 +93,7 @@ QuicStreamTxBuffer::GetTypeId (void)
 //    .AddTraceSource ("UnackSequence",
 //                     "First unacknowledged sequence number (SND.UNA)",
 //                     MakeTraceSourceAccessor (&QuicStreamTxBuffer::m_sentSize),
-//                     "ns3::SequenceNumber32TracedValueCallback")
+//                     "ns3::SequenceNumber64TracedValueCallback")
   ;
   return tid;
 }
@@ -98,29 +101,14 @@ QuicStreamTxBuffer::GetTypeId (void)
 QuicStreamTxBuffer::QuicStreamTxBuffer ()
   : m_maxBuffer (131072),
     m_appSize (0),
-    m_sentSize (0)
+    m_sentSize (0),
+    m_lostSize (0),
+    m_ackedOffset (0)
 {
-  m_appList = QuicTxPacketList ();
-  m_sentList = QuicTxPacketList ();
 }
 
 QuicStreamTxBuffer::~QuicStreamTxBuffer (void)
 {
-  QuicTxPacketList::iterator it;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
-    {
-      QuicStreamTxItem *item = *it;
-      m_sentSize -= item->m_packet->GetSize ();
-      delete item;
-    }
-
-  for (it = m_appList.begin (); it != m_appList.end (); ++it)
-    {
-      QuicStreamTxItem *item = *it;
-      m_appSize -= item->m_packet->GetSize ();
-      delete item;
-    }
 }
 
 void
@@ -159,9 +147,10 @@ QuicStreamTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          QuicStreamTxItem *item = new QuicStreamTxItem ();
+          QuicItemPool<QuicStreamTxItem>::Handle item = m_itemPool.Acquire ();
           item->m_packet = p->Copy ();
-          m_appList.insert (m_appList.end (), item);
+          item->m_queued = Simulator::Now ();
+          m_appList.push_back (std::move (item));
           m_appSize += p->GetSize ();
 
           NS_LOG_INFO ("Update: Application Size = " << m_appSize);
@@ -190,9 +179,10 @@ QuicStreamTxBuffer::Rejected (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          QuicStreamTxItem *item = new QuicStreamTxItem ();
+          QuicItemPool<QuicStreamTxItem>::Handle item = m_itemPool.Acquire ();
           item->m_packet = p->Copy ();
-          m_appList.insert (m_appList.begin (), item);
+          item->m_queued = Simulator::Now ();
+          m_appList.push_front (std::move (item));
           m_appSize += p->GetSize ();
           m_sentList.pop_back ();
           m_sentSize -= p->GetSize ();
@@ -213,7 +203,7 @@ QuicStreamTxBuffer::Rejected (Ptr<Packet> p)
 
 
 Ptr<Packet>
-QuicStreamTxBuffer::NextSequence (uint32_t numBytes, const SequenceNumber32 seq)
+QuicStreamTxBuffer::NextSequence (uint32_t numBytes, const SequenceNumber64 seq)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -238,92 +228,245 @@ QuicStreamTxBuffer::GetNewSegment (uint32_t numBytes)
 {
   NS_LOG_FUNCTION (this << numBytes);
 
-  bool toInsert = false;
-  Ptr<Packet> currentPacket = 0;
-  QuicStreamTxItem *currentItem = 0;
-  QuicStreamTxItem *outItem = new QuicStreamTxItem ();
+  if (m_appList.empty () || numBytes == 0)
+    {
+      return 0;
+    }
+
+  QuicItemPool<QuicStreamTxItem>::Handle outItem = m_itemPool.Acquire ();
   outItem->m_packet = Create<Packet> ();
   uint32_t outItemSize = 0;
-  QuicTxPacketList::iterator it = m_appList.begin ();
 
-  while (it != m_appList.end ())
+  // Take the data in order from the head of the application list
+  while (!m_appList.empty () && outItemSize < numBytes)
     {
-      currentItem = *it;
-      currentPacket = currentItem->m_packet;
-
-//	  uint32_t subheaderSize = 0;
-//	  if(m_TxBufferType == SOCKET)
-//	  {
-//		  QuicSubheader sub;
-//		  currentItem->m_packet->PeekHeader(sub);
-//		  subheaderSize = sub.GetSerializedSize();
-//	  }
-
-      if (outItemSize + currentItem->m_packet->GetSize () /*- subheaderSize*/ <= numBytes)   // Merge
+      QuicStreamTxItem *currentItem = m_appList.front ().get ();
+      uint32_t currentSize = currentItem->m_packet->GetSize ();
+
+      if (outItemSize + currentSize <= numBytes)   // Merge
         {
-          QuicSubheader qsb;
           NS_LOG_LOGIC ("Extracting packet from stream TX buffer");
-          toInsert = true;
           MergeItems (*outItem, *currentItem);
-          outItemSize += currentItem->m_packet->GetSize ();
+          outItemSize += currentSize;
+          m_appList.pop_front ();
+          m_appSize -= currentSize;
+        }
+      else   // Split, the rest stays at the head of the list
+        {
+          NS_LOG_LOGIC ("Splitting packet in stream TX buffer");
+          QuicStreamTxItem firstPart;
+          SplitItems (firstPart, *currentItem, numBytes - outItemSize);
+          MergeItems (*outItem, firstPart);
+          m_appSize -= numBytes - outItemSize;
+          outItemSize = numBytes;
+        }
+    }
 
-          m_appList.erase (it);
-          m_appSize -= currentItem->m_packet->GetSize ();
+  m_sentList.push_back (std::move (outItem));
+  m_sentSize += outItemSize;
 
-          delete currentItem;
+  NS_LOG_INFO ("Update: Sent Size = " << m_sentSize);
 
-          it = m_appList.begin (); // Torno all'inizio per ricercare altri possibili merge
-          continue;
-        }
+  return m_sentList.back ().get ();
+}
+
+void
+QuicStreamTxBuffer::OnFrameAcked (uint64_t offset, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << offset << length);
 
-      it++;
+  uint64_t end = offset + length;
+  if (end <= m_ackedOffset)
+    {
+      return;
     }
+  offset = std::max (offset, m_ackedOffset);
+  m_lostSize -= RemoveRange (m_lostRanges, offset, end);
+  AddRange (m_ackedRanges, offset, end);
 
-  if (toInsert)
+  // the data acked without gaps is not needed anymore
+  QuicTxRangeSet::iterator it = m_ackedRanges.begin ();
+  if (it->first > m_ackedOffset)
+    {
+      return;
+    }
+  m_ackedOffset = it->second;
+  m_ackedRanges.erase (it);
+  while (!m_sentList.empty ())
     {
-      m_sentList.insert (m_sentList.end (), outItem);
-      m_sentSize += outItem->m_packet->GetSize ();
+      QuicStreamTxItem *item = m_sentList.front ().get ();
+      uint32_t size = item->m_packet->GetSize ();
+      if (item->m_packetNumberSequence.GetValue () + size > m_ackedOffset)
+        {
+          break;
+        }
+      NS_LOG_LOGIC ("Discard acked data at offset " << item->m_packetNumberSequence);
+      m_sentList.pop_front ();
+      m_sentSize -= size;
     }
+  NS_LOG_INFO ("Acked up to " << m_ackedOffset << ", Sent Size = " << m_sentSize);
+}
 
-  NS_LOG_INFO ("Update: Sent Size = " << m_sentSize);
+void
+QuicStreamTxBuffer::OnFrameLost (uint64_t offset, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << offset << length);
 
-  return outItem;
+  uint64_t end = offset + length;
+  offset = std::max (offset, m_ackedOffset);
+
+  // retransmit only the gaps between the acked ranges
+  QuicTxRangeSet::const_iterator it = m_ackedRanges.upper_bound (offset);
+  if (it != m_ackedRanges.begin () and std::prev (it)->second > offset)
+    {
+      offset = std::prev (it)->second;
+    }
+  while (offset < end)
+    {
+      uint64_t gapEnd = (it == m_ackedRanges.end ()) ? end : std::min (end, it->first);
+      if (gapEnd > offset)
+        {
+          m_lostSize += AddRange (m_lostRanges, offset, gapEnd);
+        }
+      if (it == m_ackedRanges.end ())
+        {
+          break;
+        }
+      offset = it->second;
+      ++it;
+    }
+  NS_LOG_INFO ("Lost Size = " << m_lostSize);
 }
 
-void
-QuicStreamTxBuffer::OnAckUpdate (const uint64_t largestAcknowledged, const std::vector<uint64_t> &additionalAckBlocks, const std::vector<uint64_t> &gaps)
+uint32_t
+QuicStreamTxBuffer::GetLostSize () const
 {
-  NS_LOG_FUNCTION (this);
-  std::vector<uint64_t> compAckBlocks = additionalAckBlocks;
-  std::vector<uint64_t> compGaps = additionalAckBlocks;
+  return m_lostSize;
+}
 
-  NS_LOG_INFO ("Handling Ack - highest packet " << largestAcknowledged);
-  compAckBlocks.insert (compAckBlocks.begin (), largestAcknowledged);
-  compGaps.push_back (0);
-  uint64_t ackBlockCount = compAckBlocks.size ();
+uint64_t
+QuicStreamTxBuffer::GetLostOffset () const
+{
+  if (m_lostRanges.empty ())
+    {
+      return 0;
+    }
+  return m_lostRanges.begin ()->first;
+}
+
+Ptr<Packet>
+QuicStreamTxBuffer::NextLostSequence (uint32_t numBytes)
+{
+  NS_LOG_FUNCTION (this << numBytes);
+
+  Ptr<Packet> out = Create<Packet> ();
+  if (m_lostRanges.empty () or numBytes == 0)
+    {
+      return out;
+    }
 
-  std::vector<uint64_t>::const_iterator ack_it = compAckBlocks.begin ();
-  std::vector<uint64_t>::const_iterator gap_it = compGaps.begin ();
+  uint64_t start = m_lostRanges.begin ()->first;
+  uint64_t end = std::min (m_lostRanges.begin ()->second, start + numBytes);
 
-  for (uint64_t numAckBlockAnalyzed = 0; numAckBlockAnalyzed < ackBlockCount; numAckBlockAnalyzed++, ack_it++, gap_it++)
+  // gather the data from the frames in which it was sent
+  for (QuicTxPacketList::iterator it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      for (auto sent_it = m_sentList.rbegin (); sent_it != m_sentList.rend () and !m_sentList.empty (); ++sent_it)       // Visit sentList in reverse Order for optimization
+      QuicStreamTxItem *item = it->get ();
+      uint64_t itemStart = item->m_packetNumberSequence.GetValue ();
+      uint64_t itemEnd = itemStart + item->m_packet->GetSize ();
+      if (itemEnd <= start)
         {
-          if ((*sent_it)->m_packetNumberSequence < (SequenceNumber32)(*gap_it) )              // Just for optimization we suppose All is perfectly ordered
-            {
-              break;
-            }
+          continue;
+        }
+      if (itemStart >= end)
+        {
+          break;
+        }
+      uint64_t from = std::max (start, itemStart);
+      uint64_t to = std::min (end, itemEnd);
+      out->AddAtEnd (item->m_packet->CreateFragment (from - itemStart, to - from));
+      item->m_retrans = true;
+    }
+  NS_ASSERT_MSG (out->GetSize () == end - start, "Lost data at offset " << start << " not in the sent list");
 
-          if ((*sent_it)->m_packetNumberSequence <= (SequenceNumber32)(*ack_it)and (*sent_it)->m_packetNumberSequence > (SequenceNumber32)(*gap_it)and (*sent_it)->m_sacked == false)
-            {
-              NS_LOG_LOGIC ("Acked packet " << (*sent_it)->m_packetNumberSequence);
-              (*sent_it)->m_sacked = true;
-            }
+  m_lostSize -= RemoveRange (m_lostRanges, start, end);
+  NS_LOG_INFO ("Retransmit " << end - start << " bytes at offset " << start << ", Lost Size = " << m_lostSize);
+  return out;
+}
+
+uint64_t
+QuicStreamTxBuffer::AddRange (QuicTxRangeSet &ranges, uint64_t start, uint64_t end) const
+{
+  uint64_t added = end - start;
+  QuicTxRangeSet::iterator it = ranges.upper_bound (start);
+  if (it != ranges.begin () and std::prev (it)->second >= start)
+    {
+      --it;
+    }
+  while (it != ranges.end () and it->first <= end)
+    {
+      uint64_t overlapStart = std::max (start, it->first);
+      uint64_t overlapEnd = std::min (end, it->second);
+      if (overlapEnd > overlapStart)
+        {
+          added -= overlapEnd - overlapStart;
+        }
+      start = std::min (start, it->first);
+      end = std::max (end, it->second);
+      it = ranges.erase (it);
+    }
+  ranges[start] = end;
+  return added;
+}
 
+uint64_t
+QuicStreamTxBuffer::RemoveRange (QuicTxRangeSet &ranges, uint64_t start, uint64_t end) const
+{
+  uint64_t removed = 0;
+  QuicTxRangeSet::iterator it = ranges.upper_bound (start);
+  if (it != ranges.begin ())
+    {
+      --it;
+    }
+  while (it != ranges.end () and it->first < end)
+    {
+      uint64_t rangeStart = it->first;
+      uint64_t rangeEnd = it->second;
+      if (rangeEnd <= start)
+        {
+          ++it;
+          continue;
+        }
+      it = ranges.erase (it);
+      removed += std::min (rangeEnd, end) - std::max (rangeStart, start);
+      // keep the parts outside of the removed range
+      if (rangeStart < start)
+        {
+          ranges[rangeStart] = start;
+        }
+      if (rangeEnd > end)
+        {
+          ranges[end] = rangeEnd;
         }
     }
+  return removed;
 }
 
+void
+QuicStreamTxBuffer::SplitItems (QuicStreamTxItem &t1, QuicStreamTxItem &t2, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (size < t2.m_packet->GetSize ());
+
+  t1.m_packetNumberSequence = t2.m_packetNumberSequence;
+  t1.m_lost = t2.m_lost;
+  t1.m_retrans = t2.m_retrans;
+  t1.m_sacked = t2.m_sacked;
+  t1.m_lastSent = t2.m_lastSent;
+  t1.m_queued = t2.m_queued;
+  t1.m_packet = t2.m_packet->CreateFragment (0, size);
+  t2.m_packet->RemoveAtStart (size);
+}
 
 void
 QuicStreamTxBuffer::MergeItems (QuicStreamTxItem &t1, QuicStreamTxItem &t2) const
@@ -388,5 +531,15 @@ QuicStreamTxBuffer::BytesInFlight () const
 
 }
 
+Time
+QuicStreamTxBuffer::HeadQueuedTime () const
+{
+  if (m_appList.empty ())
+    {
+      return Time::Max ();
+    }
+  return m_appList.front ()->m_queued;
+}
+
 
 }
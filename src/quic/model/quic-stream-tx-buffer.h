@@ -25,11 +25,14 @@
 #ifndef QUICSTREAMTXBUFFER_H
 #define QUICSTREAMTXBUFFER_H
 
+#include <map>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
 #include "ns3/nstime.h"
+#include "quic-header.h"
 #include "quic-subheader.h"
+#include "quic-item-pool.h"
 
 namespace ns3 {
 
@@ -50,12 +53,13 @@ public:
    */
   void Print (std::ostream &os) const;
 
-  SequenceNumber32 m_packetNumberSequence;  //!< Sequence number of the application packet associated with this frame
+  SequenceNumber64 m_packetNumberSequence;  //!< Sequence number of the application packet associated with this frame
   Ptr<Packet> m_packet;                     //!< packet associated to this QuicStreamTxItem
   bool m_lost;                              //!< true if the frame is lost
   bool m_retrans;                           //!< true if it is a retx
   bool m_sacked;                            //!< true if already acknowledged
   Time m_lastSent;                          //!< time at which it was sent
+  Time m_queued;                            //!< time at which the application queued the data
   uint64_t m_id; // UNUSED !!?
 
 
@@ -65,6 +69,9 @@ public:
  * \ingroup quic
  *
  * \brief Tx stream buffer for QUIC
+ *
+ * The items of the buffer are taken from a pool owned by the buffer, and go
+ * back to it when they leave the buffer.
  */
 class QuicStreamTxBuffer : public Object
 {
@@ -110,27 +117,62 @@ public:
    * \param seq the sequence number of the next frame to transmit
    * \return the next frame to transmit
    */
-  Ptr<Packet> NextSequence (uint32_t numBytes, const SequenceNumber32 seq);
+  Ptr<Packet> NextSequence (uint32_t numBytes, const SequenceNumber64 seq);
 
   /**
    * \brief Get a block of data not transmitted yet and move it into SentList
    *
    * \param numBytes number of bytes of the QuicSocketTxItem requested
-   * \return the item that contains the right packet
+   * \return the item that contains the right packet, owned by the sent list
    */
   QuicStreamTxItem* GetNewSegment (uint32_t numBytes);
 
   /**
-   * Process an acknowledgment, set the frames in the send buffer as acknowledged, mark
-   * lost frames (according to the QUIC IETF draft)
+   * \brief Process the acknowledgment of a range of sent data
+   *
+   * The range is no longer retransmitted, and the sent data acknowledged up
+   * to the first gap is discarded.
+   *
+   * \param offset the stream offset of the first acknowledged byte
+   * \param length the number of acknowledged bytes
+   */
+  void OnFrameAcked (uint64_t offset, uint32_t length);
+
+  /**
+   * \brief Mark a range of sent data as lost, to be retransmitted
+   *
+   * The parts of the range already acknowledged, e.g., by a previous
+   * retransmission, are ignored.
+   *
+   * \param offset the stream offset of the first lost byte
+   * \param length the number of lost bytes
+   */
+  void OnFrameLost (uint64_t offset, uint32_t length);
+
+  /**
+   * \brief Get the amount of lost data waiting to be retransmitted
    *
-   * \brief Process an ACK
+   * \return the number of lost bytes
+   */
+  uint32_t GetLostSize () const;
+
+  /**
+   * \brief Get the stream offset of the first lost byte
    *
-   * \param largestAcknowledged The largest acknowledged sequence number
-   * \param additionalAckBlocks The sequence numbers that were just acknowledged
-   * \param gaps The gaps in the acknowledgment
+   * \return the offset of the lowest lost range, only meaningful if there is lost data
    */
-  void OnAckUpdate (const uint64_t largestAcknowledged, const std::vector<uint64_t> &additionalAckBlocks, const std::vector<uint64_t> &gaps);
+  uint64_t GetLostOffset () const;
+
+  /**
+   * \brief Get the next block of lost data to retransmit
+   *
+   * The block is taken from the lowest lost range, starting at GetLostOffset,
+   * and may span several of the frames in which the data was sent.
+   *
+   * \param numBytes the maximum number of bytes
+   * \return the lost data, empty if there is none
+   */
+  Ptr<Packet> NextLostSequence (uint32_t numBytes);
 
   /**
    * Get the max size of the buffer
@@ -167,8 +209,36 @@ public:
    */
   uint32_t BytesInFlight () const;
 
+  /**
+   * \brief Get the time at which the oldest data in the application buffer was queued
+   *
+   * \return the queueing time, or Time::Max () if the application buffer is empty
+   */
+  Time HeadQueuedTime () const;
+
 private:
-  typedef std::list<QuicStreamTxItem*> QuicTxPacketList;  //!< container for data stored in the buffer
+  typedef std::list<QuicItemPool<QuicStreamTxItem>::Handle> QuicTxPacketList;  //!< container for data stored in the buffer
+  typedef std::map<uint64_t, uint64_t> QuicTxRangeSet;      //!< disjoint ranges of stream offsets, from start to end
+
+  /**
+   * \brief Add a range to a set, merging it with the ranges it overlaps or touches
+   *
+   * \param ranges the set of ranges
+   * \param start the first offset of the range
+   * \param end the offset past the range
+   * \return the number of offsets that were not in the set
+   */
+  uint64_t AddRange (QuicTxRangeSet &ranges, uint64_t start, uint64_t end) const;
+
+  /**
+   * \brief Remove a range from a set
+   *
+   * \param ranges the set of ranges
+   * \param start the first offset of the range
+   * \param end the offset past the range
+   * \return the number of offsets removed from the set
+   */
+  uint64_t RemoveRange (QuicTxRangeSet &ranges, uint64_t start, uint64_t end) const;
 
   /**
    * \brief Merge two QuicStreamTxItem
@@ -193,11 +263,16 @@ private:
    */
   void SplitItems (QuicStreamTxItem &t1, QuicStreamTxItem &t2, uint32_t size) const; // Available only for streams
 
+  QuicItemPool<QuicStreamTxItem> m_itemPool;  //!< Pool of the items, declared first to outlive them
   QuicTxPacketList m_appList;   //!< List of buffered application data to be transmitted with additional info
-  QuicTxPacketList m_sentList;  //!< List of sent frame with additional info
+  QuicTxPacketList m_sentList;  //!< List of sent frame with additional info, ordered by stream offset
   uint32_t m_maxBuffer;         //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_appSize;           //!< Size of all data in the application list
   uint32_t m_sentSize;          //!< Size of all data in the sent list
+  QuicTxRangeSet m_lostRanges;  //!< Sent data to retransmit
+  uint32_t m_lostSize;          //!< Size of all data in m_lostRanges
+  QuicTxRangeSet m_ackedRanges; //!< Sent data acknowledged beyond m_ackedOffset
+  uint64_t m_ackedOffset;       //!< All the data below this offset is acknowledged
 
 };
 
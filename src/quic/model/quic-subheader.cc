@@ -35,6 +35,45 @@ NS_LOG_COMPONENT_DEFINE ("QuicSubheader");
 
 NS_OBJECT_ENSURE_REGISTERED (QuicSubheader);
 
+const uint64_t QuicSubheader::MAX_VARINT = 4611686018427387903ULL;
+
+namespace {
+
+/**
+ * Size in bytes of a variable-length integer, indexed by the number of
+ * significant bits of its value; 0 if the value exceeds 62 bits
+ */
+const uint8_t g_varIntSizeByBits[65] = {
+  1, 1, 1, 1, 1, 1, 1,                                       // 0 to 6 bits
+  2, 2, 2, 2, 2, 2, 2, 2,                                    // 7 to 14 bits
+  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,            // 15 to 30 bits
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,            // 31 to 62 bits
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  0, 0                                                       // 63 and 64 bits
+};
+
+/**
+ * Two-bit length code of a variable-length integer, indexed by its size in bytes
+ */
+const uint8_t g_varIntCodeBySize[9] = { 0, 0, 1, 0, 2, 0, 0, 0, 3 };
+
+/**
+ * Size in bytes of a variable-length integer, indexed by its two-bit length code
+ */
+const uint8_t g_varIntSizeByCode[4] = { 1, 2, 4, 8 };
+
+/**
+ * \param value a value
+ * \return the number of significant bits of the value, 1 for 0
+ */
+inline uint32_t
+GetBitLength (uint64_t value)
+{
+  return 64 - __builtin_clzll (value | 1);
+}
+
+} // anonymous namespace
+
 QuicSubheader::QuicSubheader ()
   : m_frameType (PADDING),
     m_streamId (0),
@@ -49,14 +88,14 @@ QuicSubheader::QuicSubheader ()
     //statelessResetToken(0),
     m_largestAcknowledged (0),
     m_ackDelay (0),
-    m_ackBlockCount (0),
     m_firstAckBlock (0),
     m_data (0),
-    m_length (0)
+    m_length (0),
+    m_ackElicitingThreshold (0),
+    m_requestMaxAckDelay (0),
+    m_reorderingThreshold (0)
 {
   m_reasonPhrase = std::vector<uint8_t> ();
-  m_additionalAckBlocks = std::vector<uint32_t> ();
-  m_gaps = std::vector<uint32_t> ();
 }
 
 QuicSubheader::~QuicSubheader ()
@@ -83,7 +122,7 @@ QuicSubheader::GetInstanceTypeId (void) const
 std::string
 QuicSubheader::FrameTypeToString () const
 {
-  static const char* frameTypeNames[24] = {
+  static const char* frameTypeNames[26] = {
     "PADDING",
     "RST_STREAM",
     "CONNECTION_CLOSE",
@@ -107,7 +146,9 @@ QuicSubheader::FrameTypeToString () const
     "STREAM100",
     "STREAM101",
     "STREAM110",
-    "STREAM111"
+    "STREAM111",
+    "ACK_FREQUENCY",
+    "IMMEDIATE_ACK"
   };
   std::string typeDescription = "";
 
@@ -154,7 +195,7 @@ uint32_t
 QuicSubheader::CalculateSubHeaderLength () const
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (m_frameType >= PADDING and m_frameType <= STREAM111);
+  NS_ASSERT (m_frameType >= PADDING and m_frameType <= IMMEDIATE_ACK);
   uint32_t len = 8;
 
   switch (m_frameType)
@@ -237,12 +278,12 @@ QuicSubheader::CalculateSubHeaderLength () const
 
       len += GetVarInt64Size (m_largestAcknowledged);
       len += GetVarInt64Size (m_ackDelay);
-      len += GetVarInt64Size (m_ackBlockCount);
+      len += GetVarInt64Size (m_ackRanges.GetCount ());
       len += GetVarInt64Size (m_firstAckBlock);
-      for (uint64_t j = 0; j < m_ackBlockCount; j++)
+      for (uint32_t j = 0; j < m_ackRanges.GetCount (); j++)
         {
-          len += GetVarInt64Size (m_gaps[j]);
-          len += GetVarInt64Size (m_additionalAckBlocks[j]);
+          len += GetVarInt64Size (m_ackRanges.GetGap (j));
+          len += GetVarInt64Size (m_ackRanges.GetBlock (j));
         }
       break;
 
@@ -309,6 +350,18 @@ QuicSubheader::CalculateSubHeaderLength () const
       // The frame marks the end of the stream
       break;
 
+    case ACK_FREQUENCY:
+
+      len += GetVarInt64Size (m_sequence);
+      len += GetVarInt64Size (m_ackElicitingThreshold);
+      len += GetVarInt64Size (m_requestMaxAckDelay);
+      len += GetVarInt64Size (m_reorderingThreshold);
+      break;
+
+    case IMMEDIATE_ACK:
+
+      break;
+
     }
 
   NS_LOG_LOGIC ("CalculateSubHeaderLength - len" << len << " " << len / 8);
@@ -323,7 +376,7 @@ void
 QuicSubheader::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << (uint64_t)m_frameType);
-  NS_ASSERT (m_frameType >= PADDING and m_frameType <= STREAM111);
+  NS_ASSERT (m_frameType >= PADDING and m_frameType <= IMMEDIATE_ACK);
 
   Buffer::Iterator i = start;
   i.WriteU8 ((uint8_t)m_frameType);
@@ -415,12 +468,12 @@ QuicSubheader::Serialize (Buffer::Iterator start) const
 
       WriteVarInt64 (i, m_largestAcknowledged);
       WriteVarInt64 (i, m_ackDelay);
-      WriteVarInt64 (i, m_ackBlockCount);
+      WriteVarInt64 (i, m_ackRanges.GetCount ());
       WriteVarInt64 (i, m_firstAckBlock);
-      for (uint64_t j = 0; j < m_ackBlockCount; j++)
+      for (uint32_t j = 0; j < m_ackRanges.GetCount (); j++)
         {
-          WriteVarInt64 (i, m_gaps[j]);
-          WriteVarInt64 (i, m_additionalAckBlocks[j]);
+          WriteVarInt64 (i, m_ackRanges.GetGap (j));
+          WriteVarInt64 (i, m_ackRanges.GetBlock (j));
         }
       break;
 
@@ -486,6 +539,18 @@ QuicSubheader::Serialize (Buffer::Iterator start) const
       // The frame marks the end of the stream
       break;
 
+    case ACK_FREQUENCY:
+
+      WriteVarInt64 (i, m_sequence);
+      WriteVarInt64 (i, m_ackElicitingThreshold);
+      WriteVarInt64 (i, m_requestMaxAckDelay);
+      WriteVarInt64 (i, m_reorderingThreshold);
+      break;
+
+    case IMMEDIATE_ACK:
+
+      break;
+
     }
 }
 
@@ -497,7 +562,7 @@ QuicSubheader::Deserialize (Buffer::Iterator start)
 
   NS_LOG_FUNCTION (this << (uint64_t)m_frameType);
 
-  NS_ASSERT (m_frameType >= PADDING and m_frameType <= STREAM111);
+  NS_ASSERT (m_frameType >= PADDING and m_frameType <= IMMEDIATE_ACK);
 
   switch (m_frameType)
     {
@@ -583,16 +648,18 @@ QuicSubheader::Deserialize (Buffer::Iterator start)
       break;
 
     case ACK:
-
-      m_largestAcknowledged = ReadVarInt64 (i);
-      m_ackDelay = ReadVarInt64 (i);
-      m_ackBlockCount = ReadVarInt64 (i);
-      m_firstAckBlock = ReadVarInt64 (i);
-      for (uint64_t j = 0; j < m_ackBlockCount; j++)
-        {
-          m_gaps.push_back (ReadVarInt64 (i));
-          m_additionalAckBlocks.push_back (ReadVarInt64 (i));
-        }
+      {
+        m_largestAcknowledged = ReadVarInt64 (i);
+        m_ackDelay = ReadVarInt64 (i);
+        uint64_t ackBlockCount = ReadVarInt64 (i);
+        m_firstAckBlock = ReadVarInt64 (i);
+        m_ackRanges.Clear ();
+        for (uint64_t j = 0; j < ackBlockCount; j++)
+          {
+            uint64_t gap = ReadVarInt64 (i);
+            m_ackRanges.Add (gap, ReadVarInt64 (i));
+          }
+      }
       break;
 
     case PATH_CHALLENGE:
@@ -657,6 +724,18 @@ QuicSubheader::Deserialize (Buffer::Iterator start)
       // The frame marks the end of the stream
       break;
 
+    case ACK_FREQUENCY:
+
+      m_sequence = ReadVarInt64 (i);
+      m_ackElicitingThreshold = ReadVarInt64 (i);
+      m_requestMaxAckDelay = ReadVarInt64 (i);
+      m_reorderingThreshold = ReadVarInt64 (i);
+      break;
+
+    case IMMEDIATE_ACK:
+
+      break;
+
     }
 
   NS_LOG_INFO ("Deserialized a subheader of size " << GetSerializedSize ());
@@ -667,7 +746,7 @@ void
 QuicSubheader::Print (std::ostream &os) const
 {
   NS_LOG_FUNCTION (this << (uint64_t) m_frameType);
-  NS_ASSERT (m_frameType >= PADDING and m_frameType <= STREAM111);
+  NS_ASSERT (m_frameType >= PADDING and m_frameType <= IMMEDIATE_ACK);
 
   os << "|" << FrameTypeToString () << "|\n";
   switch (m_frameType)
@@ -759,12 +838,12 @@ QuicSubheader::Print (std::ostream &os) const
 
       os << "|Largest Acknowledged " << m_largestAcknowledged << "|\n";
       os << "|Ack Delay " << m_ackDelay << "|\n";
-      os << "|Ack Block Count " << m_ackBlockCount << "|\n";
+      os << "|Ack Block Count " << m_ackRanges.GetCount () << "|\n";
       os << "|First Ack Block " << m_firstAckBlock << "|\n";
-      for (uint64_t j = 0; j < m_ackBlockCount; j++)
+      for (uint32_t j = 0; j < m_ackRanges.GetCount (); j++)
         {
-          os << "|Gap " << m_gaps[j] << "|\n";
-          os << "|Additional Ack Block " << m_additionalAckBlocks[j] << "|\n";
+          os << "|Gap " << m_ackRanges.GetGap (j) << "|\n";
+          os << "|Additional Ack Block " << m_ackRanges.GetBlock (j) << "|\n";
         }
       break;
 
@@ -829,6 +908,18 @@ QuicSubheader::Print (std::ostream &os) const
       os << "|Length " << m_length << "|\n";
       // The frame marks the end of the stream
       break;
+
+    case ACK_FREQUENCY:
+
+      os << "|Sequence " << m_sequence << "|\n";
+      os << "|Ack-Eliciting Threshold " << m_ackElicitingThreshold << "|\n";
+      os << "|Request Max Ack Delay " << m_requestMaxAckDelay << "|\n";
+      os << "|Reordering Threshold " << m_reorderingThreshold << "|\n";
+      break;
+
+    case IMMEDIATE_ACK:
+
+      break;
     }
 }
 
@@ -849,133 +940,60 @@ operator<< (std::ostream& os, QuicSubheader& tc)
 void
 QuicSubheader::WriteVarInt64 (Buffer::Iterator& i, uint64_t varInt64) const
 {
-  //NS_LOG_FUNCTION(this);
-
-  uint8_t mask = 0x00;
-  if (varInt64 <= 63)
+  uint32_t size = g_varIntSizeByBits[GetBitLength (varInt64)];
+  // the two most significant bits encode the length
+  uint64_t encoded = varInt64 | ((uint64_t) g_varIntCodeBySize[size] << (8 * size - 2));
+  // the integer is written with the widest stores available, which go
+  // straight to the buffer memory when the iterator is in a contiguous area
+  switch (size)
     {
-      uint8_t buffer[1];
-      buffer[0] = (uint8_t)varInt64;
-      i.WriteU8 (buffer[0]);
-    }
-  else if (varInt64 <= 16383)
-    {
-      mask = 0x40;
-      uint8_t buffer[2];
-      buffer[0] = (uint8_t)(varInt64 >> 8);
-      buffer[1] = (uint8_t)varInt64;
-      buffer[0] |= mask;
-
-      for (int j = 0; j < 2; j++)
-        {
-          i.WriteU8 (buffer[j]);
-        }
-    }
-  else if (varInt64 <= 1073741823)
-    {
-      mask = 0x80;
-      uint8_t buffer[4];
-      for (int i = 0; i < 4; i++)
-        {
-          buffer[i] = (uint8_t)(varInt64 >> (8 * (3 - i)));
-          //NS_LOG_INFO("WriteVarInt64 - buffer[i] " << (uint64_t)buffer[i]);
-        }
-
-      buffer[0] |= mask;
-
-      for (int j = 0; j < 4; j++)
-        {
-          i.WriteU8 (buffer[j]);
-        }
-
-    }
-  else if (varInt64 <= 4611686018427387903)
-    {
-      mask = 0xC0;
-      uint8_t buffer[8];
-
-      for (int i = 0; i < 8; i++)
-        {
-          buffer[i] = (uint8_t)(varInt64 >> (8 * (7 - i)));
-          //NS_LOG_INFO("WriteVarInt64 - buffer[i] " << (uint64_t)buffer[i]);
-        }
-
-      buffer[0] |= mask;
-
-      for (int j = 0; j < 8; j++)
-        {
-          i.WriteU8 (buffer[j]);
-        }
-    }
-  else
-    {
-      return;           // Error too much large
+    case 1:
+      i.WriteU8 ((uint8_t) encoded);
+      break;
+    case 2:
+      i.WriteHtonU16 ((uint16_t) encoded);
+      break;
+    case 4:
+      i.WriteHtonU32 ((uint32_t) encoded);
+      break;
+    case 8:
+      i.WriteHtonU32 ((uint32_t) (encoded >> 32));
+      i.WriteHtonU32 ((uint32_t) encoded);
+      break;
+    default:
+      NS_ABORT_MSG ("Variable-length integer " << varInt64 << " exceeds 62 bits");
     }
-
-  //NS_LOG_INFO("WriteVarInt64 - bytestream32 " << (uint64_t)bytestream32 << " varInt64 " << varInt64 << " mask " << mask);
-
 }
 
 uint64_t
 QuicSubheader::ReadVarInt64 (Buffer::Iterator& i)
 {
-  //NS_LOG_FUNCTION(this);
-
-  uint8_t bytestream8 = i.ReadU8 ();
-  uint8_t mask = bytestream8 & 0b11000000;
-  bytestream8 &= 0b00111111;
-
-  uint64_t bytestream64 = 0;
-
-  if (mask == 0x00)
+  uint32_t size = g_varIntSizeByCode[i.PeekU8 () >> 6];
+  uint64_t encoded = 0;
+  switch (size)
     {
-      bytestream64 = (uint64_t)bytestream8;
-    }
-  else if (mask == 0x40)
-    {
-      bytestream64 = ((uint64_t)bytestream8 << 8) | (uint64_t)i.ReadU8 ();
-    }
-  else if (mask == 0x80)
-    {
-      bytestream64 = ((uint64_t)bytestream8 << 24) | ((uint64_t)i.ReadU8 () << 16) | ((uint64_t)i.ReadU8 () << 8) | (uint64_t)i.ReadU8 ();
-    }
-  else if (mask == 0xC0)
-    {
-      bytestream64 = ((uint64_t)bytestream8 << 56) | ((uint64_t)i.ReadU8 () << 48) | ((uint64_t)i.ReadU8 () << 40) | ((uint64_t)i.ReadU8 () << 32) | ((uint64_t)i.ReadU8 () << 24) | ((uint64_t)i.ReadU8 () << 16) | ((uint64_t)i.ReadU8 () << 8) | (uint64_t)i.ReadU8 ();
+    case 1:
+      encoded = i.ReadU8 ();
+      break;
+    case 2:
+      encoded = i.ReadNtohU16 ();
+      break;
+    case 4:
+      encoded = i.ReadNtohU32 ();
+      break;
+    default:
+      encoded = (uint64_t) i.ReadNtohU32 () << 32;
+      encoded |= i.ReadNtohU32 ();
+      break;
     }
-
-  //NS_LOG_INFO("ReadVarInt64 - bytestream8 " << (uint64_t)bytestream8 << " bytestream64 " << bytestream64 << " mask " << (uint64_t)mask);
-
-  return bytestream64;
+  // drop the length bits
+  return encoded & (~(uint64_t) 0 >> (66 - 8 * size));
 }
 
 uint32_t
 QuicSubheader::GetVarInt64Size (uint64_t varInt64)
 {
-
-  //NS_LOG_FUNCTION(this);
-
-  if (varInt64 <= 63)
-    {
-      return (uint32_t) 8;
-    }
-  else if (varInt64 <= 16383)
-    {
-      return (uint32_t) 16;
-    }
-  else if (varInt64 <= 1073741823)
-    {
-      return (uint32_t) 32;
-    }
-  else if (varInt64 <= 4611686018427387903)
-    {
-      return (uint32_t) 64;
-    }
-  else
-    {
-      return 0;
-    }
-
+  return 8 * g_varIntSizeByBits[GetBitLength (varInt64)];
 }
 
 QuicSubheader
@@ -1159,7 +1177,7 @@ QuicSubheader::CreateStopSending (uint64_t streamId, uint16_t applicationErrorCo
 }
 
 QuicSubheader
-QuicSubheader::CreateAck (uint32_t largestAcknowledged, uint64_t ackDelay, uint32_t firstAckBlock, std::vector<uint32_t>& gaps, std::vector<uint32_t>& additionalAckBlocks)
+QuicSubheader::CreateAck (uint64_t largestAcknowledged, uint64_t ackDelay, uint64_t firstAckBlock, std::vector<uint64_t>& gaps, std::vector<uint64_t>& additionalAckBlocks)
 {
   NS_LOG_INFO ("Created Ack Header");
 
@@ -1167,10 +1185,29 @@ QuicSubheader::CreateAck (uint32_t largestAcknowledged, uint64_t ackDelay, uint3
   sub.SetFrameType (ACK);
   sub.SetLargestAcknowledged (largestAcknowledged);
   sub.SetAckDelay (ackDelay);
-  sub.SetAckBlockCount (gaps.size ());
   sub.SetFirstAckBlock (firstAckBlock);
-  sub.SetGaps (gaps);
-  sub.SetAdditionalAckBlocks (additionalAckBlocks);
+  NS_ASSERT (gaps.size () == additionalAckBlocks.size ());
+  QuicAckRanges ackRanges;
+  for (uint32_t j = 0; j < gaps.size (); j++)
+    {
+      ackRanges.Add (gaps[j], additionalAckBlocks[j]);
+    }
+  sub.SetAckRanges (ackRanges);
+
+  return sub;
+}
+
+QuicSubheader
+QuicSubheader::CreateAck (uint64_t largestAcknowledged, uint64_t ackDelay, uint64_t firstAckBlock, const QuicAckRanges& ackRanges)
+{
+  NS_LOG_INFO ("Created Ack Header");
+
+  QuicSubheader sub;
+  sub.SetFrameType (ACK);
+  sub.SetLargestAcknowledged (largestAcknowledged);
+  sub.SetAckDelay (ackDelay);
+  sub.SetFirstAckBlock (firstAckBlock);
+  sub.SetAckRanges (ackRanges);
 
   return sub;
 }
@@ -1223,6 +1260,47 @@ QuicSubheader::CreateStreamSubHeader (uint64_t streamId, uint64_t offset, uint64
   return sub;
 }
 
+QuicSubheader
+QuicSubheader::CreateAckFrequency (uint64_t sequence, uint64_t ackElicitingThreshold, uint64_t requestMaxAckDelay, uint64_t reorderingThreshold)
+{
+  NS_LOG_INFO ("Created AckFrequency Header");
+
+  QuicSubheader sub;
+  sub.SetFrameType (ACK_FREQUENCY);
+  sub.SetSequence (sequence);
+  sub.SetAckElicitingThreshold (ackElicitingThreshold);
+  sub.SetRequestMaxAckDelay (requestMaxAckDelay);
+  sub.SetReorderingThreshold (reorderingThreshold);
+
+  return sub;
+}
+
+QuicSubheader
+QuicSubheader::CreateImmediateAck (void)
+{
+  NS_LOG_INFO ("Created ImmediateAck Header");
+
+  QuicSubheader sub;
+  sub.SetFrameType (IMMEDIATE_ACK);
+
+  return sub;
+}
+
+uint32_t
+QuicSubheader::GetStreamSubHeaderSize (uint64_t streamId, uint64_t offset, uint64_t length, bool offBit, bool lengthBit)
+{
+  uint32_t len = 8 + GetVarInt64Size (streamId);
+  if (offBit)
+    {
+      len += GetVarInt64Size (offset);
+    }
+  if (lengthBit)
+    {
+      len += GetVarInt64Size (length);
+    }
+  return len / 8;
+}
+
 bool
 QuicSubheader::IsPadding () const
 {
@@ -1331,24 +1409,41 @@ QuicSubheader::IsStreamFin () const
   return m_frameType & 0b00000001;
 }
 
-uint32_t QuicSubheader::GetAckBlockCount () const
+bool
+QuicSubheader::IsAckFrequency () const
+{
+  return m_frameType == ACK_FREQUENCY;
+}
+
+bool
+QuicSubheader::IsImmediateAck () const
 {
-  return m_ackBlockCount;
+  return m_frameType == IMMEDIATE_ACK;
 }
 
-void QuicSubheader::SetAckBlockCount (uint32_t ackBlockCount)
+uint64_t QuicSubheader::GetAckBlockCount () const
 {
-  m_ackBlockCount = ackBlockCount;
+  return m_ackRanges.GetCount ();
 }
 
-const std::vector<uint32_t>& QuicSubheader::GetAdditionalAckBlocks () const
+const QuicAckRanges& QuicSubheader::GetAckRanges () const
 {
-  return m_additionalAckBlocks;
+  return m_ackRanges;
 }
 
-void QuicSubheader::SetAdditionalAckBlocks (const std::vector<uint32_t>& ackBlocks)
+void QuicSubheader::SetAckRanges (const QuicAckRanges& ackRanges)
 {
-  m_additionalAckBlocks = ackBlocks;
+  m_ackRanges = ackRanges;
+}
+
+std::vector<uint64_t> QuicSubheader::GetAdditionalAckBlocks () const
+{
+  std::vector<uint64_t> ackBlocks;
+  for (uint32_t j = 0; j < m_ackRanges.GetCount (); j++)
+    {
+      ackBlocks.push_back (m_ackRanges.GetBlock (j));
+    }
+  return ackBlocks;
 }
 
 uint64_t QuicSubheader::GetAckDelay () const
@@ -1401,22 +1496,22 @@ void QuicSubheader::SetFrameType (uint8_t frameType)
   m_frameType = frameType;
 }
 
-const std::vector<uint32_t>& QuicSubheader::GetGaps () const
-{
-  return m_gaps;
-}
-
-void QuicSubheader::SetGaps (const std::vector<uint32_t>& gaps)
+std::vector<uint64_t> QuicSubheader::GetGaps () const
 {
-  m_gaps = gaps;
+  std::vector<uint64_t> gaps;
+  for (uint32_t j = 0; j < m_ackRanges.GetCount (); j++)
+    {
+      gaps.push_back (m_ackRanges.GetGap (j));
+    }
+  return gaps;
 }
 
-uint32_t QuicSubheader::GetLargestAcknowledged () const
+uint64_t QuicSubheader::GetLargestAcknowledged () const
 {
   return m_largestAcknowledged;
 }
 
-void QuicSubheader::SetLargestAcknowledged (uint32_t largestAcknowledged)
+void QuicSubheader::SetLargestAcknowledged (uint64_t largestAcknowledged)
 {
   m_largestAcknowledged = largestAcknowledged;
 }
@@ -1529,6 +1624,36 @@ void QuicSubheader::SetFirstAckBlock (uint64_t firstAckBlock)
   m_firstAckBlock = firstAckBlock;
 }
 
+uint64_t QuicSubheader::GetAckElicitingThreshold () const
+{
+  return m_ackElicitingThreshold;
+}
+
+void QuicSubheader::SetAckElicitingThreshold (uint64_t ackElicitingThreshold)
+{
+  m_ackElicitingThreshold = ackElicitingThreshold;
+}
+
+uint64_t QuicSubheader::GetRequestMaxAckDelay () const
+{
+  return m_requestMaxAckDelay;
+}
+
+void QuicSubheader::SetRequestMaxAckDelay (uint64_t requestMaxAckDelay)
+{
+  m_requestMaxAckDelay = requestMaxAckDelay;
+}
+
+uint64_t QuicSubheader::GetReorderingThreshold () const
+{
+  return m_reorderingThreshold;
+}
+
+void QuicSubheader::SetReorderingThreshold (uint64_t reorderingThreshold)
+{
+  m_reorderingThreshold = reorderingThreshold;
+}
+
 } // namespace ns3
 
 
@@ -31,6 +31,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/sequence-number.h"
+#include "quic-ack-ranges.h"
 
 namespace ns3 {
 
@@ -102,8 +103,14 @@ namespace ns3 {
 class QuicSubheader : public Header
 {
 public:
+  static const uint64_t MAX_VARINT;  //!< Largest value of a variable-length integer (2^62 - 1)
+
   /**
    * \brief Quic subheader type frame values
+   *
+   * ACK_FREQUENCY and IMMEDIATE_ACK belong to the ACK frequency extension
+   * (draft-ietf-quic-ack-frequency), which encodes their types as the
+   * varints 0xaf and 0x1f; here they follow the one-byte types of draft 13.
    */
   typedef enum
   {
@@ -130,7 +137,9 @@ public:
     STREAM100 = 0x14,          //!< Stream (offset=1, length=0, fin=0)
     STREAM101 = 0x15,          //!< Stream (offset=1, length=0, fin=1)
     STREAM110 = 0x16,          //!< Stream (offset=1, length=1, fin=0)
-    STREAM111 = 0x17           //!< Stream (offset=1, length=1, fin=1)
+    STREAM111 = 0x17,          //!< Stream (offset=1, length=1, fin=1)
+    ACK_FREQUENCY = 0x18,      //!< Ack Frequency
+    IMMEDIATE_ACK = 0x19       //!< Immediate Ack
   } TypeFrame_t;
 
   /**
@@ -332,7 +341,18 @@ public:
    * \param additionalAckBlocks the vector where each field contains the number of contiguous acknowledged packets preceding the largest packet number
    * \return the generated QuicSubheader
    */
-  static QuicSubheader CreateAck (uint32_t largestAcknowledged, uint64_t ackDelay, uint32_t firstAckBlock, std::vector<uint32_t>& gaps, std::vector<uint32_t>& additionalAckBlocks);
+  static QuicSubheader CreateAck (uint64_t largestAcknowledged, uint64_t ackDelay, uint64_t firstAckBlock, std::vector<uint64_t>& gaps, std::vector<uint64_t>& additionalAckBlocks);
+
+  /**
+   * Create a Ack subheader without allocations for the common number of ACK blocks
+   *
+   * \param largestAcknowledged the largest packet number the peer is acknowledging
+   * \param ackDelay the time in microseconds that the largest acknowledged packet, was received by this peer to when this ACK was sent
+   * \param firstAckBlock the number of contiguous packets preceding the Largest Acknowledged that are being acknowledged
+   * \param ackRanges the gaps and additional ACK blocks
+   * \return the generated QuicSubheader
+   */
+  static QuicSubheader CreateAck (uint64_t largestAcknowledged, uint64_t ackDelay, uint64_t firstAckBlock, const QuicAckRanges& ackRanges);
 
   /**
    * Create a Path Response subheader
@@ -363,31 +383,61 @@ public:
    */
   static QuicSubheader CreateStreamSubHeader (uint64_t streamId, uint64_t offset, uint64_t length, bool offBit = false, bool lengthBit = false, bool finBit = false);
 
+  /**
+   * Create a Ack Frequency subheader
+   *
+   * \param sequence the sequence number of the frame, to discard the stale ones
+   * \param ackElicitingThreshold the number of ack-eliciting packets the peer receives before sending an immediate ACK
+   * \param requestMaxAckDelay the delayed ACK timeout requested to the peer, in microseconds
+   * \param reorderingThreshold the packet reordering that makes the peer send an immediate ACK (0 to disable)
+   * \return the generated QuicSubheader
+   */
+  static QuicSubheader CreateAckFrequency (uint64_t sequence, uint64_t ackElicitingThreshold, uint64_t requestMaxAckDelay, uint64_t reorderingThreshold);
+
+  /**
+   * Create a Immediate Ack subheader
+   *
+   * \return the generated QuicSubheader
+   */
+  static QuicSubheader CreateImmediateAck (void);
+
+  /**
+   * \brief Get the serialized size of a Stream subheader without building it
+   *
+   * \param streamId the ID of the stream
+   * \param offset the offset of the first byte of the frame in the stream
+   * \param length the packet size
+   * \param offBit a flag to indicate whether the offset is carried or not
+   * \param lengthBit a flag to indicate whether the length is carried or not
+   * \return the size of the Stream subheader (in bytes)
+   */
+  static uint32_t GetStreamSubHeaderSize (uint64_t streamId, uint64_t offset, uint64_t length, bool offBit = false, bool lengthBit = false);
+
   // Getters, Setters and Controls
 
   /**
    * \brief Get the ack block count
    * \return The ack block count for this QuicSubheader
    */
-  uint32_t GetAckBlockCount () const;
+  uint64_t GetAckBlockCount () const;
 
   /**
-   * \brief Set the ack block count
-   * \param ackBlockCount the ack block count for this QuicSubheader
+   * \brief Get the gaps and additional ack blocks
+   * \return The gaps and additional ack blocks for this QuicSubheader
    */
-  void SetAckBlockCount (uint32_t ackBlockCount);
+  const QuicAckRanges& GetAckRanges () const;
 
   /**
-   * \brief Get the additional ack block vector
-   * \return The additional ack block vector for this QuicSubheader
+   * \brief Set the gaps and additional ack blocks
+   * \param ackRanges the gaps and additional ack blocks for this QuicSubheader
    */
-  const std::vector<uint32_t>& GetAdditionalAckBlocks () const;
+  void SetAckRanges (const QuicAckRanges& ackRanges);
 
   /**
-   * \brief Set the additional ack block vector
-   * \param ackBlocks the additional ack block vector for this QuicSubheader
+   * \brief Get a copy of the additional ack blocks (allocates, use GetAckRanges on the data path)
+   * \return The additional ack block vector for this QuicSubheader
    */
-  void SetAdditionalAckBlocks (const std::vector<uint32_t>& ackBlocks);
+  std::vector<uint64_t> GetAdditionalAckBlocks () const;
 
   /**
    * \brief Get the ack delay
@@ -450,28 +500,22 @@ public:
   void SetFrameType (uint8_t frameType);
 
   /**
-   * \brief Get the gap vector
+   * \brief Get a copy of the gaps (allocates, use GetAckRanges on the data path)
    * \return The gap vector for this QuicSubheader
    */
-  const std::vector<uint32_t>& GetGaps () const;
-
-  /**
-   * \brief Set the gap vector
-   * \param gaps the gap for this QuicSubheader
-   */
-  void SetGaps (const std::vector<uint32_t>& gaps);
+  std::vector<uint64_t> GetGaps () const;
 
   /**
    * \brief Get the largest acknowledged
    * \return The largest acknowledged for this QuicSubheader
    */
-  uint32_t GetLargestAcknowledged () const;
+  uint64_t GetLargestAcknowledged () const;
 
   /**
    * \brief Set the largest acknowledged
    * \param largestAcknowledged the largest acknowledged for this QuicSubheader
    */
-  void SetLargestAcknowledged (uint32_t largestAcknowledged);
+  void SetLargestAcknowledged (uint64_t largestAcknowledged);
 
   /**
    * \brief Get the length
@@ -569,6 +613,42 @@ public:
    */
   void SetSequence (uint64_t sequence);
 
+  /**
+   * \brief Get the ack-eliciting threshold
+   * \return The ack-eliciting threshold for this QuicSubheader
+   */
+  uint64_t GetAckElicitingThreshold () const;
+
+  /**
+   * \brief Set the ack-eliciting threshold
+   * \param ackElicitingThreshold the ack-eliciting threshold for this QuicSubheader
+   */
+  void SetAckElicitingThreshold (uint64_t ackElicitingThreshold);
+
+  /**
+   * \brief Get the requested max ack delay
+   * \return The requested max ack delay (in microseconds) for this QuicSubheader
+   */
+  uint64_t GetRequestMaxAckDelay () const;
+
+  /**
+   * \brief Set the requested max ack delay
+   * \param requestMaxAckDelay the requested max ack delay (in microseconds) for this QuicSubheader
+   */
+  void SetRequestMaxAckDelay (uint64_t requestMaxAckDelay);
+
+  /**
+   * \brief Get the reordering threshold
+   * \return The reordering threshold for this QuicSubheader
+   */
+  uint64_t GetReorderingThreshold () const;
+
+  /**
+   * \brief Set the reordering threshold
+   * \param reorderingThreshold the reordering threshold for this QuicSubheader
+   */
+  void SetReorderingThreshold (uint64_t reorderingThreshold);
+
   /**
    * \brief Get the stream Id
    * \return The stream Id for this QuicSubheader
@@ -705,6 +785,18 @@ public:
    */
   bool IsStreamFin () const;
 
+  /**
+   * \brief Check if the subheader is Ack Frequency
+   * \return true if the subheader is Ack Frequency, false otherwise
+   */
+  bool IsAckFrequency () const;
+
+  /**
+   * \brief Check if the subheader is Immediate Ack
+   * \return true if the subheader is Immediate Ack, false otherwise
+   */
+  bool IsImmediateAck () const;
+
   /**
    * Comparison operator
    * \param lhs left operand
@@ -736,14 +828,15 @@ private:
   uint64_t m_sequence;                          //!< Sequence
   uint64_t m_connectionId;                      //!< Connection id
   //uint128_t statelessResetToken;              //!< Stateless reset token
-  uint32_t m_largestAcknowledged;               //!< Largest acknowledged
-  uint32_t m_ackDelay;                          //!< Ack delay
-  uint32_t m_ackBlockCount;                     //!< Ack block count
-  uint32_t m_firstAckBlock;                     //!< First Ack block
-  std::vector<uint32_t> m_additionalAckBlocks;  //!< Additional ack blocks vector
-  std::vector<uint32_t> m_gaps;                 //!< Gaps vector
+  uint64_t m_largestAcknowledged;               //!< Largest acknowledged
+  uint64_t m_ackDelay;                          //!< Ack delay
+  uint64_t m_firstAckBlock;                     //!< First Ack block
+  QuicAckRanges m_ackRanges;                    //!< Gaps and additional ack blocks
   uint8_t m_data;                               //!< Data word
   uint64_t m_length;                            //!< Length
+  uint64_t m_ackElicitingThreshold;             //!< Ack-eliciting threshold
+  uint64_t m_requestMaxAckDelay;                //!< Requested max ack delay (in microseconds)
+  uint64_t m_reorderingThreshold;               //!< Reordering threshold
 };
 
 } // namespace ns3
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "quic-tcp-congestion-adapter.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicTcpCongestionAdapter");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicTcpCongestionAdapter);
+
+TypeId
+QuicTcpCongestionAdapter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicTcpCongestionAdapter")
+    .SetParent<QuicCongestionOps> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicTcpCongestionAdapter> ()
+  ;
+  return tid;
+}
+
+QuicTcpCongestionAdapter::QuicTcpCongestionAdapter ()
+  : QuicCongestionOps (),
+    m_ops (CreateObject<TcpNewReno> ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicTcpCongestionAdapter::QuicTcpCongestionAdapter (Ptr<TcpCongestionOps> ops)
+  : QuicCongestionOps (),
+    m_ops (ops)
+{
+  NS_LOG_FUNCTION (this << ops);
+  NS_ASSERT (ops != 0);
+}
+
+QuicTcpCongestionAdapter::QuicTcpCongestionAdapter (const QuicTcpCongestionAdapter& sock)
+  : QuicCongestionOps (sock),
+    m_ops (sock.m_ops->Fork ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicTcpCongestionAdapter::~QuicTcpCongestionAdapter ()
+{
+}
+
+Ptr<TcpCongestionOps>
+QuicTcpCongestionAdapter::GetCongestionOps () const
+{
+  return m_ops;
+}
+
+std::string
+QuicTcpCongestionAdapter::GetName () const
+{
+  return m_ops->GetName ();
+}
+
+uint32_t
+QuicTcpCongestionAdapter::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  return m_ops->GetSsThresh (tcb, bytesInFlight);
+}
+
+void
+QuicTcpCongestionAdapter::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  m_ops->IncreaseWindow (tcb, segmentsAcked);
+}
+
+void
+QuicTcpCongestionAdapter::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                                     const Time& rtt)
+{
+  m_ops->PktsAcked (tcb, segmentsAcked, rtt);
+}
+
+void
+QuicTcpCongestionAdapter::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                              const TcpSocketState::TcpCongState_t newState)
+{
+  m_ops->CongestionStateSet (tcb, newState);
+}
+
+void
+QuicTcpCongestionAdapter::CwndEvent (Ptr<TcpSocketState> tcb,
+                                     const TcpSocketState::TcpCAEvent_t event)
+{
+  m_ops->CwndEvent (tcb, event);
+}
+
+Ptr<TcpCongestionOps>
+QuicTcpCongestionAdapter::Fork ()
+{
+  return CopyObject<QuicTcpCongestionAdapter> (this);
+}
+
+void
+QuicTcpCongestionAdapter::OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack,
+                                         QuicSocketTxItemSpan newAcks,
+                                         const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  // only the stream data is accounted in the window
+  uint32_t ackedBytes = 0;
+  for (auto it = newAcks.begin (); it != newAcks.end (); ++it)
+    {
+      if (!(*it)->m_isStream0 && (*it)->m_isStream)
+        {
+          ackedBytes += (*it)->m_size;
+        }
+    }
+  if (ackedBytes == 0)
+    {
+      return;
+    }
+
+  // the packets carry less than a full segment of stream data:
+  // count a partial segment, or single-packet ACKs never grow cWnd
+  uint32_t ackedSegments = (ackedBytes + tcb.m_segmentSize - 1) / tcb.m_segmentSize;
+  NS_LOG_INFO ("ackedBytes " << ackedBytes << " ackedSegments " << ackedSegments);
+
+  // newAcks are ordered from the highest packet number to the smallest
+  QuicSocketTxItem* lastAcked = newAcks.front ();
+  uint64_t largestAcknowledged = ack.GetLargestAcknowledged ();
+
+  NS_LOG_LOGIC ("Updating RTT estimate");
+  // If the largest acked is newly acked, update the RTT.
+  if (lastAcked->m_packetNumber >= tcb.m_largestAckedPacket)
+    {
+      Time ackDelay = MicroSeconds (ack.GetAckDelay ());
+      UpdateRtt (tcb, Now () - lastAcked->m_lastSent, ackDelay);
+      tcb.m_lastRtt = Now () - lastAcked->m_lastSent - ackDelay;
+    }
+  tcb.m_largestAckedPacket = std::max (tcb.m_largestAckedPacket,
+                                       SequenceNumber64 (largestAcknowledged));
+
+  Ptr<TcpSocketState> tcbp (&tcb);
+  if (tcb.m_congState != TcpSocketState::CA_RECOVERY
+      && tcb.m_congState != TcpSocketState::CA_LOSS)
+    {
+      // Increase the congestion window
+      m_ops->PktsAcked (tcbp, ackedSegments, tcb.m_lastRtt);
+      m_ops->IncreaseWindow (tcbp, ackedSegments);
+    }
+  else if (tcb.m_endOfRecovery.GetValue () > largestAcknowledged)
+    {
+      m_ops->PktsAcked (tcbp, ackedSegments, tcb.m_lastRtt);
+      m_ops->IncreaseWindow (tcbp, ackedSegments);
+    }
+  else
+    {
+      NS_LOG_INFO ("Exit recovery");
+      tcb.m_congState = TcpSocketState::CA_OPEN;
+      m_ops->PktsAcked (tcbp, ackedSegments, tcb.m_lastRtt);
+      m_ops->CongestionStateSet (tcbp, TcpSocketState::CA_OPEN);
+    }
+}
+
+void
+QuicTcpCongestionAdapter::OnPacketsLost (QuicSocketState &tcb,
+                                         QuicSocketTxItemSpan lostPackets,
+                                         const QuicRateSample &rs)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Enter recovery (RFC 6675, Sec. 5)
+  if (tcb.m_congState != TcpSocketState::CA_RECOVERY)
+    {
+      NS_LOG_INFO ("Enter recovery");
+      Ptr<TcpSocketState> tcbp (&tcb);
+      tcb.m_congState = TcpSocketState::CA_RECOVERY;
+      tcb.m_endOfRecovery = tcb.m_highTxPacketNumber;
+      m_ops->CongestionStateSet (tcbp, TcpSocketState::CA_RECOVERY);
+      tcb.m_ssThresh = m_ops->GetSsThresh (tcbp, tcb.m_bytesInFlight);
+      tcb.m_cWnd = tcb.m_ssThresh;
+    }
+
+  if (InPersistentCongestion (tcb, lostPackets))
+    {
+      OnPersistentCongestion (tcb);
+    }
+}
+
+void
+QuicTcpCongestionAdapter::OnPersistentCongestion (QuicSocketState &tcb)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Reset congestion window and go into loss mode, as on a TCP RTO
+  Ptr<TcpSocketState> tcbp (&tcb);
+  tcb.m_cWnd = tcb.m_kMinimumWindow;
+  tcb.m_endOfRecovery = tcb.m_highTxPacketNumber;
+  tcb.m_congState = TcpSocketState::CA_LOSS;
+  m_ops->CongestionStateSet (tcbp, TcpSocketState::CA_LOSS);
+}
+
+} // namespace ns3
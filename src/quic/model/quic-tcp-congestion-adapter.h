@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICTCPCONGESTIONADAPTER_H
+#define QUICTCPCONGESTIONADAPTER_H
+
+#include "quic-congestion-ops.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief Runs a TCP congestion control behind the QUIC interface
+ *
+ * The socket installs the TCP congestion controls (e.g., TcpVegas) wrapped in
+ * this adapter, and drives every algorithm through QuicCongestionOps. The
+ * newly acked stream bytes are counted in segments and handed to PktsAcked
+ * and IncreaseWindow, while the losses enter the recovery of RFC 6675
+ * with the slow start threshold given by the TCP algorithm.
+ */
+class QuicTcpCongestionAdapter : public QuicCongestionOps
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicTcpCongestionAdapter ();
+  /**
+   * \brief Constructor
+   *
+   * \param ops the TCP congestion control to wrap
+   */
+  QuicTcpCongestionAdapter (Ptr<TcpCongestionOps> ops);
+  QuicTcpCongestionAdapter (const QuicTcpCongestionAdapter& sock);
+  ~QuicTcpCongestionAdapter ();
+
+  /**
+   * \brief Get the wrapped TCP congestion control
+   *
+   * \return the TCP congestion control
+   */
+  Ptr<TcpCongestionOps> GetCongestionOps () const;
+
+  // Inherited from TcpCongestionOps, forwarded to the TCP congestion control
+  std::string GetName () const;
+  uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight);
+  void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt);
+  void CongestionStateSet (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCongState_t newState);
+  void CwndEvent (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCAEvent_t event);
+  Ptr<TcpCongestionOps> Fork ();
+
+  // Inherited from QuicCongestionOps
+  void OnAckReceived (QuicSocketState &tcb, QuicSubheader &ack, QuicSocketTxItemSpan newAcks,
+                      const QuicRateSample &rs);
+  void OnPacketsLost (QuicSocketState &tcb, QuicSocketTxItemSpan lostPackets,
+                      const QuicRateSample &rs);
+
+protected:
+  void OnPersistentCongestion (QuicSocketState &tcb);
+
+private:
+  Ptr<TcpCongestionOps> m_ops;  //!< Wrapped TCP congestion control
+};
+
+} // namespace ns3
+
+#endif /* QUICTCPCONGESTIONADAPTER_H */
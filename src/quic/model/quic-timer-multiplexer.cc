@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "quic-timer-multiplexer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuicTimerMultiplexer");
+
+NS_OBJECT_ENSURE_REGISTERED (QuicTimerMultiplexer);
+
+TypeId
+QuicTimerMultiplexer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuicTimerMultiplexer")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<QuicTimerMultiplexer> ()
+  ;
+  return tid;
+}
+
+QuicTimerMultiplexer::QuicTimerMultiplexer ()
+  : Object (),
+    m_eventTime (Time::Max ()),
+    m_dispatching (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuicTimerMultiplexer::~QuicTimerMultiplexer ()
+{
+  NS_LOG_FUNCTION (this);
+  // the scheduler event holds a raw pointer to the multiplexer
+  m_event.Cancel ();
+}
+
+void
+QuicTimerMultiplexer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  CancelAll ();
+  m_handlers.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+QuicTimerMultiplexer::AddTimer (Callback<void> handler)
+{
+  NS_LOG_FUNCTION (this);
+  m_deadlines.push_back (Time::Max ());
+  m_handlers.push_back (handler);
+  return m_handlers.size () - 1;
+}
+
+void
+QuicTimerMultiplexer::Schedule (uint32_t timer, Time delay)
+{
+  NS_LOG_FUNCTION (this << timer << delay);
+  NS_ASSERT (timer < m_deadlines.size ());
+
+  Time deadline = Simulator::Now () + delay;
+  m_deadlines[timer] = deadline;
+
+  // the handlers running now re-arm the event when they are done
+  if (!m_dispatching and deadline < m_eventTime)
+    {
+      Rearm ();
+    }
+}
+
+void
+QuicTimerMultiplexer::Cancel (uint32_t timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  NS_ASSERT (timer < m_deadlines.size ());
+
+  // the event is left in place, it re-arms itself for the next timer
+  m_deadlines[timer] = Time::Max ();
+}
+
+void
+QuicTimerMultiplexer::CancelAll ()
+{
+  NS_LOG_FUNCTION (this);
+
+  for (std::vector<Time>::iterator it = m_deadlines.begin (); it != m_deadlines.end (); ++it)
+    {
+      *it = Time::Max ();
+    }
+  m_event.Cancel ();
+  m_eventTime = Time::Max ();
+}
+
+bool
+QuicTimerMultiplexer::IsRunning (uint32_t timer) const
+{
+  NS_ASSERT (timer < m_deadlines.size ());
+  return m_deadlines[timer] != Time::Max ();
+}
+
+Time
+QuicTimerMultiplexer::GetDeadline (uint32_t timer) const
+{
+  NS_ASSERT (timer < m_deadlines.size ());
+  return m_deadlines[timer];
+}
+
+void
+QuicTimerMultiplexer::Expire ()
+{
+  NS_LOG_FUNCTION (this);
+
+  // a handler may release the last reference to the owner of the timers
+  Ptr<QuicTimerMultiplexer> self = this;
+
+  m_eventTime = Time::Max ();
+  m_dispatching = true;
+  while (true)
+    {
+      uint32_t next = m_deadlines.size ();
+      for (uint32_t i = 0; i < m_deadlines.size (); ++i)
+        {
+          if (m_deadlines[i] <= Simulator::Now ()
+              and (next == m_deadlines.size () or m_deadlines[i] < m_deadlines[next]))
+            {
+              next = i;
+            }
+        }
+      if (next == m_deadlines.size ())
+        {
+          break;
+        }
+      NS_LOG_LOGIC ("Timer " << next << " expired");
+      m_deadlines[next] = Time::Max ();
+      m_handlers[next] ();
+    }
+  m_dispatching = false;
+
+  Rearm ();
+}
+
+void
+QuicTimerMultiplexer::Rearm ()
+{
+  Time earliest = Time::Max ();
+  for (std::vector<Time>::const_iterator it = m_deadlines.begin (); it != m_deadlines.end (); ++it)
+    {
+      earliest = std::min (earliest, *it);
+    }
+
+  m_event.Cancel ();
+  m_eventTime = earliest;
+  if (earliest != Time::Max ())
+    {
+      m_event = Simulator::Schedule (earliest - Simulator::Now (),
+                                     &QuicTimerMultiplexer::Expire, this);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUICTIMERMULTIPLEXER_H
+#define QUICTIMERMULTIPLEXER_H
+
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ *
+ * \brief Timers of a connection sharing a single scheduler event
+ *
+ * Each timer is a deadline and a handler. The multiplexer keeps one event in
+ * the simulator, at the earliest deadline, and when it fires it runs the
+ * handlers of the expired timers in deadline order. Arming a timer later
+ * than the pending event or cancelling it only updates its deadline; the
+ * event is rescheduled only when a timer must fire before it.
+ */
+class QuicTimerMultiplexer : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QuicTimerMultiplexer ();
+  virtual ~QuicTimerMultiplexer ();
+
+  /**
+   * \brief Add a timer, initially not armed
+   *
+   * \param handler the function called when the timer expires
+   * \return the ID of the timer, i.e., the number of timers added before
+   */
+  uint32_t AddTimer (Callback<void> handler);
+
+  /**
+   * \brief Arm a timer, replacing its previous deadline
+   *
+   * \param timer the timer ID
+   * \param delay the time after which the timer expires
+   */
+  void Schedule (uint32_t timer, Time delay);
+
+  /**
+   * \brief Disarm a timer
+   *
+   * \param timer the timer ID
+   */
+  void Cancel (uint32_t timer);
+
+  /**
+   * \brief Disarm all the timers and remove the scheduler event
+   */
+  void CancelAll ();
+
+  /**
+   * \brief Check whether a timer is armed
+   *
+   * \param timer the timer ID
+   * \return true if the timer is armed and has not expired yet
+   */
+  bool IsRunning (uint32_t timer) const;
+
+  /**
+   * \brief Get the deadline of a timer
+   *
+   * \param timer the timer ID
+   * \return the expiration time, or Time::Max if the timer is not armed
+   */
+  Time GetDeadline (uint32_t timer) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Run the handlers of the expired timers, then re-arm the event
+   */
+  void Expire ();
+
+  /**
+   * \brief Move the scheduler event to the earliest deadline, if any
+   */
+  void Rearm ();
+
+  std::vector<Time> m_deadlines;            //!< Deadline of each timer, Time::Max if not armed
+  std::vector<Callback<void> > m_handlers;  //!< Handler of each timer
+  EventId m_event;                          //!< The scheduler event
+  Time m_eventTime;                         //!< Time of the scheduler event, Time::Max if none
+  bool m_dispatching;                       //!< True while the handlers of the expired timers run
+};
+
+} // namespace ns3
+
+#endif /* QUICTIMERMULTIPLEXER_H */
@@ -44,7 +44,8 @@ QuicTransportParameters::QuicTransportParameters ()
     m_max_packet_size (65527),
     //m_stateless_reset_token(0),
     m_ack_delay_exponent (3),
-    m_initial_max_stream_id_uni (0)
+    m_initial_max_stream_id_uni (0),
+    m_min_ack_delay (0)
 {
 }
 
@@ -82,7 +83,7 @@ QuicTransportParameters::GetSerializedSize (void) const
 uint32_t
 QuicTransportParameters::CalculateHeaderLength () const
 {
-  uint32_t len = 32 * 4 + 16 * 2 + 8 * 2;
+  uint32_t len = 64 * 2 + 32 * 3 + 16 * 2 + 8 * 2;
 
   return len / 8;
 }
@@ -96,8 +97,8 @@ QuicTransportParameters::Serialize (Buffer::Iterator start) const
 
   Buffer::Iterator i = start;
 
-  i.WriteHtonU32 (m_initial_max_stream_data);
-  i.WriteHtonU32 (m_initial_max_data);
+  i.WriteHtonU64 (m_initial_max_stream_data);
+  i.WriteHtonU64 (m_initial_max_data);
   i.WriteHtonU32 (m_initial_max_stream_id_bidi);
   i.WriteHtonU16 (m_idleTimeout);
   i.WriteU8 (m_omit_connection);
@@ -105,6 +106,7 @@ QuicTransportParameters::Serialize (Buffer::Iterator start) const
   //i.WriteHtonU128(m_stateless_reset_token);
   i.WriteU8 (m_ack_delay_exponent);
   i.WriteHtonU32 (m_initial_max_stream_id_uni);
+  i.WriteHtonU32 (m_min_ack_delay);
 
 }
 
@@ -115,8 +117,8 @@ QuicTransportParameters::Deserialize (Buffer::Iterator start)
 
   Buffer::Iterator i = start;
 
-  m_initial_max_stream_data = i.ReadNtohU32 ();
-  m_initial_max_data = i.ReadNtohU32 ();
+  m_initial_max_stream_data = i.ReadNtohU64 ();
+  m_initial_max_data = i.ReadNtohU64 ();
   m_initial_max_stream_id_bidi = i.ReadNtohU32 ();
   m_idleTimeout = i.ReadNtohU16 ();
   m_omit_connection = i.ReadU8 ();
@@ -124,6 +126,7 @@ QuicTransportParameters::Deserialize (Buffer::Iterator start)
   //m_stateless_reset_token = i.ReadNtohU128();
   m_ack_delay_exponent = i.ReadU8 ();
   m_initial_max_stream_id_uni = i.ReadNtohU32 ();
+  m_min_ack_delay = i.ReadNtohU32 ();
 
   NS_LOG_INFO ("Deserialize::Serialized Size " << CalculateHeaderLength ());
 
@@ -141,11 +144,12 @@ QuicTransportParameters::Print (std::ostream &os) const
   os << "|max_packet_size " << m_max_packet_size << "|\n";
   //os << "|stateless_reset_token " << m_stateless_reset_token << "|\n";
   os << "|ack_delay_exponent " << (uint16_t)m_ack_delay_exponent << "|\n";
-  os << "|initial_max_stream_id_uni " << m_initial_max_stream_id_uni << "]\n";
+  os << "|initial_max_stream_id_uni " << m_initial_max_stream_id_uni << "|\n";
+  os << "|min_ack_delay " << m_min_ack_delay << "]\n";
 }
 
 QuicTransportParameters
-QuicTransportParameters::CreateTransportParameters (uint32_t initial_max_stream_data, uint32_t initial_max_data, uint32_t initial_max_stream_id_bidi, uint16_t idleTimeout,
+QuicTransportParameters::CreateTransportParameters (uint64_t initial_max_stream_data, uint64_t initial_max_data, uint32_t initial_max_stream_id_bidi, uint16_t idleTimeout,
                                                     uint8_t omit_connection, uint16_t max_packet_size, /*uint128_t stateless_reset_token,*/ uint8_t ack_delay_exponent, uint32_t initial_max_stream_id_uni)
 {
   NS_LOG_INFO ("Create Transport Parameters Helper called");
@@ -178,6 +182,7 @@ operator== (const QuicTransportParameters &lhs, const QuicTransportParameters &r
            //&& lhs.m_stateless_reset_token == rhs.m_stateless_reset_token
            && lhs.m_ack_delay_exponent == rhs.m_ack_delay_exponent
            && lhs.m_initial_max_stream_id_uni == rhs.m_initial_max_stream_id_uni
+           && lhs.m_min_ack_delay == rhs.m_min_ack_delay
            );
 }
 
@@ -208,22 +213,22 @@ void QuicTransportParameters::SetIdleTimeout (uint16_t idleTimeout)
   m_idleTimeout = idleTimeout;
 }
 
-uint32_t QuicTransportParameters::GetInitialMaxData () const
+uint64_t QuicTransportParameters::GetInitialMaxData () const
 {
   return m_initial_max_data;
 }
 
-void QuicTransportParameters::SetInitialMaxData (uint32_t initialMaxData)
+void QuicTransportParameters::SetInitialMaxData (uint64_t initialMaxData)
 {
   m_initial_max_data = initialMaxData;
 }
 
-uint32_t QuicTransportParameters::GetInitialMaxStreamData () const
+uint64_t QuicTransportParameters::GetInitialMaxStreamData () const
 {
   return m_initial_max_stream_data;
 }
 
-void QuicTransportParameters::SetInitialMaxStreamData (uint32_t initialMaxStreamData)
+void QuicTransportParameters::SetInitialMaxStreamData (uint64_t initialMaxStreamData)
 {
   m_initial_max_stream_data = initialMaxStreamData;
 }
@@ -268,5 +273,15 @@ void QuicTransportParameters::SetOmitConnection (uint8_t omitConnection)
   m_omit_connection = omitConnection;
 }
 
+uint32_t QuicTransportParameters::GetMinAckDelay () const
+{
+  return m_min_ack_delay;
+}
+
+void QuicTransportParameters::SetMinAckDelay (uint32_t minAckDelay)
+{
+  m_min_ack_delay = minAckDelay;
+}
+
 } // namespace ns3
 
@@ -92,7 +92,7 @@ public:
    * \param initial_max_stream_id_uni the initial maximum number of application-owned unidirectional streams the peer may initiate
    * \return the generated QuicTransportParameters
    */
-  static QuicTransportParameters CreateTransportParameters (uint32_t initial_max_stream_data, uint32_t initial_max_data, uint32_t initial_max_stream_id_bidi, uint16_t idleTimeout,
+  static QuicTransportParameters CreateTransportParameters (uint64_t initial_max_stream_data, uint64_t initial_max_data, uint32_t initial_max_stream_id_bidi, uint16_t idleTimeout,
                                                             uint8_t omit_connection, uint16_t max_packet_size, /*uint128_t stateless_reset_token,*/ uint8_t ack_delay_exponent, uint32_t initial_max_stream_id_uni);
 
   // Getters, Setters and Controls
@@ -125,25 +125,25 @@ public:
    * \brief Get the initial max data limit
    * \return The initial max data limit for this QuicTransportParameters
    */
-  uint32_t GetInitialMaxData () const;
+  uint64_t GetInitialMaxData () const;
 
   /**
    * \brief Set the initial max data limit
    * \param initialMaxData the initial max data limit for this QuicTransportParameters
    */
-  void SetInitialMaxData (uint32_t initialMaxData);
+  void SetInitialMaxData (uint64_t initialMaxData);
 
   /**
    * \brief Get the initial max stream data limit
    * \return The initial max stream data limit for this QuicTransportParameters
    */
-  uint32_t GetInitialMaxStreamData () const;
+  uint64_t GetInitialMaxStreamData () const;
 
   /**
    * \brief Set the initial max stream data limit
    * \param initialMaxStreamData the initial max stream data limit for this QuicTransportParameters
    */
-  void SetInitialMaxStreamData (uint32_t initialMaxStreamData);
+  void SetInitialMaxStreamData (uint64_t initialMaxStreamData);
 
   /**
    * \brief Get the initial max bidirectional stream id limit
@@ -193,6 +193,18 @@ public:
    */
   void SetOmitConnection (uint8_t omitConnection);
 
+  /**
+   * \brief Get the min ack delay
+   * \return The min ack delay (in microseconds) for this QuicTransportParameters, 0 if the ACK frequency extension is not supported
+   */
+  uint32_t GetMinAckDelay () const;
+
+  /**
+   * \brief Set the min ack delay
+   * \param minAckDelay the min ack delay (in microseconds) for this QuicTransportParameters, 0 if the ACK frequency extension is not supported
+   */
+  void SetMinAckDelay (uint32_t minAckDelay);
+
   /**
    * Comparison operator
    * \param lhs left operand
@@ -212,8 +224,8 @@ private:
    */
   uint32_t CalculateHeaderLength () const;
 
-  uint32_t m_initial_max_stream_data;     //!< The initial value for the maximum data that can be sent on any newly created stream
-  uint32_t m_initial_max_data;            //!< The initial value for the maximum amount of data that can be sent on the connection
+  uint64_t m_initial_max_stream_data;     //!< The initial value for the maximum data that can be sent on any newly created stream
+  uint64_t m_initial_max_data;            //!< The initial value for the maximum amount of data that can be sent on the connection
   uint32_t m_initial_max_stream_id_bidi;  //!< The the initial maximum number of application-owned bidirectional streams the peer may initiate
   uint16_t m_idleTimeout;                 //!< The idle timeout value in seconds
   uint8_t m_omit_connection;              //!< The flag that indicates if the connection id is required in the upcoming connection
@@ -221,6 +233,7 @@ private:
   //uint128_t m_stateless_reset_token;    //!< The stateless reset token
   uint8_t m_ack_delay_exponent;           //!< The exponent used to decode the ack delay field in the ACK frame
   uint32_t m_initial_max_stream_id_uni;   //!< The initial maximum number of application-owned unidirectional streams the peer may initiate
+  uint32_t m_min_ack_delay;               //!< The minimum delayed ACK timeout the endpoint accepts in ACK_FREQUENCY frames, in microseconds (0 if not supported)
 };
 
 } // namespace ns3
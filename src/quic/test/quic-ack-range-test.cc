@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Alvise De Biasio <alvise.debiasio@gmail.com>
+ *          Federico Chiariotti <chiariotti.federico@gmail.com>
+ *          Michele Polese <michele.polese@gmail.com>
+ *          Davide Marcato <davidemarcato@outlook.com>
+ *          
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+
+#include "ns3/quic-ack-range-tracker.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("QuicAckRangeTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicAckRangeTracker Test
+ */
+class QuicAckRangeTestCase : public TestCase
+{
+public:
+  QuicAckRangeTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+
+  /**
+   * \brief Test the insertion and coalescing of packet numbers
+   */
+  void
+  TestAdd ();
+  /**
+   * \brief Test the generation of the ACK gaps and blocks
+   */
+  void
+  TestAckBlocks ();
+  /**
+   * \brief Test the storage of the pairs beyond the inline capacity
+   */
+  void
+  TestInlineRanges ();
+  /**
+   * \brief Test the removal of the ranges already reported to the peer
+   */
+  void
+  TestDiscard ();
+  /**
+   * \brief Test the search of the packets still missing
+   */
+  void
+  TestMissing ();
+};
+
+QuicAckRangeTestCase::QuicAckRangeTestCase () :
+    TestCase ("QuicAckRangeTracker Test")
+{
+}
+
+void
+QuicAckRangeTestCase::DoRun ()
+{
+  /*
+   * Test the insertion of packet numbers:
+   * -> add packets out of order
+   * -> check that adjacent packets are merged into a single range
+   * -> check duplicate detection
+   */
+  TestAdd ();
+
+  /*
+   * Test the generation of the ACK blocks:
+   * -> add packets with holes
+   * -> check gaps and blocks against the QuicSubheader::CreateAck layout
+   * -> check the limit on the number of gaps
+   */
+  TestAckBlocks ();
+
+  /*
+   * Test the ACK ranges:
+   * -> add more pairs than the inline storage holds
+   * -> check order, copy and clear
+   */
+  TestInlineRanges ();
+
+  /*
+   * Test the removal of old ranges:
+   * -> discard below a packet number
+   * -> discard the oldest ranges beyond a maximum number
+   * -> check that the largest range is always kept
+   */
+  TestDiscard ();
+
+  /*
+   * Test the search of the missing packets:
+   * -> above a packet inside a range, in a hole and above the largest
+   */
+  TestMissing ();
+}
+
+void
+QuicAckRangeTestCase::TestAdd ()
+{
+  QuicAckRangeTracker tracker;
+  NS_TEST_ASSERT_MSG_EQ (tracker.IsEmpty (), true, "Tracker not empty");
+
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (1), true, "Insertion failed");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (3), true, "Insertion failed");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (5), true, "Insertion failed");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 3, "Wrong number of ranges");
+
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (2), true, "Insertion failed");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 2, "Ranges not merged");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (4), true, "Insertion failed");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 1, "Ranges not merged");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (0), true, "Insertion failed");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 1, "Range not extended");
+
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (3), false, "Duplicate not detected");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Add (5), false, "Duplicate not detected");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetLargest (), 5, "Wrong largest packet");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Contains (4), true, "Packet not found");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Contains (6), false, "Packet found");
+}
+
+void
+QuicAckRangeTestCase::TestAckBlocks ()
+{
+  QuicAckRangeTracker tracker;
+  // ranges [1, 2], [5, 5], [8, 10]
+  uint32_t pns[] = { 10, 1, 8, 2, 5, 9 };
+  for (uint32_t pn : pns)
+    {
+      tracker.Add (pn);
+    }
+
+  QuicAckRanges ranges;
+  tracker.BuildAckBlocks (20, ranges);
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetLargest (), 10, "Wrong largest packet");
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetCount (), 2, "Wrong number of gaps");
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetGap (0), 7, "Wrong gap");
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetBlock (0), 5, "Wrong block");
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetGap (1), 4, "Wrong gap");
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetBlock (1), 2, "Wrong block");
+
+  tracker.BuildAckBlocks (1, ranges);
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetCount (), 1, "Gap limit not enforced");
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetGap (0), 7, "Wrong gap after a rebuild");
+}
+
+void
+QuicAckRangeTestCase::TestInlineRanges ()
+{
+  /*
+   * The pairs beyond the inline storage are kept in order, and a cleared
+   * set starts again from the inline storage
+   */
+  QuicAckRanges ranges;
+  uint32_t count = QuicAckRanges::kInlineRanges + 3;
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      ranges.Add (100 - 10 * i, 95 - 10 * i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetCount (), count, "Wrong number of pairs");
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ranges.GetGap (i), 100 - 10 * i, "Wrong gap");
+      NS_TEST_ASSERT_MSG_EQ (ranges.GetBlock (i), 95 - 10 * i, "Wrong block");
+    }
+
+  QuicAckRanges copy = ranges;
+  NS_TEST_ASSERT_MSG_EQ (copy.GetBlock (count - 1), 95 - 10 * (count - 1), "Wrong copied block");
+
+  ranges.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetCount (), 0, "Pairs left after clear");
+  ranges.Add (7, 5);
+  NS_TEST_ASSERT_MSG_EQ (ranges.GetGap (0), 7, "Wrong gap after clear");
+}
+
+void
+QuicAckRangeTestCase::TestDiscard ()
+{
+  QuicAckRangeTracker tracker;
+  // ranges [1, 2], [5, 5], [8, 10]
+  uint32_t pns[] = { 1, 2, 5, 8, 9, 10 };
+  for (uint32_t pn : pns)
+    {
+      tracker.Add (pn);
+    }
+
+  tracker.DiscardBelow (5);
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 2, "Wrong number of ranges");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Contains (2), false, "Range not discarded");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Contains (5), true, "Range discarded");
+
+  tracker.DiscardBelow (100);
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 1, "Largest range discarded");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetLargest (), 10, "Wrong largest packet");
+
+  // ranges [8, 10], [12, 12], ..., [20, 20]
+  for (uint32_t pn = 12; pn <= 20; pn += 2)
+    {
+      tracker.Add (pn);
+    }
+  tracker.DiscardOldest (3);
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 3, "Wrong number of ranges");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Contains (14), false, "Oldest range not discarded");
+  NS_TEST_ASSERT_MSG_EQ (tracker.Contains (16), true, "Recent range discarded");
+
+  tracker.DiscardOldest (0);
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetNumRanges (), 1, "Largest range discarded");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetLargest (), 20, "Wrong largest packet");
+}
+
+void
+QuicAckRangeTestCase::TestMissing ()
+{
+  QuicAckRangeTracker tracker;
+  // ranges [1, 2], [5, 5], [8, 10]
+  uint32_t pns[] = { 1, 2, 5, 8, 9, 10 };
+  for (uint32_t pn : pns)
+    {
+      tracker.Add (pn);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetSmallestMissingAbove (0), 3, "Wrong missing packet");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetSmallestMissingAbove (1), 3, "Wrong missing packet");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetSmallestMissingAbove (3), 4, "Wrong missing packet");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetSmallestMissingAbove (4), 6, "Wrong missing packet");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetSmallestMissingAbove (7), 11, "Wrong missing packet");
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetSmallestMissingAbove (10), 11, "Wrong missing packet");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicAckRangeTracker test case
+ */
+class QuicAckRangeTestSuite : public TestSuite
+{
+public:
+  QuicAckRangeTestSuite () :
+      TestSuite ("quic-ack-range", UNIT)
+  {
+    AddTestCase (new QuicAckRangeTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicAckRangeTestSuite g_quicAckRangeTestSuite; //!< Static variable for test initialization
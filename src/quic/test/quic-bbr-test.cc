@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/quic-bbr.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "quic-cc-test-sender.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("QuicBbrTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicBbr Test
+ *
+ * A paced, cwnd-limited sender runs QuicBbr over a single bottleneck with a
+ * fixed propagation delay. The test checks that the state machine leaves
+ * startup and drain, that the filters converge to the path characteristics
+ * and that losses do not collapse the rate.
+ */
+class QuicBbrTestCase : public TestCase
+{
+public:
+  /** \brief Constructor */
+  QuicBbrTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /** \brief Check that a loss triggers packet conservation, not a back-off */
+  void
+  TestLoss ();
+
+  Ptr<QuicSocketState> m_tcb;              //!< Socket state driven by the CC
+  Ptr<QuicBbr> m_bbr;                      //!< The congestion control under test
+  Ptr<QuicCcTestSender> m_sender;          //!< Paced sender over the bottleneck
+  DataRate m_bottleneck;                   //!< Bottleneck rate
+  Time m_delay;                            //!< Round-trip propagation delay
+};
+
+QuicBbrTestCase::QuicBbrTestCase () :
+    TestCase ("QuicBbr Test"),
+    m_bottleneck (DataRate ("10Mbps")),
+    m_delay (MilliSeconds (50))
+{
+}
+
+void
+QuicBbrTestCase::DoRun ()
+{
+  m_tcb = CreateObject<QuicSocketState> ();
+  m_tcb->m_segmentSize = 1200;
+  m_tcb->m_initialCWnd = 10 * m_tcb->m_segmentSize;
+  m_tcb->m_cWnd = m_tcb->m_initialCWnd;
+  m_bbr = CreateObject<QuicBbr> ();
+  m_sender = Create<QuicCcTestSender> (m_tcb, m_bbr);
+  m_sender->SetPath (m_bottleneck, m_delay, true);
+
+  Simulator::Schedule (Seconds (0.0), &QuicCcTestSender::SendPackets, m_sender);
+  Simulator::Schedule (Seconds (3.0), &QuicBbrTestCase::TestLoss, this);
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+QuicBbrTestCase::TestLoss ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_bbr->GetMode (), QuicBbr::BBR_PROBE_BW,
+                         "BBR did not reach the probe bandwidth state");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_bbr->GetMaxBandwidth ().GetBitRate (),
+                             m_bottleneck.GetBitRate (),
+                             m_bottleneck.GetBitRate () / 10,
+                             "BBR misestimates the bottleneck bandwidth");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_bbr->GetMinRtt ().GetSeconds (),
+                             m_delay.GetSeconds (), 0.002,
+                             "BBR misestimates the propagation delay");
+  NS_TEST_ASSERT_MSG_NE (m_tcb->m_currentPacingRate.GetBitRate (), 0,
+                         "BBR did not set the pacing rate");
+  NS_TEST_ASSERT_MSG_LT (m_tcb->m_cWnd.Get (), 3 * m_bottleneck.GetBitRate ()
+                         * m_delay.GetSeconds () / 8,
+                         "BBR congestion window is not bounded by the BDP");
+
+  DataRate rate = m_tcb->m_currentPacingRate;
+  m_sender->GetTxBuffer ()->MarkAsLost (SequenceNumber64 (m_sender->GetNextPacketNumber () - 1));
+  m_sender->DetectLostPackets ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_currentPacingRate, rate,
+                         "BBR changed the pacing rate on loss");
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_cWnd.Get (),
+                         std::max (m_tcb->m_bytesInFlight.Get (), 4 * m_tcb->m_segmentSize),
+                         "BBR does not conserve packets in recovery");
+}
+
+void
+QuicBbrTestCase::DoTeardown ()
+{
+  m_sender = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicBbr test case
+ */
+class QuicBbrTestSuite : public TestSuite
+{
+public:
+  QuicBbrTestSuite () :
+      TestSuite ("quic-bbr", UNIT)
+  {
+    AddTestCase (new QuicBbrTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicBbrTestSuite g_quicBbrTestSuite; //!< Static variable for test initialization
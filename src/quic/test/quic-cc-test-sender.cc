@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "quic-cc-test-sender.h"
+
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/quic-subheader.h"
+
+namespace ns3 {
+
+QuicCcTestSender::QuicCcTestSender (Ptr<QuicSocketState> tcb,
+                                    Ptr<QuicCongestionOps> congestionControl)
+  : m_tcb (tcb),
+    m_congestionControl (congestionControl),
+    m_nextPacketNumber (1),
+    m_bottleneck (0),
+    m_delay (Seconds (0)),
+    m_paced (false),
+    m_linkFree (Seconds (0)),
+    m_nextSend (Seconds (0))
+{
+  m_txBuffer = CreateObject<QuicSocketTxBuffer> ();
+  m_txBuffer->SetMaxBufferSize (1 << 22);
+}
+
+void
+QuicCcTestSender::SetPath (DataRate bottleneck, Time delay, bool paced)
+{
+  m_bottleneck = bottleneck;
+  m_delay = delay;
+  m_paced = paced;
+}
+
+void
+QuicCcTestSender::SendPackets ()
+{
+  while (m_txBuffer->BytesInFlight () + m_tcb->m_segmentSize <= m_tcb->m_cWnd)
+    {
+      if (m_paced && m_nextSend > Now ())
+        {
+          if (!m_sendEvent.IsRunning ())
+            {
+              m_sendEvent = Simulator::Schedule (m_nextSend - Now (),
+                                                 &QuicCcTestSender::SendPackets, this);
+            }
+          return;
+        }
+      uint64_t packetNumber = m_nextPacketNumber;
+      SendPacket (packetNumber);
+      if (m_paced)
+        {
+          m_nextSend = Now () + m_tcb->m_currentPacingRate.CalculateBytesTxTime (m_tcb->m_segmentSize);
+        }
+
+      // Queue at the bottleneck, then propagate
+      m_linkFree = std::max (m_linkFree, Now ())
+        + m_bottleneck.CalculateBytesTxTime (m_tcb->m_segmentSize);
+      Simulator::Schedule (m_linkFree - Now () + m_delay,
+                           &QuicCcTestSender::OnPacketReceived, this, packetNumber);
+    }
+}
+
+void
+QuicCcTestSender::SendPacket (uint64_t packetNumber)
+{
+  uint32_t payload = m_tcb->m_segmentSize - 4;
+  Ptr<Packet> p = Create<Packet> (payload);
+  QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (1, (packetNumber - 1) * payload,
+                                                            payload, false, true, false);
+  p->AddHeader (sub);
+  m_txBuffer->Add (p);
+  m_txBuffer->NextSequence (m_tcb->m_segmentSize, SequenceNumber64 (packetNumber));
+  m_tcb->m_bytesInFlight = m_txBuffer->BytesInFlight ();
+  m_congestionControl->OnPacketSent (*m_tcb, SequenceNumber64 (packetNumber), false);
+  m_nextPacketNumber = std::max (m_nextPacketNumber, packetNumber + 1);
+}
+
+const std::vector<QuicSocketTxItem*> &
+QuicCcTestSender::AckPacket (uint64_t packetNumber)
+{
+  // only the packet is acked, the block below the gap is empty
+  std::vector<uint64_t> gaps (1, packetNumber - 1);
+  std::vector<uint64_t> additionalAckBlocks (1, 0);
+  m_txBuffer->OnAckUpdate (*m_tcb, packetNumber, additionalAckBlocks, gaps, m_ackedPackets,
+                           m_lostPackets);
+  m_tcb->m_bytesInFlight = m_txBuffer->BytesInFlight ();
+  return m_ackedPackets;
+}
+
+const std::vector<QuicSocketTxItem*> &
+QuicCcTestSender::DetectLostPackets ()
+{
+  m_txBuffer->DetectLostPackets (m_lostPackets);
+  m_tcb->m_bytesInFlight = m_txBuffer->BytesInFlight ();
+  if (!m_lostPackets.empty ())
+    {
+      m_congestionControl->OnPacketsLost (*m_tcb, m_lostPackets, m_txBuffer->GetRateSample ());
+    }
+  return m_lostPackets;
+}
+
+Ptr<QuicSocketTxBuffer>
+QuicCcTestSender::GetTxBuffer () const
+{
+  return m_txBuffer;
+}
+
+uint64_t
+QuicCcTestSender::GetNextPacketNumber () const
+{
+  return m_nextPacketNumber;
+}
+
+void
+QuicCcTestSender::OnPacketReceived (uint64_t packetNumber)
+{
+  std::vector<uint64_t> gaps;
+  std::vector<uint64_t> additionalAckBlocks;
+  m_txBuffer->OnAckUpdate (*m_tcb, packetNumber, additionalAckBlocks, gaps, m_ackedPackets,
+                           m_lostPackets);
+  m_tcb->m_bytesInFlight = m_txBuffer->BytesInFlight ();
+  if (!m_ackedPackets.empty ())
+    {
+      QuicSubheader ack = QuicSubheader::CreateAck (packetNumber, 0, 0, gaps, additionalAckBlocks);
+      m_congestionControl->OnAckReceived (*m_tcb, ack, m_ackedPackets,
+                                          m_txBuffer->GetRateSample ());
+    }
+  SendPackets ();
+}
+
+} // namespace ns3
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUIC_CC_TEST_SENDER_H
+#define QUIC_CC_TEST_SENDER_H
+
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/quic-congestion-ops.h"
+#include "ns3/quic-socket-base.h"
+#include "ns3/quic-socket-tx-buffer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ * \ingroup tests
+ *
+ * \brief A sender that drives a congestion control through a QuicSocketTxBuffer
+ *
+ * Each packet carries a full segment of data of stream 1. The tests send,
+ * ack and lose the packets themselves or, once a path is set, let the sender
+ * fill the congestion window and the path ack every packet when it reaches
+ * the receiver. The path is a bottleneck with an unbounded queue and a fixed
+ * propagation delay, so that an overshoot shows up as queueing delay.
+ */
+class QuicCcTestSender : public SimpleRefCount<QuicCcTestSender>
+{
+public:
+  /**
+   * \brief Constructor
+   * \param tcb the socket state driven by the congestion control
+   * \param congestionControl the congestion control under test
+   */
+  QuicCcTestSender (Ptr<QuicSocketState> tcb, Ptr<QuicCongestionOps> congestionControl);
+
+  /**
+   * \brief Set the path that acks the packets
+   * \param bottleneck the rate of the bottleneck
+   * \param delay the round-trip propagation delay
+   * \param paced true to send the packets at the pacing rate of the socket state
+   */
+  void SetPath (DataRate bottleneck, Time delay, bool paced);
+
+  /** \brief Send packets while the congestion window allows */
+  void SendPackets ();
+
+  /**
+   * \brief Send a packet and notify the congestion control
+   * \param packetNumber the packet number
+   */
+  void SendPacket (uint64_t packetNumber);
+
+  /**
+   * \brief Acknowledge a single packet, without notifying the congestion control
+   * \param packetNumber the acked packet number
+   * \return the newly acked packets
+   */
+  const std::vector<QuicSocketTxItem*> &AckPacket (uint64_t packetNumber);
+
+  /**
+   * \brief Collect the packets marked as lost and notify the congestion control
+   * \return the lost packets
+   */
+  const std::vector<QuicSocketTxItem*> &DetectLostPackets ();
+
+  /**
+   * \brief Get the tx buffer of the sender
+   * \return the tx buffer
+   */
+  Ptr<QuicSocketTxBuffer> GetTxBuffer () const;
+
+  /**
+   * \brief Get the number of the next packet to send
+   * \return the next packet number
+   */
+  uint64_t GetNextPacketNumber () const;
+
+private:
+  /**
+   * \brief Acknowledge the packets up to one that reaches the receiver, and
+   *   notify the congestion control
+   * \param packetNumber the packet that reaches the receiver
+   */
+  void OnPacketReceived (uint64_t packetNumber);
+
+  Ptr<QuicSocketState> m_tcb;                  //!< Socket state driven by the CC
+  Ptr<QuicCongestionOps> m_congestionControl;  //!< The congestion control under test
+  Ptr<QuicSocketTxBuffer> m_txBuffer;          //!< Sent packets and delivery rate estimation
+  std::vector<QuicSocketTxItem*> m_ackedPackets;  //!< Packets acked by the last ACK
+  std::vector<QuicSocketTxItem*> m_lostPackets;   //!< Packets lost at the last detection
+  uint64_t m_nextPacketNumber;                 //!< Next packet number to send
+  DataRate m_bottleneck;                       //!< Bottleneck rate
+  Time m_delay;                                //!< Round-trip propagation delay
+  bool m_paced;                                //!< True if the packets are paced
+  Time m_linkFree;                             //!< Time at which the bottleneck is idle
+  Time m_nextSend;                             //!< Earliest time of the next paced packet
+  EventId m_sendEvent;                         //!< Pending paced transmission
+};
+
+} // namespace ns3
+
+#endif /* QUIC_CC_TEST_SENDER_H */
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/quic-cubic.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "quic-cc-test-sender.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("QuicCubicTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicCubic Test
+ *
+ * A window-limited sender runs QuicCubic over a single bottleneck with a
+ * fixed propagation delay and an unbounded queue, so that an overshoot shows
+ * up as queueing delay instead of losses. With HyStart++ the slow start ends
+ * a few rounds after the queue starts to build; without it, it never ends
+ * and the window runs away. After a loss, the window is reduced once per
+ * recovery period and then grows back towards the window before the loss.
+ */
+class QuicCubicTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param hyStart true to enable HyStart++
+   */
+  QuicCubicTestCase (bool hyStart);
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /** \brief Check the end of slow start */
+  void
+  TestSlowStart ();
+  /** \brief Check the reduction of the window on loss */
+  void
+  TestLoss ();
+  /** \brief Check the growth of the window after the loss */
+  void
+  TestGrowth ();
+
+  bool m_hyStart;                          //!< True if HyStart++ is enabled
+  Ptr<QuicSocketState> m_tcb;              //!< Socket state driven by the CC
+  Ptr<QuicCubic> m_cubic;                  //!< The congestion control under test
+  Ptr<QuicCcTestSender> m_sender;          //!< Window-limited sender over the bottleneck
+  DataRate m_bottleneck;                   //!< Bottleneck rate
+  Time m_delay;                            //!< Round-trip propagation delay
+  uint32_t m_reducedCwnd;                  //!< Window after the loss
+};
+
+QuicCubicTestCase::QuicCubicTestCase (bool hyStart) :
+    TestCase (hyStart ? "QuicCubic Test with HyStart++" : "QuicCubic Test without HyStart++"),
+    m_hyStart (hyStart),
+    m_bottleneck (DataRate ("10Mbps")),
+    m_delay (MilliSeconds (50)),
+    m_reducedCwnd (0)
+{
+}
+
+void
+QuicCubicTestCase::DoRun ()
+{
+  m_tcb = CreateObject<QuicSocketState> ();
+  m_tcb->m_segmentSize = 1200;
+  m_tcb->m_initialCWnd = 10 * m_tcb->m_segmentSize;
+  m_tcb->m_cWnd = m_tcb->m_initialCWnd;
+  m_tcb->m_ssThresh = UINT32_MAX;
+  m_cubic = CreateObject<QuicCubic> ();
+  m_cubic->SetAttribute ("HyStart", BooleanValue (m_hyStart));
+  m_sender = Create<QuicCcTestSender> (m_tcb, m_cubic);
+  m_sender->SetPath (m_bottleneck, m_delay, false);
+
+  Simulator::Schedule (Seconds (0.0), &QuicCcTestSender::SendPackets, m_sender);
+  Simulator::Schedule (Seconds (2.0), &QuicCubicTestCase::TestSlowStart, this);
+  if (m_hyStart)
+    {
+      Simulator::Schedule (Seconds (2.0), &QuicCubicTestCase::TestLoss, this);
+      Simulator::Schedule (Seconds (4.0), &QuicCubicTestCase::TestGrowth, this);
+    }
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+QuicCubicTestCase::TestSlowStart ()
+{
+  double bdp = m_bottleneck.GetBitRate () * m_delay.GetSeconds () / 8;
+  if (m_hyStart)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_cubic->GetHyStartState (), QuicCubic::HYSTART_DONE,
+                             "HyStart++ did not end slow start");
+      NS_TEST_ASSERT_MSG_LT (m_tcb->m_ssThresh.Get (), 10 * bdp,
+                             "HyStart++ ended slow start too late");
+      NS_TEST_ASSERT_MSG_GT (m_tcb->m_ssThresh.Get (), bdp,
+                             "HyStart++ ended slow start too early");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_tcb->m_ssThresh.Get (), UINT32_MAX,
+                             "Slow start ended without losses");
+      NS_TEST_ASSERT_MSG_GT (m_tcb->m_cWnd.Get (), 30 * bdp,
+                             "Slow start did not overshoot the path");
+    }
+}
+
+void
+QuicCubicTestCase::TestLoss ()
+{
+  uint32_t cWnd = m_tcb->m_cWnd;
+  m_sender->GetTxBuffer ()->MarkAsLost (SequenceNumber64 (m_sender->GetNextPacketNumber () - 1));
+  m_sender->DetectLostPackets ();
+
+  m_reducedCwnd = m_tcb->m_cWnd;
+  NS_TEST_ASSERT_MSG_EQ (m_reducedCwnd, static_cast<uint32_t> (cWnd * 0.7),
+                         "CUBIC does not reduce the window by beta");
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_ssThresh.Get (), m_reducedCwnd,
+                         "CUBIC does not set the slow start threshold to the window");
+
+  // a packet sent before the recovery period does not reduce the window again
+  m_sender->GetTxBuffer ()->MarkAsLost (SequenceNumber64 (m_sender->GetNextPacketNumber () - 2));
+  m_sender->DetectLostPackets ();
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_cWnd.Get (), m_reducedCwnd,
+                         "CUBIC reduced the window twice in a recovery period");
+}
+
+void
+QuicCubicTestCase::TestGrowth ()
+{
+  NS_TEST_ASSERT_MSG_GT (m_tcb->m_cWnd.Get (), m_reducedCwnd,
+                         "CUBIC did not grow the window after recovery");
+  NS_TEST_ASSERT_MSG_LT (m_tcb->m_cWnd.Get (), 2 * m_reducedCwnd,
+                         "CUBIC grew the window faster than the cubic function");
+}
+
+void
+QuicCubicTestCase::DoTeardown ()
+{
+  m_sender = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicCubic test case
+ */
+class QuicCubicTestSuite : public TestSuite
+{
+public:
+  QuicCubicTestSuite () :
+      TestSuite ("quic-cubic", UNIT)
+  {
+    AddTestCase (new QuicCubicTestCase (true), TestCase::QUICK);
+    AddTestCase (new QuicCubicTestCase (false), TestCase::QUICK);
+  }
+};
+
+static QuicCubicTestSuite g_quicCubicTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/quic-flow-controller.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicFlowControllerTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicFlowController Test
+ *
+ * The receive side is checked for the moments at which new credit is
+ * advertised, the send side for the deduplication of the blocked signals.
+ */
+class QuicFlowControllerTestCase : public TestCase
+{
+public:
+  QuicFlowControllerTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+
+  /**
+   * \brief Check the advertisement of credit when the threshold is crossed
+   */
+  void
+  TestThreshold ();
+  /**
+   * \brief Check the advertisement of credit when the window changes
+   */
+  void
+  TestWindowChange ();
+  /**
+   * \brief Check the blocked signals of the peer and of the sender
+   */
+  void
+  TestBlocked ();
+  /**
+   * \brief Check the autotuning of the window
+   */
+  void
+  TestAutoTune ();
+};
+
+QuicFlowControllerTestCase::QuicFlowControllerTestCase () :
+    TestCase ("QuicFlowController Test")
+{
+}
+
+void
+QuicFlowControllerTestCase::DoRun ()
+{
+  TestThreshold ();
+  TestWindowChange ();
+  TestBlocked ();
+  TestAutoTune ();
+}
+
+void
+QuicFlowControllerTestCase::TestThreshold ()
+{
+  QuicFlowController fc;
+  fc.SetWindow (1000);
+  fc.SetInitialLimit (1000);
+  fc.SetUpdateThreshold (0.5);
+
+  /*
+   * Threshold:
+   * -> no update until half of the window is consumed
+   * -> the new limit is the consumed data plus the window
+   * -> the limit is not advertised again until the threshold is crossed again
+   */
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due with no data consumed");
+  fc.AddConsumed (499);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due below the threshold");
+  fc.AddConsumed (1);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), true, "Update not due at the threshold");
+  NS_TEST_ASSERT_MSG_EQ (fc.Advertise (), 1500, "Wrong advertised limit");
+  NS_TEST_ASSERT_MSG_EQ (fc.GetLimit (), 1500, "Wrong limit");
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due right after an advertisement");
+  fc.AddConsumed (499);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due below the threshold");
+  fc.AddConsumed (1);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), true, "Update not due at the threshold");
+  NS_TEST_ASSERT_MSG_EQ (fc.Advertise (), 2000, "Wrong advertised limit");
+}
+
+void
+QuicFlowControllerTestCase::TestWindowChange ()
+{
+  QuicFlowController fc;
+  fc.SetWindow (1000);
+  fc.SetInitialLimit (1000);
+  fc.SetUpdateThreshold (0.5);
+
+  /*
+   * Window change:
+   * -> a larger window is advertised at once
+   * -> a smaller window never decreases the limit
+   * -> a limit larger than the window is not advertised until it is reached
+   */
+  fc.AddConsumed (100);
+  fc.SetWindow (2000);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), true, "Update not due after a window increase");
+  NS_TEST_ASSERT_MSG_EQ (fc.Advertise (), 2100, "Wrong advertised limit");
+  fc.SetWindow (500);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due after a window decrease");
+  fc.AddConsumed (1600);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), true, "Update not due past the old limit");
+  NS_TEST_ASSERT_MSG_EQ (fc.Advertise (), 2200, "Wrong advertised limit");
+
+  QuicFlowController large;
+  large.SetWindow (1000);
+  large.SetInitialLimit (100000);
+  large.AddConsumed (50000);
+  NS_TEST_ASSERT_MSG_EQ (large.IsUpdateDue (), false, "Update due below the initial limit");
+}
+
+void
+QuicFlowControllerTestCase::TestBlocked ()
+{
+  QuicFlowController fc;
+  fc.SetWindow (1000);
+  fc.SetInitialLimit (1000);
+  fc.SetUpdateThreshold (0.5);
+
+  /*
+   * Peer blocked:
+   * -> a peer blocked at the advertised limit does not trigger an update
+   * -> a peer blocked at an older limit missed the update, which is sent again
+   */
+  fc.AddConsumed (200);
+  fc.OnPeerBlocked (1000);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due when blocked at the current limit");
+  fc.AddConsumed (400);
+  NS_TEST_ASSERT_MSG_EQ (fc.Advertise (), 1600, "Wrong advertised limit");
+  fc.OnPeerBlocked (1000);
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), true, "Update not due when blocked at a stale limit");
+  NS_TEST_ASSERT_MSG_EQ (fc.Advertise (), 1600, "The limit changed when sent again");
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), false, "Update due after it was sent again");
+
+  /*
+   * Sender blocked:
+   * -> the signal is sent once per peer limit
+   */
+  NS_TEST_ASSERT_MSG_EQ (fc.OnBlocked (5000), true, "First blocked signal not sent");
+  NS_TEST_ASSERT_MSG_EQ (fc.OnBlocked (5000), false, "Blocked signal sent twice for the same limit");
+  NS_TEST_ASSERT_MSG_EQ (fc.OnBlocked (8000), true, "Blocked signal not sent for a new limit");
+}
+
+void
+QuicFlowControllerTestCase::TestAutoTune ()
+{
+  QuicFlowController fc;
+  fc.SetWindow (1000);
+  fc.SetInitialLimit (1000);
+  fc.SetMaxWindow (3000);
+  Time rtt = MilliSeconds (100);
+
+  /*
+   * Autotuning:
+   * -> the first update only records the time
+   * -> an update less than two RTTs after the previous one doubles the window
+   * -> an update two RTTs or more after the previous one keeps the window
+   * -> the window does not grow beyond the maximum
+   * -> no RTT sample, no growth
+   */
+  uint64_t increase = fc.AutoTune (MilliSeconds (0), rtt);
+  NS_TEST_ASSERT_MSG_EQ (increase, 0, "Growth at the first update");
+  increase = fc.AutoTune (MilliSeconds (150), rtt);
+  NS_TEST_ASSERT_MSG_EQ (increase, 1000, "No growth for a fast application");
+  fc.SetWindow (2000);
+  increase = fc.AutoTune (MilliSeconds (350), rtt);
+  NS_TEST_ASSERT_MSG_EQ (increase, 0, "Growth for a slow application");
+  increase = fc.AutoTune (MilliSeconds (400), rtt);
+  NS_TEST_ASSERT_MSG_EQ (increase, 1000, "Growth beyond the maximum window");
+  fc.SetWindow (3000);
+  increase = fc.AutoTune (MilliSeconds (450), rtt);
+  NS_TEST_ASSERT_MSG_EQ (increase, 0, "Growth at the maximum window");
+  fc.SetMaxWindow (10000);
+  increase = fc.AutoTune (MilliSeconds (500), Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (increase, 0, "Growth without RTT");
+  NS_TEST_ASSERT_MSG_EQ (fc.IsUpdateDue (), true, "Update not due after a window change");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicFlowController test case
+ */
+class QuicFlowControllerTestSuite : public TestSuite
+{
+public:
+  QuicFlowControllerTestSuite () :
+      TestSuite ("quic-flow-controller", UNIT)
+  {
+    AddTestCase (new QuicFlowControllerTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicFlowControllerTestSuite g_quicFlowControllerTestSuite; //!< Static variable for test initialization
@@ -35,6 +35,7 @@
 #include "ns3/buffer.h"
 #include "ns3/quic-header.h"
 #include "ns3/quic-subheader.h"
+#include "ns3/quic-transport-parameters.h"
 
 using namespace ns3;
 
@@ -75,6 +76,12 @@ private:
   void
   TestQuicHeaderSerializeDeserialize ();
 
+  /**
+   * \brief Check the recovery of packet numbers truncated on the wire.
+   */
+  void
+  TestQuicHeaderPacketNumberDecode ();
+
 };
 
 /**
@@ -100,6 +107,12 @@ private:
   void
   TestQuicSubHeaderSerializeDeserialize ();
 
+  /**
+   * \brief Check that values beyond 32 bits survive serialization.
+   */
+  void
+  TestQuicSubHeaderLargeValues ();
+
 };
 
 
@@ -112,6 +125,7 @@ void
 QuicHeaderTestCase::DoRun ()
 {
   TestQuicHeaderSerializeDeserialize ();
+  TestQuicHeaderPacketNumberDecode ();
 }
 
 QuicSubHeaderTestCase::QuicSubHeaderTestCase () :
@@ -123,6 +137,7 @@ void
 QuicSubHeaderTestCase::DoRun ()
 {
   TestQuicSubHeaderSerializeDeserialize ();
+  TestQuicSubHeaderLargeValues ();
 }
 
 
@@ -138,7 +153,7 @@ QuicHeaderTestCase::TestQuicHeaderSerializeDeserialize ()
     {
       uint64_t connectionId = GET_RANDOM_UINT64 (x);
       uint32_t version = GET_RANDOM_UINT32 (x);
-      SequenceNumber32 packetNumber = SequenceNumber32(GET_RANDOM_UINT32 (x));
+      SequenceNumber64 packetNumber = SequenceNumber64(GET_RANDOM_UINT32 (x));
       std::vector<uint32_t> supportedVersions;
 
       for ( int h_case = QuicHeader::VERSION_NEGOTIATION; 
@@ -395,16 +410,18 @@ QuicSubHeaderTestCase::TestQuicSubHeaderSerializeDeserialize ()
       uint64_t offset = GET_RANDOM_UINT64 (x);
       uint64_t sequence = GET_RANDOM_UINT64 (x);
       uint64_t connectionId = GET_RANDOM_UINT64 (x);
-      uint32_t largestAcknowledged = GET_RANDOM_UINT32 (x);
+      uint64_t largestAcknowledged = GET_RANDOM_UINT32 (x);
       uint64_t ackDelay = GET_RANDOM_UINT64 (x);
-      uint32_t firstAckBlock = GET_RANDOM_UINT32 (x);
-      std::vector<uint32_t> gaps(10, 1);
-      std::vector<uint32_t> additionalAckBlocks(10, 1);
+      uint64_t firstAckBlock = GET_RANDOM_UINT32 (x);
+      uint64_t ackElicitingThreshold = GET_RANDOM_UINT64 (x);
+      uint64_t reorderingThreshold = GET_RANDOM_UINT64 (x);
+      std::vector<uint64_t> gaps(10, 1);
+      std::vector<uint64_t> additionalAckBlocks(10, 1);
       uint8_t data = GET_RANDOM_UINT8 (x);
       uint64_t length = GET_RANDOM_UINT64 (x);
 
       for ( int h_case = QuicSubheader::PADDING; 
-        h_case != QuicSubheader::STREAM111 +1; h_case++ )
+        h_case != QuicSubheader::IMMEDIATE_ACK +1; h_case++ )
         {
           switch ( h_case )
           {
@@ -1173,6 +1190,59 @@ QuicSubHeaderTestCase::TestQuicSubHeaderSerializeDeserialize ()
                   NS_TEST_ASSERT_MSG_EQ (copyHead.GetSerializedSize (), headSize, 
                     "QuicSubHeader for STREAM111 frame is not as expected in deserialized subheader");
                   break;
+              case QuicSubheader::ACK_FREQUENCY:
+                  head = QuicSubheader::CreateAckFrequency (sequence, ackElicitingThreshold,
+                    ackDelay, reorderingThreshold);
+
+                  headSize = 1 + QuicSubheader::GetVarInt64Size(sequence)/8 + QuicSubheader::GetVarInt64Size(ackElicitingThreshold)/8 + QuicSubheader::GetVarInt64Size(ackDelay)/8 + QuicSubheader::GetVarInt64Size(reorderingThreshold)/8;
+
+                  NS_TEST_ASSERT_MSG_EQ (head.GetSerializedSize (), headSize, 
+                    "QuicSubHeader for ACK_FREQUENCY frame is not as expected");
+
+                  buffer.AddAtStart (head.GetSerializedSize ());
+                  head.Serialize (buffer.Begin ());
+
+                  NS_TEST_ASSERT_MSG_EQ (head.GetFrameType (), QuicSubheader::ACK_FREQUENCY,
+                                             "Different frame type found");
+                  NS_TEST_ASSERT_MSG_EQ (head.IsAckFrequency (), true,
+                                             "ACK_FREQUENCY frame not recognized");
+
+                  copyHead.Deserialize (buffer.Begin ());
+
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetFrameType (), QuicSubheader::ACK_FREQUENCY,
+                                             "Different frame type found in deserialized subheader");
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetSequence (), sequence,
+                                             "Different sequence found in deserialized subheader");
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetAckElicitingThreshold (), ackElicitingThreshold,
+                                             "Different ack-eliciting threshold found in deserialized subheader");
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetRequestMaxAckDelay (), ackDelay,
+                                             "Different requested max ack delay found in deserialized subheader");
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetReorderingThreshold (), reorderingThreshold,
+                                             "Different reordering threshold found in deserialized subheader");
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetSerializedSize (), headSize, 
+                    "QuicSubHeader for ACK_FREQUENCY frame is not as expected in deserialized subheader");
+                  break;
+              case QuicSubheader::IMMEDIATE_ACK:
+                  head = QuicSubheader::CreateImmediateAck ();
+
+                  headSize = 1;
+
+                  NS_TEST_ASSERT_MSG_EQ (head.GetSerializedSize (), headSize, 
+                    "QuicSubHeader for IMMEDIATE_ACK frame is not as expected");
+
+                  buffer.AddAtStart (head.GetSerializedSize ());
+                  head.Serialize (buffer.Begin ());
+
+                  NS_TEST_ASSERT_MSG_EQ (head.IsImmediateAck (), true,
+                                             "IMMEDIATE_ACK frame not recognized");
+
+                  copyHead.Deserialize (buffer.Begin ());
+
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetFrameType (), QuicSubheader::IMMEDIATE_ACK,
+                                             "Different frame type found in deserialized subheader");
+                  NS_TEST_ASSERT_MSG_EQ (copyHead.GetSerializedSize (), headSize, 
+                    "QuicSubHeader for IMMEDIATE_ACK frame is not as expected in deserialized subheader");
+                  break;
                default:
                   break;
           }
@@ -1182,6 +1252,123 @@ QuicSubHeaderTestCase::TestQuicSubHeaderSerializeDeserialize ()
 }
 
 
+void
+QuicHeaderTestCase::TestQuicHeaderPacketNumberDecode ()
+{
+  uint64_t base = (uint64_t) 1 << 32;
+
+  // 4 octets on the wire: the receiver only sees the lower 32 bits
+  QuicHeader head = QuicHeader::CreateShort (1, SequenceNumber64 (base + 5));
+  NS_TEST_ASSERT_MSG_EQ (head.GetTypeByte (), QuicHeader::FOUR_OCTECTS,
+                         "Large packet numbers are not sent on 4 octets");
+  Buffer buffer;
+  buffer.AddAtStart (head.GetSerializedSize ());
+  head.Serialize (buffer.Begin ());
+  QuicHeader copyHead;
+  copyHead.Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyHead.GetPacketNumber (), SequenceNumber64 (5),
+                         "Packet number is not truncated on the wire");
+  NS_TEST_ASSERT_MSG_EQ (copyHead.DecodePacketNumber (SequenceNumber64 (base + 3)),
+                         SequenceNumber64 (base + 5),
+                         "Packet number not recovered from the largest received");
+
+  // across a wrap of the truncated value
+  copyHead.SetPacketNumber (SequenceNumber64 (1));
+  copyHead.SetTypeByte (QuicHeader::FOUR_OCTECTS);
+  NS_TEST_ASSERT_MSG_EQ (copyHead.DecodePacketNumber (SequenceNumber64 (2 * base - 2)),
+                         SequenceNumber64 (2 * base + 1),
+                         "Packet number not recovered across a wrap");
+
+  // a reordered packet from before the wrap
+  copyHead.SetPacketNumber (SequenceNumber64 (base - 3));
+  NS_TEST_ASSERT_MSG_EQ (copyHead.DecodePacketNumber (SequenceNumber64 (base + 10)),
+                         SequenceNumber64 (base - 3),
+                         "Reordered packet number not recovered");
+
+  // short encodings carry the full packet number
+  head = QuicHeader::CreateShort (1, SequenceNumber64 (200));
+  NS_TEST_ASSERT_MSG_EQ (head.DecodePacketNumber (SequenceNumber64 (base)),
+                         SequenceNumber64 (200),
+                         "One octet packet number modified");
+}
+
+void
+QuicSubHeaderTestCase::TestQuicSubHeaderLargeValues ()
+{
+  uint64_t large = ((uint64_t) 1 << 40) + 7;
+  std::vector<uint64_t> gaps (1, large - 10);
+  std::vector<uint64_t> additionalAckBlocks (1, large - 20);
+
+  QuicSubheader head = QuicSubheader::CreateAck (large, 0, large, gaps, additionalAckBlocks);
+  Buffer buffer;
+  buffer.AddAtStart (head.GetSerializedSize ());
+  head.Serialize (buffer.Begin ());
+  QuicSubheader copyHead;
+  copyHead.Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyHead.GetLargestAcknowledged (), large,
+                         "64 bit largest acknowledged not preserved");
+  NS_TEST_ASSERT_MSG_EQ (copyHead.GetGaps ()[0], large - 10,
+                         "64 bit gap not preserved");
+  NS_TEST_ASSERT_MSG_EQ (copyHead.GetAdditionalAckBlocks ()[0], large - 20,
+                         "64 bit ack block not preserved");
+
+  head = QuicSubheader::CreateMaxData (QuicSubheader::MAX_VARINT);
+  Buffer maxDataBuffer;
+  maxDataBuffer.AddAtStart (head.GetSerializedSize ());
+  head.Serialize (maxDataBuffer.Begin ());
+  copyHead.Deserialize (maxDataBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyHead.GetMaxData (), QuicSubheader::MAX_VARINT,
+                         "62 bit max data not preserved");
+
+  // the values at the boundaries of each variable-length integer size
+  uint64_t boundaries[] = { 0, 63, 64, 16383, 16384, 1073741823, 1073741824, QuicSubheader::MAX_VARINT };
+  uint32_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8 };
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (QuicSubheader::GetVarInt64Size (boundaries[j]), 8 * sizes[j],
+                             "Wrong size of variable-length integer " << boundaries[j]);
+      head = QuicSubheader::CreateMaxData (boundaries[j]);
+      Buffer boundaryBuffer;
+      boundaryBuffer.AddAtStart (head.GetSerializedSize ());
+      head.Serialize (boundaryBuffer.Begin ());
+      uint32_t read = copyHead.Deserialize (boundaryBuffer.Begin ());
+      NS_TEST_ASSERT_MSG_EQ (read, 1 + sizes[j], "Wrong number of bytes read for " << boundaries[j]);
+      NS_TEST_ASSERT_MSG_EQ (copyHead.GetMaxData (), boundaries[j],
+                             "Variable-length integer " << boundaries[j] << " not preserved");
+    }
+  NS_TEST_ASSERT_MSG_EQ (QuicSubheader::GetVarInt64Size (QuicSubheader::MAX_VARINT + 1), 0,
+                         "Size of a variable-length integer beyond 62 bits");
+
+  head = QuicSubheader::CreateStreamSubHeader (1, large, 100, true, true, false);
+  Buffer streamBuffer;
+  streamBuffer.AddAtStart (head.GetSerializedSize ());
+  head.Serialize (streamBuffer.Begin ());
+  copyHead.Deserialize (streamBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyHead.GetOffset (), large,
+                         "64 bit stream offset not preserved");
+
+  QuicTransportParameters params = QuicTransportParameters::CreateTransportParameters (
+      large, large + 1, 2, 300, 0, 1460, 3, 3);
+  Buffer paramsBuffer;
+  paramsBuffer.AddAtStart (params.GetSerializedSize ());
+  params.Serialize (paramsBuffer.Begin ());
+  QuicTransportParameters copyParams;
+  copyParams.Deserialize (paramsBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyParams.GetInitialMaxStreamData (), large,
+                         "64 bit initial max stream data not preserved");
+  NS_TEST_ASSERT_MSG_EQ (copyParams.GetInitialMaxData (), large + 1,
+                         "64 bit initial max data not preserved");
+
+  params.SetMinAckDelay (1000);
+  Buffer minAckDelayBuffer;
+  minAckDelayBuffer.AddAtStart (params.GetSerializedSize ());
+  params.Serialize (minAckDelayBuffer.Begin ());
+  copyParams.Deserialize (minAckDelayBuffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (copyParams.GetMinAckDelay (), 1000,
+                         "min_ack_delay not preserved");
+  NS_TEST_ASSERT_MSG_EQ (copyParams.GetInitialMaxData (), large + 1,
+                         "min_ack_delay overwrites the following parameters");
+}
 
 void
 QuicHeaderTestCase::DoTeardown ()
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <list>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/quic-item-pool.h"
+#include "ns3/quic-socket-tx-buffer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicItemPoolTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicItemPool Test
+ *
+ * The items released by the handles are reset and handed out again
+ * without new allocations.
+ */
+class QuicItemPoolTestCase : public TestCase
+{
+public:
+  QuicItemPoolTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+};
+
+QuicItemPoolTestCase::QuicItemPoolTestCase () :
+    TestCase ("QuicItemPool Test")
+{
+}
+
+void
+QuicItemPoolTestCase::DoRun ()
+{
+  QuicItemPool<QuicSocketTxItem> pool;
+
+  /*
+   * Reuse:
+   * -> the items of the destroyed handles go back to the free list
+   * -> the next items come from the free list, reset to their default
+   * -> new items are allocated only when the free list is empty
+   */
+  std::list<QuicItemPool<QuicSocketTxItem>::Handle> list;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      list.push_back (pool.Acquire ());
+      list.back ()->m_packet = Create<Packet> (100);
+      list.back ()->m_lost = true;
+    }
+  NS_TEST_ASSERT_MSG_EQ (pool.GetAllocated (), 3, "Wrong number of allocated items");
+  NS_TEST_ASSERT_MSG_EQ (pool.GetFree (), 0, "Free items while all are in use");
+
+  list.pop_front ();
+  list.clear ();
+  NS_TEST_ASSERT_MSG_EQ (pool.GetFree (), 3, "Items not returned to the pool");
+
+  QuicItemPool<QuicSocketTxItem>::Handle item = pool.Acquire ();
+  NS_TEST_ASSERT_MSG_EQ (pool.GetAllocated (), 3, "Item allocated with free items in the pool");
+  NS_TEST_ASSERT_MSG_EQ (pool.GetFree (), 2, "Wrong number of free items");
+  NS_TEST_ASSERT_MSG_EQ ((item->m_packet == 0), true, "Reused item keeps its packet");
+  NS_TEST_ASSERT_MSG_EQ (item->m_lost, false, "Reused item keeps its state");
+
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      list.push_back (pool.Acquire ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (pool.GetAllocated (), 4, "Wrong number of allocated items");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicItemPool test case
+ */
+class QuicItemPoolTestSuite : public TestSuite
+{
+public:
+  QuicItemPoolTestSuite () :
+      TestSuite ("quic-item-pool", UNIT)
+  {
+    AddTestCase (new QuicItemPoolTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicItemPoolTestSuite g_quicItemPoolTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/quic-l4-protocol.h"
+#include "ns3/quic-socket-base.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicL4ProtocolTestSuite");
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicL4Protocol Test
+ *
+ * The authenticated addresses cache of a QuicL4Protocol is filled past its
+ * capacity and left idle past its lifetime; the test checks which addresses
+ * are still authenticated. The test also checks the index of the sockets by
+ * connection ID when a listening socket is cloned.
+ */
+class QuicL4ProtocolTestCase : public TestCase
+{
+public:
+  QuicL4ProtocolTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /**
+   * \brief Test the eviction of the least recently used addresses
+   */
+  void
+  TestAuthEviction ();
+  /**
+   * \brief Check whether an address is authenticated at the current time
+   * \param address the address
+   * \param authenticated true if the address is expected to be authenticated
+   */
+  void
+  CheckAuthenticated (Ipv4Address address, bool authenticated);
+  /**
+   * \brief Test the index of the sockets by connection ID
+   */
+  void
+  TestConnectionIdIndex ();
+
+  Ptr<QuicL4Protocol> m_l4;  //!< The QuicL4Protocol under test
+};
+
+QuicL4ProtocolTestCase::QuicL4ProtocolTestCase () :
+    TestCase ("QuicL4Protocol Test")
+{
+}
+
+void
+QuicL4ProtocolTestCase::DoRun ()
+{
+  m_l4 = CreateObject<QuicL4Protocol> ();
+
+  /*
+   * Capacity:
+   * -> a new address beyond the capacity evicts the least recently used one
+   * -> a lookup or a new authentication refreshes an address
+   */
+  TestAuthEviction ();
+
+  /*
+   * Lifetime:
+   * -> an address is forgotten once idle for longer than the lifetime
+   * -> a lookup restarts the lifetime
+   */
+  m_l4->SetAttribute ("AuthAddressTtl", TimeValue (Seconds (1)));
+  Ipv4Address idle ("10.1.2.1");
+  Ipv4Address used ("10.1.2.2");
+  m_l4->AddAuthAddress (idle);
+  m_l4->AddAuthAddress (used);
+  Simulator::Schedule (Seconds (0.8), &QuicL4ProtocolTestCase::CheckAuthenticated, this, used, true);
+  Simulator::Schedule (Seconds (1.5), &QuicL4ProtocolTestCase::CheckAuthenticated, this, used, true);
+  Simulator::Schedule (Seconds (1.5), &QuicL4ProtocolTestCase::CheckAuthenticated, this, idle, false);
+  Simulator::Schedule (Seconds (3), &QuicL4ProtocolTestCase::CheckAuthenticated, this, used, false);
+  Simulator::Run ();
+  // the lifetime is checked on lookup, the other addresses are still cached
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_authAddresses.size (), 3, "Expired addresses not removed");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_authAddressIndex.size (), 3, "Expired addresses still indexed");
+
+  /*
+   * Connection ID index:
+   * -> a clone of the listening socket is indexed with its own connection ID,
+   *    next to the listener
+   * -> a new connection ID replaces the old one in the index
+   */
+  TestConnectionIdIndex ();
+}
+
+void
+QuicL4ProtocolTestCase::TestAuthEviction ()
+{
+  m_l4->SetAttribute ("MaxAuthAddresses", UintegerValue (3));
+  Ipv4Address a ("10.1.1.1");
+  Ipv4Address b ("10.1.1.2");
+  Ipv4Address c ("10.1.1.3");
+  Ipv4Address d ("10.1.1.4");
+  Ipv4Address e ("10.1.1.5");
+  Ipv4Address f ("10.1.1.6");
+
+  m_l4->AddAuthAddress (a);
+  m_l4->AddAuthAddress (b);
+  m_l4->AddAuthAddress (c);
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (d), false, "Address authenticated without a handshake");
+  m_l4->AddAuthAddress (d);
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_authAddresses.size (), 3, "Cache above its capacity");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (a), false, "Least recently used address not evicted");
+
+  // b is refreshed by a lookup, c by a new authentication: d is the oldest
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (b), true, "Address evicted too early");
+  m_l4->AddAuthAddress (c);
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_authAddresses.size (), 3, "Refreshed address added twice");
+  m_l4->AddAuthAddress (e);
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (d), false, "Least recently used address not evicted");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (c), true, "Refreshed address evicted");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (b), true, "Refreshed address evicted");
+
+  // e is now the least recently used
+  m_l4->AddAuthAddress (f);
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (e), false, "Least recently used address not evicted");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (b), true, "Most recently used address evicted");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (f), true, "New address not authenticated");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_authAddressIndex.size (), m_l4->m_authAddresses.size (),
+                         "Index out of sync with the cache");
+
+  m_l4->SetAttribute ("MaxAuthAddresses", UintegerValue (5));
+}
+
+void
+QuicL4ProtocolTestCase::CheckAuthenticated (Ipv4Address address, bool authenticated)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_l4->IsAuthenticated (address), authenticated,
+                         "Wrong authentication of " << address << " at " << Now ().GetSeconds () << " s");
+}
+
+void
+QuicL4ProtocolTestCase::TestConnectionIdIndex ()
+{
+  Ptr<QuicSocketBase> listener = DynamicCast<QuicSocketBase> (m_l4->CreateSocket ());
+  uint64_t listenerId = listener->GetConnectionId ();
+  auto listenerIt = m_l4->m_connectionIdIndex.find (listenerId);
+  NS_TEST_ASSERT_MSG_EQ ((listenerIt != m_l4->m_connectionIdIndex.end ()), true, "Socket not indexed");
+  Ptr<QuicUdpBinding> listenerBinding = listenerIt->second;
+  NS_TEST_ASSERT_MSG_EQ (listenerBinding->m_quicSocket, listener, "Wrong socket indexed");
+
+  uint64_t cloneId = listenerId ^ 1;
+  Ptr<QuicSocketBase> clone = m_l4->CloneSocket (listener, cloneId);
+  NS_TEST_ASSERT_MSG_EQ (clone->GetConnectionId (), cloneId, "Clone without its connection ID");
+  auto cloneIt = m_l4->m_connectionIdIndex.find (cloneId);
+  NS_TEST_ASSERT_MSG_EQ ((cloneIt != m_l4->m_connectionIdIndex.end ()), true, "Clone not indexed");
+  Ptr<QuicUdpBinding> cloneBinding = cloneIt->second;
+  NS_TEST_ASSERT_MSG_EQ (cloneBinding->m_quicSocket, clone, "Wrong socket indexed for the clone");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->FindBinding (clone), cloneBinding, "Clone not found through the index");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_connectionIdIndex.find (listenerId)->second, listenerBinding,
+                         "Listener replaced in the index by the clone");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_connectionIdIndex.size (), 2, "Stale entries in the index");
+
+  clone->SetConnectionId (cloneId ^ 2);
+  NS_TEST_ASSERT_MSG_EQ ((m_l4->m_connectionIdIndex.find (cloneId) == m_l4->m_connectionIdIndex.end ()),
+                         true, "Old connection ID still indexed");
+  cloneIt = m_l4->m_connectionIdIndex.find (cloneId ^ 2);
+  NS_TEST_ASSERT_MSG_EQ ((cloneIt != m_l4->m_connectionIdIndex.end ()), true, "New connection ID not indexed");
+  NS_TEST_ASSERT_MSG_EQ (cloneIt->second, cloneBinding, "Clone re-indexed with a new binding");
+  NS_TEST_ASSERT_MSG_EQ (m_l4->m_connectionIdIndex.size (), 2, "Stale entries in the index");
+}
+
+void
+QuicL4ProtocolTestCase::DoTeardown ()
+{
+  m_l4 = 0;
+  Simulator::Destroy ();
+}
+
+} // namespace ns3
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicL4Protocol test case
+ */
+class QuicL4ProtocolTestSuite : public TestSuite
+{
+public:
+  QuicL4ProtocolTestSuite () :
+      TestSuite ("quic-l4-protocol", UNIT)
+  {
+    AddTestCase (new QuicL4ProtocolTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicL4ProtocolTestSuite g_quicL4ProtocolTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/object-map.h"
+#include "ns3/quic-l5-protocol.h"
+#include "ns3/quic-stream-base.h"
+#include "quic-test-connection.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicL5ProtocolTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicL5Protocol Test
+ *
+ * The frames of the peer are dispatched to a QuicL5Protocol bound to an open
+ * client socket, and the test reads the data that the streams deliver in order.
+ * The streams that the protocol allocates are counted through its StreamList.
+ */
+class QuicL5ProtocolTestCase : public TestCase
+{
+public:
+  QuicL5ProtocolTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /**
+   * \brief Dispatch a STREAM frame of the peer and read the delivered data
+   * \param streamId the stream ID
+   * \param offset the offset of the frame
+   * \param length the length of the frame
+   */
+  void
+  ReceiveFrame (uint64_t streamId, uint64_t offset, uint32_t length);
+  /**
+   * \brief Get the number of streams allocated by the QuicL5Protocol
+   * \return the number of streams
+   */
+  uint32_t
+  GetNStreams ();
+  /**
+   * \brief Test the lazy creation of the streams
+   */
+  void
+  TestLazyStreams ();
+  /**
+   * \brief Test the delivery of retransmissions that straddle the delivered offset
+   */
+  void
+  TestStreamRetransmission ();
+  /**
+   * \brief Test the rejection of the stream IDs above the maximum
+   */
+  void
+  TestMaxStreamId ();
+
+  Ptr<QuicSocketBase> m_socket;   //!< The open client socket
+  Ptr<QuicL5Protocol> m_l5;       //!< The QuicL5Protocol under test
+  uint32_t m_delivered;           //!< The data read from the socket
+};
+
+QuicL5ProtocolTestCase::QuicL5ProtocolTestCase () :
+    TestCase ("QuicL5Protocol Test"),
+    m_delivered (0)
+{
+}
+
+void
+QuicL5ProtocolTestCase::DoRun ()
+{
+  QuicTestConnection connection ("10Mbps", MilliSeconds (10));
+  m_socket = connection.Connect (Seconds (0));
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_socket->GetSocketState (), QuicSocket::OPEN, "Connection not open");
+  // leave room for unused stream IDs below the ones in use
+  m_socket->SetAttribute ("MaxStreamIdBidi", UintegerValue (8));
+
+  m_l5 = CreateObject<QuicL5Protocol> ();
+  m_l5->SetSocket (m_socket);
+  m_l5->SetNode (m_socket->GetNode ());
+
+  /*
+   * Lazy stream creation:
+   * -> no stream is allocated before it is used
+   * -> a write on a local stream opens only that stream
+   * -> the first frame of the peer on a stream opens it
+   */
+  TestLazyStreams ();
+
+  /*
+   * Retransmissions on a stream:
+   * -> a frame whose head has been delivered delivers its tail and the
+   *    buffered data that follows it
+   * -> the frames after it are delivered in order
+   * -> a duplicate frame is discarded
+   */
+  TestStreamRetransmission ();
+
+  /*
+   * Maximum stream ID:
+   * -> a stream above the maximum is not created, and the connection is aborted
+   * -> a frame of the peer above the maximum does not open a stream
+   */
+  TestMaxStreamId ();
+}
+
+void
+QuicL5ProtocolTestCase::ReceiveFrame (uint64_t streamId, uint64_t offset, uint32_t length)
+{
+  Ptr<Packet> frame = Create<Packet> (length);
+  frame->AddHeader (QuicSubheader::CreateStreamSubHeader (streamId, offset, length, true, true, false));
+  Address from;
+  m_l5->DispatchRecv (frame, from);
+
+  Ptr<Packet> data;
+  while ((data = m_socket->Recv (UINT32_MAX, 0)) != 0 and data->GetSize () > 0)
+    {
+      m_delivered += data->GetSize ();
+    }
+}
+
+uint32_t
+QuicL5ProtocolTestCase::GetNStreams ()
+{
+  ObjectMapValue streams;
+  m_l5->GetAttribute ("StreamList", streams);
+  return streams.GetN ();
+}
+
+void
+QuicL5ProtocolTestCase::TestLazyStreams ()
+{
+  NS_TEST_ASSERT_MSG_EQ (GetNStreams (), 0, "Streams allocated before use");
+
+  int sent = m_l5->DispatchSend (Create<Packet> (500), 4);
+  NS_TEST_ASSERT_MSG_EQ (sent, 500, "Write on stream 4 failed");
+  NS_TEST_ASSERT_MSG_EQ (GetNStreams (), 1, "Unused streams allocated");
+  NS_TEST_ASSERT_MSG_NE (m_l5->SearchStream (4), 0, "Stream 4 not open");
+  for (uint64_t streamId = 0; streamId < 4; ++streamId)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_l5->SearchStream (streamId), 0, "Stream " << streamId << " open");
+    }
+
+  ReceiveFrame (5, 0, 100);
+  NS_TEST_ASSERT_MSG_EQ (GetNStreams (), 2, "Peer stream not allocated on its first frame");
+  NS_TEST_ASSERT_MSG_NE (m_l5->SearchStream (5), 0, "Stream 5 not open");
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 100, "Data of the peer stream not delivered");
+  m_delivered = 0;
+}
+
+void
+QuicL5ProtocolTestCase::TestStreamRetransmission ()
+{
+  ReceiveFrame (1, 0, 1000);
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 1000, "In-order frame not delivered");
+
+  ReceiveFrame (1, 2000, 1000);
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 1000, "Out-of-order frame delivered");
+
+  // the retransmission of the lost [1000, 2000) merged with bytes already delivered
+  ReceiveFrame (1, 500, 2000);
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 3000, "Straddling frame not delivered");
+
+  ReceiveFrame (1, 3000, 1000);
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 4000, "Stream stalled after the retransmission");
+
+  ReceiveFrame (1, 1000, 1000);
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 4000, "Duplicate frame delivered");
+}
+
+void
+QuicL5ProtocolTestCase::TestMaxStreamId ()
+{
+  uint64_t maxStreamId = m_socket->GetMaxStreamId ();
+  uint32_t streams = GetNStreams ();
+
+  Ptr<QuicStreamBase> stream = m_l5->CreateStream (QuicStream::SENDER, maxStreamId + 1);
+  NS_TEST_ASSERT_MSG_EQ (stream, 0, "Stream above the maximum created");
+  NS_TEST_ASSERT_MSG_EQ (GetNStreams (), streams, "Stream above the maximum allocated");
+  NS_TEST_ASSERT_MSG_NE (m_socket->GetSocketState (), QuicSocket::OPEN, "Connection not aborted");
+
+  ReceiveFrame (maxStreamId + 1, 0, 100);
+  NS_TEST_ASSERT_MSG_EQ (GetNStreams (), streams, "Peer stream above the maximum allocated");
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, 4000, "Data above the maximum stream delivered");
+}
+
+void
+QuicL5ProtocolTestCase::DoTeardown ()
+{
+  m_l5 = 0;
+  m_socket = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicL5Protocol test case
+ */
+class QuicL5ProtocolTestSuite : public TestSuite
+{
+public:
+  QuicL5ProtocolTestSuite () :
+      TestSuite ("quic-l5-protocol", UNIT)
+  {
+    AddTestCase (new QuicL5ProtocolTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicL5ProtocolTestSuite g_quicL5ProtocolTestSuite; //!< Static variable for test initialization
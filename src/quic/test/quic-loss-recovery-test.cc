@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/quic-congestion-ops.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "quic-cc-test-sender.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("QuicLossRecoveryTestSuite");
+
+/**
+ * \brief Create the socket state of the tests, with an RTT sample taken at the start
+ *
+ * \return the socket state
+ */
+static Ptr<QuicSocketState>
+CreateSocketState ()
+{
+  Ptr<QuicSocketState> tcb = CreateObject<QuicSocketState> ();
+  tcb->m_segmentSize = 1200;
+  tcb->m_kMinimumWindow = 2 * tcb->m_segmentSize;
+  tcb->m_cWnd = 20 * tcb->m_segmentSize;
+  tcb->m_ssThresh = UINT32_MAX;
+  tcb->m_smoothedRtt = MilliSeconds (100);
+  tcb->m_rttVar = MilliSeconds (10);
+  tcb->m_lastRtt = MilliSeconds (100);
+  tcb->m_firstRttSample = NanoSeconds (1);
+  return tcb;
+}
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QUIC loss detection and probe timeout Test
+ *
+ * Packets sent before an acknowledged one are lost when they are 3 packets
+ * older or when they were sent 9/8 of an RTT earlier; the youngest of the
+ * others sets the loss time, at which they are lost unless acked.
+ */
+class QuicLossDetectionTestCase : public TestCase
+{
+public:
+  QuicLossDetectionTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /**
+   * \brief Acknowledge a packet and check the packets lost by the time threshold
+   * \param packetNumber the acked packet number
+   */
+  void
+  TestAck (uint32_t packetNumber);
+  /** \brief Check the packets lost at the loss time */
+  void
+  TestLossTime ();
+
+  Ptr<QuicSocketState> m_tcb;          //!< Socket state
+  Ptr<QuicCcTestSender> m_sender;      //!< Sender of the packets
+};
+
+QuicLossDetectionTestCase::QuicLossDetectionTestCase () :
+    TestCase ("QUIC time threshold loss detection and probe timeout")
+{
+}
+
+void
+QuicLossDetectionTestCase::DoRun ()
+{
+  m_tcb = CreateSocketState ();
+  m_sender = Create<QuicCcTestSender> (m_tcb, CreateObject<QuicCongestionOps> ());
+
+  // smoothed_rtt + max (4 * rttvar, kGranularity) + max_ack_delay
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->GetProbeTimeout (), MilliSeconds (165), "Wrong PTO");
+  m_tcb->m_rttVar = MicroSeconds (100);
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->GetProbeTimeout (), MilliSeconds (126),
+                         "The PTO is not bounded by the timer granularity");
+  m_tcb->m_rttVar = MilliSeconds (10);
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->GetLossDelay (), MicroSeconds (112500), "Wrong loss delay");
+
+  Simulator::Schedule (MilliSeconds (0), &QuicCcTestSender::SendPacket, m_sender, 1);
+  Simulator::Schedule (MilliSeconds (50), &QuicCcTestSender::SendPacket, m_sender, 2);
+  Simulator::Schedule (MilliSeconds (60), &QuicCcTestSender::SendPacket, m_sender, 3);
+  Simulator::Schedule (MilliSeconds (130), &QuicLossDetectionTestCase::TestAck, this, 3);
+  Simulator::Schedule (MicroSeconds (162500), &QuicLossDetectionTestCase::TestLossTime, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+QuicLossDetectionTestCase::TestAck (uint32_t packetNumber)
+{
+  m_sender->AckPacket (packetNumber);
+
+  const std::vector<QuicSocketTxItem*> &lostPackets = m_sender->DetectLostPackets ();
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.size (), 1, "Wrong lost packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.at (0)->m_packetNumber, SequenceNumber64 (1),
+                         "The packet older than the loss delay is not lost");
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_lossTime, MicroSeconds (162500),
+                         "The loss time is not the one of the youngest packet");
+}
+
+void
+QuicLossDetectionTestCase::TestLossTime ()
+{
+  std::vector<QuicSocketTxItem*> newlyLost;
+  m_sender->GetTxBuffer ()->MarkLostPackets (*m_tcb, newlyLost);
+  NS_TEST_ASSERT_MSG_EQ (newlyLost.size (), 1, "Wrong newly lost packet vector size");
+  const std::vector<QuicSocketTxItem*> &lostPackets = m_sender->DetectLostPackets ();
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.size (), 2, "Wrong lost packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.at (1)->m_packetNumber, SequenceNumber64 (2),
+                         "The packet is not lost at the loss time");
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_lossTime, Seconds (0),
+                         "The loss time is set without packets to be lost");
+}
+
+void
+QuicLossDetectionTestCase::DoTeardown ()
+{
+  m_sender = 0;
+}
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QUIC persistent congestion Test
+ *
+ * Packets are sent every 100 ms and all lost. When the lost packets span
+ * 3 PTOs (495 ms), the congestion window collapses to the minimum window,
+ * unless a packet in between is acked; otherwise it is only reduced.
+ */
+class QuicPersistentCongestionTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param packets number of lost packets
+   * \param ackedPacket packet number of a packet acked in between (0 if none)
+   * \param persistent true if the losses are a persistent congestion
+   */
+  QuicPersistentCongestionTestCase (uint32_t packets, uint32_t ackedPacket, bool persistent);
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /** \brief Declare all packets lost and check the congestion window */
+  void
+  TestLoss ();
+
+  uint32_t m_packets;                  //!< Number of lost packets
+  uint32_t m_ackedPacket;              //!< Packet acked in between (0 if none)
+  bool m_persistent;                   //!< True if the congestion is expected to be persistent
+  Ptr<QuicSocketState> m_tcb;          //!< Socket state
+  Ptr<QuicCcTestSender> m_sender;      //!< Sender of the packets
+};
+
+QuicPersistentCongestionTestCase::QuicPersistentCongestionTestCase (uint32_t packets,
+                                                                    uint32_t ackedPacket,
+                                                                    bool persistent) :
+    TestCase ("QUIC persistent congestion, " + std::to_string (packets) + " lost packets"
+              + (ackedPacket > 0 ? " with an acked packet" : "")),
+    m_packets (packets),
+    m_ackedPacket (ackedPacket),
+    m_persistent (persistent)
+{
+}
+
+void
+QuicPersistentCongestionTestCase::DoRun ()
+{
+  m_tcb = CreateSocketState ();
+  m_sender = Create<QuicCcTestSender> (m_tcb, CreateObject<QuicCongestionOps> ());
+
+  for (uint32_t packetNumber = 1; packetNumber <= m_packets; ++packetNumber)
+    {
+      Simulator::Schedule (MilliSeconds (100) * packetNumber,
+                           &QuicCcTestSender::SendPacket, m_sender, packetNumber);
+    }
+  Simulator::Schedule (MilliSeconds (100) * (m_packets + 1),
+                       &QuicPersistentCongestionTestCase::TestLoss, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+QuicPersistentCongestionTestCase::TestLoss ()
+{
+  if (m_ackedPacket > 0)
+    {
+      m_sender->AckPacket (m_ackedPacket);
+    }
+  for (uint32_t packetNumber = 1; packetNumber <= m_packets; ++packetNumber)
+    {
+      if (packetNumber != m_ackedPacket)
+        {
+          m_sender->GetTxBuffer ()->MarkAsLost (SequenceNumber64 (packetNumber));
+        }
+    }
+  m_sender->DetectLostPackets ();
+
+  if (m_persistent)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_tcb->m_cWnd.Get (), m_tcb->m_kMinimumWindow,
+                             "The window does not collapse on persistent congestion");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_tcb->m_cWnd.Get (), 10 * m_tcb->m_segmentSize,
+                             "The window is not reduced once on loss");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_tcb->m_ssThresh.Get (), 10 * m_tcb->m_segmentSize,
+                         "The persistent congestion changed the slow start threshold");
+}
+
+void
+QuicPersistentCongestionTestCase::DoTeardown ()
+{
+  m_sender = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QUIC loss recovery test cases
+ */
+class QuicLossRecoveryTestSuite : public TestSuite
+{
+public:
+  QuicLossRecoveryTestSuite () :
+      TestSuite ("quic-loss-recovery", UNIT)
+  {
+    AddTestCase (new QuicLossDetectionTestCase (), TestCase::QUICK);
+    AddTestCase (new QuicPersistentCongestionTestCase (7, 0, true), TestCase::QUICK);
+    AddTestCase (new QuicPersistentCongestionTestCase (5, 0, false), TestCase::QUICK);
+    AddTestCase (new QuicPersistentCongestionTestCase (7, 4, false), TestCase::QUICK);
+  }
+};
+
+static QuicLossRecoveryTestSuite g_quicLossRecoveryTestSuite; //!< Static variable for test initialization
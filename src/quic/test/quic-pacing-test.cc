@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/quic-header.h"
+#include "quic-test-connection.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicPacingTestSuite");
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QUIC pacing Test
+ *
+ * With pacing enabled, the client first writes enough data to open the
+ * congestion window, and then writes again once the connection is idle. The
+ * test checks that after the idle period the first packets leave in a burst,
+ * that the others are spaced by the transmission time of a packet at the
+ * pacing rate, and that the rate is the one set by the gain.
+ */
+class QuicPacingTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param gain the pacing gain
+   * \param burst the number of packets sent back-to-back after an idle period
+   */
+  QuicPacingTestCase (double gain, uint32_t burst);
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /**
+   * \brief Record a packet sent by the client
+   * \param packet the packet
+   * \param header the QUIC header
+   * \param socket the client socket
+   */
+  void
+  Tx (const Ptr<const Packet> packet, const QuicHeader& header,
+      const Ptr<const QuicSocketBase> socket);
+  /**
+   * \brief Record a change of the pacing rate
+   * \param oldValue the old pacing rate
+   * \param newValue the new pacing rate
+   */
+  void
+  PacingRate (DataRate oldValue, DataRate newValue);
+  /**
+   * \brief Write on the idle socket
+   * \param size the number of bytes to write
+   */
+  void
+  Write (uint32_t size);
+  /**
+   * \brief Check the burst and the spacing of the packets sent since the write
+   */
+  void
+  TestPacing ();
+
+  double m_gain;                  //!< The pacing gain
+  uint32_t m_burst;               //!< Number of packets sent back-to-back after an idle period
+  Ptr<QuicSocketBase> m_socket;   //!< The client socket
+  std::vector<Time> m_txTimes;    //!< Time of the packets sent since the write
+  DataRate m_rate;                //!< The pacing rate at the first packet after the write
+  DataRate m_tracedRate;          //!< The last pacing rate reported by the trace
+};
+
+QuicPacingTestCase::QuicPacingTestCase (double gain, uint32_t burst) :
+    TestCase ("QUIC pacing, gain " + std::to_string (gain) + ", burst of "
+              + std::to_string (burst) + " packets"),
+    m_gain (gain),
+    m_burst (burst)
+{
+}
+
+void
+QuicPacingTestCase::DoRun ()
+{
+  QuicTestConnection connection ("100Mbps", MilliSeconds (50));
+  m_socket = connection.Connect (Seconds (0));
+  m_socket->SetAttribute ("EnablePacing", BooleanValue (true));
+  m_socket->SetAttribute ("PacingGain", DoubleValue (m_gain));
+  m_socket->SetAttribute ("PacingBurst", UintegerValue (m_burst));
+  m_socket->TraceConnectWithoutContext ("Tx", MakeCallback (&QuicPacingTestCase::Tx, this));
+  m_socket->TraceConnectWithoutContext ("PacingRate",
+                                        MakeCallback (&QuicPacingTestCase::PacingRate, this));
+
+  // open the congestion window and take RTT samples
+  Simulator::Schedule (Seconds (1), &QuicPacingTestCase::Write, this, 80 * 1460);
+
+  /*
+   * Write after an idle period:
+   * -> the pacing rate is the gain times cWnd over the RTT
+   * -> the first packets leave back-to-back, up to the burst
+   * -> each of the others leaves the transmission time of a packet at the
+   *    pacing rate after the previous one
+   * The checks run before the first ACK, which changes the rate.
+   */
+  Simulator::Schedule (Seconds (5), &QuicPacingTestCase::Write, this, 40 * 1460);
+  Simulator::Schedule (Seconds (5.09), &QuicPacingTestCase::TestPacing, this);
+  Simulator::Stop (Seconds (6));
+  Simulator::Run ();
+}
+
+void
+QuicPacingTestCase::Tx (const Ptr<const Packet> packet, const QuicHeader& header,
+                        const Ptr<const QuicSocketBase> socket)
+{
+  if (m_txTimes.empty ())
+    {
+      m_rate = m_socket->m_tcb->m_currentPacingRate;
+    }
+  m_txTimes.push_back (Now ());
+}
+
+void
+QuicPacingTestCase::PacingRate (DataRate oldValue, DataRate newValue)
+{
+  m_tracedRate = newValue;
+}
+
+void
+QuicPacingTestCase::Write (uint32_t size)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_txBuffer->BytesInFlight (), 0, "Connection not idle");
+  m_txTimes.clear ();
+  int sent = m_socket->Send (Create<Packet> (size));
+  NS_TEST_ASSERT_MSG_EQ (sent, (int) size, "Write failed");
+}
+
+void
+QuicPacingTestCase::TestPacing ()
+{
+  Ptr<QuicSocketState> tcb = m_socket->m_tcb;
+  Time rtt = tcb->m_smoothedRtt;
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_rate.GetBitRate (),
+                             m_gain * tcb->m_cWnd.Get () * 8 / rtt.GetSeconds (), 1,
+                             "The pacing rate is not the gain times cWnd over the RTT");
+  NS_TEST_ASSERT_MSG_EQ (m_tracedRate, m_rate, "Pacing rate not traced");
+
+  // the frames of a packet may take a few bytes less than a segment
+  Time tx = m_rate.CalculateBytesTxTime (m_socket->GetSegSize ());
+  NS_TEST_ASSERT_MSG_GT (m_txTimes.size (), m_burst + 2, "Too few packets sent");
+  for (uint32_t i = 1; i < m_txTimes.size (); ++i)
+    {
+      Time gap = i < m_burst ? Seconds (0) : tx;
+      NS_TEST_ASSERT_MSG_EQ_TOL (m_txTimes[i] - m_txTimes[i - 1], gap, tx / 100,
+                                 "Packet " << i << " not paced");
+    }
+}
+
+void
+QuicPacingTestCase::DoTeardown ()
+{
+  m_socket = 0;
+  Simulator::Destroy ();
+}
+
+} // namespace ns3
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QUIC pacing test cases
+ */
+class QuicPacingTestSuite : public TestSuite
+{
+public:
+  QuicPacingTestSuite () :
+      TestSuite ("quic-pacing", UNIT)
+  {
+    // the defaults
+    AddTestCase (new QuicPacingTestCase (1.25, 2), TestCase::QUICK);
+    // no burst, and a larger gain
+    AddTestCase (new QuicPacingTestCase (2, 1), TestCase::QUICK);
+    // a longer burst, and no gain
+    AddTestCase (new QuicPacingTestCase (1, 4), TestCase::QUICK);
+  }
+};
+
+static QuicPacingTestSuite g_quicPacingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/quic-header.h"
+#include "ns3/quic-socket-tx-buffer.h"
+#include "ns3/quic-timer-multiplexer.h"
+#include "quic-test-connection.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicProbeTimeoutTestSuite");
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QUIC probe timeout Test
+ *
+ * The client writes on an open connection while the link is blacked out, so
+ * that nothing is acked. The packets sent by the client are grouped in bursts:
+ * the first is the flight sent on the write, each of the others is sent by a
+ * probe timeout. The test checks the deadline and the backoff of the probe
+ * timeouts, the probes they send and the recovery once the link is back.
+ */
+class QuicProbeTimeoutTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param size the number of bytes written by the client
+   * \param probes the number of probes sent on each probe timeout
+   */
+  QuicProbeTimeoutTestCase (uint32_t size, uint32_t probes);
+
+private:
+  virtual void
+  DoRun (void);
+  virtual void
+  DoTeardown (void);
+
+  /**
+   * \brief Record a packet sent by the client
+   * \param packet the packet
+   * \param header the QUIC header
+   * \param socket the client socket
+   */
+  void
+  Tx (const Ptr<const Packet> packet, const QuicHeader& header,
+      const Ptr<const QuicSocketBase> socket);
+  /**
+   * \brief Check that a probe timeout without data to probe with leaves the timer disarmed
+   */
+  void
+  TestNoProbeData ();
+  /**
+   * \brief Black out the link and write on the socket
+   */
+  void
+  Write ();
+  /**
+   * \brief Check the probe timeouts during the blackout
+   */
+  void
+  TestBackoff ();
+  /**
+   * \brief Check that the connection recovers once the link is back
+   */
+  void
+  TestRecovery ();
+
+  uint32_t m_size;                  //!< Number of bytes written by the client
+  uint32_t m_probes;                //!< Number of probes sent on each probe timeout
+  QuicTestConnection *m_connection; //!< The connection under test
+  Ptr<QuicSocketBase> m_socket;     //!< The client socket
+  bool m_recording;                 //!< True while the packets of the client are recorded
+  std::vector<Time> m_burstStart;   //!< Time of the first packet of each burst
+  std::vector<Time> m_burstEnd;     //!< Time of the last packet of each burst
+  std::vector<uint32_t> m_burstSize;  //!< Number of packets of each burst
+};
+
+QuicProbeTimeoutTestCase::QuicProbeTimeoutTestCase (uint32_t size, uint32_t probes) :
+    TestCase ("QUIC probe timeout, " + std::to_string (size) + " bytes written during a blackout"),
+    m_size (size),
+    m_probes (probes),
+    m_connection (0),
+    m_recording (false)
+{
+}
+
+void
+QuicProbeTimeoutTestCase::DoRun ()
+{
+  QuicTestConnection connection ("10Mbps", MilliSeconds (10));
+  m_connection = &connection;
+  m_socket = connection.Connect (Seconds (0));
+  m_socket->TraceConnectWithoutContext ("Tx", MakeCallback (&QuicProbeTimeoutTestCase::Tx, this));
+
+  /*
+   * No data to probe with:
+   * -> a probe timeout on an idle connection sends nothing, and leaves the
+   *    timer disarmed
+   */
+  Simulator::Schedule (Seconds (1), &QuicProbeTimeoutTestCase::TestNoProbeData, this);
+
+  /*
+   * Blackout:
+   * -> each probe timeout expires a PTO after the last packet, with the PTO
+   *    doubled for each previous probe timeout
+   * -> each probe timeout sends the probes, with new data or, if there is
+   *    none, with the data of the oldest packet
+   */
+  Simulator::Schedule (Seconds (1), &QuicProbeTimeoutTestCase::Write, this);
+  Simulator::Schedule (Seconds (4), &QuicProbeTimeoutTestCase::TestBackoff, this);
+
+  /*
+   * Recovery:
+   * -> once the link is back, the next probe is acked, the backoff is reset
+   *    and all the data is delivered
+   */
+  Simulator::Schedule (Seconds (4), &QuicTestConnection::SetBlackout, &connection, false);
+  Simulator::Schedule (Seconds (15), &QuicProbeTimeoutTestCase::TestRecovery, this);
+  Simulator::Stop (Seconds (15));
+  Simulator::Run ();
+  m_connection = 0;
+}
+
+void
+QuicProbeTimeoutTestCase::Tx (const Ptr<const Packet> packet, const QuicHeader& header,
+                              const Ptr<const QuicSocketBase> socket)
+{
+  if (!m_recording)
+    {
+      return;
+    }
+  // the packets of a burst leave within the micro-delay that batches the writes
+  if (m_burstStart.empty () || Now () - m_burstEnd.back () > MilliSeconds (1))
+    {
+      m_burstStart.push_back (Now ());
+      m_burstEnd.push_back (Now ());
+      m_burstSize.push_back (0);
+    }
+  m_burstEnd.back () = Now ();
+  m_burstSize.back ()++;
+}
+
+void
+QuicProbeTimeoutTestCase::TestNoProbeData ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_socket->GetSocketState (), QuicSocket::OPEN, "Connection not open");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_timers->IsRunning (QuicSocketBase::LOSS_DETECTION_TIMER),
+                         false, "Loss detection timer armed without packets in flight");
+
+  m_recording = true;
+  m_socket->m_tcb->m_alarmType = 2;
+  m_socket->ReTxTimeout ();
+  m_recording = false;
+  NS_TEST_ASSERT_MSG_EQ (m_burstStart.size (), 0, "Probe sent without data");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_tcb->m_ptoCount, 0, "Probe timeout counted without probes");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_timers->IsRunning (QuicSocketBase::LOSS_DETECTION_TIMER),
+                         false, "Loss detection timer armed without data to probe with");
+}
+
+void
+QuicProbeTimeoutTestCase::Write ()
+{
+  m_connection->SetBlackout (true);
+  m_recording = true;
+  int sent = m_socket->Send (Create<Packet> (m_size));
+  NS_TEST_ASSERT_MSG_EQ (sent, (int) m_size, "Write failed");
+}
+
+void
+QuicProbeTimeoutTestCase::TestBackoff ()
+{
+  m_recording = false;
+  Time pto = m_socket->m_tcb->GetProbeTimeout ();
+  uint32_t timeouts = m_burstStart.size () - 1;
+  NS_TEST_ASSERT_MSG_GT (timeouts, 2, "Too few probe timeouts in the blackout");
+  for (uint32_t i = 1; i < m_burstStart.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_burstStart[i], m_burstEnd[i - 1] + pto * (1 << (i - 1)),
+                             "Probe timeout " << i << " does not expire at the backed off deadline");
+      NS_TEST_ASSERT_MSG_EQ (m_burstSize[i], m_probes,
+                             "Probe timeout " << i << " sends the wrong number of probes");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_tcb->m_ptoCount, timeouts, "Probe timeouts not counted");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->GetProbeTimeoutBackoff (), (1u << timeouts), "Wrong backoff");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_timers->GetDeadline (QuicSocketBase::LOSS_DETECTION_TIMER),
+                         m_burstEnd.back () + pto * (1 << timeouts),
+                         "The next probe timeout is not backed off");
+}
+
+void
+QuicProbeTimeoutTestCase::TestRecovery ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_tcb->m_ptoCount, 0, "Backoff not reset by the ACK");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_txBuffer->BytesInFlight (), 0, "Data still in flight");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_txBuffer->AppSize (), 0, "Data still to send");
+  NS_TEST_ASSERT_MSG_EQ (m_connection->GetTotalRx (), m_size, "Data not delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_timers->IsRunning (QuicSocketBase::LOSS_DETECTION_TIMER),
+                         false, "Loss detection timer armed after the recovery");
+}
+
+void
+QuicProbeTimeoutTestCase::DoTeardown ()
+{
+  m_socket = 0;
+  Simulator::Destroy ();
+}
+
+} // namespace ns3
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QUIC probe timeout test cases
+ */
+class QuicProbeTimeoutTestSuite : public TestSuite
+{
+public:
+  QuicProbeTimeoutTestSuite () :
+      TestSuite ("quic-probe-timeout", UNIT)
+  {
+    // a single packet: the probe sends its data again
+    AddTestCase (new QuicProbeTimeoutTestCase (1000, 1), TestCase::QUICK);
+    // more data than the window: the probes send new data
+    AddTestCase (new QuicProbeTimeoutTestCase (50000, 2), TestCase::QUICK);
+  }
+};
+
+static QuicProbeTimeoutTestSuite g_quicProbeTimeoutTestSuite; //!< Static variable for test initialization
@@ -70,6 +70,11 @@ private:
    */
   void
   TestStreamExtract ();
+  /**
+   * \brief Test the handling of overlapping frames in the Stream RX buffer
+   */
+  void
+  TestStreamOverlap ();
 };
 
 QuicRxBufferTestCase::QuicRxBufferTestCase () :
@@ -115,6 +120,18 @@ QuicRxBufferTestCase::DoRun ()
    * -> check correctness of buffer application size and available size
    */
   TestStreamExtract ();
+
+  /*
+   * Test the handling of overlapping frames in the Stream RX buffer:
+   * -> add 2 non-contiguous packets
+   * -> add a packet that overlaps with both and fills the hole between them
+   * -> add a packet that is already entirely in the buffer
+   * -> discard the data already delivered to the application
+   * -> trim or drop new packets below the delivered offset
+   * -> tell duplicates apart from overflows when the buffer is full
+   * -> check correctness of buffer size and deliverable data
+   */
+  TestStreamOverlap ();
 }
 
 void
@@ -218,10 +235,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
   sub.SetOffset(0);
 
   // add a packet
-  bool pos = rxBuf.Add (p, sub);
+  QuicStreamRxBuffer::AddResult_t res = rxBuf.Add (p, sub, 0);
   std::pair<uint64_t, uint64_t> deliverable = rxBuf.GetDeliverable (0);
 
-  NS_TEST_ASSERT_MSG_EQ(pos, true, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 16800, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 1200, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 0, "Wrong deliverable offset value");
@@ -229,10 +246,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
                         "Wrong deliverable packet size");
 
   // duplicate packet
-  bool neg = rxBuf.Add (p, sub);
+  res = rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
 
-  NS_TEST_ASSERT_MSG_EQ(neg, false, "Added duplicate packet");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::DUPLICATE, "Added duplicate packet");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 16800, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 1200, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 0, "Wrong deliverable offset value");
@@ -241,10 +258,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
 
   // add a second packet
   sub.SetOffset (1200);
-  pos = rxBuf.Add (p, sub);
+  res = rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
   
-  NS_TEST_ASSERT_MSG_EQ(pos, true, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 15600, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 2400, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 1200,
@@ -254,10 +271,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
 
   // insert out of order packet
   sub.SetOffset (3600);
-  pos = rxBuf.Add (p, sub);
+  res = rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
 
-  NS_TEST_ASSERT_MSG_EQ(pos, true, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 14400, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 3600, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 1200,
@@ -267,10 +284,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
 
   // insert missing packet
   sub.SetOffset (2400);
-  pos = rxBuf.Add (p, sub);
+  res = rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
 
-  NS_TEST_ASSERT_MSG_EQ(pos, true, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 13200, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 4800, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 3600,
@@ -281,10 +298,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
   // test full buffer
   sub.SetOffset (4800);
   Ptr<Packet> p1 = Create<Packet> (13200);
-  pos = rxBuf.Add (p1, sub);
+  res = rxBuf.Add (p1, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
 
-  NS_TEST_ASSERT_MSG_EQ(pos, true, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 0, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 18000, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 4800,
@@ -294,10 +311,10 @@ QuicRxBufferTestCase::TestStreamAdd ()
 
   // test buffer overflow
   sub.SetOffset (18000);
-  neg = rxBuf.Add (p, sub);
+  res = rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
 
-  NS_TEST_ASSERT_MSG_EQ(neg, false, "Buffer overflow");
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::NO_ROOM, "Buffer overflow");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Available (), 0, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 18000, "Wrong buffer size");
   NS_TEST_ASSERT_MSG_EQ(deliverable.first, 4800,
@@ -320,17 +337,17 @@ QuicRxBufferTestCase::TestStreamExtract ()
   sub.SetOffset (0);
 
   // add a packet
-  rxBuf.Add (p, sub);
+  rxBuf.Add (p, sub, 0);
   std::pair<uint64_t, uint64_t> deliverable = rxBuf.GetDeliverable (0);
 
   // add a second packet
   sub.SetOffset (1200);
-  rxBuf.Add (p, sub);
+  rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
 
   // insert a third packet
   sub.SetOffset (2400);
-  rxBuf.Add (p, sub);
+  rxBuf.Add (p, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
   
   // extract first two packets
@@ -343,7 +360,7 @@ QuicRxBufferTestCase::TestStreamExtract ()
   
   // insert missing packet
   sub.SetOffset (0);
-  rxBuf.Add (outPkt, sub);
+  rxBuf.Add (outPkt, sub, 0);
   deliverable = rxBuf.GetDeliverable (0);
   
   // extract all packets
@@ -361,6 +378,74 @@ QuicRxBufferTestCase::TestStreamExtract ()
   NS_TEST_ASSERT_MSG_EQ(rxBuf.Size (), 0, "Wrong buffer size");
 }
 
+void
+QuicRxBufferTestCase::TestStreamOverlap ()
+{
+  // create the buffer
+  QuicStreamRxBuffer rxBuf;
+  rxBuf.SetMaxBufferSize (18000);
+
+  // add packets at offsets 1200 and 3600
+  Ptr<Packet> p = Create<Packet> (1200);
+  QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (1, 1200, p->GetSize (), true,
+                                                            true, false);
+  QuicStreamRxBuffer::AddResult_t res = rxBuf.Add (p, sub, 0);
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
+  sub.SetOffset (3600);
+  res = rxBuf.Add (p, sub, 0);
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 2400, "Wrong buffer size");
+
+  // add a retransmission that covers [1800, 4200): only the hole is new data
+  Ptr<Packet> p1 = Create<Packet> (2400);
+  sub.SetOffset (1800);
+  res = rxBuf.Add (p1, sub, 0);
+  std::pair<uint64_t, uint64_t> deliverable = rxBuf.GetDeliverable (1200);
+
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 3600, "Overlapping bytes counted twice");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 14400, "Wrong available data size");
+  NS_TEST_ASSERT_MSG_EQ (deliverable.first, 3600, "Wrong deliverable offset value");
+  NS_TEST_ASSERT_MSG_EQ (deliverable.second, 3600, "Wrong deliverable packet size");
+
+  // add data that is already in the buffer
+  sub.SetOffset (2000);
+  res = rxBuf.Add (p, sub, 0);
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::DUPLICATE, "Added duplicate data");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 3600, "Wrong buffer size");
+
+  // the first 1000 bytes of the block have already been delivered
+  deliverable = rxBuf.GetDeliverable (2200);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 2600, "Delivered data not discarded");
+  NS_TEST_ASSERT_MSG_EQ (deliverable.second, 2600, "Wrong deliverable packet size");
+
+  Ptr<Packet> outPkt = rxBuf.Extract (deliverable.second);
+  NS_TEST_ASSERT_MSG_NE (outPkt, 0, "Failed to extract packets");
+  NS_TEST_ASSERT_MSG_EQ (outPkt->GetSize (), 2600, "Wrong packet size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Wrong buffer size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 18000, "Wrong available data size");
+
+  // the data up to 4800 has been delivered: only the tail of [4200, 5400) is new
+  sub.SetOffset (4200);
+  res = rxBuf.Add (p, sub, 4800);
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::ADDED, "Failed to add packet");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 600, "Delivered data counted as new");
+  deliverable = rxBuf.GetDeliverable (4800);
+  NS_TEST_ASSERT_MSG_EQ (deliverable.second, 600, "Wrong deliverable packet size");
+
+  // data entirely below the delivered offset is a duplicate
+  sub.SetOffset (3600);
+  res = rxBuf.Add (p, sub, 4800);
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::DUPLICATE, "Added delivered data");
+
+  // a duplicate is not mistaken for an overflow when the buffer is full
+  rxBuf.SetMaxBufferSize (600);
+  sub.SetOffset (4200);
+  res = rxBuf.Add (p, sub, 4800);
+  NS_TEST_ASSERT_MSG_EQ (res, QuicStreamRxBuffer::DUPLICATE, "Duplicate reported as overflow");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 600, "Wrong buffer size");
+}
+
 void
 QuicRxBufferTestCase::DoTeardown ()
 {
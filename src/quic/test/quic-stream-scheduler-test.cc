@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/quic-stream-base.h"
+#include "ns3/quic-stream-scheduler.h"
+
+#include <algorithm>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicStreamSchedulerTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicStreamScheduler Test
+ *
+ * The streams are backlogged with data that flow control allows to send; the
+ * test checks the order in which each scheduler selects them.
+ */
+class QuicStreamSchedulerTestCase : public TestCase
+{
+public:
+  QuicStreamSchedulerTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+
+  /**
+   * \brief Create a sender stream with data in its TX buffer
+   * \param streamId the stream ID
+   * \param bytes the amount of buffered data
+   * \return the stream
+   */
+  Ptr<QuicStreamBase>
+  CreateStream (uint64_t streamId, uint32_t bytes);
+  /**
+   * \brief Select streams, accounting a frame for each of them
+   * \param scheduler the scheduler
+   * \param frames the number of frames
+   * \param frameSize the size of each frame
+   * \return the IDs of the selected streams
+   */
+  std::vector<uint64_t>
+  Select (Ptr<QuicStreamScheduler> scheduler, uint32_t frames, uint32_t frameSize);
+  /**
+   * \brief Test the round-robin scheduler
+   */
+  void
+  TestRoundRobin ();
+  /**
+   * \brief Test the weighted fair scheduler
+   */
+  void
+  TestWeightedFair ();
+  /**
+   * \brief Test the strict priority scheduler
+   */
+  void
+  TestPriority ();
+  /**
+   * \brief Test the earliest deadline first scheduler
+   */
+  void
+  TestEdf ();
+  /**
+   * \brief Write data on a stream
+   * \param stream the stream
+   */
+  void
+  Write (Ptr<QuicStreamBase> stream);
+  /**
+   * \brief Check the stream selected by the EDF scheduler
+   * \param expected the expected stream ID
+   */
+  void
+  CheckEdf (uint64_t expected);
+
+  Ptr<QuicStreamScheduler> m_edf;   //!< The EDF scheduler under test
+};
+
+QuicStreamSchedulerTestCase::QuicStreamSchedulerTestCase () :
+    TestCase ("QuicStreamScheduler Test")
+{
+}
+
+void
+QuicStreamSchedulerTestCase::DoRun ()
+{
+  /*
+   * Round-robin:
+   * -> streams with data send one frame each in turn
+   * -> streams without data are skipped
+   */
+  TestRoundRobin ();
+
+  /*
+   * Weighted fair:
+   * -> streams send in proportion to their weights
+   * -> a stream that was idle does not get a burst when it has data again
+   */
+  TestWeightedFair ();
+
+  /*
+   * Strict priority:
+   * -> the stream with the lowest priority value is always served first
+   * -> streams with the same priority are served in round-robin
+   */
+  TestPriority ();
+
+  /*
+   * Earliest deadline first:
+   * -> the stream whose oldest data expires first is served
+   * -> streams without deadline are served last
+   */
+  TestEdf ();
+}
+
+Ptr<QuicStreamBase>
+QuicStreamSchedulerTestCase::CreateStream (uint64_t streamId, uint32_t bytes)
+{
+  Ptr<QuicStreamBase> stream = CreateObject<QuicStreamBase> ();
+  stream->SetStreamId (streamId);
+  stream->SetStreamDirectionType (QuicStream::SENDER);
+  stream->SetMaxStreamData (1 << 20);
+  if (bytes > 0)
+    {
+      stream->AppendingTx (Create<Packet> (bytes));
+    }
+  return stream;
+}
+
+std::vector<uint64_t>
+QuicStreamSchedulerTestCase::Select (Ptr<QuicStreamScheduler> scheduler, uint32_t frames,
+                                     uint32_t frameSize)
+{
+  std::vector<uint64_t> selected;
+  for (uint32_t i = 0; i < frames; i++)
+    {
+      Ptr<QuicStreamBase> stream = scheduler->SelectStream ();
+      if (stream == 0)
+        {
+          break;
+        }
+      scheduler->OnFrameSent (stream, frameSize);
+      selected.push_back (stream->GetStreamId ());
+    }
+  return selected;
+}
+
+void
+QuicStreamSchedulerTestCase::TestRoundRobin ()
+{
+  Ptr<QuicStreamScheduler> scheduler = CreateObject<QuicStreamRoundRobinScheduler> ();
+  scheduler->AddStream (CreateStream (2, 10000));
+  scheduler->AddStream (CreateStream (1, 10000));
+  scheduler->AddStream (CreateStream (3, 0));
+
+  std::vector<uint64_t> selected = Select (scheduler, 4, 1000);
+  uint64_t expected[] = {1, 2, 1, 2};
+  NS_TEST_ASSERT_MSG_EQ (selected.size (), 4, "The scheduler did not select a stream");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (selected[i], expected[i], "Wrong round-robin order at frame " << i);
+    }
+
+  Ptr<QuicStreamScheduler> empty = CreateObject<QuicStreamRoundRobinScheduler> ();
+  empty->AddStream (CreateStream (1, 0));
+  NS_TEST_ASSERT_MSG_EQ (empty->SelectStream (), 0, "Selected a stream without data");
+}
+
+void
+QuicStreamSchedulerTestCase::TestWeightedFair ()
+{
+  Ptr<QuicStreamScheduler> scheduler = CreateObject<QuicStreamWeightedFairScheduler> ();
+  Ptr<QuicStreamBase> light = CreateStream (1, 100000);
+  Ptr<QuicStreamBase> heavy = CreateStream (2, 100000);
+  heavy->SetWeight (3);
+  scheduler->AddStream (light);
+  scheduler->AddStream (heavy);
+
+  std::vector<uint64_t> selected = Select (scheduler, 8, 1000);
+  NS_TEST_ASSERT_MSG_EQ (std::count (selected.begin (), selected.end (), 2), 6,
+                         "The stream with weight 3 did not get 3/4 of the frames");
+
+  // a stream that was not backlogged starts from the current virtual time
+  scheduler->AddStream (CreateStream (3, 100000));
+  selected = Select (scheduler, 2, 1000);
+  NS_TEST_ASSERT_MSG_EQ (selected.front (), 3, "The new stream is not served first");
+  NS_TEST_ASSERT_MSG_NE (selected.back (), 3, "The new stream got a burst of frames");
+}
+
+void
+QuicStreamSchedulerTestCase::TestPriority ()
+{
+  Ptr<QuicStreamScheduler> scheduler = CreateObject<QuicStreamPriorityScheduler> ();
+  Ptr<QuicStreamBase> urgent = CreateStream (2, 10000);
+  urgent->SetPriority (0);
+  scheduler->AddStream (CreateStream (1, 10000));
+  scheduler->AddStream (urgent);
+  scheduler->AddStream (CreateStream (3, 10000));
+
+  std::vector<uint64_t> selected = Select (scheduler, 3, 1000);
+  NS_TEST_ASSERT_MSG_EQ (std::count (selected.begin (), selected.end (), 2), 3,
+                         "The urgent stream was not always served first");
+
+  Ptr<QuicStreamScheduler> idle = CreateObject<QuicStreamPriorityScheduler> ();
+  Ptr<QuicStreamBase> urgentIdle = CreateStream (2, 0);
+  urgentIdle->SetPriority (0);
+  idle->AddStream (CreateStream (1, 10000));
+  idle->AddStream (urgentIdle);
+  idle->AddStream (CreateStream (3, 10000));
+
+  selected = Select (idle, 4, 1000);
+  uint64_t expected[] = {1, 3, 1, 3};
+  NS_TEST_ASSERT_MSG_EQ (selected.size (), 4, "The scheduler did not select a stream");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (selected[i], expected[i], "Wrong order at frame " << i);
+    }
+}
+
+void
+QuicStreamSchedulerTestCase::TestEdf ()
+{
+  m_edf = CreateObject<QuicStreamEdfScheduler> ();
+  Ptr<QuicStreamBase> slow = CreateStream (1, 0);
+  slow->SetDeadline (MilliSeconds (50));
+  Ptr<QuicStreamBase> fast = CreateStream (2, 0);
+  fast->SetDeadline (MilliSeconds (10));
+  Ptr<QuicStreamBase> bulk = CreateStream (3, 0);
+  m_edf->AddStream (slow);
+  m_edf->AddStream (fast);
+  m_edf->AddStream (bulk);
+
+  // stream 3 has no deadline, the data of stream 1 expires at 52 ms, the one of stream 2 at 30 ms
+  Simulator::Schedule (MilliSeconds (0), &QuicStreamSchedulerTestCase::Write, this, bulk);
+  Simulator::Schedule (MilliSeconds (1), &QuicStreamSchedulerTestCase::CheckEdf, this, 3);
+  Simulator::Schedule (MilliSeconds (2), &QuicStreamSchedulerTestCase::Write, this, slow);
+  Simulator::Schedule (MilliSeconds (5), &QuicStreamSchedulerTestCase::CheckEdf, this, 1);
+  Simulator::Schedule (MilliSeconds (20), &QuicStreamSchedulerTestCase::Write, this, fast);
+  Simulator::Schedule (MilliSeconds (25), &QuicStreamSchedulerTestCase::CheckEdf, this, 2);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_edf = 0;
+}
+
+void
+QuicStreamSchedulerTestCase::Write (Ptr<QuicStreamBase> stream)
+{
+  stream->AppendingTx (Create<Packet> (10000));
+}
+
+void
+QuicStreamSchedulerTestCase::CheckEdf (uint64_t expected)
+{
+  Ptr<QuicStreamBase> stream = m_edf->SelectStream ();
+  NS_TEST_ASSERT_MSG_NE (stream, 0, "No stream selected");
+  NS_TEST_ASSERT_MSG_EQ (stream->GetStreamId (), expected,
+                         "Wrong stream selected at " << Simulator::Now ().GetSeconds ());
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicStreamScheduler test case
+ */
+class QuicStreamSchedulerTestSuite : public TestSuite
+{
+public:
+  QuicStreamSchedulerTestSuite () :
+      TestSuite ("quic-stream-scheduler", UNIT)
+  {
+    AddTestCase (new QuicStreamSchedulerTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicStreamSchedulerTestSuite g_quicStreamSchedulerTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "quic-test-connection.h"
+
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/quic-helper.h"
+#include "ns3/quic-socket-factory.h"
+
+namespace ns3 {
+
+static const uint16_t g_quicTestPort = 50000;  //!< Port of the sink
+
+QuicTestConnection::QuicTestConnection (std::string rate, Time delay)
+  : m_client (0)
+{
+  m_nodes.Create (2);
+
+  m_errorModel = CreateObject<RateErrorModel> ();
+  m_errorModel->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+  m_errorModel->SetRate (1.0);
+  m_errorModel->Disable ();
+
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue (rate));
+  link.SetChannelAttribute ("Delay", TimeValue (delay));
+  link.SetDeviceAttribute ("ReceiveErrorModel", PointerValue (m_errorModel));
+  m_devices = link.Install (m_nodes);
+
+  QuicHelper stack;
+  stack.InstallQuic (m_nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  m_interfaces = address.Assign (m_devices);
+
+  PacketSinkHelper sink ("ns3::QuicSocketFactory",
+                         InetSocketAddress (Ipv4Address::GetAny (), g_quicTestPort));
+  ApplicationContainer apps = sink.Install (m_nodes.Get (1));
+  apps.Start (Seconds (0));
+  m_sink = DynamicCast<PacketSink> (apps.Get (0));
+}
+
+Ptr<QuicSocketBase>
+QuicTestConnection::Connect (Time start)
+{
+  m_client = DynamicCast<QuicSocketBase> (
+      Socket::CreateSocket (m_nodes.Get (0), QuicSocketFactory::GetTypeId ()));
+  Simulator::Schedule (start, &QuicTestConnection::DoConnect, this);
+  return m_client;
+}
+
+void
+QuicTestConnection::DoConnect ()
+{
+  m_client->Bind ();
+  m_client->Connect (InetSocketAddress (m_interfaces.GetAddress (1), g_quicTestPort));
+}
+
+void
+QuicTestConnection::SetBlackout (bool blackout)
+{
+  if (blackout)
+    {
+      m_errorModel->Enable ();
+    }
+  else
+    {
+      m_errorModel->Disable ();
+    }
+}
+
+Ptr<QuicSocketBase>
+QuicTestConnection::GetClient () const
+{
+  return m_client;
+}
+
+uint64_t
+QuicTestConnection::GetTotalRx () const
+{
+  return m_sink->GetTotalRx ();
+}
+
+} // namespace ns3
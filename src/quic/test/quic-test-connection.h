@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef QUIC_TEST_CONNECTION_H
+#define QUIC_TEST_CONNECTION_H
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/error-model.h"
+#include "ns3/packet-sink.h"
+#include "ns3/quic-socket-base.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup quic
+ * \ingroup tests
+ *
+ * \brief A QUIC connection between two nodes over a point-to-point link
+ *
+ * The client socket connects to a packet sink on the server node. The tests
+ * write on the client socket and run the simulation themselves, and can
+ * black out the link to drop every packet in both directions.
+ */
+class QuicTestConnection
+{
+public:
+  /**
+   * \brief Create the nodes and the link, and install QUIC on them
+   * \param rate the data rate of the link
+   * \param delay the propagation delay of the link
+   */
+  QuicTestConnection (std::string rate, Time delay);
+
+  /**
+   * \brief Create the client socket and connect it to the sink
+   * \param start the time of the connection
+   * \return the client socket
+   */
+  Ptr<QuicSocketBase> Connect (Time start);
+
+  /**
+   * \brief Drop or deliver all the packets on the link
+   * \param blackout true to drop the packets
+   */
+  void SetBlackout (bool blackout);
+
+  /**
+   * \brief Get the client socket
+   * \return the client socket, or 0 before Connect
+   */
+  Ptr<QuicSocketBase> GetClient () const;
+
+  /**
+   * \brief Get the data received by the sink
+   * \return the number of bytes received by the sink
+   */
+  uint64_t GetTotalRx () const;
+
+private:
+  /**
+   * \brief Connect the client socket
+   */
+  void DoConnect ();
+
+  NodeContainer m_nodes;                  //!< The client and the server
+  NetDeviceContainer m_devices;           //!< The devices of the link
+  Ipv4InterfaceContainer m_interfaces;    //!< The addresses of the nodes
+  Ptr<RateErrorModel> m_errorModel;       //!< Drops the packets during a blackout
+  Ptr<QuicSocketBase> m_client;           //!< The client socket
+  Ptr<PacketSink> m_sink;                 //!< The sink on the server
+};
+
+} // namespace ns3
+
+#endif /* QUIC_TEST_CONNECTION_H */
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 SIGNET Lab, Department of Information Engineering, University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/quic-timer-multiplexer.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QuicTimerMultiplexerTestSuite");
+
+/**
+ * \ingroup internet-tests
+ * \ingroup tests
+ *
+ * \brief The QuicTimerMultiplexer Test
+ *
+ * Three timers are armed, moved and cancelled; the test checks the time and
+ * the order in which their handlers run.
+ */
+class QuicTimerMultiplexerTestCase : public TestCase
+{
+public:
+  QuicTimerMultiplexerTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+
+  /**
+   * \brief Record the expiration of a timer
+   * \param timer the timer ID
+   */
+  void
+  Expired (uint32_t timer);
+  /**
+   * \brief Expiration of timer 1
+   */
+  void
+  ExpiredOne ();
+  /**
+   * \brief Expiration of timer 2
+   */
+  void
+  ExpiredTwo ();
+  /**
+   * \brief Expiration of timer 0, which arms timer 1 again
+   */
+  void
+  ExpiredAndRearm ();
+  /**
+   * \brief Check the recorded expirations
+   * \param timers the expected timer IDs, in order
+   * \param times the expected expiration times in milliseconds
+   * \param count the number of expected expirations
+   */
+  void
+  Check (const uint32_t *timers, const int64_t *times, uint32_t count);
+
+  Ptr<QuicTimerMultiplexer> m_timers;     //!< The multiplexer under test
+  std::vector<uint32_t> m_expiredTimers;  //!< The timers that expired, in order
+  std::vector<int64_t> m_expiredTimes;    //!< The expiration times in milliseconds
+  bool m_rearm;                           //!< True if timer 0 arms timer 1 when it expires
+};
+
+QuicTimerMultiplexerTestCase::QuicTimerMultiplexerTestCase () :
+    TestCase ("QuicTimerMultiplexer Test"),
+    m_rearm (false)
+{
+}
+
+void
+QuicTimerMultiplexerTestCase::DoRun ()
+{
+  m_timers = CreateObject<QuicTimerMultiplexer> ();
+  m_timers->AddTimer (MakeCallback (&QuicTimerMultiplexerTestCase::ExpiredAndRearm, this));
+  m_timers->AddTimer (MakeCallback (&QuicTimerMultiplexerTestCase::ExpiredOne, this));
+  m_timers->AddTimer (MakeCallback (&QuicTimerMultiplexerTestCase::ExpiredTwo, this));
+
+  /*
+   * Deadline order:
+   * -> the timers expire in deadline order, not in arming order
+   * -> timers with the same deadline expire in ID order
+   */
+  m_timers->Schedule (2, MilliSeconds (30));
+  m_timers->Schedule (1, MilliSeconds (10));
+  m_timers->Schedule (0, MilliSeconds (30));
+  NS_TEST_ASSERT_MSG_EQ (m_timers->IsRunning (1), true, "Timer 1 not armed");
+  NS_TEST_ASSERT_MSG_EQ (m_timers->GetDeadline (1), MilliSeconds (10), "Wrong deadline");
+  Simulator::Run ();
+  uint32_t orderTimers[] = {1, 0, 2};
+  int64_t orderTimes[] = {10, 30, 30};
+  Check (orderTimers, orderTimes, 3);
+  NS_TEST_ASSERT_MSG_EQ (m_timers->IsRunning (1), false, "Timer 1 still armed after expiring");
+
+  /*
+   * Cancel and re-arm:
+   * -> a cancelled timer does not expire
+   * -> a timer moved later expires at the new deadline only
+   * -> a timer moved earlier than the pending event expires at the new deadline
+   */
+  m_timers->Schedule (0, MilliSeconds (10));
+  m_timers->Schedule (1, MilliSeconds (20));
+  m_timers->Schedule (2, MilliSeconds (30));
+  m_timers->Cancel (0);
+  m_timers->Schedule (1, MilliSeconds (50));
+  m_timers->Schedule (2, MilliSeconds (5));
+  NS_TEST_ASSERT_MSG_EQ (m_timers->IsRunning (0), false, "Timer 0 still armed after cancel");
+  Simulator::Run ();
+  uint32_t rearmTimers[] = {2, 1};
+  int64_t rearmTimes[] = {35, 80};
+  Check (rearmTimers, rearmTimes, 2);
+
+  /*
+   * Dispatch:
+   * -> a handler can arm a timer, which expires at its own deadline
+   * -> CancelAll disarms all the timers
+   */
+  m_rearm = true;
+  m_timers->Schedule (0, MilliSeconds (10));
+  Simulator::Run ();
+  uint32_t dispatchTimers[] = {0, 1};
+  int64_t dispatchTimes[] = {90, 95};
+  Check (dispatchTimers, dispatchTimes, 2);
+
+  m_rearm = false;
+  m_timers->Schedule (0, MilliSeconds (10));
+  m_timers->Schedule (2, MilliSeconds (20));
+  m_timers->CancelAll ();
+  Simulator::Run ();
+  Check (0, 0, 0);
+
+  /*
+   * Destruction:
+   * -> the timers of a released multiplexer do not expire
+   */
+  m_timers->Schedule (0, MilliSeconds (10));
+  m_timers = 0;
+  Simulator::Run ();
+  Check (0, 0, 0);
+
+  Simulator::Destroy ();
+}
+
+void
+QuicTimerMultiplexerTestCase::Expired (uint32_t timer)
+{
+  m_expiredTimers.push_back (timer);
+  m_expiredTimes.push_back (Simulator::Now ().GetMilliSeconds ());
+}
+
+void
+QuicTimerMultiplexerTestCase::ExpiredOne ()
+{
+  Expired (1);
+}
+
+void
+QuicTimerMultiplexerTestCase::ExpiredTwo ()
+{
+  Expired (2);
+}
+
+void
+QuicTimerMultiplexerTestCase::ExpiredAndRearm ()
+{
+  Expired (0);
+  if (m_rearm)
+    {
+      m_timers->Schedule (1, MilliSeconds (5));
+    }
+}
+
+void
+QuicTimerMultiplexerTestCase::Check (const uint32_t *timers, const int64_t *times, uint32_t count)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTimers.size (), count, "Wrong number of expirations");
+  for (uint32_t i = 0; i < count && i < m_expiredTimers.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_expiredTimers[i], timers[i], "Wrong timer at expiration " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_expiredTimes[i], times[i], "Wrong time at expiration " << i);
+    }
+  m_expiredTimers.clear ();
+  m_expiredTimes.clear ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief the TestSuite for the QuicTimerMultiplexer test case
+ */
+class QuicTimerMultiplexerTestSuite : public TestSuite
+{
+public:
+  QuicTimerMultiplexerTestSuite () :
+      TestSuite ("quic-timer-multiplexer", UNIT)
+  {
+    AddTestCase (new QuicTimerMultiplexerTestCase, TestCase::QUICK);
+  }
+};
+
+static QuicTimerMultiplexerTestSuite g_quicTimerMultiplexerTestSuite; //!< Static variable for test initialization
@@ -83,6 +83,21 @@ private:
   /** \brief Test the Socket TX buffer retransmission of lost packets */
   void
   TestRetransmission ();
+  /** \brief Test the Stream TX buffer retransmission of lost data ranges */
+  void
+  TestStreamLoss ();
+  /** \brief Test the split of a frame that does not fit in the packet */
+  void
+  TestSplitFrame ();
+  /** \brief Test the ACK block processing and loss detection with gaps in the packet numbers */
+  void
+  TestAckRanges ();
+  /** \brief Test the delivery rate samples generated by the ACKs */
+  void
+  TestRateSample ();
+  /** \brief Test ACK processing with packet numbers beyond 32 bits */
+  void
+  TestLargePacketNumbers ();
 };
 
 QuicTxBufferTestCase::QuicTxBufferTestCase () :
@@ -193,6 +208,51 @@ QuicTxBufferTestCase::DoRun ()
    * -> check correctness of acked and lost packets list
    */
   TestRetransmission ();
+
+  /*
+   * Test the Stream TX buffer retransmission of lost data ranges:
+   * -> send 3 frames, lose the first and the third, ack the second
+   * -> retransmit the lost data in blocks smaller and larger than the frames
+   * -> ack the first frame and check that the acked data is discarded
+   * -> lose acked data and check that it is not retransmitted
+   * -> lose two adjacent frames and retransmit them in a single block
+   */
+  TestStreamLoss ();
+
+  /*
+   * Test the split of a frame in the Socket TX buffer:
+   * -> add a small frame and a large one, at offsets that take 1 and 2 bytes
+   * -> fill packets of several sizes, splitting the large frame
+   * -> check that the packet is exactly as large as requested
+   * -> check the offset, length and subheader size of the part left in the buffer
+   */
+  TestSplitFrame ();
+
+  /*
+   * Test the ACK block processing and loss detection on the sent packets:
+   * -> send 8 packets with packet numbers 1-3 and 5-9 (4 is an ACK-only packet)
+   * -> ack packets 1-2 and 6-7
+   * -> check that only packet 3 is marked as lost (packet 5 is within the reordering threshold)
+   * -> ack packet 9 and check that packet 5 is marked as lost, but not packet 8
+   * -> check correctness of bytes in flight count
+   */
+  TestAckRanges ();
+
+  /*
+   * Test the delivery rate estimation:
+   * -> send 4 packets, ack 2 of them after 100 ms and check the rate sample
+   * -> mark the connection as application limited and send 1 more packet
+   * -> ack the remaining packets after 100 ms and check that the sample covers
+   *    the send and ACK phases and is flagged as application limited
+   */
+  TestRateSample ();
+
+  /*
+   * Test packet numbers beyond 32 bits:
+   * -> send 6 packets across the 2^32 boundary
+   * -> ack them leaving a hole and check the acked and lost packets
+   */
+  TestLargePacketNumbers ();
 }
 
 void
@@ -213,35 +273,34 @@ QuicTxBufferTestCase::TestRetransmission ()
   p1->AddHeader (sub);
   txBuf.Add (p1);
 
-  Ptr<Packet> ptx = txBuf.NextSequence (1200, SequenceNumber32 (1));
+  Ptr<Packet> ptx = txBuf.NextSequence (1200, SequenceNumber64 (1));
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1200, "TxBuf miscalculates size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200, "TxBuf miscalculates size of in flight segments");
 
   // ack the packet sent
-  std::vector<uint32_t> additionalAckBlocks;
-  std::vector<uint32_t> gaps;
-  uint32_t largestAcknowledged = 1;
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+  uint64_t largestAcknowledged = 1;
   additionalAckBlocks.push_back (0);
   gaps.push_back (0);
 
-  std::vector<QuicSocketTxItem*> acked = txBuf.OnAckUpdate (tcbd,
-                                                            largestAcknowledged,
-                                                            additionalAckBlocks,
-                                                            gaps);
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(acked.size (), 1, "Wrong acked packet vector size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packet->GetSize (), 1200, "TxBuf miscalculates size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packetNumber, SequenceNumber32 (1),
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_size, 1200, "TxBuf miscalculates size");
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packetNumber, SequenceNumber64 (1),
                         "TxBuf gets the wrong lost packet ID");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 0, "TxBuf miscalculates size of in flight segments");
 
   // send other two packets from socket tx buffer but mark them as lost on ack
-  Ptr<Packet> p2 = Create<Packet> (1196);
+  Ptr<Packet> p2 = Create<Packet> (1194);
   sub = QuicSubheader::CreateStreamSubHeader (1, 1200, p2->GetSize (), 
-                                          false, true, false);
+                                          true, true, false);
   p2->AddHeader (sub);
   txBuf.Add (p2);
 
-  ptx = txBuf.NextSequence (1200, SequenceNumber32 (2));
+  ptx = txBuf.NextSequence (1200, SequenceNumber64 (2));
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1200, "TxBuf miscalculates size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200, "TxBuf miscalculates size of in flight segments");
 
@@ -251,60 +310,169 @@ QuicTxBufferTestCase::TestRetransmission ()
   p3->AddHeader (sub);
   txBuf.Add (p3);
 
-  ptx = txBuf.NextSequence (1200, SequenceNumber32 (3));
+  ptx = txBuf.NextSequence (1200, SequenceNumber64 (3));
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1200, "TxBuf miscalculates size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 2400, "TxBuf miscalculates size of in flight segments");
 
-  acked = txBuf.OnAckUpdate (tcbd,
-                             largestAcknowledged,
-                             additionalAckBlocks,
-                             gaps);
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(acked.size (), 0, "Wrong acked packet vector size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 2400, "TxBuf miscalculates size of in flight segments");
 
   // retransmit the first of the two packets
   uint32_t newPackets = 1;
   txBuf.ResetSentList (newPackets);
-  std::vector<QuicSocketTxItem*> lostPackets = txBuf.DetectLostPackets ();
+  std::vector<QuicSocketTxItem*> lostPackets;
+  txBuf.DetectLostPackets (lostPackets);
   NS_TEST_ASSERT_MSG_EQ(lostPackets.size (), 1, "Wrong lost packet vector size");
-  NS_TEST_ASSERT_MSG_EQ(lostPackets.at (0)->m_packet->GetSize (), 1200, "TxBuf miscalculates size");
-  NS_TEST_ASSERT_MSG_EQ(lostPackets.at (0)->m_packetNumber, SequenceNumber32 (2),
+  NS_TEST_ASSERT_MSG_EQ(lostPackets.at (0)->m_size, 1200, "TxBuf miscalculates size");
+  NS_TEST_ASSERT_MSG_EQ(lostPackets.at (0)->m_packetNumber, SequenceNumber64 (2),
                         "TxBuf gets the wrong lost packet ID");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 2400, "TxBuf miscalculates size of in flight segments");
 
-  uint32_t toRetx = txBuf.Retransmission (SequenceNumber32(2));
-  NS_TEST_ASSERT_MSG_EQ(toRetx, 1200, "wrong number of lost bytes");
+  std::vector<QuicStreamFrameRange> lostFrames;
+  uint32_t toRetx = txBuf.Retransmission (lostFrames);
+  NS_TEST_ASSERT_MSG_EQ(toRetx, 0, "Stream data put back in the socket buffer");
+  NS_TEST_ASSERT_MSG_EQ(txBuf.AppSize (), 0, "Stream data put back in the socket buffer");
+  NS_TEST_ASSERT_MSG_EQ(lostFrames.size (), 1, "Wrong lost frame vector size");
+  NS_TEST_ASSERT_MSG_EQ(lostFrames.at (0).m_streamId, 1, "Wrong stream of the lost frame");
+  NS_TEST_ASSERT_MSG_EQ(lostFrames.at (0).m_offset, 1200, "Wrong offset of the lost frame");
+  NS_TEST_ASSERT_MSG_EQ(lostFrames.at (0).m_length, 1194, "Wrong length of the lost frame");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200, "TxBuf miscalculates size of in flight segments");
 
-  ptx = txBuf.NextSequence (toRetx, SequenceNumber32 (4));
+  // the stream sends the lost data again in a new frame
+  Ptr<Packet> p4 = Create<Packet> (1194);
+  sub = QuicSubheader::CreateStreamSubHeader (1, 1200, p4->GetSize (),
+                                          true, true, false);
+  p4->AddHeader (sub);
+  txBuf.Add (p4);
+
+  ptx = txBuf.NextSequence (1200, SequenceNumber64 (4));
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1200, "TxBuf miscalculates size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 2400, "TxBuf miscalculates size of in flight segments");
 
   // ack the previous packet but not the retransmitted one
   largestAcknowledged = 3;
-  acked = txBuf.OnAckUpdate (tcbd,
-                             largestAcknowledged,
-                             additionalAckBlocks,
-                             gaps);
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(acked.size (), 1, "Wrong acked packet vector size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packet->GetSize (), 1200, "TxBuf miscalculates size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packetNumber, SequenceNumber32 (3),
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_size, 1200, "TxBuf miscalculates size");
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packetNumber, SequenceNumber64 (3),
                         "TxBuf gets the wrong lost packet ID");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200, "TxBuf miscalculates size of in flight segments");
 
   // ack also the retransmitted packet
   largestAcknowledged = 4;
-  acked = txBuf.OnAckUpdate (tcbd,
-                             largestAcknowledged,
-                             additionalAckBlocks,
-                             gaps);
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(acked.size (), 1, "Wrong acked packet vector size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packet->GetSize (), 1200, "TxBuf miscalculates size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packetNumber, SequenceNumber32 (4),
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_size, 1200, "TxBuf miscalculates size");
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packetNumber, SequenceNumber64 (4),
                         "TxBuf gets the wrong lost packet ID");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 0, "TxBuf miscalculates size of in flight segments");
 }
 
+void
+QuicTxBufferTestCase::TestStreamLoss ()
+{
+  // create the buffer
+  QuicStreamTxBuffer txBuf;
+  txBuf.SetMaxBufferSize (18000);
+  txBuf.Add (Create<Packet> (3600));
+
+  // send 3 frames at offsets 0, 1200 and 2400
+  txBuf.NextSequence (1200, SequenceNumber64 (0));
+  txBuf.NextSequence (1200, SequenceNumber64 (1200));
+  txBuf.NextSequence (1200, SequenceNumber64 (2400));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 3600, "Wrong sent size");
+
+  // lose the first and the third frame, ack the second one
+  txBuf.OnFrameLost (0, 1200);
+  txBuf.OnFrameLost (2400, 1200);
+  txBuf.OnFrameAcked (1200, 1200);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostSize (), 2400, "Wrong lost size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 3600, "Data discarded before the first gap is acked");
+
+  // retransmit the lost data
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostOffset (), 0, "Wrong offset of the lost data");
+  Ptr<Packet> retx = txBuf.NextLostSequence (1000);
+  NS_TEST_ASSERT_MSG_EQ (retx->GetSize (), 1000, "Wrong retransmission size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostOffset (), 1000, "Wrong offset of the lost data");
+  retx = txBuf.NextLostSequence (2000);
+  NS_TEST_ASSERT_MSG_EQ (retx->GetSize (), 200, "Retransmission beyond the lost range");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostOffset (), 2400, "Wrong offset of the lost data");
+  retx = txBuf.NextLostSequence (2000);
+  NS_TEST_ASSERT_MSG_EQ (retx->GetSize (), 1200, "Wrong retransmission size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostSize (), 0, "Wrong lost size");
+
+  // the first frame is acked, the data up to the third frame is discarded
+  txBuf.OnFrameAcked (0, 1000);
+  txBuf.OnFrameAcked (1000, 200);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 1200, "Acked data not discarded");
+
+  // acked data is not retransmitted
+  txBuf.OnFrameLost (0, 1200);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostSize (), 0, "Acked data marked as lost");
+
+  // adjacent lost frames are retransmitted together
+  txBuf.Add (Create<Packet> (1200));
+  txBuf.NextSequence (1200, SequenceNumber64 (3600));
+  txBuf.OnFrameLost (2400, 1200);
+  txBuf.OnFrameLost (3600, 1200);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLostSize (), 2400, "Wrong lost size");
+  retx = txBuf.NextLostSequence (3000);
+  NS_TEST_ASSERT_MSG_EQ (retx->GetSize (), 2400, "Adjacent lost frames not merged");
+  txBuf.OnFrameAcked (2400, 2400);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 0, "Acked data not discarded");
+}
+
+void
+QuicTxBufferTestCase::TestSplitFrame ()
+{
+  uint32_t sizes[] = { 600, 1200, 1460 };
+  for (uint32_t numBytes : sizes)
+    {
+      // create the buffer, with a 400-byte frame at offset 0 and a 3000-byte one at offset 400
+      QuicSocketTxBuffer txBuf;
+      Ptr<Packet> p = Create<Packet> (400);
+      p->AddHeader (QuicSubheader::CreateStreamSubHeader (1, 0, 400, false, true, false));
+      txBuf.Add (p);
+      p = Create<Packet> (3000);
+      p->AddHeader (QuicSubheader::CreateStreamSubHeader (1, 400, 3000, true, true, true));
+      txBuf.Add (p);
+
+      QuicItemPool<QuicSocketTxItem>::Handle item = txBuf.GetNewSegment (numBytes);
+      NS_TEST_ASSERT_MSG_EQ (item->m_packet->GetSize (), numBytes,
+                             "The packet does not fill " << numBytes << " bytes");
+
+      // the first frame is sent whole, the second one up to the end of the packet
+      Ptr<Packet> sent = item->m_packet->Copy ();
+      QuicSubheader sub;
+      sent->RemoveHeader (sub);
+      sent->RemoveAtStart (sub.GetLength ());
+      sent->RemoveHeader (sub);
+      uint64_t sentLength = sub.GetLength ();
+      NS_TEST_ASSERT_MSG_EQ (sub.GetOffset (), 400, "Wrong offset of the first part");
+      NS_TEST_ASSERT_MSG_EQ (sent->GetSize (), sentLength, "Wrong length of the first part");
+      NS_TEST_ASSERT_MSG_EQ (sub.IsStreamFin (), false, "FIN bit on the first part");
+      NS_TEST_ASSERT_MSG_EQ (item->m_streamFrames.back ().m_offset, 400,
+                             "Wrong stream range of the first part");
+      NS_TEST_ASSERT_MSG_EQ (item->m_streamFrames.back ().m_length, sentLength,
+                             "Wrong stream range of the first part");
+
+      // the rest of the frame is left at the head of the buffer
+      uint64_t leftOffset = 400 + sentLength;
+      uint64_t leftLength = 3000 - sentLength;
+      uint32_t leftSubSize = QuicSubheader::GetStreamSubHeaderSize (1, leftOffset, leftLength, true, true);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.AppSize (), leftSubSize + leftLength, "Wrong buffer size");
+      Ptr<Packet> left = txBuf.NextSequence (4000, SequenceNumber64 (1));
+      NS_TEST_ASSERT_MSG_EQ (left->GetSize (), leftSubSize + leftLength, "Wrong size of the rest");
+      left->RemoveHeader (sub);
+      NS_TEST_ASSERT_MSG_EQ (sub.GetSerializedSize (), leftSubSize, "Wrong subheader size of the rest");
+      NS_TEST_ASSERT_MSG_EQ (sub.GetOffset (), leftOffset, "Wrong offset of the rest");
+      NS_TEST_ASSERT_MSG_EQ (sub.GetLength (), leftLength, "Wrong length of the rest");
+      NS_TEST_ASSERT_MSG_EQ (sub.IsStreamFin (), true, "FIN bit not on the rest");
+      NS_TEST_ASSERT_MSG_EQ (txBuf.AppSize (), 0, "Wrong buffer size");
+    }
+}
+
 void
 QuicTxBufferTestCase::TestRejection ()
 {
@@ -330,7 +498,7 @@ QuicTxBufferTestCase::TestRejection ()
   NS_TEST_ASSERT_MSG_EQ(streamTxBuf.AppSize (), 6000, "Wrong buffer size");
 
   // Extract first two packets
-  Ptr<Packet> outPkt = streamTxBuf.NextSequence(2400, SequenceNumber32(0));
+  Ptr<Packet> outPkt = streamTxBuf.NextSequence(2400, SequenceNumber64(0));
 
   NS_TEST_ASSERT_MSG_NE(outPkt, 0, "Failed to extract packets");
   NS_TEST_ASSERT_MSG_EQ(outPkt->GetSize(), 2400,  "Wrong packet size");
@@ -349,7 +517,7 @@ QuicTxBufferTestCase::TestRejection ()
   NS_TEST_ASSERT_MSG_EQ(socketTxBuf.AppSize (), outPkt->GetSize (), "Wrong buffer size");
 
   // Extract two packets more
-  Ptr<Packet> outPktMore = streamTxBuf.NextSequence(2400, SequenceNumber32(0));
+  Ptr<Packet> outPktMore = streamTxBuf.NextSequence(2400, SequenceNumber64(0));
 
   NS_TEST_ASSERT_MSG_NE(outPktMore, 0, "Failed to extract packets");
   NS_TEST_ASSERT_MSG_EQ(outPktMore->GetSize(), 2400,  "Wrong packet size");
@@ -446,7 +614,7 @@ QuicTxBufferTestCase::TestStreamExtract ()
   NS_TEST_ASSERT_MSG_EQ(txBuf.AppSize (), 3600, "Wrong buffer size");
 
   //Extract first two packets
-  Ptr<Packet> outPkt = txBuf.NextSequence(2400, SequenceNumber32(0));
+  Ptr<Packet> outPkt = txBuf.NextSequence(2400, SequenceNumber64(0));
 
   NS_TEST_ASSERT_MSG_EQ(pos, true, "Failed to add packet");
   NS_TEST_ASSERT_MSG_EQ(outPkt->GetSize(), 2400,  "Wrong packet size");
@@ -461,7 +629,7 @@ QuicTxBufferTestCase::TestStreamExtract ()
   NS_TEST_ASSERT_MSG_EQ(txBuf.AppSize (), 3600, "Wrong buffer size");
 
   //Extract all packets
-  outPkt = txBuf.NextSequence(3600, SequenceNumber32(1));
+  outPkt = txBuf.NextSequence(3600, SequenceNumber64(1));
 
   NS_TEST_ASSERT_MSG_NE(outPkt, 0, "Failed to extract packets");
   NS_TEST_ASSERT_MSG_EQ(outPkt->GetSize(), 3600,  "Wrong packet size");
@@ -469,7 +637,7 @@ QuicTxBufferTestCase::TestStreamExtract ()
   NS_TEST_ASSERT_MSG_EQ(txBuf.AppSize (), 0, "Wrong buffer size");
 
   // Test empty buffer
-  outPkt = txBuf.NextSequence(1200, SequenceNumber32(2));
+  outPkt = txBuf.NextSequence(1200, SequenceNumber64(2));
   NS_TEST_ASSERT_MSG_EQ(outPkt->GetSize(), 0,  "Wrong packet size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.Available (), 18000, "Wrong available data size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.AppSize (), 0, "Wrong buffer size");
@@ -495,23 +663,22 @@ QuicTxBufferTestCase::TestNewBlock ()
   p1->AddHeader (sub);
   txBuf.Add (p1);
 
-  Ptr<Packet> ptx = txBuf.NextSequence (1200, SequenceNumber32 (1));
+  Ptr<Packet> ptx = txBuf.NextSequence (1200, SequenceNumber64 (1));
 
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1200, "TxBuf miscalculates size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200,
                         "TxBuf miscalculates size of in flight segments");
 
-  std::vector<uint32_t> additionalAckBlocks;
-  std::vector<uint32_t> gaps;
-  uint32_t largestAcknowledged = 1;
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+  uint64_t largestAcknowledged = 1;
   additionalAckBlocks.push_back (1);
 
-  std::vector<QuicSocketTxItem*> acked = txBuf.OnAckUpdate (tcbd,
-                                                            largestAcknowledged,
-                                                            additionalAckBlocks,
-                                                            gaps);
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(acked.size (), 1, "Wrong acked packet vector size");
-  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_packet->GetSize (), 1200,
+  NS_TEST_ASSERT_MSG_EQ(acked.at (0)->m_size, 1200,
                         "TxBuf miscalculates size");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 0,
                         "TxBuf miscalculates size of in flight segments");
@@ -524,13 +691,13 @@ QuicTxBufferTestCase::TestNewBlock ()
   p2->AddHeader (sub);
   txBuf.Add (p2);
 
-  ptx = txBuf.NextSequence (1200, SequenceNumber32 (2));
+  ptx = txBuf.NextSequence (1200, SequenceNumber64 (2));
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1200,
                         "Returned packet has different size than requested");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200,
                         "TxBuf miscalculates size of in flight segments");
 
-  ptx = txBuf.NextSequence (3000, SequenceNumber32 (3));
+  ptx = txBuf.NextSequence (3000, SequenceNumber64 (3));
   // Expecting 3000 (added, including QuicSubheader 4) - 1200 (extracted, including QuicSubheader 4)
   // + 6 (QuicSubheader of the new packet, with both the length and the offset)
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 1806, 
@@ -549,7 +716,7 @@ QuicTxBufferTestCase::TestNewBlock ()
                                                    true, false);
   p4->AddHeader (sub);
   txBuf.Add (p4);
-  ptx = txBuf.NextSequence (2400, SequenceNumber32 (4));
+  ptx = txBuf.NextSequence (2400, SequenceNumber64 (4));
   NS_TEST_ASSERT_MSG_EQ(ptx->GetSize (), 2400,
                         "Returned packet has different size than requested");
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 5406,
@@ -558,8 +725,7 @@ QuicTxBufferTestCase::TestNewBlock ()
   additionalAckBlocks.pop_back ();
   largestAcknowledged = 4;
   // Clear everything
-  acked = txBuf.OnAckUpdate (tcbd, largestAcknowledged, additionalAckBlocks,
-                             gaps);
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 0,
                         "TxBuf miscalculates size of in flight segments");
 }
@@ -595,29 +761,28 @@ QuicTxBufferTestCase::TestPartialAck ()
   txBuf.Add (p6);
 
   // send the packets with successive sequence numbers
-  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber32 (1));
-  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber32 (2));
-  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber32 (3));
-  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber32 (4));
-  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber32 (5));
-  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber32 (6));
+  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber64 (1));
+  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber64 (2));
+  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber64 (3));
+  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber64 (4));
+  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber64 (5));
+  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber64 (6));
 
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 7200,
                         "TxBuf miscalculates size of in flight segments");
 
-  std::vector<uint32_t> additionalAckBlocks;
-  std::vector<uint32_t> gaps;
-  uint32_t largestAcknowledged = 6;
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+  uint64_t largestAcknowledged = 6;
   additionalAckBlocks.push_back (4);
   gaps.push_back (6);
 
   // acknowledge all packets except 5
-  std::vector<QuicSocketTxItem*> acked = txBuf.OnAckUpdate (tcbd,
-                                                            largestAcknowledged,
-                                                            additionalAckBlocks,
-                                                            gaps);
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
 
-  std::vector<QuicSocketTxItem*> lost = txBuf.DetectLostPackets ();
+  txBuf.DetectLostPackets (lost);
   NS_TEST_ASSERT_MSG_EQ(lost.empty (), true,
                         "TxBuf detects a non-existent loss");
   NS_TEST_ASSERT_MSG_EQ(
@@ -625,7 +790,7 @@ QuicTxBufferTestCase::TestPartialAck ()
       "TxBuf does not correctly detect the number of ACKed packets");
 
   // test ACK correctness
-  std::vector<uint32_t> pkts;
+  std::vector<uint64_t> pkts;
   pkts.push_back (6);
   pkts.push_back (4);
   pkts.push_back (3);
@@ -676,35 +841,34 @@ QuicTxBufferTestCase::TestAckLoss ()
   txBuf.Add (p6);
 
   // send the packets with successive sequence numbers
-  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber32 (1));
-  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber32 (2));
-  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber32 (3));
-  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber32 (4));
-  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber32 (5));
-  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber32 (6));
+  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber64 (1));
+  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber64 (2));
+  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber64 (3));
+  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber64 (4));
+  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber64 (5));
+  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber64 (6));
 
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 7200,
                         "TxBuf miscalculates size of in flight segments");
 
-  std::vector<uint32_t> additionalAckBlocks;
-  std::vector<uint32_t> gaps;
-  uint32_t largestAcknowledged = 6;
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+  uint64_t largestAcknowledged = 6;
   gaps.push_back (3);
   additionalAckBlocks.push_back (1);
 
   // acknowledge all packets except 5
-  std::vector<QuicSocketTxItem*> acked = txBuf.OnAckUpdate (tcbd,
-                                                            largestAcknowledged,
-                                                            additionalAckBlocks,
-                                                            gaps);
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
 
-  std::vector<QuicSocketTxItem*> lost = txBuf.DetectLostPackets ();
+  txBuf.DetectLostPackets (lost);
   NS_TEST_ASSERT_MSG_EQ(
       acked.size(), 5,
       "TxBuf does not correctly detect the number of ACKed packets");
 
   // test ACK correctness
-  std::vector<uint32_t> pkts;
+  std::vector<uint64_t> pkts;
   pkts.push_back (6);
   pkts.push_back (5);
   pkts.push_back (4);
@@ -761,39 +925,40 @@ QuicTxBufferTestCase::TestSetLoss ()
   txBuf.Add (p6);
 
   // send the packets with successive sequence numbers
-  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber32 (1));
-  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber32 (2));
-  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber32 (3));
-  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber32 (4));
-  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber32 (5));
-  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber32 (6));
+  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber64 (1));
+  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber64 (2));
+  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber64 (3));
+  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber64 (4));
+  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber64 (5));
+  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber64 (6));
 
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 7200,
                         "TxBuf miscalculates size of in flight segments");
-  bool found = txBuf.MarkAsLost (SequenceNumber32 (4));
+  bool found = txBuf.MarkAsLost (SequenceNumber64 (4));
 
   NS_TEST_ASSERT_MSG_EQ(found, true, "TxBuf misses lost packet");
 
   // mark packet 4 as lost
-  std::vector<QuicSocketTxItem*> lost = txBuf.DetectLostPackets ();
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.DetectLostPackets (lost);
 
   NS_TEST_ASSERT_MSG_EQ(lost.size (), 1,
                         "TxBuf cannot set the correct number of lost packets");
-  NS_TEST_ASSERT_MSG_EQ(lost.at (0)->m_packetNumber, SequenceNumber32 (4),
+  NS_TEST_ASSERT_MSG_EQ(lost.at (0)->m_packetNumber, SequenceNumber64 (4),
                         "TxBuf gets the wrong lost packet ID");
 
   // mark packets 1 and 2 as lost (all except the last 4)
   txBuf.ResetSentList (4);
 
-  lost = txBuf.DetectLostPackets ();
+  txBuf.DetectLostPackets (lost);
 
   NS_TEST_ASSERT_MSG_EQ(lost.size (), 3,
                         "TxBuf cannot set the correct number of lost packets");
-  NS_TEST_ASSERT_MSG_EQ(lost.at (0)->m_packetNumber, SequenceNumber32 (1),
+  NS_TEST_ASSERT_MSG_EQ(lost.at (0)->m_packetNumber, SequenceNumber64 (1),
                         "TxBuf gets the wrong lost packet ID");
-  NS_TEST_ASSERT_MSG_EQ(lost.at (1)->m_packetNumber, SequenceNumber32 (2),
+  NS_TEST_ASSERT_MSG_EQ(lost.at (1)->m_packetNumber, SequenceNumber64 (2),
                         "TxBuf gets the wrong lost packet ID");
-  NS_TEST_ASSERT_MSG_EQ(lost.at (2)->m_packetNumber, SequenceNumber32 (4),
+  NS_TEST_ASSERT_MSG_EQ(lost.at (2)->m_packetNumber, SequenceNumber64 (4),
                         "TxBuf gets the wrong lost packet ID");
 
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 7200,
@@ -837,12 +1002,12 @@ QuicTxBufferTestCase::TestAddBlocks ()
   NS_TEST_ASSERT_MSG_EQ(extra, false, "TxBuf adds a packet in overflow");
 
   // send the packets with successive sequence numbers
-  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber32 (1));
-  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber32 (2));
-  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber32 (3));
-  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber32 (4));
-  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber32 (5));
-  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber32 (6));
+  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber64 (1));
+  Ptr<Packet> ptx2 = txBuf.NextSequence (1200, SequenceNumber64 (2));
+  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber64 (3));
+  Ptr<Packet> ptx4 = txBuf.NextSequence (1200, SequenceNumber64 (4));
+  Ptr<Packet> ptx5 = txBuf.NextSequence (1200, SequenceNumber64 (5));
+  Ptr<Packet> ptx6 = txBuf.NextSequence (1200, SequenceNumber64 (6));
 
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 6000,
                         "TxBuf miscalculates size of in flight segments");
@@ -876,28 +1041,27 @@ QuicTxBufferTestCase::TestStream0 ()
   txBuf.Add (p3);
 
   // send the packets with successive sequence numbers
-  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber32 (1));
+  Ptr<Packet> ptx1 = txBuf.NextSequence (1200, SequenceNumber64 (1));
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200,
                         "TxBuf miscalculates size of in flight segments");
 
-  Ptr<Packet> ptx2 = txBuf.NextStream0Sequence (SequenceNumber32 (2));
+  Ptr<Packet> ptx2 = txBuf.NextStream0Sequence (SequenceNumber64 (2));
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200,
                         "TxBuf miscalculates size of in flight segments");
 
-  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber32 (3));
+  Ptr<Packet> ptx3 = txBuf.NextSequence (1200, SequenceNumber64 (3));
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 2400,
                         "TxBuf miscalculates size of in flight segments");
 
-  std::vector<uint32_t> additionalAckBlocks;
-  std::vector<uint32_t> gaps;
-  uint32_t largestAcknowledged = 1;
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+  uint64_t largestAcknowledged = 1;
   additionalAckBlocks.push_back (1);
 
   // acknowledge all packets except 5
-  std::vector<QuicSocketTxItem*> acked = txBuf.OnAckUpdate (tcbd,
-                                                            largestAcknowledged,
-                                                            additionalAckBlocks,
-                                                            gaps);
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200,
                         "TxBuf miscalculates size of in flight segments");
 
@@ -905,14 +1069,187 @@ QuicTxBufferTestCase::TestStream0 ()
   additionalAckBlocks.push_back (2);
 
   // acknowledge all packets except 5
-  acked = txBuf.OnAckUpdate (tcbd,
-                                                            largestAcknowledged,
-                                                            additionalAckBlocks,
-                                                            gaps);
+  txBuf.OnAckUpdate (*tcbd, largestAcknowledged, additionalAckBlocks, gaps, acked, lost);
   NS_TEST_ASSERT_MSG_EQ(txBuf.BytesInFlight (), 1200,
                         "TxBuf miscalculates size of in flight segments");
 }
 
+void
+QuicTxBufferTestCase::TestAckRanges ()
+{
+  // create the buffer
+  QuicSocketTxBuffer txBuf;
+  Ptr<QuicSocketState> tcbd;
+
+  tcbd = CreateObject<QuicSocketState> ();
+  tcbd->m_kUsingTimeLossDetection = false;
+
+  // send 8 packets, skipping packet number 4
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1196);
+      QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (1, i * 1196, p->GetSize (),
+                                                                false, true, false);
+      p->AddHeader (sub);
+      txBuf.Add (p);
+      uint32_t packetNumber = (i < 3) ? i + 1 : i + 2;
+      Ptr<Packet> ptx = txBuf.NextSequence (1200, SequenceNumber64 (packetNumber));
+      NS_TEST_ASSERT_MSG_EQ (ptx->GetSize (), 1200, "TxBuf miscalculates size");
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 9600, "TxBuf miscalculates size of in flight segments");
+
+  // ack packets 6-7 and 1-2
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+  gaps.push_back (5);
+  additionalAckBlocks.push_back (2);
+
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, 7, additionalAckBlocks, gaps, acked, lost);
+  NS_TEST_ASSERT_MSG_EQ (acked.size (), 4, "Wrong acked packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (acked.at (0)->m_packetNumber, SequenceNumber64 (7),
+                         "Acked packets are not ordered from the highest");
+  NS_TEST_ASSERT_MSG_EQ (acked.at (3)->m_packetNumber, SequenceNumber64 (1),
+                         "Acked packets are not ordered from the highest");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 4800, "TxBuf miscalculates size of in flight segments");
+
+  std::vector<QuicSocketTxItem*> lostPackets;
+  txBuf.DetectLostPackets (lostPackets);
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.size (), 1, "Wrong lost packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.at (0)->m_packetNumber, SequenceNumber64 (3),
+                         "TxBuf gets the wrong lost packet ID");
+
+  // ack packet 9, which makes packet 5 exceed the reordering threshold
+  gaps.clear ();
+  additionalAckBlocks.clear ();
+  gaps.push_back (8);
+  additionalAckBlocks.push_back (7);
+  gaps.push_back (5);
+  additionalAckBlocks.push_back (2);
+
+  txBuf.OnAckUpdate (*tcbd, 9, additionalAckBlocks, gaps, acked, lost);
+  NS_TEST_ASSERT_MSG_EQ (acked.size (), 1, "Wrong acked packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (acked.at (0)->m_packetNumber, SequenceNumber64 (9),
+                         "TxBuf gets the wrong acked packet ID");
+  NS_TEST_ASSERT_MSG_EQ (lost.size (), 1, "Wrong newly lost packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (lost.at (0)->m_packetNumber, SequenceNumber64 (5),
+                         "TxBuf gets the wrong newly lost packet ID");
+
+  txBuf.DetectLostPackets (lostPackets);
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.size (), 2, "Wrong lost packet vector size");
+  NS_TEST_ASSERT_MSG_EQ (lostPackets.at (1)->m_packetNumber, SequenceNumber64 (5),
+                         "TxBuf gets the wrong lost packet ID");
+
+  std::vector<QuicStreamFrameRange> lostFrames;
+  uint32_t toRetx = txBuf.Retransmission (lostFrames);
+  NS_TEST_ASSERT_MSG_EQ (toRetx, 0, "Stream data put back in the socket buffer");
+  NS_TEST_ASSERT_MSG_EQ (lostFrames.size (), 2, "wrong number of lost frames");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 1200, "TxBuf miscalculates size of in flight segments");
+}
+
+void
+QuicTxBufferTestCase::TestRateSample ()
+{
+  // create the buffer
+  QuicSocketTxBuffer txBuf;
+  Ptr<QuicSocketState> tcbd;
+
+  tcbd = CreateObject<QuicSocketState> ();
+  tcbd->m_kUsingTimeLossDetection = false;
+  std::vector<uint64_t> additionalAckBlocks;
+  std::vector<uint64_t> gaps;
+
+  // send 4 packets at time 0
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1196);
+      QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (1, i * 1196, p->GetSize (),
+                                                                false, true, false);
+      p->AddHeader (sub);
+      txBuf.Add (p);
+      txBuf.NextSequence (1200, SequenceNumber64 (i + 1));
+    }
+
+  // ack packets 1-2 after 100 ms
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, 2, additionalAckBlocks, gaps, acked, lost);
+  QuicRateSample rs = txBuf.GetRateSample ();
+  NS_TEST_ASSERT_MSG_EQ (rs.IsValid (), true, "The rate sample is not valid");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackedBytes, 2400, "Wrong number of acked bytes");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_delivered, 2400, "Wrong number of delivered bytes");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_interval, MilliSeconds (100), "Wrong sampling interval");
+  NS_TEST_ASSERT_MSG_EQ_TOL (rs.m_deliveryRate.GetBitRate (), 192000, 1, "Wrong delivery rate");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_isAppLimited, false, "Sample wrongly marked as application limited");
+
+  // the application has no more data: the next packet is application limited
+  txBuf.CheckAppLimited (100000);
+  Ptr<Packet> p = Create<Packet> (1196);
+  QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (1, 4 * 1196, p->GetSize (),
+                                                            false, true, false);
+  p->AddHeader (sub);
+  txBuf.Add (p);
+  txBuf.NextSequence (1200, SequenceNumber64 (5));
+
+  // ack packets 3-5 after 100 ms: the sample starts with the delivery of
+  // packet 2 and with the transmission of packet 2
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  txBuf.OnAckUpdate (*tcbd, 5, additionalAckBlocks, gaps, acked, lost);
+  rs = txBuf.GetRateSample ();
+  NS_TEST_ASSERT_MSG_EQ (rs.IsValid (), true, "The rate sample is not valid");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackedBytes, 3600, "Wrong number of acked bytes");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_priorDelivered, 2400, "Wrong start of the sampling interval");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_sendElapsed, MilliSeconds (100), "Wrong send phase");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_ackElapsed, MilliSeconds (100), "Wrong ACK phase");
+  NS_TEST_ASSERT_MSG_EQ_TOL (rs.m_deliveryRate.GetBitRate (), 288000, 1, "Wrong delivery rate");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_isAppLimited, true, "Sample not marked as application limited");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetDelivered (), 6000, "Wrong number of delivered bytes");
+  NS_TEST_ASSERT_MSG_EQ (rs.m_totalDelivered, 6000, "Wrong total delivered in the sample");
+
+  Simulator::Destroy ();
+}
+
+void
+QuicTxBufferTestCase::TestLargePacketNumbers ()
+{
+  QuicSocketTxBuffer txBuf;
+  Ptr<QuicSocketState> tcbd = CreateObject<QuicSocketState> ();
+  tcbd->m_kUsingTimeLossDetection = false;
+  uint64_t base = ((uint64_t) 1 << 32) - 3;
+
+  for (uint64_t i = 0; i < 6; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1196);
+      QuicSubheader sub = QuicSubheader::CreateStreamSubHeader (1, i * 1196, p->GetSize (),
+                                                                false, true, false);
+      p->AddHeader (sub);
+      txBuf.Add (p);
+      txBuf.NextSequence (1200, SequenceNumber64 (base + i));
+    }
+
+  // ack everything but base + 1
+  std::vector<uint64_t> gaps (1, base + 1);
+  std::vector<uint64_t> additionalAckBlocks (1, base);
+  std::vector<QuicSocketTxItem*> acked;
+  std::vector<QuicSocketTxItem*> lost;
+  txBuf.OnAckUpdate (*tcbd, base + 5, additionalAckBlocks, gaps, acked, lost);
+  NS_TEST_ASSERT_MSG_EQ (acked.size (), 5, "Wrong number of acked packets");
+  NS_TEST_ASSERT_MSG_EQ (acked.at (0)->m_packetNumber, SequenceNumber64 (base + 5),
+                         "Wrong largest acked packet");
+  NS_TEST_ASSERT_MSG_EQ (acked.at (4)->m_packetNumber, SequenceNumber64 (base),
+                         "Wrong smallest acked packet");
+
+  txBuf.DetectLostPackets (lost);
+  NS_TEST_ASSERT_MSG_EQ (lost.size (), 1, "Wrong number of lost packets");
+  NS_TEST_ASSERT_MSG_EQ (lost.at (0)->m_packetNumber, SequenceNumber64 (base + 1),
+                         "Wrong lost packet");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 1200, "Wrong bytes in flight");
+}
+
 void
 QuicTxBufferTestCase::DoTeardown ()
 {